@@ -22,16 +22,16 @@
 #include "cache_service.hh"
 #include "api/api-doc/cache_service.json.hh"
 #include "column_family.hh"
+#include "db/config.hh"
 
 namespace api {
 using namespace json;
 namespace cs = httpd::cache_service_json;
 
 void set_cache_service(http_context& ctx, routes& r) {
-    cs::get_row_cache_save_period_in_seconds.set(r, [](std::unique_ptr<request> req) {
-        // We never save the cache
+    cs::get_row_cache_save_period_in_seconds.set(r, [&ctx](std::unique_ptr<request> req) {
         // Origin uses 0 for never
-        return make_ready_future<json::json_return_type>(0);
+        return make_ready_future<json::json_return_type>(ctx.db.local().get_config().row_cache_save_period());
     });
 
     cs::set_row_cache_save_period_in_seconds.set(r, [](std::unique_ptr<request> req) {
@@ -41,10 +41,8 @@ void set_cache_service(http_context& ctx, routes& r) {
         return make_ready_future<json::json_return_type>(json_void());
     });
 
-    cs::get_key_cache_save_period_in_seconds.set(r, [](std::unique_ptr<request> req) {
-        // We never save the cache
-        // Origin uses 0 for never
-        return make_ready_future<json::json_return_type>(0);
+    cs::get_key_cache_save_period_in_seconds.set(r, [&ctx](std::unique_ptr<request> req) {
+        return make_ready_future<json::json_return_type>(ctx.db.local().get_config().key_cache_save_period());
     });
 
     cs::set_key_cache_save_period_in_seconds.set(r, [](std::unique_ptr<request> req) {
@@ -67,10 +65,8 @@ void set_cache_service(http_context& ctx, routes& r) {
         return make_ready_future<json::json_return_type>(json_void());
     });
 
-    cs::get_row_cache_keys_to_save.set(r, [](std::unique_ptr<request> req) {
-        // TBD
-        unimplemented();
-        return make_ready_future<json::json_return_type>(0);
+    cs::get_row_cache_keys_to_save.set(r, [&ctx](std::unique_ptr<request> req) {
+        return make_ready_future<json::json_return_type>(ctx.db.local().get_config().row_cache_keys_to_save());
     });
 
     cs::set_row_cache_keys_to_save.set(r, [](std::unique_ptr<request> req) {
@@ -80,10 +76,8 @@ void set_cache_service(http_context& ctx, routes& r) {
         return make_ready_future<json::json_return_type>(json_void());
     });
 
-    cs::get_key_cache_keys_to_save.set(r, [](std::unique_ptr<request> req) {
-        // TBD
-        unimplemented();
-        return make_ready_future<json::json_return_type>(0);
+    cs::get_key_cache_keys_to_save.set(r, [&ctx](std::unique_ptr<request> req) {
+        return make_ready_future<json::json_return_type>(ctx.db.local().get_config().key_cache_keys_to_save());
     });
 
     cs::set_key_cache_keys_to_save.set(r, [](std::unique_ptr<request> req) {
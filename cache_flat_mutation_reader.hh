@@ -487,14 +487,24 @@ void cache_flat_mutation_reader::maybe_add_to_cache(const clustering_row& cr) {
         if (_read_context.digest_requested()) {
             cr.cells().prepare_hash(*_schema, column_kind::regular_column);
         }
-        auto new_entry = alloc_strategy_unique_ptr<rows_entry>(
-            current_allocator().construct<rows_entry>(*_schema, cr.key(), cr.as_deletable_row()));
-        new_entry->set_continuous(false);
+        auto& rows = mp.clustered_rows();
         auto it = _next_row.iterators_valid() ? _next_row.get_iterator_in_latest_version()
-                                              : mp.clustered_rows().lower_bound(cr.key(), cmp);
-        auto insert_result = mp.clustered_rows().insert_before_hint(it, std::move(new_entry), cmp);
-        it = insert_result.first;
-        if (insert_result.second) {
+                                              : rows.lower_bound(cr.key(), cmp);
+        // Rows are read from underlying when the range is not continuous in cache,
+        // so they may already be cached. Find the row's position before building an
+        // entry for it, which copies all of its cells into LSA memory.
+        auto before_it = [&] {
+            return (it == rows.end() || cmp(cr.key(), *it) < 0)
+                && (it == rows.begin() || cmp(cr.key(), *std::prev(it)) > 0);
+        };
+        if (!before_it()) {
+            it = rows.lower_bound(cr.key(), cmp);
+        }
+        if (it == rows.end() || cmp(cr.key(), *it) != 0) {
+            auto new_entry = alloc_strategy_unique_ptr<rows_entry>(
+                current_allocator().construct<rows_entry>(*_schema, cr.key(), cr.as_deletable_row()));
+            new_entry->set_continuous(false);
+            it = rows.insert_before(it, std::move(new_entry));
             _snp->tracker()->insert(*it);
         }
 
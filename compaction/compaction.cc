@@ -506,6 +506,8 @@ class compaction {
     lw_shared_ptr<sstable_set> _compacting;
     uint64_t _max_sstable_size;
     uint32_t _sstable_level;
+    // Output is repaired only if all of the input is.
+    uint64_t _repaired_at = 0;
     lw_shared_ptr<compaction_info> _info;
     uint64_t _estimated_partitions = 0;
     std::vector<unsigned long> _ancestors;
@@ -555,6 +557,11 @@ class compaction {
         for (auto& sst : _sstables) {
             _stats_collector.update(sst->get_encoding_stats_for_compaction());
         }
+        if (!_sstables.empty() && std::all_of(_sstables.begin(), _sstables.end(), std::mem_fn(&sstable::is_repaired))) {
+            _repaired_at = (*std::min_element(_sstables.begin(), _sstables.end(), [] (const shared_sstable& a, const shared_sstable& b) {
+                return a->get_repaired_at() < b->get_repaired_at();
+            }))->get_repaired_at();
+        }
         std::unordered_set<utils::UUID> ssts_run_ids;
         _contains_multi_fragment_runs = std::any_of(_sstables.begin(), _sstables.end(), [&ssts_run_ids] (shared_sstable& sst) {
             return !ssts_run_ids.insert(sst->run_identifier()).second;
@@ -595,6 +602,7 @@ class compaction {
         cfg.run_identifier = _run_identifier;
         cfg.replay_position = _rp;
         cfg.sstable_level = _sstable_level;
+        cfg.repaired_at = _repaired_at;
         return cfg;
     }
 
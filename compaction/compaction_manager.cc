@@ -252,21 +252,32 @@ future<> compaction_manager::submit_major_compaction(column_family* cf) {
 
             // candidates are sstables that aren't being operated on by other compaction types.
             // those are eligible for major compaction.
-            sstables::compaction_strategy cs = cf->get_compaction_strategy();
-            sstables::compaction_descriptor descriptor = cs.get_major_compaction_job(*cf, get_candidates(*cf));
-            auto compacting = make_lw_shared<compacting_sstable_registration>(this, descriptor.sstables);
-            descriptor.release_exhausted = [compacting] (const std::vector<sstables::shared_sstable>& exhausted_sstables) {
-                compacting->release_compacting(exhausted_sstables);
-            };
-
-            cmlog.info0("User initiated compaction started on behalf of {}.{}", cf->schema()->ks_name(), cf->schema()->cf_name());
-            compaction_backlog_tracker user_initiated(std::make_unique<user_initiated_backlog_tracker>(_compaction_controller.backlog_of_shares(200), _available_memory));
-            return do_with(std::move(user_initiated), [this, cf, descriptor = std::move(descriptor)] (compaction_backlog_tracker& bt) mutable {
-                register_backlog_tracker(bt);
-                return with_scheduling_group(_compaction_controller.sg(), [this, cf, descriptor = std::move(descriptor)] () mutable {
-                    return cf->compact_sstables(std::move(descriptor));
-                });
-            }).then([compacting = std::move(compacting)] {});
+            // Unrepaired and repaired sstables are compacted by separate jobs, so that
+            // major compaction doesn't make repaired data unrepaired.
+            auto [unrepaired, repaired] = sstables::partition_by_repaired_status(get_candidates(*cf));
+            auto candidate_sets = std::vector<std::vector<sstables::shared_sstable>>{std::move(unrepaired), std::move(repaired)};
+            return do_with(std::move(candidate_sets), [this, task, cf] (std::vector<std::vector<sstables::shared_sstable>>& candidate_sets) {
+              return do_for_each(candidate_sets, [this, task, cf] (std::vector<sstables::shared_sstable>& candidates) {
+                if (candidates.empty() || !can_proceed(task)) {
+                    return make_ready_future<>();
+                }
+                sstables::compaction_strategy cs = cf->get_compaction_strategy();
+                sstables::compaction_descriptor descriptor = cs.get_major_compaction_job(*cf, std::move(candidates));
+                auto compacting = make_lw_shared<compacting_sstable_registration>(this, descriptor.sstables);
+                descriptor.release_exhausted = [compacting] (const std::vector<sstables::shared_sstable>& exhausted_sstables) {
+                    compacting->release_compacting(exhausted_sstables);
+                };
+
+                cmlog.info0("User initiated compaction started on behalf of {}.{}", cf->schema()->ks_name(), cf->schema()->cf_name());
+                compaction_backlog_tracker user_initiated(std::make_unique<user_initiated_backlog_tracker>(_compaction_controller.backlog_of_shares(200), _available_memory));
+                return do_with(std::move(user_initiated), [this, cf, descriptor = std::move(descriptor)] (compaction_backlog_tracker& bt) mutable {
+                    register_backlog_tracker(bt);
+                    return with_scheduling_group(_compaction_controller.sg(), [this, cf, descriptor = std::move(descriptor)] () mutable {
+                        return cf->compact_sstables(std::move(descriptor));
+                    });
+                }).then([compacting = std::move(compacting)] {});
+              });
+            });
         });
     }).then_wrapped([this, task] (future<> f) {
         _stats.active_tasks--;
@@ -55,6 +55,7 @@
 #include "date_tiered_compaction_strategy.hh"
 #include "leveled_compaction_strategy.hh"
 #include "time_window_compaction_strategy.hh"
+#include "incremental_compaction_strategy.hh"
 #include "compaction_backlog_manager.hh"
 #include "size_tiered_backlog_tracker.hh"
 #include "leveled_manifest.hh"
@@ -634,7 +635,17 @@ compaction_strategy_type compaction_strategy::type() const {
 }
 
 compaction_descriptor compaction_strategy::get_sstables_for_compaction(column_family& cfs, std::vector<sstables::shared_sstable> candidates) {
-    return _compaction_strategy_impl->get_sstables_for_compaction(cfs, std::move(candidates));
+    auto [unrepaired, repaired] = partition_by_repaired_status(std::move(candidates));
+    if (repaired.empty()) {
+        return _compaction_strategy_impl->get_sstables_for_compaction(cfs, std::move(unrepaired));
+    }
+    if (!unrepaired.empty()) {
+        auto desc = _compaction_strategy_impl->get_sstables_for_compaction(cfs, std::move(unrepaired));
+        if (!desc.sstables.empty()) {
+            return desc;
+        }
+    }
+    return _compaction_strategy_impl->get_sstables_for_compaction(cfs, std::move(repaired));
 }
 
 compaction_descriptor compaction_strategy::get_major_compaction_job(column_family& cf, std::vector<sstables::shared_sstable> candidates) {
@@ -678,6 +689,15 @@ bool compaction_strategy::use_interposer_consumer() const {
     return _compaction_strategy_impl->use_interposer_consumer();
 }
 
+std::pair<std::vector<shared_sstable>, std::vector<shared_sstable>> partition_by_repaired_status(std::vector<shared_sstable> sstables) {
+    auto it = std::stable_partition(sstables.begin(), sstables.end(), [] (const shared_sstable& sst) {
+        return !sst->is_repaired();
+    });
+    std::vector<shared_sstable> repaired(std::make_move_iterator(it), std::make_move_iterator(sstables.end()));
+    sstables.erase(it, sstables.end());
+    return {std::move(sstables), std::move(repaired)};
+}
+
 compaction_strategy make_compaction_strategy(compaction_strategy_type strategy, const std::map<sstring, sstring>& options) {
     ::shared_ptr<compaction_strategy_impl> impl;
 
@@ -697,6 +717,9 @@ compaction_strategy make_compaction_strategy(compaction_strategy_type strategy,
     case compaction_strategy_type::time_window:
         impl = ::make_shared<time_window_compaction_strategy>(options);
         break;
+    case compaction_strategy_type::incremental:
+        impl = ::make_shared<incremental_compaction_strategy>(options);
+        break;
     default:
         throw std::runtime_error("strategy not supported");
     }
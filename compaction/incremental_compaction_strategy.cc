@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "incremental_compaction_strategy.hh"
+#include "sstables/sstables.hh"
+#include "service/priority_manager.hh"
+#include "database.hh"
+#include "exceptions/exceptions.hh"
+
+#include <cmath>
+#include <unordered_map>
+#include <boost/range/adaptors.hpp>
+#include <boost/range/algorithm.hpp>
+#include <boost/algorithm/cxx11/none_of.hpp>
+
+namespace sstables {
+
+// Same as size_tiered_backlog_tracker, except that the unit of compaction,
+// whose size determines the backlog, is a whole sstable run.
+class incremental_backlog_tracker final : public compaction_backlog_tracker::impl {
+    int64_t _total_bytes = 0;
+    double _runs_backlog_contribution = 0.0f;
+    std::unordered_map<utils::UUID, int64_t> _run_sizes;
+
+    struct inflight_component {
+        int64_t total_bytes = 0;
+        double contribution = 0;
+    };
+
+    static double log4(double x) {
+        double inv_log_4 = 1.0f / std::log(4);
+        return log(x) * inv_log_4;
+    }
+
+    static double contribution(int64_t run_size) {
+        return run_size > 0 ? run_size * log4(run_size) : 0;
+    }
+
+    void update_run_size(utils::UUID run_id, int64_t delta) {
+        auto& size = _run_sizes[run_id];
+        _runs_backlog_contribution -= contribution(size);
+        size += delta;
+        _runs_backlog_contribution += contribution(size);
+        _total_bytes += delta;
+        if (size <= 0) {
+            _run_sizes.erase(run_id);
+        }
+    }
+
+    inflight_component partial_backlog(const compaction_backlog_tracker::ongoing_writes& ongoing_writes) const {
+        std::unordered_map<utils::UUID, int64_t> written_by_run;
+        for (auto const& swp : ongoing_writes) {
+            written_by_run[swp.first->run_identifier()] += swp.second->written();
+        }
+        inflight_component in;
+        for (auto const& [run_id, written] : written_by_run) {
+            in.total_bytes += written;
+            in.contribution += contribution(written);
+        }
+        return in;
+    }
+
+    inflight_component compacted_backlog(const compaction_backlog_tracker::ongoing_compactions& ongoing_compactions) const {
+        inflight_component in;
+        for (auto const& crp : ongoing_compactions) {
+            auto compacted = crp.second->compacted();
+            auto it = _run_sizes.find(crp.first->run_identifier());
+            int64_t run_size = it != _run_sizes.end() ? it->second : crp.first->data_size();
+            if (run_size > 0) {
+                in.total_bytes += compacted;
+                in.contribution += compacted * log4(run_size);
+            }
+        }
+        return in;
+    }
+public:
+    virtual double backlog(const compaction_backlog_tracker::ongoing_writes& ow, const compaction_backlog_tracker::ongoing_compactions& oc) const override {
+        inflight_component partial = partial_backlog(ow);
+        inflight_component compacted = compacted_backlog(oc);
+
+        auto effective_total_size = _total_bytes + partial.total_bytes - compacted.total_bytes;
+        if (effective_total_size <= 0 || _total_bytes <= 0) {
+            return 0;
+        }
+        auto runs_contribution = _runs_backlog_contribution + partial.contribution - compacted.contribution;
+        auto b = (effective_total_size * log4(_total_bytes)) - runs_contribution;
+        return b > 0 ? b : 0;
+    }
+
+    virtual void add_sstable(sstables::shared_sstable sst) override {
+        if (sst->data_size() > 0) {
+            update_run_size(sst->run_identifier(), sst->data_size());
+        }
+    }
+
+    virtual void remove_sstable(sstables::shared_sstable sst) override {
+        if (sst->data_size() > 0) {
+            update_run_size(sst->run_identifier(), -int64_t(sst->data_size()));
+        }
+    }
+};
+
+incremental_compaction_strategy_options::incremental_compaction_strategy_options(const std::map<sstring, sstring>& options) {
+    using namespace cql3::statements;
+
+    auto tmp_value = compaction_strategy_impl::get_value(options, MIN_SSTABLE_SIZE_KEY);
+    min_sstable_size = property_definitions::to_long(MIN_SSTABLE_SIZE_KEY, tmp_value, DEFAULT_MIN_SSTABLE_SIZE);
+
+    tmp_value = compaction_strategy_impl::get_value(options, BUCKET_LOW_KEY);
+    bucket_low = property_definitions::to_double(BUCKET_LOW_KEY, tmp_value, DEFAULT_BUCKET_LOW);
+
+    tmp_value = compaction_strategy_impl::get_value(options, BUCKET_HIGH_KEY);
+    bucket_high = property_definitions::to_double(BUCKET_HIGH_KEY, tmp_value, DEFAULT_BUCKET_HIGH);
+
+    tmp_value = compaction_strategy_impl::get_value(options, SSTABLE_SIZE_OPTION);
+    auto fragment_size_in_mb = property_definitions::to_int(SSTABLE_SIZE_OPTION, tmp_value, DEFAULT_MAX_SSTABLE_SIZE_IN_MB);
+    if (fragment_size_in_mb <= 0) {
+        throw exceptions::configuration_exception(format("{} must be positive: {}", SSTABLE_SIZE_OPTION, fragment_size_in_mb));
+    }
+    fragment_size = uint64_t(fragment_size_in_mb) * 1024 * 1024;
+}
+
+incremental_compaction_strategy::incremental_compaction_strategy(const std::map<sstring, sstring>& options)
+    : compaction_strategy_impl(options)
+    , _options(options)
+    , _backlog_tracker(std::make_unique<incremental_backlog_tracker>())
+{}
+
+// Group sstables by the run they belong to. Fragments of a run which are
+// not among the given sstables, e.g. because they're being compacted, are
+// left out of it.
+static std::vector<sstable_run> make_runs(const std::vector<shared_sstable>& sstables) {
+    std::unordered_map<utils::UUID, sstable_run> runs;
+    for (auto& sst : sstables) {
+        runs[sst->run_identifier()].insert(sst);
+    }
+    return boost::copy_range<std::vector<sstable_run>>(runs | boost::adaptors::map_values);
+}
+
+std::vector<std::vector<sstable_run>>
+incremental_compaction_strategy::get_buckets(const std::vector<sstable_run>& runs, const incremental_compaction_strategy_options& options) {
+    // runs sorted by their data size.
+    auto sorted_runs = boost::copy_range<std::vector<std::pair<const sstable_run*, uint64_t>>>(runs
+            | boost::adaptors::transformed([] (const sstable_run& run) {
+        return std::make_pair(&run, run.data_size());
+    }));
+    std::sort(sorted_runs.begin(), sorted_runs.end(), [] (auto& i, auto& j) {
+        return i.second < j.second;
+    });
+
+    std::vector<std::vector<sstable_run>> bucket_list;
+    std::vector<double> bucket_average_size_list;
+    std::vector<uint64_t> bucket_smallest_size_list;
+
+    for (auto& [run, size] : sorted_runs) {
+        // look for a bucket containing similar-sized runs:
+        // group in the same bucket if it's w/in (bucket_low, bucket_high) of the average for this bucket,
+        // or this run and the bucket are all considered "small" (less than min_sstable_size)
+        if (!bucket_list.empty()) {
+            auto& bucket = bucket_list.back();
+            auto& bucket_average_size = bucket_average_size_list.back();
+
+            if ((size > (bucket_average_size * options.bucket_low) && size < (bucket_average_size * options.bucket_high)) ||
+                    (size < options.min_sstable_size && bucket_average_size < options.min_sstable_size)) {
+                auto total_size = bucket.size() * bucket_average_size;
+                auto new_average_size = (total_size + size) / (bucket.size() + 1);
+
+                // Runs are added in increasing size order so the bucket's
+                // average might drift upwards.
+                // Don't let it drift too high, to a point where the smallest
+                // run might fall out of range.
+                if (size < options.min_sstable_size || bucket_smallest_size_list.back() > new_average_size * options.bucket_low) {
+                    bucket.push_back(*run);
+                    bucket_average_size = new_average_size;
+                    continue;
+                }
+            }
+        }
+
+        // no similar bucket found; put it in a new one
+        bucket_list.push_back({*run});
+        bucket_average_size_list.push_back(size);
+        bucket_smallest_size_list.push_back(size);
+    }
+
+    return bucket_list;
+}
+
+std::vector<sstable_run>
+incremental_compaction_strategy::most_interesting_bucket(std::vector<std::vector<sstable_run>> buckets, size_t min_threshold, size_t max_threshold) {
+    std::vector<std::pair<std::vector<sstable_run>, uint64_t>> pruned_buckets;
+    pruned_buckets.reserve(buckets.size());
+
+    for (auto& bucket : buckets) {
+        bucket.resize(std::min(bucket.size(), max_threshold));
+        if (bucket.size() >= min_threshold) {
+            auto total = boost::accumulate(bucket | boost::adaptors::transformed(std::mem_fn(&sstable_run::data_size)), uint64_t(0));
+            auto avg = total / bucket.size();
+            pruned_buckets.push_back({ std::move(bucket), avg });
+        }
+    }
+
+    if (pruned_buckets.empty()) {
+        return {};
+    }
+
+    // Compacting smallest runs first, which is cheapest and reduces the run count the most.
+    auto& min = *std::min_element(pruned_buckets.begin(), pruned_buckets.end(), [] (auto& i, auto& j) {
+        return i.second < j.second;
+    });
+    return std::move(min.first);
+}
+
+std::vector<shared_sstable>
+incremental_compaction_strategy::runs_to_sstables(std::vector<sstable_run> runs) {
+    return boost::accumulate(runs, std::vector<shared_sstable>(), [] (std::vector<shared_sstable>&& v, const sstable_run& run) {
+        v.insert(v.end(), run.all().begin(), run.all().end());
+        return std::move(v);
+    });
+}
+
+compaction_descriptor
+incremental_compaction_strategy::make_descriptor(column_family& cf, std::vector<shared_sstable> sstables) const {
+    return compaction_descriptor(std::move(sstables), cf.get_sstable_set(), service::get_local_compaction_priority(),
+            compaction_descriptor::default_level, _options.fragment_size);
+}
+
+compaction_descriptor
+incremental_compaction_strategy::get_sstables_for_compaction(column_family& cf, std::vector<sstables::shared_sstable> candidates) {
+    // make local copies so they can't be changed out from under us mid-method
+    size_t min_threshold = cf.min_compaction_threshold();
+    size_t max_threshold = cf.schema()->max_compaction_threshold();
+    auto gc_before = gc_clock::now() - cf.schema()->gc_grace_seconds();
+
+    auto buckets = get_buckets(make_runs(candidates), _options);
+
+    auto most_interesting = most_interesting_bucket(buckets, min_threshold, max_threshold);
+    if (!most_interesting.empty()) {
+        return make_descriptor(cf, runs_to_sstables(std::move(most_interesting)));
+    }
+
+    // If we are not enforcing min_threshold explicitly, try any pair of runs in the same tier.
+    if (!cf.compaction_enforce_min_threshold()) {
+        most_interesting = most_interesting_bucket(buckets, 2, max_threshold);
+        if (!most_interesting.empty()) {
+            return make_descriptor(cf, runs_to_sstables(std::move(most_interesting)));
+        }
+    }
+
+    // If there is no run to compact in standard way, try compacting a single run
+    // containing a fragment whose droppable tombstone ratio is greater than threshold.
+    // Prefer oldest runs from biggest size tiers because they will be easier to satisfy
+    // conditions for tombstone purge, i.e. less likely to shadow even older data.
+    auto min_timestamp = [] (const sstable_run& run) {
+        auto ts = api::max_timestamp;
+        for (auto& sst : run.all()) {
+            ts = std::min(ts, sst->get_stats_metadata().min_timestamp);
+        }
+        return ts;
+    };
+    for (auto&& runs : buckets | boost::adaptors::reversed) {
+        std::erase_if(runs, [this, &gc_before] (const sstable_run& run) {
+            return boost::algorithm::none_of(run.all(), [this, &gc_before] (const shared_sstable& sst) {
+                return worth_dropping_tombstones(sst, gc_before);
+            });
+        });
+        if (runs.empty()) {
+            continue;
+        }
+        // find oldest run from current tier
+        auto it = std::min_element(runs.begin(), runs.end(), [&] (const sstable_run& i, const sstable_run& j) {
+            return min_timestamp(i) < min_timestamp(j);
+        });
+        return make_descriptor(cf, runs_to_sstables({ std::move(*it) }));
+    }
+    return compaction_descriptor();
+}
+
+compaction_descriptor
+incremental_compaction_strategy::get_major_compaction_job(column_family& cf, std::vector<sstables::shared_sstable> candidates) {
+    return make_descriptor(cf, std::move(candidates));
+}
+
+int64_t incremental_compaction_strategy::estimated_pending_compactions(column_family& cf) const {
+    size_t min_threshold = cf.min_compaction_threshold();
+    size_t max_threshold = cf.schema()->max_compaction_threshold();
+    std::vector<sstables::shared_sstable> sstables;
+
+    sstables.reserve(cf.sstables_count());
+    for (auto all_sstables = cf.get_sstables(); auto& entry : *all_sstables) {
+        sstables.push_back(entry);
+    }
+
+    int64_t n = 0;
+    for (auto& bucket : get_buckets(make_runs(sstables), _options)) {
+        if (bucket.size() >= min_threshold) {
+            n += std::ceil(double(bucket.size()) / max_threshold);
+        }
+    }
+    return n;
+}
+
+compaction_descriptor
+incremental_compaction_strategy::get_reshaping_job(std::vector<shared_sstable> input, schema_ptr schema, const ::io_priority_class& iop, reshape_mode mode) {
+    size_t offstrategy_threshold = std::max(schema->min_compaction_threshold(), 4);
+    size_t max_runs = std::max(schema->max_compaction_threshold(), int(offstrategy_threshold));
+
+    if (mode == reshape_mode::relaxed) {
+        offstrategy_threshold = max_runs;
+    }
+
+    for (auto& bucket : get_buckets(make_runs(input), _options)) {
+        if (bucket.size() >= offstrategy_threshold) {
+            bucket.resize(std::min(bucket.size(), max_runs));
+            compaction_descriptor desc(runs_to_sstables(std::move(bucket)), std::optional<sstables::sstable_set>(), iop,
+                    compaction_descriptor::default_level, _options.fragment_size);
+            desc.options = compaction_options::make_reshape();
+            return desc;
+        }
+    }
+
+    return compaction_descriptor();
+}
+
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "compaction_strategy_impl.hh"
+#include "compaction_backlog_manager.hh"
+#include "compaction.hh"
+#include "sstables/sstable_set.hh"
+#include "database_fwd.hh"
+
+namespace sstables {
+
+class incremental_compaction_strategy_options {
+    static constexpr uint64_t DEFAULT_MIN_SSTABLE_SIZE = 50L * 1024L * 1024L;
+    static constexpr double DEFAULT_BUCKET_LOW = 0.5;
+    static constexpr double DEFAULT_BUCKET_HIGH = 1.5;
+    static constexpr int32_t DEFAULT_MAX_SSTABLE_SIZE_IN_MB = 1000;
+    const sstring MIN_SSTABLE_SIZE_KEY = "min_sstable_size";
+    const sstring BUCKET_LOW_KEY = "bucket_low";
+    const sstring BUCKET_HIGH_KEY = "bucket_high";
+    const sstring SSTABLE_SIZE_OPTION = "sstable_size_in_mb";
+
+    uint64_t min_sstable_size = DEFAULT_MIN_SSTABLE_SIZE;
+    double bucket_low = DEFAULT_BUCKET_LOW;
+    double bucket_high = DEFAULT_BUCKET_HIGH;
+    // Size of every sstable (fragment) of the runs produced by compaction.
+    uint64_t fragment_size = uint64_t(DEFAULT_MAX_SSTABLE_SIZE_IN_MB) * 1024 * 1024;
+public:
+    incremental_compaction_strategy_options(const std::map<sstring, sstring>& options);
+
+    incremental_compaction_strategy_options() = default;
+
+    friend class incremental_compaction_strategy;
+};
+
+// Size-tiered compaction working on sstable runs instead of sstables.
+//
+// Runs of similar size are grouped into tiers the same way STCS groups
+// sstables, and compaction writes its output as a run of fixed-size fragments.
+// Since fragments of a run are disjoint, compaction can release each input
+// fragment as soon as output covering it is sealed, so the temporary space
+// needed by a compaction, even a major one, is bounded by a few fragments
+// rather than by the size of its input.
+class incremental_compaction_strategy : public compaction_strategy_impl {
+    incremental_compaction_strategy_options _options;
+    compaction_backlog_tracker _backlog_tracker;
+
+    // Group runs of similar size into buckets.
+    static std::vector<std::vector<sstable_run>> get_buckets(const std::vector<sstable_run>& runs, const incremental_compaction_strategy_options& options);
+
+    // Maybe return a bucket of runs to compact
+    static std::vector<sstable_run> most_interesting_bucket(std::vector<std::vector<sstable_run>> buckets, size_t min_threshold, size_t max_threshold);
+
+    static std::vector<shared_sstable> runs_to_sstables(std::vector<sstable_run> runs);
+
+    compaction_descriptor make_descriptor(column_family& cf, std::vector<shared_sstable> sstables) const;
+public:
+    incremental_compaction_strategy(const std::map<sstring, sstring>& options);
+
+    virtual compaction_descriptor get_sstables_for_compaction(column_family& cf, std::vector<sstables::shared_sstable> candidates) override;
+
+    virtual compaction_descriptor get_major_compaction_job(column_family& cf, std::vector<sstables::shared_sstable> candidates) override;
+
+    virtual int64_t estimated_pending_compactions(column_family& cf) const override;
+
+    virtual compaction_strategy_type type() const {
+        return compaction_strategy_type::incremental;
+    }
+
+    virtual std::unique_ptr<sstable_set_impl> make_sstable_set(schema_ptr schema) const override;
+
+    virtual compaction_backlog_tracker& get_backlog_tracker() override {
+        return _backlog_tracker;
+    }
+
+    virtual compaction_descriptor get_reshaping_job(std::vector<shared_sstable> input, schema_ptr schema, const ::io_priority_class& iop, reshape_mode mode) override;
+
+    uint64_t fragment_size() const {
+        return _options.fragment_size;
+    }
+};
+
+}
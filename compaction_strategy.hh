@@ -57,6 +57,7 @@ class compaction_strategy {
     compaction_strategy& operator=(compaction_strategy&&);
 
     // Return a list of sstables to be compacted after applying the strategy.
+    // Repaired and unrepaired sstables are never picked for the same job.
     compaction_descriptor get_sstables_for_compaction(column_family& cfs, std::vector<shared_sstable> candidates);
 
     compaction_descriptor get_major_compaction_job(column_family& cf, std::vector<shared_sstable> candidates);
@@ -91,6 +92,8 @@ class compaction_strategy {
             return "DateTieredCompactionStrategy";
         case compaction_strategy_type::time_window:
             return "TimeWindowCompactionStrategy";
+        case compaction_strategy_type::incremental:
+            return "IncrementalCompactionStrategy";
         default:
             throw std::runtime_error("Invalid Compaction Strategy");
         }
@@ -111,6 +114,8 @@ class compaction_strategy {
             return compaction_strategy_type::date_tiered;
         } else if (short_name == "TimeWindowCompactionStrategy") {
             return compaction_strategy_type::time_window;
+        } else if (short_name == "IncrementalCompactionStrategy") {
+            return compaction_strategy_type::incremental;
         } else {
             throw exceptions::configuration_exception(format("Unable to find compaction strategy class '{}'", name));
         }
@@ -148,6 +153,11 @@ class compaction_strategy {
 
 };
 
+// Splits sstables into the unrepaired and the repaired ones, in this order.
+// The two sets are compacted separately, so that incremental repair can skip
+// the repaired data.
+std::pair<std::vector<shared_sstable>, std::vector<shared_sstable>> partition_by_repaired_status(std::vector<shared_sstable> sstables);
+
 // Creates a compaction_strategy object from one of the strategies available.
 compaction_strategy make_compaction_strategy(compaction_strategy_type strategy, const std::map<sstring, sstring>& options);
 
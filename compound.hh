@@ -33,10 +33,43 @@
 
 enum class allow_prefixes { no, yes };
 
+// Compares serialized values of a component of a compound.
+//
+// Created once per compound type, so that comparing components of types whose
+// serialized form sorts like their values, like blobs and text, boils down to
+// a memcmp() of the values, without dispatching on the type for every comparison.
+class component_comparator {
+    const abstract_type* _type;
+    bool _byte_order_comparable;
+    bool _reversed;
+public:
+    explicit component_comparator(const abstract_type& t)
+        : _type(&t)
+        , _byte_order_comparable(t.without_reversed().is_byte_order_comparable())
+        , _reversed(t.is_reversed())
+    { }
+
+    int operator()(managed_bytes_view v1, managed_bytes_view v2) const {
+        if (_byte_order_comparable) {
+            return _reversed ? compare_unsigned(v2, v1) : compare_unsigned(v1, v2);
+        }
+        return _type->compare(v1, v2);
+    }
+};
+
+// Comparator for lexicographical_tri_compare() and prefix_equality_tri_compare()
+// iterating over component comparators instead of types.
+struct component_tri_compare {
+    int operator()(const component_comparator& cmp, managed_bytes_view v1, managed_bytes_view v2) const {
+        return cmp(v1, v2);
+    }
+};
+
 template<allow_prefixes AllowPrefixes = allow_prefixes::no>
 class compound_type final {
 private:
     const std::vector<data_type> _types;
+    const std::vector<component_comparator> _comparators;
     const bool _byte_order_equal;
     const bool _byte_order_comparable;
     const bool _is_reversed;
@@ -48,6 +81,9 @@ class compound_type final {
 
     compound_type(std::vector<data_type> types)
         : _types(std::move(types))
+        , _comparators(boost::copy_range<std::vector<component_comparator>>(_types | boost::adaptors::transformed([] (const data_type& t) {
+                return component_comparator(*t);
+            })))
         , _byte_order_equal(std::all_of(_types.begin(), _types.end(), [] (const auto& t) {
                 return t->is_byte_order_equal();
             }))
@@ -61,6 +97,11 @@ class compound_type final {
         return _types;
     }
 
+    // Comparators of the components, in the order of types().
+    const std::vector<component_comparator>& comparators() const {
+        return _comparators;
+    }
+
     bool is_singular() const {
         return _types.size() == 1;
     }
@@ -263,10 +304,8 @@ class compound_type final {
                 return compare_unsigned(b1, b2);
             }
         }
-        return lexicographical_tri_compare(_types.begin(), _types.end(),
-            begin(b1), end(b1), begin(b2), end(b2), [] (auto&& type, auto&& v1, auto&& v2) {
-                return type->compare(v1, v2);
-            });
+        return lexicographical_tri_compare(_comparators.begin(), _comparators.end(),
+            begin(b1), end(b1), begin(b2), end(b2), component_tri_compare{});
     }
     // Retruns true iff given prefix has no missing components
     bool is_full(managed_bytes_view v) const {
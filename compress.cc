@@ -73,6 +73,18 @@ std::map<sstring, sstring> compressor::options() const {
     return {};
 }
 
+size_t compressor::dictionary_sample_size() const {
+    return 0;
+}
+
+future<bytes> compressor::train_dictionary(const std::vector<temporary_buffer<char>>& samples) const {
+    return make_ready_future<bytes>();
+}
+
+shared_ptr<compressor> compressor::with_dictionary(bytes_view dictionary) const {
+    throw std::runtime_error(format("{} doesn't support compression dictionaries", name()));
+}
+
 shared_ptr<compressor> compressor::create(const sstring& name, const opt_getter& opts) {
     if (name.empty()) {
         return {};
@@ -23,11 +23,14 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 #include <seastar/core/future.hh>
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/sstring.hh>
+#include <seastar/core/temporary_buffer.hh>
 
+#include "bytes.hh"
 #include "exceptions/exceptions.hh"
 
 
@@ -64,6 +67,26 @@ class compressor {
      */
     virtual std::map<sstring, sstring> options() const;
 
+    /**
+     * Returns the amount of data, taken from the beginning of the compressed
+     * file, to train a compression dictionary on, or 0 if this compressor
+     * doesn't use dictionaries.
+     */
+    virtual size_t dictionary_sample_size() const;
+    /**
+     * Trains a dictionary on "samples", which are chunks of the data to be
+     * compressed. Resolves to an empty dictionary if one couldn't be trained,
+     * e.g. because there is too little data. Training is CPU-heavy, so it
+     * doesn't run on the reactor; "samples" must be kept alive until the
+     * returned future resolves.
+     */
+    virtual future<bytes> train_dictionary(const std::vector<temporary_buffer<char>>& samples) const;
+    /**
+     * Returns a compressor with the same options, which uses "dictionary",
+     * obtained from train_dictionary(), for both compression and decompression.
+     */
+    virtual shared_ptr<compressor> with_dictionary(bytes_view dictionary) const;
+
     /**
      * Compressor class name.
      */
@@ -406,6 +406,8 @@ scylla_tests = set([
     'test/boost/cql_query_like_test',
     'test/boost/cql_query_group_test',
     'test/boost/cql_functions_test',
+    'test/boost/cql_server_test',
+    'test/boost/cql_server_shard_affinity_test',
     'test/boost/crc_test',
     'test/boost/data_listeners_test',
     'test/boost/database_test',
@@ -425,7 +427,9 @@ scylla_tests = set([
     'test/boost/gossiping_property_file_snitch_test',
     'test/boost/hash_test',
     'test/boost/hashers_test',
+    'test/boost/hint_replay_test',
     'test/boost/idl_test',
+    'test/boost/incremental_repair_test',
     'test/boost/input_stream_test',
     'test/boost/json_cql_query_test',
     'test/boost/json_test',
@@ -460,6 +464,8 @@ scylla_tests = set([
     'test/boost/query_processor_test',
     'test/boost/range_test',
     'test/boost/range_tombstone_list_test',
+    'test/boost/repair_hash_iblt_test',
+    'test/boost/repair_reader_test',
     'test/boost/reusable_buffer_test',
     'test/boost/restrictions_test',
     'test/boost/role_manager_test',
@@ -485,6 +491,7 @@ scylla_tests = set([
     'test/boost/sstable_move_test',
     'test/boost/statement_restrictions_test',
     'test/boost/storage_proxy_test',
+    'test/boost/stream_sstable_files_test',
     'test/boost/top_k_test',
     'test/boost/transport_test',
     'test/boost/types_test',
@@ -496,6 +503,7 @@ scylla_tests = set([
     'test/boost/view_schema_test',
     'test/boost/view_schema_pkey_test',
     'test/boost/view_schema_ckey_test',
+    'test/boost/view_update_coalescing_test',
     'test/boost/vint_serialization_test',
     'test/boost/virtual_reader_test',
     'test/boost/virtual_table_mutation_source_test',
@@ -547,6 +555,7 @@ perf_tests = set([
     'test/perf/perf_mutation_fragment',
     'test/perf/perf_idl',
     'test/perf/perf_vint',
+    'test/perf/perf_bloom_filter',
     'test/perf/perf_big_decimal',
 ])
 
@@ -714,6 +723,7 @@ scylla_core = (['database.cc',
                 'compaction/compaction_strategy.cc',
                 'compaction/size_tiered_compaction_strategy.cc',
                 'compaction/leveled_compaction_strategy.cc',
+                'compaction/incremental_compaction_strategy.cc',
                 'compaction/time_window_compaction_strategy.cc',
                 'compaction/compaction_manager.cc',
                 'sstables/integrity_checked_file_impl.cc',
@@ -723,6 +733,7 @@ scylla_core = (['database.cc',
                 'sstables/random_access_reader.cc',
                 'sstables/metadata_collector.cc',
                 'sstables/writer.cc',
+                'sstables/trie_index.cc',
                 'transport/cql_protocol_extension.cc',
                 'transport/event.cc',
                 'transport/event_notifier.cc',
@@ -865,6 +876,7 @@ scylla_core = (['database.cc',
                 'db/large_data_handler.cc',
                 'db/marshal/type_parser.cc',
                 'db/batchlog_manager.cc',
+                'db/cache_saver.cc',
                 'db/view/view.cc',
                 'db/view/view_update_generator.cc',
                 'db/view/row_locking.cc',
@@ -1098,6 +1110,7 @@ idls = ['idl/gossip_digest.idl.hh',
         'idl/paxos.idl.hh',
         'idl/raft.idl.hh',
         'idl/hinted_handoff.idl.hh',
+        'idl/saved_cache.idl.hh',
         ]
 
 headers = find_headers('.', excluded_dirs=['idl', 'build', 'seastar', '.git'])
@@ -128,6 +128,8 @@ class batch_statement : public cql_statement_opt_metadata {
 
     bool has_conditions() const { return _has_conditions; }
 
+    virtual bool is_conditional() const override { return _has_conditions; }
+
     void build_cas_result_set_metadata();
 
     // The batch itself will be validated in either Parsed#prepare() - for regular CQL3 batches,
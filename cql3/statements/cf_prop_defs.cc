@@ -146,6 +146,9 @@ void cf_prop_defs::validate(const database& db, const schema::extensions_map& sc
         }
         compression_parameters cp(*compression_options);
         cp.validate();
+        if (auto c = cp.get_compressor(); c && c->dictionary_sample_size() && !db.features().cluster_supports_compression_dictionary()) {
+            throw exceptions::configuration_exception("Compression dictionaries not supported by the cluster");
+        }
     }
 
     if (auto caching_options = get_caching_options(); caching_options && !caching_options->enabled() && !db.features().cluster_supports_per_table_caching()) {
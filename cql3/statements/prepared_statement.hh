@@ -71,6 +71,8 @@ class prepared_statement : public seastar::weakly_referencable<prepared_statemen
     const seastar::shared_ptr<cql_statement> statement;
     const std::vector<seastar::lw_shared_ptr<column_specification>> bound_names;
     std::vector<uint16_t> partition_key_bind_indices;
+    // statement->is_conditional(), checked for every execution by the CQL server.
+    const bool is_conditional;
 
     prepared_statement(seastar::shared_ptr<cql_statement> statement_, std::vector<seastar::lw_shared_ptr<column_specification>> bound_names_, std::vector<uint16_t> partition_key_bind_indices);
 
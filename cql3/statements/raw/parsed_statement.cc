@@ -72,6 +72,7 @@ prepared_statement::prepared_statement(::shared_ptr<cql_statement> statement_, s
     : statement(std::move(statement_))
     , bound_names(std::move(bound_names_))
     , partition_key_bind_indices(std::move(partition_key_bind_indices))
+    , is_conditional(statement->is_conditional())
 { }
 
 prepared_statement::prepared_statement(::shared_ptr<cql_statement> statement_, const variable_specifications& names, const std::vector<uint16_t>& partition_key_bind_indices)
@@ -699,6 +699,9 @@ database::setup_metrics() {
 
         sm::make_total_operations("total_view_updates_failed_remote", _cf_stats.total_view_updates_failed_remote,
                 sm::description("Total number of view updates generated for tables and failed to be sent to remote replicas.")),
+
+        sm::make_total_operations("total_view_updates_coalesced", _cf_stats.total_view_updates_coalesced,
+                sm::description("Total number of base table writes whose view updates were generated from the same read as an earlier write to the same partition.")),
     });
     if (this_shard_id() == 0) {
         _metrics.add_group("database", {
@@ -1118,6 +1121,7 @@ keyspace::make_column_family_config(const schema& s, const database& db) const {
     cfg.enable_cache = _config.enable_cache;
     cfg.enable_dangerous_direct_import_of_cassandra_counters = _config.enable_dangerous_direct_import_of_cassandra_counters;
     cfg.compaction_enforce_min_threshold = _config.compaction_enforce_min_threshold;
+    cfg.enable_view_update_coalescing = _config.enable_view_update_coalescing;
     cfg.dirty_memory_manager = _config.dirty_memory_manager;
     cfg.streaming_read_concurrency_semaphore = _config.streaming_read_concurrency_semaphore;
     cfg.compaction_concurrency_semaphore = _config.compaction_concurrency_semaphore;
@@ -1955,6 +1959,7 @@ database::make_keyspace_config(const keyspace_metadata& ksm) {
     }
     cfg.enable_dangerous_direct_import_of_cassandra_counters = _cfg.enable_dangerous_direct_import_of_cassandra_counters();
     cfg.compaction_enforce_min_threshold = _cfg.compaction_enforce_min_threshold;
+    cfg.enable_view_update_coalescing = _cfg.enable_view_update_coalescing;
     cfg.dirty_memory_manager = &_dirty_memory_manager;
     cfg.streaming_read_concurrency_semaphore = &_streaming_concurrency_sem;
     cfg.compaction_concurrency_semaphore = &_compaction_concurrency_sem;
@@ -2330,7 +2335,7 @@ template <typename T>
 using foreign_unique_ptr = foreign_ptr<std::unique_ptr<T>>;
 
 flat_mutation_reader make_multishard_streaming_reader(distributed<database>& db, schema_ptr schema, reader_permit permit,
-        std::function<std::optional<dht::partition_range>()> range_generator) {
+        std::function<std::optional<dht::partition_range>()> range_generator, unrepaired_only only_unrepaired) {
     class streaming_reader_lifecycle_policy
             : public reader_lifecycle_policy
             , public enable_shared_from_this<streaming_reader_lifecycle_policy> {
@@ -2341,9 +2346,11 @@ flat_mutation_reader make_multishard_streaming_reader(distributed<database>& db,
         };
         distributed<database>& _db;
         utils::UUID _table_id;
+        unrepaired_only _only_unrepaired;
         std::vector<reader_context> _contexts;
     public:
-        streaming_reader_lifecycle_policy(distributed<database>& db, utils::UUID table_id) : _db(db), _table_id(table_id), _contexts(smp::count) {
+        streaming_reader_lifecycle_policy(distributed<database>& db, utils::UUID table_id, unrepaired_only only_unrepaired)
+            : _db(db), _table_id(table_id), _only_unrepaired(only_unrepaired), _contexts(smp::count) {
         }
         virtual flat_mutation_reader create_reader(
                 schema_ptr schema,
@@ -2360,7 +2367,7 @@ flat_mutation_reader make_multishard_streaming_reader(distributed<database>& db,
             _contexts[shard].read_operation = make_foreign(std::make_unique<utils::phased_barrier::operation>(cf.read_in_progress()));
             _contexts[shard].semaphore = &cf.streaming_read_concurrency_semaphore();
 
-            return cf.make_streaming_reader(std::move(schema), std::move(permit), *_contexts[shard].range, slice, fwd_mr);
+            return cf.make_streaming_reader(std::move(schema), std::move(permit), *_contexts[shard].range, slice, fwd_mr, _only_unrepaired);
         }
         virtual future<> destroy_reader(stopped_reader reader) noexcept override {
             auto ctx = std::move(_contexts[this_shard_id()]);
@@ -2383,7 +2390,7 @@ flat_mutation_reader make_multishard_streaming_reader(distributed<database>& db,
             return semaphore().obtain_permit(schema.get(), description, cf.estimate_read_memory_cost(), timeout);
         }
     };
-    auto ms = mutation_source([&db] (schema_ptr s,
+    auto ms = mutation_source([&db, only_unrepaired] (schema_ptr s,
             reader_permit permit,
             const dht::partition_range& pr,
             const query::partition_slice& ps,
@@ -2392,7 +2399,7 @@ flat_mutation_reader make_multishard_streaming_reader(distributed<database>& db,
             streamed_mutation::forwarding,
             mutation_reader::forwarding fwd_mr) {
         auto table_id = s->id();
-        return make_multishard_combining_reader(make_shared<streaming_reader_lifecycle_policy>(db, table_id), std::move(s), std::move(permit), pr, ps, pc,
+        return make_multishard_combining_reader(make_shared<streaming_reader_lifecycle_policy>(db, table_id, only_unrepaired), std::move(s), std::move(permit), pr, ps, pc,
                 std::move(trace_state), fwd_mr);
     });
     auto&& full_slice = schema->full_slice();
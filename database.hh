@@ -308,6 +308,10 @@ struct cf_stats {
     uint64_t total_view_updates_pushed_remote = 0;
     uint64_t total_view_updates_failed_local = 0;
     uint64_t total_view_updates_failed_remote = 0;
+
+    // How many writes had their view updates generated together with an
+    // earlier write to the same base partition.
+    uint64_t total_view_updates_coalesced = 0;
 };
 
 class table;
@@ -318,6 +322,8 @@ using column_family_stats = table_stats;
 class database_sstable_write_monitor;
 
 using enable_backlog_tracker = bool_class<class enable_backlog_tracker_tag>;
+// Whether a streaming reader skips the sstables marked as repaired.
+using unrepaired_only = bool_class<class unrepaired_only_tag>;
 
 extern const ssize_t new_reader_base_cost;
 
@@ -361,6 +367,7 @@ class table : public enable_lw_shared_from_this<table> {
         bool enable_commitlog = true;
         bool enable_incremental_backups = false;
         utils::updateable_value<bool> compaction_enforce_min_threshold{false};
+        utils::updateable_value<bool> enable_view_update_coalescing{true};
         bool enable_dangerous_direct_import_of_cassandra_counters = false;
         ::dirty_memory_manager* dirty_memory_manager = &default_dirty_memory_manager;
         reader_concurrency_semaphore* streaming_read_concurrency_semaphore;
@@ -674,14 +681,21 @@ class table : public enable_lw_shared_from_this<table> {
     //  - Reflects all writes accepted by replica prior to creation of the
     //    reader and a _bounded_ amount of writes which arrive later.
     //  - Does not populate the cache
+    //  - Marks the permit as a sequential scan, so that sstables are read
+    //    in larger chunks
     // Requires ranges to be sorted and disjoint.
     flat_mutation_reader make_streaming_reader(schema_ptr schema, reader_permit permit,
             const dht::partition_range_vector& ranges) const;
 
+    // Like above, but doesn't read the excluded sstables.
+    flat_mutation_reader make_streaming_reader(schema_ptr schema, reader_permit permit,
+            const dht::partition_range_vector& ranges, std::vector<sstables::shared_sstable> excluded) const;
+
     // Single range overload.
     flat_mutation_reader make_streaming_reader(schema_ptr schema, reader_permit permit, const dht::partition_range& range,
             const query::partition_slice& slice,
-            mutation_reader::forwarding fwd_mr = mutation_reader::forwarding::no) const;
+            mutation_reader::forwarding fwd_mr = mutation_reader::forwarding::no,
+            unrepaired_only only_unrepaired = unrepaired_only::no) const;
 
     flat_mutation_reader make_streaming_reader(schema_ptr schema, reader_permit permit, const dht::partition_range& range) {
         return make_streaming_reader(std::move(schema), std::move(permit), range, schema->full_slice());
@@ -692,6 +706,9 @@ class table : public enable_lw_shared_from_this<table> {
             lw_shared_ptr<sstables::sstable_set> sstables) const;
 
     sstables::shared_sstable make_streaming_sstable_for_write(std::optional<sstring> subdir = {});
+    // For an sstable streamed as files, which keeps the version and format it was written in.
+    sstables::shared_sstable make_streaming_sstable_for_write(sstables::sstable_version_types v, sstables::sstable_format_types f,
+            std::optional<sstring> subdir = {});
     sstables::shared_sstable make_streaming_staging_sstable() {
         return make_streaming_sstable_for_write("staging");
     }
@@ -908,8 +925,10 @@ class table : public enable_lw_shared_from_this<table> {
         return _global_cache_hit_rate;
     }
 
+    // Whether writes go to the commitlog: the keyspace has durable_writes
+    // and the table is not in unlogged_ingest mode.
     bool durable_writes() const {
-        return _durable_writes;
+        return _durable_writes && !_schema->unlogged_ingest();
     }
 
     void set_durable_writes(bool dw) {
@@ -1019,7 +1038,10 @@ class table : public enable_lw_shared_from_this<table> {
 
 private:
     future<row_locker::lock_holder> do_push_view_replica_updates(schema_ptr s, mutation m, db::timeout_clock::time_point timeout, mutation_source source,
-            tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem, const io_priority_class& io_priority, query::partition_slice::option_set custom_opts) const;
+            tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem, const io_priority_class& io_priority, query::partition_slice::option_set custom_opts,
+            bool coalesce) const;
+    future<row_locker::lock_holder> push_coalesced_view_replica_updates(schema_ptr base, mutation m, query::clustering_row_ranges cr_ranges,
+            db::timeout_clock::time_point timeout, tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem, gc_clock::time_point now) const;
     std::vector<view_ptr> affected_views(const schema_ptr& base, const mutation& update) const;
     future<> generate_and_propagate_view_updates(const schema_ptr& base,
             reader_permit permit,
@@ -1030,6 +1052,40 @@ class table : public enable_lw_shared_from_this<table> {
             gc_clock::time_point now) const;
 
     mutable row_locker _row_locker;
+    // Writes to a base row or partition which need to read existing rows to
+    // generate their view updates, and which wait together for the same lock.
+    // The first of them takes the lock, then reads the rows affected by all of
+    // them and generates their view updates at once.
+    struct view_update_group {
+        // A write which joined the group while its lock was awaited
+        struct joined_write {
+            mutation m;
+            // The memory of the write, counted in the view update backlog
+            db::timeout_semaphore_units units;
+            // Resolved with the lock once the view updates were generated, or
+            // with a null pointer if the group failed to take the lock
+            promise<lw_shared_ptr<row_locker::lock_holder>> done;
+            // Fails the write at its own timeout, unless the group took the
+            // lock and merged it before
+            timer<db::timeout_clock> expiry;
+            bool timed_out = false;
+
+            joined_write(mutation m, db::timeout_semaphore_units units)
+                : m(std::move(m)), units(std::move(units)) { }
+        };
+        // The first write, which takes the lock
+        mutation m;
+        // The row locked by the group, or disengaged if it locks the whole partition
+        std::optional<clustering_key_prefix> row;
+        db::timeout_semaphore_units units;
+        std::vector<lw_shared_ptr<joined_write>> joined;
+
+        view_update_group(mutation m, std::optional<clustering_key_prefix> row, db::timeout_semaphore_units units)
+            : m(std::move(m)), row(std::move(row)), units(std::move(units)) { }
+    };
+    // The groups which didn't get their lock yet and can still be joined, by
+    // the token of their partition.
+    mutable std::unordered_multimap<dht::token, lw_shared_ptr<view_update_group>> _view_update_groups;
     future<row_locker::lock_holder> local_base_lock(
             const schema_ptr& s,
             const dht::decorated_key& pk,
@@ -1140,6 +1196,7 @@ class keyspace {
         bool enable_cache = true;
         bool enable_incremental_backups = false;
         utils::updateable_value<bool> compaction_enforce_min_threshold{false};
+        utils::updateable_value<bool> enable_view_update_coalescing{true};
         bool enable_dangerous_direct_import_of_cassandra_counters = false;
         ::dirty_memory_manager* dirty_memory_manager = &default_dirty_memory_manager;
         reader_concurrency_semaphore* streaming_read_concurrency_semaphore;
@@ -1621,7 +1678,7 @@ future<> stop_database(sharded<database>& db);
 // Shard readers are created via `table::make_streaming_reader()`.
 // Range generator must generate disjoint, monotonically increasing ranges.
 flat_mutation_reader make_multishard_streaming_reader(distributed<database>& db, schema_ptr schema, reader_permit permit,
-        std::function<std::optional<dht::partition_range>()> range_generator);
+        std::function<std::optional<dht::partition_range>()> range_generator, unrepaired_only only_unrepaired = unrepaired_only::no);
 
 bool is_internal_keyspace(std::string_view name);
 
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021-present ScyllaDB
+ */
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "serializer.hh"
+#include "schema.hh"
+#include "exceptions/exceptions.hh"
+#include "utils/i_filter.hh"
+
+namespace db {
+
+/**
+ * \brief Schema extension which represents `bloom_filter_format` per-table option.
+ *
+ * The option selects the kind of bloom filter written to new sstables of the table:
+ *  - 'standard': the bloom filter compatible with Cassandra, which may need
+ *    a cache miss per hash function to look a key up;
+ *  - 'split_block': a bloom filter which keeps all bits of a key in one
+ *    cache line, see utils::filter::split_block_bloom_filter.
+ *
+ * Existing sstables keep their filters until they are rewritten.
+ */
+class bloom_filter_format_extension : public schema_extension {
+    utils::filter_format _format = utils::filter_format::m_format;
+public:
+    static constexpr auto NAME = "bloom_filter_format";
+
+    bloom_filter_format_extension() = default;
+
+    explicit bloom_filter_format_extension(utils::filter_format format)
+        : _format(format)
+    {}
+
+    explicit bloom_filter_format_extension(const std::map<sstring, sstring>& map) {
+        throw exceptions::configuration_exception(format("{} must be a string", NAME));
+    }
+
+    explicit bloom_filter_format_extension(bytes b) : _format(parse(deserialize(b)))
+    {}
+
+    explicit bloom_filter_format_extension(const sstring& s) : _format(parse(s))
+    {}
+
+    bytes serialize() const override {
+        return ser::serialize_to_buffer<bytes>(name(_format));
+    }
+
+    static sstring deserialize(const bytes_view& buffer) {
+        return ser::deserialize_from_buffer(buffer, boost::type<sstring>());
+    }
+
+    static utils::filter_format parse(const sstring& s) {
+        if (s == "standard") {
+            return utils::filter_format::m_format;
+        } else if (s == "split_block") {
+            return utils::filter_format::split_block_format;
+        }
+        throw exceptions::configuration_exception(format("Invalid {} '{}': must be 'standard' or 'split_block'", NAME, s));
+    }
+
+    static sstring name(utils::filter_format format) {
+        return format == utils::filter_format::split_block_format ? "split_block" : "standard";
+    }
+
+    utils::filter_format get_format() const {
+        return _format;
+    }
+};
+
+} // namespace db
@@ -0,0 +1,549 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <charconv>
+#include <optional>
+#include <unordered_map>
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/fstream.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/core/with_scheduling_group.hh>
+#include <boost/range/adaptor/map.hpp>
+
+#include "db/cache_saver.hh"
+#include "db/config.hh"
+#include "database.hh"
+#include "lister.hh"
+#include "log.hh"
+#include "partition_slice_builder.hh"
+#include "service/priority_manager.hh"
+#include "sstables/sstables.hh"
+#include "sstables/partition_index_cache.hh"
+#include "db/cache_tracker.hh"
+#include "serializer.hh"
+#include "idl/uuid.dist.hh"
+#include "idl/keys.dist.hh"
+#include "idl/range.dist.hh"
+#include "idl/saved_cache.dist.hh"
+#include "serializer_impl.hh"
+#include "idl/uuid.dist.impl.hh"
+#include "idl/keys.dist.impl.hh"
+#include "idl/range.dist.impl.hh"
+#include "idl/saved_cache.dist.impl.hh"
+
+static logging::logger cslogger("cache_saver");
+
+namespace db {
+
+static constexpr std::string_view row_cache_file_prefix = "RowCache-";
+static constexpr std::string_view key_cache_file_prefix = "KeyCache-";
+static constexpr std::string_view saved_cache_file_suffix = ".db";
+
+// Returns the shard which saved the file if its name matches given prefix.
+static std::optional<unsigned> saved_cache_file_shard(std::string_view name, std::string_view prefix) {
+    if (!name.starts_with(prefix) || !name.ends_with(saved_cache_file_suffix)) {
+        return std::nullopt;
+    }
+    name.remove_prefix(prefix.size());
+    name.remove_suffix(saved_cache_file_suffix.size());
+    unsigned shard;
+    auto [ptr, ec] = std::from_chars(name.data(), name.data() + name.size(), shard);
+    if (ec != std::errc() || ptr != name.data() + name.size()) {
+        return std::nullopt;
+    }
+    return shard;
+}
+
+// Returns the number of entries to save, given the *_keys_to_save setting.
+static size_t max_entries(uint32_t keys_to_save, size_t limit) {
+    return keys_to_save ? std::min(size_t(keys_to_save), limit) : limit;
+}
+
+cache_saver::periodic_task::periodic_task(utils::updateable_value<uint32_t> period)
+    : _period(std::move(period))
+    , _period_observer(_period.observe([this] (const uint32_t&) {
+        _period_changed.signal();
+    }))
+{ }
+
+void cache_saver::periodic_task::start(std::function<future<> ()> func) {
+    _done = run(std::move(func));
+}
+
+future<> cache_saver::periodic_task::stop() {
+    _period_changed.broken();
+    return std::move(_done);
+}
+
+future<> cache_saver::periodic_task::run(std::function<future<> ()> func) {
+    while (true) {
+        auto period = std::chrono::seconds(_period());
+        try {
+            if (period.count() == 0) {
+                co_await _period_changed.wait();
+            } else {
+                co_await _period_changed.wait(period);
+            }
+            // The period was changed, start waiting over.
+            continue;
+        } catch (seastar::condition_variable_timed_out&) {
+            // Time to run.
+        } catch (seastar::broken_condition_variable&) {
+            co_return;
+        }
+        co_await func();
+    }
+}
+
+cache_saver::cache_saver(database& db, const db::config& cfg)
+    : _db(db)
+    , _directory(cfg.saved_caches_directory())
+    , _row_cache_keys_to_save(cfg.row_cache_keys_to_save)
+    , _key_cache_keys_to_save(cfg.key_cache_keys_to_save)
+    , _row_cache_saving(cfg.row_cache_save_period)
+    , _key_cache_saving(cfg.key_cache_save_period)
+    , _lru_walk_expiry([this] { _lru_walk.reset(); })
+{
+    setup_metrics();
+}
+
+future<> cache_saver::start() {
+    _row_cache_saving.start([this] {
+        return with_scheduling_group(_db.get_streaming_scheduling_group(), [this] {
+            return save_row_caches();
+        });
+    });
+    _key_cache_saving.start([this] {
+        return with_scheduling_group(_db.get_streaming_scheduling_group(), [this] {
+            return save_key_caches();
+        });
+    });
+    return make_ready_future<>();
+}
+
+future<> cache_saver::stop() {
+    co_await when_all_succeed(_row_cache_saving.stop(), _key_cache_saving.stop()).discard_result();
+    _lru_walk_expiry.cancel();
+    _lru_walk.reset();
+}
+
+sstring cache_saver::table_directory(const schema& s) const {
+    return format("{}/{}-{}-{}", _directory, s.ks_name(), s.cf_name(), s.id().to_sstring());
+}
+
+sstring cache_saver::cache_file(const schema& s, std::string_view prefix, unsigned shard) const {
+    return format("{}/{}{}{}", table_directory(s), prefix, shard, saved_cache_file_suffix);
+}
+
+future<> cache_saver::write_cache_file(const schema& s, std::string_view prefix, bytes_ostream buf) {
+    auto dir = table_directory(s);
+    auto file_name = cache_file(s, prefix, this_shard_id());
+    auto tmp_file_name = file_name + ".tmp";
+    co_await recursive_touch_directory(dir);
+    auto f = co_await open_file_dma(tmp_file_name, open_flags::wo | open_flags::create | open_flags::truncate);
+    auto out = co_await make_file_output_stream(std::move(f));
+    std::exception_ptr ex;
+    try {
+        for (bytes_view fragment : buf.fragments()) {
+            co_await out.write(reinterpret_cast<const char*>(fragment.data()), fragment.size());
+        }
+        co_await out.flush();
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await out.close();
+    if (ex) {
+        std::rethrow_exception(std::move(ex));
+    }
+    co_await rename_file(tmp_file_name, file_name);
+
+    // Files left over by shards which no longer exist would be preloaded
+    // over and over again, with their contents growing more and more stale.
+    if (this_shard_id() == 0) {
+        std::vector<sstring> stale_files;
+        co_await lister::scan_dir(dir, { directory_entry_type::regular }, [&] (fs::path dir, directory_entry de) {
+            auto shard = saved_cache_file_shard(de.name, prefix);
+            if (shard && *shard >= smp::count) {
+                stale_files.push_back((dir / de.name.c_str()).native());
+            }
+            return make_ready_future<>();
+        });
+        for (auto& stale_file : stale_files) {
+            co_await remove_file(stale_file);
+        }
+    }
+    co_await sync_directory(dir);
+}
+
+future<std::vector<temporary_buffer<int8_t>>> cache_saver::read_cache_files(const schema& s, std::string_view prefix) {
+    std::vector<temporary_buffer<int8_t>> result;
+    auto dir = table_directory(s);
+    if (!co_await file_exists(dir)) {
+        co_return result;
+    }
+
+    std::vector<sstring> files;
+    co_await lister::scan_dir(dir, { directory_entry_type::regular }, [&files] (fs::path dir, directory_entry de) {
+        files.push_back((dir / de.name.c_str()).native());
+        return make_ready_future<>();
+    }, [prefix] (const fs::path&, const directory_entry& de) {
+        return bool(saved_cache_file_shard(de.name, prefix));
+    });
+
+    for (auto& file_name : files) {
+        try {
+            auto f = co_await open_file_dma(file_name, open_flags::ro);
+            std::exception_ptr ex;
+            try {
+                auto size = co_await f.size();
+                result.push_back(co_await f.dma_read_exactly<int8_t>(0, size));
+            } catch (...) {
+                ex = std::current_exception();
+            }
+            co_await f.close();
+            if (ex) {
+                std::rethrow_exception(std::move(ex));
+            }
+        } catch (...) {
+            cslogger.warn("Failed to read saved cache {}: {}", file_name, std::current_exception());
+        }
+    }
+    co_return result;
+}
+
+future<lw_shared_ptr<const cache_saver::lru_contents>> cache_saver::get_lru_contents(bool need_partitions, bool need_index_pages) {
+    if (_lru_walk) {
+        try {
+            auto contents = co_await _lru_walk->get_future();
+            if ((contents->has_partitions || !need_partitions) && (contents->has_index_pages || !need_index_pages)) {
+                co_return contents;
+            }
+        } catch (...) {
+            // Walk again
+        }
+    }
+    // Collect what the other save needs too, if it's enabled.
+    _lru_walk_expiry.cancel();
+    _lru_walk.emplace(walk_lru(need_partitions || _row_cache_saving.enabled(), need_index_pages || _key_cache_saving.enabled())
+            .finally([this] {
+        _lru_walk_expiry.rearm(lowres_clock::now() + lru_walk_reuse_period);
+    }));
+    co_return co_await _lru_walk->get_future();
+}
+
+future<lw_shared_ptr<const cache_saver::lru_contents>> cache_saver::walk_lru(bool collect_partitions, bool collect_index_pages) {
+    auto max_partitions = collect_partitions ? max_entries(_row_cache_keys_to_save(), max_saved_partitions) : 0;
+    auto max_pages = collect_index_pages ? max_entries(_key_cache_keys_to_save(), max_saved_index_pages) : 0;
+    auto contents = make_lw_shared<lru_contents>();
+    contents->has_partitions = collect_partitions;
+    contents->has_index_pages = collect_index_pages;
+
+    row_cache::cached_partitions_collector partitions(max_partitions);
+    size_t nr_pages = 0;
+    auto full = [&] {
+        return partitions.full() && nr_pages >= max_pages;
+    };
+    auto& tracker = _db.row_cache_tracker();
+    // Runs with reclaiming disabled, so that eviction doesn't modify the LRU
+    // while it's walked, and releases it between chunks.
+    logalloc::allocating_section read_section;
+    lru_cursor cursor;
+    bool started = false;
+    while (!full()) {
+        if (started && !cursor.is_linked()) {
+            // Reached the end, or the cursor was evicted.
+            break;
+        }
+        started = true;
+        auto done = read_section(tracker.region(), [&] {
+            return tracker.get_lru().walk(cursor, [&] (evictable& e) {
+                if (!partitions.consume(e) && nr_pages < max_pages) {
+                    if (auto page = sstables::partition_index_cache::lru_entry(e)) {
+                        contents->index_pages[page->first].push_back(page->second);
+                        ++nr_pages;
+                    }
+                }
+                return stop_iteration(full() || need_preempt());
+            });
+        });
+        if (done) {
+            break;
+        }
+        co_await make_ready_future<>(); // maybe yield
+    }
+    contents->partitions = std::move(partitions).get();
+    co_return contents;
+}
+
+future<> cache_saver::save_row_caches() {
+    auto contents = co_await get_lru_contents(true, false);
+    auto tables = boost::copy_range<std::vector<lw_shared_ptr<table>>>(_db.get_column_families() | boost::adaptors::map_values);
+    for (auto& t : tables) {
+        if (!t->cache_enabled()) {
+            continue;
+        }
+        try {
+            std::vector<saved_row_cache_entry> entries;
+            if (auto it = contents->partitions.find(t->schema()->id()); it != contents->partitions.end()) {
+                entries.reserve(it->second.size());
+                for (auto& p : it->second) {
+                    entries.push_back(saved_row_cache_entry{p.key._key, p.ranges});
+                }
+            }
+            co_await save_row_cache(*t, std::move(entries));
+            ++_stats.row_cache_saves;
+        } catch (...) {
+            ++_stats.row_cache_save_failures;
+            cslogger.warn("Failed to save row cache of {}.{}: {}", t->schema()->ks_name(), t->schema()->cf_name(), std::current_exception());
+        }
+    }
+}
+
+future<> cache_saver::save_row_cache(const table& t, std::vector<saved_row_cache_entry> entries) {
+    auto s = t.schema();
+    saved_row_cache saved{current_format_version, s->id(), std::move(entries)};
+    bytes_ostream buf;
+    ser::serialize(buf, saved);
+    co_await write_cache_file(*s, row_cache_file_prefix, std::move(buf));
+
+    _stats.saved_partitions += saved.entries.size();
+    cslogger.debug("Saved {} partitions of {}.{} row cache", saved.entries.size(), s->ks_name(), s->cf_name());
+}
+
+future<std::vector<saved_row_cache_entry>> cache_saver::load_row_cache(const table& t) {
+    auto s = t.schema();
+    auto& sharder = s->get_sharder();
+    std::vector<saved_row_cache_entry> result;
+    for (auto& buf : co_await read_cache_files(*s, row_cache_file_prefix)) {
+        try {
+            auto in = ser::as_input_stream(bytes_view(buf.get(), buf.size()));
+            auto saved = ser::deserialize(in, boost::type<saved_row_cache>());
+            if (saved.format_version != current_format_version || saved.table_id != s->id()) {
+                cslogger.info("Ignoring saved row cache of {}.{}: format version {}, table {}", s->ks_name(), s->cf_name(),
+                        saved.format_version, saved.table_id);
+                continue;
+            }
+            for (auto& e : saved.entries) {
+                if (sharder.shard_of(dht::get_token(*s, e.key)) == this_shard_id()) {
+                    result.push_back(std::move(e));
+                }
+            }
+        } catch (...) {
+            cslogger.warn("Failed to load saved row cache of {}.{}: {}", s->ks_name(), s->cf_name(), std::current_exception());
+        }
+    }
+    co_return result;
+}
+
+future<> cache_saver::preload_row_caches() {
+    auto tables = boost::copy_range<std::vector<lw_shared_ptr<table>>>(_db.get_column_families() | boost::adaptors::map_values);
+    co_await with_scheduling_group(_db.get_streaming_scheduling_group(), [this, &tables] {
+        return do_for_each(tables, [this] (lw_shared_ptr<table>& t) {
+            if (!t->cache_enabled()) {
+                return make_ready_future<>();
+            }
+            return preload_row_cache(t);
+        });
+    });
+}
+
+future<> cache_saver::preload_row_cache(lw_shared_ptr<table> t) {
+    auto s = t->schema();
+    auto entries = co_await load_row_cache(*t);
+    if (entries.empty()) {
+        co_return;
+    }
+    cslogger.info("Preloading {} partitions into {}.{} row cache", entries.size(), s->ks_name(), s->cf_name());
+
+    auto permit = co_await t->streaming_read_concurrency_semaphore().obtain_permit(s.get(), "cache-preload",
+            t->estimate_read_memory_cost(), db::no_timeout);
+    co_await max_concurrent_for_each(entries, preload_concurrency, [this, &t, &s, &permit] (saved_row_cache_entry& e) -> future<> {
+        auto dk = dht::decorate_key(*s, std::move(e.key));
+        auto pr = dht::partition_range::make_singular(dk);
+        auto slice = partition_slice_builder(*s).with_ranges(std::move(e.ranges)).build();
+        auto reader = t->get_row_cache().make_reader(s, permit, pr, slice, service::get_local_streaming_priority());
+        std::exception_ptr ex;
+        try {
+            co_await reader.consume_pausable([] (mutation_fragment) {
+                return stop_iteration::no;
+            }, db::no_timeout);
+            ++_stats.preloaded_partitions;
+        } catch (...) {
+            ex = std::current_exception();
+        }
+        co_await reader.close();
+        if (ex) {
+            ++_stats.preload_failures;
+            cslogger.debug("Failed to preload partition {} of {}.{}: {}", dk, s->ks_name(), s->cf_name(), ex);
+        }
+    });
+}
+
+future<> cache_saver::save_key_caches() {
+    auto contents = co_await get_lru_contents(false, true);
+    auto max_pages = max_entries(_key_cache_keys_to_save(), max_saved_index_pages);
+    size_t nr_pages = 0;
+    auto tables = boost::copy_range<std::vector<lw_shared_ptr<table>>>(_db.get_column_families() | boost::adaptors::map_values);
+    for (auto& t : tables) {
+        try {
+            co_await save_key_cache(*t, *contents, nr_pages, max_pages);
+            ++_stats.key_cache_saves;
+        } catch (...) {
+            ++_stats.key_cache_save_failures;
+            cslogger.warn("Failed to save key cache of {}.{}: {}", t->schema()->ks_name(), t->schema()->cf_name(), std::current_exception());
+        }
+    }
+}
+
+future<> cache_saver::save_key_cache(const table& t, const lru_contents& contents, size_t& nr_pages, size_t max_pages) {
+    auto s = t.schema();
+    auto sstables = t.get_sstables();
+    saved_key_cache saved{current_format_version, s->id(), {}};
+    size_t nr_table_pages = 0;
+    for (auto& sst : *sstables) {
+        saved_index_pages pages{sst->generation(), {}};
+        // Pages used by readers right now are the hottest, and are linked in
+        // the LRU only once released.
+        for (auto summary_index : sst->get_index_cache().referenced_keys()) {
+            if (nr_pages == max_pages) {
+                break;
+            }
+            pages.summary_indexes.push_back(summary_index);
+            ++nr_pages;
+        }
+        // Then the other cached pages, from the most recently used one.
+        if (auto it = contents.index_pages.find(&sst->get_index_cache()); it != contents.index_pages.end()) {
+            for (auto summary_index : it->second) {
+                if (nr_pages == max_pages) {
+                    break;
+                }
+                pages.summary_indexes.push_back(summary_index);
+                ++nr_pages;
+            }
+        }
+        nr_table_pages += pages.summary_indexes.size();
+        if (!pages.summary_indexes.empty()) {
+            saved.sstables.push_back(std::move(pages));
+        }
+        co_await make_ready_future<>(); // maybe yield
+    }
+    bytes_ostream buf;
+    ser::serialize(buf, saved);
+    co_await write_cache_file(*s, key_cache_file_prefix, std::move(buf));
+
+    _stats.saved_index_pages += nr_table_pages;
+    cslogger.debug("Saved {} index pages of {}.{} key cache", nr_table_pages, s->ks_name(), s->cf_name());
+}
+
+future<> cache_saver::preload_key_caches() {
+    auto tables = boost::copy_range<std::vector<lw_shared_ptr<table>>>(_db.get_column_families() | boost::adaptors::map_values);
+    co_await with_scheduling_group(_db.get_streaming_scheduling_group(), [this, &tables] {
+        return do_for_each(tables, [this] (lw_shared_ptr<table>& t) {
+            return preload_key_cache(t);
+        });
+    });
+}
+
+future<> cache_saver::preload_key_cache(lw_shared_ptr<table> t) {
+    auto s = t->schema();
+    // Sstables owned by several shards, e.g. after a change of the shard
+    // count, are read by each of them through its own index cache, so the
+    // pages saved by any shard may be useful here.
+    std::unordered_map<int64_t, std::vector<uint64_t>> pages_by_generation;
+    for (auto& buf : co_await read_cache_files(*s, key_cache_file_prefix)) {
+        try {
+            auto in = ser::as_input_stream(bytes_view(buf.get(), buf.size()));
+            auto saved = ser::deserialize(in, boost::type<saved_key_cache>());
+            if (saved.format_version != current_format_version || saved.table_id != s->id()) {
+                cslogger.info("Ignoring saved key cache of {}.{}: format version {}, table {}", s->ks_name(), s->cf_name(),
+                        saved.format_version, saved.table_id);
+                continue;
+            }
+            for (auto& p : saved.sstables) {
+                auto& pages = pages_by_generation[p.generation];
+                pages.insert(pages.end(), p.summary_indexes.begin(), p.summary_indexes.end());
+            }
+        } catch (...) {
+            cslogger.warn("Failed to load saved key cache of {}.{}: {}", s->ks_name(), s->cf_name(), std::current_exception());
+        }
+    }
+    if (pages_by_generation.empty()) {
+        co_return;
+    }
+
+    auto sstables = t->get_sstables();
+    auto permit = co_await t->streaming_read_concurrency_semaphore().obtain_permit(s.get(), "key-cache-preload",
+            t->estimate_read_memory_cost(), db::no_timeout);
+    co_await max_concurrent_for_each(*sstables, preload_concurrency, [this, &s, &permit, &pages_by_generation] (const sstables::shared_sstable& sst) -> future<> {
+        auto it = pages_by_generation.find(sst->generation());
+        if (it == pages_by_generation.end()) {
+            co_return;
+        }
+        auto& pages = it->second;
+        std::sort(pages.begin(), pages.end());
+        pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+        try {
+            co_await sst->prefetch_index_pages(pages, permit, service::get_local_streaming_priority());
+            _stats.preloaded_index_pages += pages.size();
+        } catch (...) {
+            ++_stats.preload_failures;
+            cslogger.debug("Failed to prefetch index pages of {} of {}.{}: {}", sst->get_filename(), s->ks_name(), s->cf_name(),
+                    std::current_exception());
+        }
+    });
+}
+
+void cache_saver::setup_metrics() {
+    namespace sm = seastar::metrics;
+
+    _metrics.add_group("cache_saver", {
+        sm::make_derive("row_cache_saves", _stats.row_cache_saves,
+                sm::description("Number of times a row cache of a table was saved to disk")),
+
+        sm::make_derive("row_cache_save_failures", _stats.row_cache_save_failures,
+                sm::description("Number of times saving a row cache of a table failed")),
+
+        sm::make_derive("saved_partitions", _stats.saved_partitions,
+                sm::description("Number of partitions saved to disk with the row caches")),
+
+        sm::make_derive("preloaded_partitions", _stats.preloaded_partitions,
+                sm::description("Number of saved partitions read back into the row caches on startup")),
+
+        sm::make_derive("preload_failures", _stats.preload_failures,
+                sm::description("Number of saved partitions or sstable index pages which failed to be read back into the caches on startup")),
+
+        sm::make_derive("key_cache_saves", _stats.key_cache_saves,
+                sm::description("Number of times partition index caches of a table were saved to disk")),
+
+        sm::make_derive("key_cache_save_failures", _stats.key_cache_save_failures,
+                sm::description("Number of times saving partition index caches of a table failed")),
+
+        sm::make_derive("saved_index_pages", _stats.saved_index_pages,
+                sm::description("Number of partition index pages saved to disk with the key caches")),
+
+        sm::make_derive("preloaded_index_pages", _stats.preloaded_index_pages,
+                sm::description("Number of saved partition index pages read back into the key caches on startup")),
+    });
+}
+
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <seastar/core/condition-variable.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/timer.hh>
+
+#include "bytes_ostream.hh"
+#include "keys.hh"
+#include "query-request.hh"
+#include "row_cache.hh"
+#include "schema_fwd.hh"
+#include "utils/UUID.hh"
+#include "utils/observable.hh"
+#include "utils/updateable_value.hh"
+#include "seastarx.hh"
+
+class database;
+class table;
+
+namespace sstables {
+
+class partition_index_cache;
+
+}
+
+namespace db {
+
+class config;
+
+// On-disk representation of a saved row cache, see idl/saved_cache.idl.hh.
+struct saved_row_cache_entry {
+    partition_key key;
+    // Clustering ranges which were cached at the time of saving.
+    query::clustering_row_ranges ranges;
+};
+
+struct saved_row_cache {
+    uint32_t format_version;
+    utils::UUID table_id;
+    std::vector<saved_row_cache_entry> entries;
+};
+
+struct saved_index_pages {
+    int64_t generation;
+    // Summary indexes of the partition index pages which were cached.
+    std::vector<uint64_t> summary_indexes;
+};
+
+struct saved_key_cache {
+    uint32_t format_version;
+    utils::UUID table_id;
+    std::vector<saved_index_pages> sstables;
+};
+
+// Saves the contents of row caches and partition index caches (the "key cache")
+// to saved_caches_directory and brings them back after a restart, so that
+// a freshly started node doesn't have to warm up its caches from client reads,
+// with all of them missing.
+//
+// Row caches are saved every row_cache_save_period seconds. Only the partition
+// keys and the clustering ranges which were cached are saved, not the data itself,
+// up to row_cache_keys_to_save partitions per shard, the hottest ones first.
+// Partition index caches are saved every key_cache_save_period seconds, as
+// the summary indexes of cached index pages of every sstable, identified by
+// its generation. Each shard saves its caches into separate files per table.
+// Both kinds of entries are kept in the same LRU, which is walked once per
+// save for all tables, and once for both caches when they're saved together.
+//
+// Preloading reads the saved partitions through the row cache, so it is
+// populated the same way a miss during a regular read populates it. Every shard
+// reads the files saved by all shards and keeps the partitions it owns, so
+// a change in the shard count between restarts is handled. Index pages are
+// prefetched for sstables which are still present, which is done first, so
+// that the row cache preloading benefits from them.
+class cache_saver : public seastar::peering_sharded_service<cache_saver> {
+public:
+    static constexpr uint32_t current_format_version = 1;
+    // Maximum number of partitions each shard preloads concurrently.
+    static constexpr size_t preload_concurrency = 16;
+    // Maximum number of partitions each shard saves, for all tables,
+    // also when row_cache_keys_to_save is 0.
+    static constexpr size_t max_saved_partitions = 1'000'000;
+    // Maximum number of index pages each shard saves, for all tables,
+    // also when key_cache_keys_to_save is 0.
+    static constexpr size_t max_saved_index_pages = 1'000'000;
+    // A walk of the LRU is reused by saves starting this soon after it completed.
+    static constexpr auto lru_walk_reuse_period = std::chrono::seconds(60);
+
+    struct stats {
+        uint64_t row_cache_saves = 0;
+        uint64_t row_cache_save_failures = 0;
+        uint64_t saved_partitions = 0;
+        uint64_t preloaded_partitions = 0;
+        uint64_t preload_failures = 0;
+        uint64_t key_cache_saves = 0;
+        uint64_t key_cache_save_failures = 0;
+        uint64_t saved_index_pages = 0;
+        uint64_t preloaded_index_pages = 0;
+    };
+private:
+    // Invokes a function every period seconds. Zero period disables it.
+    // The period can be changed while the task is running.
+    class periodic_task {
+        utils::updateable_value<uint32_t> _period;
+        seastar::condition_variable _period_changed;
+        utils::observer<uint32_t> _period_observer;
+        future<> _done = make_ready_future<>();
+    private:
+        future<> run(std::function<future<> ()> func);
+    public:
+        explicit periodic_task(utils::updateable_value<uint32_t> period);
+        void start(std::function<future<> ()> func);
+        future<> stop();
+        bool enabled() const { return _period() != 0; }
+    };
+
+    // Contents of the LRU shared by row caches and partition index caches.
+    struct lru_contents {
+        bool has_partitions;
+        bool has_index_pages;
+        row_cache::cached_partitions partitions;
+        // Summary indexes of cached pages, from the most recently used one.
+        std::unordered_map<const sstables::partition_index_cache*, std::vector<uint64_t>> index_pages;
+    };
+
+    database& _db;
+    sstring _directory;
+    utils::updateable_value<uint32_t> _row_cache_keys_to_save;
+    utils::updateable_value<uint32_t> _key_cache_keys_to_save;
+    periodic_task _row_cache_saving;
+    periodic_task _key_cache_saving;
+    std::optional<shared_future<lw_shared_ptr<const lru_contents>>> _lru_walk;
+    timer<lowres_clock> _lru_walk_expiry;
+    stats _stats;
+    seastar::metrics::metric_groups _metrics;
+public:
+    cache_saver(database& db, const db::config& cfg);
+
+    // Starts saving the caches periodically.
+    // Should be called after preloading, so that a partially
+    // preloaded cache doesn't overwrite the saved one.
+    future<> start();
+    future<> stop();
+
+    // Saves row caches of all tables on this shard.
+    future<> save_row_caches();
+
+    // Saves partition index caches of all sstables on this shard.
+    future<> save_key_caches();
+
+    // Populates row caches of all tables on this shard with partitions
+    // which were saved before the restart.
+    future<> preload_row_caches();
+
+    // Reads partition index pages which were cached before the restart
+    // into the caches of sstables on this shard.
+    future<> preload_key_caches();
+
+    const stats& get_stats() const noexcept { return _stats; }
+private:
+    sstring table_directory(const schema& s) const;
+    sstring cache_file(const schema& s, std::string_view prefix, unsigned shard) const;
+    future<> write_cache_file(const schema& s, std::string_view prefix, bytes_ostream buf);
+    future<std::vector<temporary_buffer<int8_t>>> read_cache_files(const schema& s, std::string_view prefix);
+    future<> save_row_cache(const table& t, std::vector<saved_row_cache_entry> entries);
+    future<std::vector<saved_row_cache_entry>> load_row_cache(const table& t);
+    future<> preload_row_cache(lw_shared_ptr<table> t);
+    future<lw_shared_ptr<const lru_contents>> get_lru_contents(bool need_partitions, bool need_index_pages);
+    future<lw_shared_ptr<const lru_contents>> walk_lru(bool collect_partitions, bool collect_index_pages);
+    future<> save_key_cache(const table& t, const lru_contents& contents, size_t& nr_pages, size_t max_pages);
+    future<> preload_key_cache(lw_shared_ptr<table> t);
+    void setup_metrics();
+};
+
+}
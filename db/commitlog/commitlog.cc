@@ -55,6 +55,7 @@
 #include <seastar/core/metrics.hh>
 #include <seastar/core/coroutine.hh>
 #include <seastar/core/future-util.hh>
+#include <seastar/core/sleep.hh>
 #include <seastar/core/file.hh>
 #include <seastar/core/rwlock.hh>
 #include <seastar/core/gate.hh>
@@ -132,7 +133,10 @@ db::commitlog::config db::commitlog::config::from_db_config(const db::config& cf
     c.commitlog_total_space_in_mb = cfg.commitlog_total_space_in_mb() >= 0 ? cfg.commitlog_total_space_in_mb() : (shard_available_memory * smp::count) >> 20;
     c.commitlog_segment_size_in_mb = cfg.commitlog_segment_size_in_mb();
     c.commitlog_sync_period_in_ms = cfg.commitlog_sync_period_in_ms();
-    c.mode = cfg.commitlog_sync() == "batch" ? sync_mode::BATCH : sync_mode::PERIODIC;
+    c.mode = cfg.commitlog_sync() == "batch" || cfg.commitlog_sync() == "group" ? sync_mode::BATCH : sync_mode::PERIODIC;
+    if (cfg.commitlog_sync() == "group") {
+        c.max_group_commit_delay = std::chrono::milliseconds(cfg.commitlog_sync_batch_window_in_ms());
+    }
     c.extensions = &cfg.extensions();
     c.reuse_segments = cfg.commitlog_reuse_segments();
     c.use_o_dsync = cfg.commitlog_use_o_dsync();
@@ -321,10 +325,41 @@ class db::commitlog::segment_manager : public ::enable_shared_from_this<segment_
         // size allocated on disk - i.e. files created (new, reserve, recycled)
         uint64_t total_size_on_disk = 0;
         uint64_t requests_blocked_memory = 0;
+        uint64_t delayed_syncs = 0;
     };
 
     stats totals;
 
+    // Group commit state for batch mode, see group_commit_delay().
+    // Moving averages of the time between batch mode writes and of the latency of their syncs.
+    using precise_clock_type = std::chrono::steady_clock;
+    precise_clock_type::time_point _last_batch_write = {};
+    std::chrono::duration<double, std::micro> _batch_write_interval{0};
+    std::chrono::duration<double, std::micro> _batch_sync_latency{0};
+
+    void note_batch_write() {
+        auto now = precise_clock_type::now();
+        if (_last_batch_write != precise_clock_type::time_point{}) {
+            _batch_write_interval = 0.8 * _batch_write_interval + 0.2 * (now - _last_batch_write);
+        }
+        _last_batch_write = now;
+    }
+    void note_batch_sync_latency(precise_clock_type::duration latency) {
+        _batch_sync_latency = 0.8 * _batch_sync_latency + 0.2 * latency;
+    }
+    // How long to delay a batch mode sync, so that it also commits writes expected
+    // to arrive shortly. Writes arriving while a sync is in progress are already
+    // committed together by the next one, so only delay when another write is
+    // expected before half the sync latency passes. Otherwise waiting would only add
+    // latency.
+    std::chrono::microseconds group_commit_delay() const {
+        auto half_sync = _batch_sync_latency / 2;
+        if (cfg.max_group_commit_delay.count() == 0 || _batch_write_interval.count() == 0 || _batch_write_interval > half_sync) {
+            return std::chrono::microseconds(0);
+        }
+        return std::min(std::chrono::duration_cast<std::chrono::microseconds>(half_sync), cfg.max_group_commit_delay);
+    }
+
     size_t pending_allocations() const {
         return _request_controller.waiters();
     }
@@ -516,6 +551,8 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
     bool _closed = false;
     // Not the same as _closed since files can be reused
     bool _closed_file = false;
+    // Set while a delayed batch mode sync is pending, see batch_cycle().
+    std::optional<shared_promise<>> _group_commit;
 
     bool _terminated = false;
 
@@ -912,6 +949,16 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
         auto me = shared_from_this();
         auto fp = _file_pos;
         try {
+            if (_group_commit) {
+                // A delayed sync is pending, and will write the buffer holding
+                // our allocation.
+                co_await with_timeout(timeout, _group_commit->get_shared_future());
+                if (_flush_pos > fp) {
+                    co_return me;
+                }
+            } else if (auto delay = _segment_manager->group_commit_delay(); delay.count()) {
+                co_return co_await delayed_batch_cycle(delay, timeout);
+            }
             co_await _pending_ops.wait_for_pending(timeout);
             if (fp != _file_pos) {
                 // some other request already wrote this buffer.
@@ -931,7 +978,9 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
             } else {
                 // It is ok to leave the sync behind on timeout because there will be at most one
                 // such sync, all later allocations will block on _pending_ops until it is done.
+                auto start = segment_manager::precise_clock_type::now();
                 co_await with_timeout(timeout, sync());
+                _segment_manager->note_batch_sync_latency(segment_manager::precise_clock_type::now() - start);
             }
         } catch (...) {
             // If we get an IO exception (which we assume this is)
@@ -944,6 +993,46 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
         co_return me;
     }
 
+    // Waits for writes expected to arrive shortly, letting them join the buffer,
+    // then syncs it. Batch mode writes arriving in the meantime wait for this sync
+    // instead of issuing their own.
+    future<sseg_ptr> delayed_batch_cycle(std::chrono::microseconds delay, timeout_clock::time_point timeout) {
+        auto me = shared_from_this();
+        ++_segment_manager->totals.delayed_syncs;
+        _group_commit.emplace();
+        // A failure is propagated to the writes waiting for this sync, if any.
+        // Without them, it must not be reported as an ignored exceptional future.
+        (void)_group_commit->get_shared_future().handle_exception([] (std::exception_ptr) {});
+        std::exception_ptr ex;
+        try {
+            co_await seastar::sleep(delay);
+            auto fp = _file_pos;
+            co_await _pending_ops.wait_for_pending(timeout);
+            if (fp == _file_pos) {
+                auto start = segment_manager::precise_clock_type::now();
+                co_await with_timeout(timeout, sync());
+                _segment_manager->note_batch_sync_latency(segment_manager::precise_clock_type::now() - start);
+            } else if (_flush_pos <= fp) {
+                replay_position rp(_desc.id, position_type(fp));
+                co_await _pending_ops.wait_for_pending(rp, timeout);
+                if (_flush_pos <= fp) {
+                    co_await do_flush(fp);
+                }
+            }
+        } catch (...) {
+            ex = std::current_exception();
+        }
+        if (ex) {
+            _group_commit->set_exception(ex);
+            _group_commit.reset();
+            me->_closed = true; // just mark segment as closed, no writes will be done.
+            std::rethrow_exception(ex);
+        }
+        _group_commit->set_value();
+        _group_commit.reset();
+        co_return me;
+    }
+
     void background_cycle() {
         //FIXME: discarded future
         (void)cycle().discard_result().handle_exception([] (auto ex) {
@@ -1169,6 +1258,7 @@ future<R> db::commitlog::segment_manager::allocate_when_possible(T writer, db::t
                 s = co_await s->finish_and_get_new(timeout);
                 continue;
             case write_result::ok_need_batch_sync:
+                note_batch_write();
                 s = co_await s->batch_cycle(timeout);
                 co_return writer.result();
         }
@@ -1340,6 +1430,9 @@ void db::commitlog::segment_manager::create_counters(const sstring& metrics_cate
         sm::make_derive("flush", totals.flush_count,
                        sm::description("Counts a number of times the flush() method was called for a file.")),
 
+        sm::make_derive("delayed_syncs", totals.delayed_syncs,
+                       sm::description("Counts a number of batch mode syncs which were delayed to commit more writes together.")),
+
         sm::make_derive("bytes_written", totals.bytes_written,
                        sm::description("Counts a number of bytes written to the disk. "
                                        "Divide this value by \"alloc\" to get the average number of bytes per mutation written to the disk.")),
@@ -2638,6 +2731,10 @@ uint64_t db::commitlog::get_flush_count() const {
     return _segment_manager->totals.flush_count;
 }
 
+uint64_t db::commitlog::get_delayed_syncs() const {
+    return _segment_manager->totals.delayed_syncs;
+}
+
 uint64_t db::commitlog::get_pending_tasks() const {
     return _segment_manager->totals.pending_flushes;
 }
@@ -135,6 +135,10 @@ class commitlog {
         uint64_t max_active_flushes = 0;
 
         sync_mode mode = sync_mode::PERIODIC;
+        // In batch mode, delay syncs for up to this long, as estimated from the
+        // rate of writes and the latency of syncs, to commit more writes together.
+        // Zero disables delaying.
+        std::chrono::microseconds max_group_commit_delay{0};
         std::string fname_prefix = descriptor::FILENAME_PREFIX;
 
         bool reuse_segments = true;
@@ -306,6 +310,7 @@ class commitlog {
     uint64_t get_total_size() const;
     uint64_t get_completed_tasks() const;
     uint64_t get_flush_count() const;
+    uint64_t get_delayed_syncs() const;
     uint64_t get_pending_tasks() const;
     uint64_t get_pending_flushes() const;
     uint64_t get_pending_allocations() const;
@@ -268,7 +268,7 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "The directory where hints files are stored if hinted handoff is enabled.")
     , view_hints_directory(this, "view_hints_directory", value_status::Used, "",
         "The directory where materialized-view updates are stored while a view replica is unreachable.")
-    , saved_caches_directory(this, "saved_caches_directory", value_status::Unused, "",
+    , saved_caches_directory(this, "saved_caches_directory", value_status::Used, "",
         "The directory location where table key and row caches are stored.")
     /* Commonly used properties */
     /* Properties most frequently used when configuring Scylla. */
@@ -371,6 +371,7 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "\n"
         "\tperiodic : Used with commitlog_sync_period_in_ms (Default: 10000 - 10 seconds ) to control how often the commit log is synchronized to disk. Periodic syncs are acknowledged immediately.\n"
         "\tbatch : Used with commitlog_sync_batch_window_in_ms (Default: disabled **) to control how long Scylla waits for other writes before performing a sync. When using this method, writes are not acknowledged until fsynced to disk.\n"
+        "\tgroup : Like batch, but a sync may be delayed, by at most commitlog_sync_batch_window_in_ms, so that it commits writes which are expected to arrive shortly. The delay is estimated from the rate of writes and the latency of syncs, and is not used if writes arrive less often than syncs complete.\n"
         "Related information: Durability")
     , commitlog_segment_size_in_mb(this, "commitlog_segment_size_in_mb", value_status::Used, 64,
         "Sets the size of the individual commitlog file segments. A commitlog segment may be archived, deleted, or recycled after all its data has been flushed to SSTables. This amount of data can potentially include commitlog segments from every table in the system. The default size is usually suitable for most commitlog archiving, but if you want a finer granularity, 8 or 16 MB is reasonable. See Commit log archive configuration.\n"
@@ -476,19 +477,19 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     /* Key caches and global row properties */
     /* When creating or modifying tables, you enable or disable the key cache (partition key cache) or row cache for that table by setting the caching parameter. Other row and key cache tuning and configuration options are set at the global (node) level. Cassandra uses these settings to automatically distribute memory for each table on the node based on the overall workload and specific table usage. You can also configure the save periods for these caches globally. */
     /* Related information: Configuring caches */
-    , key_cache_keys_to_save(this, "key_cache_keys_to_save", value_status::Unused, 0,
-        "Number of keys from the key cache to save. (0: all)")
-    , key_cache_save_period(this, "key_cache_save_period", value_status::Unused, 14400,
-        "Duration in seconds that keys are saved in cache. Caches are saved to saved_caches_directory. Saved caches greatly improve cold-start speeds and has relatively little effect on I/O.")
+    , key_cache_keys_to_save(this, "key_cache_keys_to_save", liveness::LiveUpdate, value_status::Used, 0,
+        "Number of partition index pages from the key cache to save, per shard. (0: up to 1000000)")
+    , key_cache_save_period(this, "key_cache_save_period", liveness::LiveUpdate, value_status::Used, 14400,
+        "Duration in seconds that keys are saved in cache. Caches are saved to saved_caches_directory. Saved caches greatly improve cold-start speeds and has relatively little effect on I/O. (0: disabled)")
     , key_cache_size_in_mb(this, "key_cache_size_in_mb", value_status::Unused, 100,
         "A global cache setting for tables. It is the maximum size of the key cache in memory. To disable set to 0.\n"
         "Related information: nodetool setcachecapacity.")
-    , row_cache_keys_to_save(this, "row_cache_keys_to_save", value_status::Unused, 0,
-        "Number of keys from the row cache to save.")
+    , row_cache_keys_to_save(this, "row_cache_keys_to_save", liveness::LiveUpdate, value_status::Used, 0,
+        "Number of keys from the row cache to save, per shard. (0: up to 1000000)")
     , row_cache_size_in_mb(this, "row_cache_size_in_mb", value_status::Unused, 0,
         "Maximum size of the row cache in memory. Row cache can save more time than key_cache_size_in_mb, but is space-intensive because it contains the entire row. Use the row cache only for hot rows or static rows. If you reduce the size, you may not get you hottest keys loaded on start up.")
-    , row_cache_save_period(this, "row_cache_save_period", value_status::Unused, 0,
-        "Duration in seconds that rows are saved in cache. Caches are saved to saved_caches_directory.")
+    , row_cache_save_period(this, "row_cache_save_period", liveness::LiveUpdate, value_status::Used, 0,
+        "Duration in seconds that rows are saved in cache. Caches are saved to saved_caches_directory and preloaded on startup. (0: disabled)")
     , memory_allocator(this, "memory_allocator", value_status::Invalid, "NativeAllocator",
         "The off-heap memory allocator. In addition to caches, this property affects storage engine meta data. Supported values:\n"
         "\tNativeAllocator\n"
@@ -602,6 +603,10 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "\tYour own RPC server: You must provide a fully-qualified class name of an o.a.c.t.TServerFactory that can create a server instance.")
     , cache_hit_rate_read_balancing(this, "cache_hit_rate_read_balancing", value_status::Used, true,
         "This boolean controls whether the replicas for read query will be choosen based on cache hit ratio")
+    , replica_latency_read_balancing(this, "replica_latency_read_balancing", liveness::LiveUpdate, value_status::Used, true,
+        "For tables with a percentile speculative_retry, order the replicas of a read by their recent latencies, "
+        "sending data requests to the fastest ones, and speculate when the contacted replicas are slower than "
+        "the percentile of their own latencies.")
     /* Advanced fault detection settings */
     /* Settings to handle poorly performing or failing nodes. */
     , dynamic_snitch_badness_threshold(this, "dynamic_snitch_badness_threshold", value_status::Unused, 0,
@@ -738,6 +743,7 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , replace_address_first_boot(this, "replace_address_first_boot", value_status::Used, "", "Like replace_address option, but if the node has been bootstrapped successfully it will be ignored. Same as -Dcassandra.replace_address_first_boot.")
     , override_decommission(this, "override_decommission", value_status::Used, false, "Set true to force a decommissioned node to join the cluster")
     , enable_repair_based_node_ops(this, "enable_repair_based_node_ops", liveness::LiveUpdate, value_status::Used, false, "Set true to use enable repair based node operations instead of streaming based")
+    , enable_sstable_file_streaming(this, "enable_sstable_file_streaming", liveness::LiveUpdate, value_status::Used, true, "When bootstrapping or decommissioning with streaming, send sstables which are fully contained in the streamed ranges as whole files instead of as mutation fragments, if the peer has the same sharding")
     , wait_for_hint_replay_before_repair(this, "wait_for_hint_replay_before_repair", liveness::LiveUpdate, value_status::Used, true, "If set to true, the cluster will first wait until the cluster sends its hints towards the nodes participating in repair before proceeding with the repair itself. This reduces the amount of data needed to be transferred during repair.")
     , ring_delay_ms(this, "ring_delay_ms", value_status::Used, 30 * 1000, "Time a node waits to hear from other nodes before joining the ring in milliseconds. Same as -Dcassandra.ring_delay_ms in cassandra.")
     , shadow_round_ms(this, "shadow_round_ms", value_status::Used, 300 * 1000, "The maximum gossip shadow round time. Can be used to reduce the gossip feature check time during node boot up.")
@@ -750,6 +756,7 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , experimental(this, "experimental", value_status::Used, false, "Set to true to unlock all experimental features.")
     , experimental_features(this, "experimental_features", value_status::Used, {}, "Unlock experimental features provided as the option arguments (possible values: 'lwt', 'cdc', 'udf'). Can be repeated.")
     , lsa_reclamation_step(this, "lsa_reclamation_step", value_status::Used, 1, "Minimum number of segments to reclaim in a single step")
+    , lsa_transparent_hugepages(this, "lsa_transparent_hugepages", value_status::Used, true, "Ask the kernel to back memory of LSA segments (memtables and cache) with transparent huge pages, to reduce TLB misses. Has no effect if memory is already backed by hugetlbfs (--hugepages) or if transparent huge pages are disabled in the kernel")
     , prometheus_port(this, "prometheus_port", value_status::Used, 9180, "Prometheus port, set to zero to disable")
     , prometheus_address(this, "prometheus_address", value_status::Used, "0.0.0.0", "Prometheus listening address")
     , prometheus_prefix(this, "prometheus_prefix", value_status::Used, "scylla", "Set the prefix of the exported Prometheus metrics. Changing this will break Scylla's dashboard compatibility, do not change unless you know what you are doing.")
@@ -767,11 +774,17 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         " Performance is affected to some extent as a result. Useful to help debugging problems that may arise at another layers.")
     , cpu_scheduler(this, "cpu_scheduler", value_status::Used, true, "Enable cpu scheduling")
     , view_building(this, "view_building", value_status::Used, true, "Enable view building; should only be set to false when the node is experience issues due to view building")
+    , enable_view_update_coalescing(this, "enable_view_update_coalescing", liveness::LiveUpdate, value_status::Used, true,
+        "When concurrent writes to the same base partition need to read existing rows to generate their view updates, wait for the row or partition lock together and generate the view updates of all of them from a single read")
     , enable_sstables_mc_format(this, "enable_sstables_mc_format", value_status::Unused, true, "Enable SSTables 'mc' format to be used as the default file format")
     , enable_sstables_md_format(this, "enable_sstables_md_format", value_status::Used, true, "Enable SSTables 'md' format to be used as the default file format")
     , enable_dangerous_direct_import_of_cassandra_counters(this, "enable_dangerous_direct_import_of_cassandra_counters", value_status::Used, false, "Only turn this option on if you want to import tables from Cassandra containing counters, and you are SURE that no counters in that table were created in a version earlier than Cassandra 2.1."
         " It is not enough to have ever since upgraded to newer versions of Cassandra. If you EVER used a version earlier than 2.1 in the cluster where these SSTables come from, DO NOT TURN ON THIS OPTION! You will corrupt your data. You have been warned.")
     , enable_shard_aware_drivers(this, "enable_shard_aware_drivers", value_status::Used, true, "Enable native transport drivers to use connection-per-shard for better performance")
+    , native_transport_flush_delay_in_us(this, "native_transport_flush_delay_in_us", value_status::Used, 0,
+        "Responses of a CQL connection which are ready at the same time are always sent together. If set, the connection also waits up to this many microseconds "
+        "for responses of its other in-flight requests before sending, so that pipelined requests are answered with fewer writes to the socket, at the cost of latency. "
+        "0 disables the wait.")
     , enable_ipv6_dns_lookup(this, "enable_ipv6_dns_lookup", value_status::Used, false, "Use IPv6 address resolution")
     , abort_on_internal_error(this, "abort_on_internal_error", liveness::LiveUpdate, value_status::Used, false, "Abort the server instead of throwing exception when internal invariants are violated")
     , max_partition_key_restrictions_per_query(this, "max_partition_key_restrictions_per_query", liveness::LiveUpdate, value_status::Used, 100,
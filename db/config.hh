@@ -248,6 +248,7 @@ class config : public utils::config_file {
     named_value<uint32_t> rpc_send_buff_size_in_bytes;
     named_value<sstring> rpc_server_type;
     named_value<bool> cache_hit_rate_read_balancing;
+    named_value<bool> replica_latency_read_balancing;
     named_value<double> dynamic_snitch_badness_threshold;
     named_value<uint32_t> dynamic_snitch_reset_interval_in_ms;
     named_value<uint32_t> dynamic_snitch_update_interval_in_ms;
@@ -291,6 +292,7 @@ class config : public utils::config_file {
     named_value<sstring> replace_address_first_boot;
     named_value<bool> override_decommission;
     named_value<bool> enable_repair_based_node_ops;
+    named_value<bool> enable_sstable_file_streaming;
     named_value<bool> wait_for_hint_replay_before_repair;
     named_value<uint32_t> ring_delay_ms;
     named_value<uint32_t> shadow_round_ms;
@@ -303,6 +305,7 @@ class config : public utils::config_file {
     named_value<bool> experimental;
     named_value<std::vector<enum_option<experimental_features_t>>> experimental_features;
     named_value<size_t> lsa_reclamation_step;
+    named_value<bool> lsa_transparent_hugepages;
     named_value<uint16_t> prometheus_port;
     named_value<sstring> prometheus_address;
     named_value<sstring> prometheus_prefix;
@@ -317,10 +320,12 @@ class config : public utils::config_file {
     named_value<bool> enable_sstable_key_validation;
     named_value<bool> cpu_scheduler;
     named_value<bool> view_building;
+    named_value<bool> enable_view_update_coalescing;
     named_value<bool> enable_sstables_mc_format;
     named_value<bool> enable_sstables_md_format;
     named_value<bool> enable_dangerous_direct_import_of_cassandra_counters;
     named_value<bool> enable_shard_aware_drivers;
+    named_value<uint32_t> native_transport_flush_delay_in_us;
     named_value<bool> enable_ipv6_dns_lookup;
     named_value<bool> abort_on_internal_error;
     named_value<uint32_t> max_partition_key_restrictions_per_query;
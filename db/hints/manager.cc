@@ -31,6 +31,7 @@
 #include "db/extensions.hh"
 #include "service/storage_proxy.hh"
 #include "gms/versioned_value.hh"
+#include "gms/feature_service.hh"
 #include "seastarx.hh"
 #include "converting_mutation_partition_applier.hh"
 #include "utils/disk-error-handler.hh"
@@ -87,6 +88,12 @@ void manager::register_metrics(const sstring& group_name) {
         sm::make_derive("sent", _stats.sent,
                         sm::description("Number of sent hints.")),
 
+        sm::make_derive("sent_bytes", _stats.sent_bytes,
+                        sm::description("Total size of sent hints.")),
+
+        sm::make_derive("sent_batches", _stats.sent_batches,
+                        sm::description("Number of batches of hints sent with a single message.")),
+
         sm::make_derive("discarded", _stats.discarded,
                         sm::description("Number of hints that were discarded during sending (too old, schema changed, etc.).")),
 
@@ -809,11 +816,31 @@ future<> manager::end_point_hints_manager::sender::send_one_mutation(frozen_muta
     return do_send_one_mutation(std::move(m), natural_endpoints);
 }
 
+void manager::end_point_hints_manager::sender::on_hint_read_error(lw_shared_ptr<send_one_file_ctx> ctx_ptr, db::replay_position rp, const sstring& fname, std::exception_ptr eptr) noexcept {
+    try {
+        std::rethrow_exception(std::move(eptr));
+    // ignore these errors and move on - probably this hint is too old and the KS/CF has been deleted...
+    } catch (no_such_column_family& e) {
+        manager_logger.debug("send_hints(): no_such_column_family: {}", e.what());
+        ++shard_stats().discarded;
+    } catch (no_such_keyspace& e) {
+        manager_logger.debug("send_hints(): no_such_keyspace: {}", e.what());
+        ++shard_stats().discarded;
+    } catch (no_column_mapping& e) {
+        manager_logger.debug("send_hints(): {} at {}: {}", fname, rp, e.what());
+        ++shard_stats().discarded;
+    } catch (...) {
+        manager_logger.debug("send_hints(): unexpected error in file {} at {}: {}", fname, rp, std::current_exception());
+        ctx_ptr->on_hint_send_failure(rp);
+    }
+}
+
 future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<send_one_file_ctx> ctx_ptr, fragmented_temporary_buffer buf, db::replay_position rp, gc_clock::duration secs_since_file_mod, const sstring& fname) {
     ctx_ptr->last_attempted_rp = rp;
     return _resource_manager.get_send_units_for(buf.size_bytes()).then([this, secs_since_file_mod, &fname, buf = std::move(buf), rp, ctx_ptr] (auto units) mutable {
         // Future is waited on indirectly in `send_one_file()` (via `ctx_ptr->file_send_gate`).
         (void)with_gate(ctx_ptr->file_send_gate, [this, secs_since_file_mod, &fname, buf = std::move(buf), rp, ctx_ptr] () mutable {
+            const size_t size = buf.size_bytes();
             try {
                 auto m = this->get_mutation(ctx_ptr, buf);
                 gc_clock::duration gc_grace_sec = m.s->gc_grace_seconds();
@@ -826,26 +853,15 @@ future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<s
                     return make_ready_future<>();
                 }
 
-                return this->send_one_mutation(std::move(m)).then([this, rp, ctx_ptr] {
+                return this->send_one_mutation(std::move(m)).then([this, rp, ctx_ptr, size] {
                     ++this->shard_stats().sent;
+                    this->shard_stats().sent_bytes += size;
                 }).handle_exception([this, ctx_ptr, rp] (auto eptr) {
                     manager_logger.trace("send_one_hint(): failed to send to {}: {}", end_point_key(), eptr);
                     ctx_ptr->on_hint_send_failure(rp);
                 });
-
-            // ignore these errors and move on - probably this hint is too old and the KS/CF has been deleted...
-            } catch (no_such_column_family& e) {
-                manager_logger.debug("send_hints(): no_such_column_family: {}", e.what());
-                ++this->shard_stats().discarded;
-            } catch (no_such_keyspace& e) {
-                manager_logger.debug("send_hints(): no_such_keyspace: {}", e.what());
-                ++this->shard_stats().discarded;
-            } catch (no_column_mapping& e) {
-                manager_logger.debug("send_hints(): {} at {}: {}", fname, rp, e.what());
-                ++this->shard_stats().discarded;
             } catch (...) {
-                manager_logger.debug("send_hints(): unexpected error in file {} at {}: {}", fname, rp, std::current_exception());
-                ctx_ptr->on_hint_send_failure(rp);
+                this->on_hint_read_error(ctx_ptr, rp, fname, std::current_exception());
             }
             return make_ready_future<>();
         }).finally([units = std::move(units), ctx_ptr] {});
@@ -855,6 +871,85 @@ future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<s
     });
 }
 
+future<> manager::end_point_hints_manager::sender::batch_one_hint(lw_shared_ptr<send_one_file_ctx> ctx_ptr, fragmented_temporary_buffer buf, db::replay_position rp, gc_clock::duration secs_since_file_mod, const sstring& fname) {
+    ctx_ptr->last_attempted_rp = rp;
+    const size_t size = buf.size_bytes();
+    try {
+        auto m = get_mutation(ctx_ptr, buf);
+        gc_clock::duration gc_grace_sec = m.s->gc_grace_seconds();
+
+        // The hint is too old - drop it. See send_one_hint().
+        if (gc_clock::now().time_since_epoch() - secs_since_file_mod > gc_grace_sec - manager::hints_flush_period) {
+            return make_ready_future<>();
+        }
+
+        keyspace& ks = _db.find_keyspace(m.s->ks_name());
+        auto token = dht::get_token(*m.s, m.fm.key());
+        inet_address_vector_replica_set natural_endpoints = ks.get_replication_strategy().get_natural_endpoints(std::move(token));
+
+        if (boost::range::find(natural_endpoints, end_point_key()) == natural_endpoints.end()) {
+            return _resource_manager.get_send_units_for(size).then([this, ctx_ptr, m = std::move(m), natural_endpoints = std::move(natural_endpoints), rp, size] (auto units) mutable {
+                // Future is waited on indirectly in `send_one_file()` (via `ctx_ptr->file_send_gate`).
+                (void)with_gate(ctx_ptr->file_send_gate, [this, ctx_ptr, m = std::move(m), natural_endpoints = std::move(natural_endpoints), rp, size] () mutable {
+                    return do_send_one_mutation(std::move(m), natural_endpoints).then([this, size] {
+                        ++shard_stats().sent;
+                        shard_stats().sent_bytes += size;
+                    }).handle_exception([this, ctx_ptr, rp] (auto eptr) {
+                        manager_logger.trace("batch_one_hint(): failed to send to {}: {}", end_point_key(), eptr);
+                        ctx_ptr->on_hint_send_failure(rp);
+                    });
+                }).finally([units = std::move(units), ctx_ptr] {});
+            }).handle_exception([this, ctx_ptr, rp] (auto eptr) {
+                manager_logger.trace("batch_one_hint(): Hmmm. Something bad had happend: {}", eptr);
+                ctx_ptr->on_hint_send_failure(rp);
+            });
+        }
+
+        if (ctx_ptr->batch.empty()) {
+            ctx_ptr->batch_first_rp = rp;
+        }
+        ctx_ptr->batch.push_back(std::move(m));
+        ctx_ptr->batch_size += size;
+        if (ctx_ptr->batch.size() >= max_hints_per_batch || ctx_ptr->batch_size >= max_batch_size) {
+            return send_hint_batch(std::move(ctx_ptr));
+        }
+    } catch (...) {
+        on_hint_read_error(ctx_ptr, rp, fname, std::current_exception());
+    }
+    return make_ready_future<>();
+}
+
+future<> manager::end_point_hints_manager::sender::send_hint_batch(lw_shared_ptr<send_one_file_ctx> ctx_ptr) {
+    if (ctx_ptr->batch.empty()) {
+        return make_ready_future<>();
+    }
+
+    auto batch = std::exchange(ctx_ptr->batch, {});
+    const size_t size = std::exchange(ctx_ptr->batch_size, 0);
+    // Hints are read in the order of their replay positions, so replaying the file
+    // from the first hint of the batch is going to retry all of them.
+    const db::replay_position first_rp = *ctx_ptr->batch_first_rp;
+    return _resource_manager.get_send_units_for(size).then([this, ctx_ptr, batch = std::move(batch), size, first_rp] (auto units) mutable {
+        // Future is waited on indirectly in `send_one_file()` (via `ctx_ptr->file_send_gate`).
+        (void)with_gate(ctx_ptr->file_send_gate, [this, ctx_ptr, batch = std::move(batch), size, first_rp] () mutable {
+            const size_t count = batch.size();
+            return futurize_invoke([this, &batch] {
+                return _proxy.send_hints_to_endpoint(std::move(batch), end_point_key());
+            }).then([this, count, size] {
+                shard_stats().sent += count;
+                shard_stats().sent_bytes += size;
+                ++shard_stats().sent_batches;
+            }).handle_exception([this, ctx_ptr, first_rp] (auto eptr) {
+                manager_logger.trace("send_hint_batch(): failed to send to {}: {}", end_point_key(), eptr);
+                ctx_ptr->on_hint_send_failure(first_rp);
+            });
+        }).finally([units = std::move(units), ctx_ptr] {});
+    }).handle_exception([this, ctx_ptr, first_rp] (auto eptr) {
+        manager_logger.trace("send_hint_batch(): Hmmm. Something bad had happend: {}", eptr);
+        ctx_ptr->on_hint_send_failure(first_rp);
+    });
+}
+
 void manager::end_point_hints_manager::sender::send_one_file_ctx::on_hint_send_failure(db::replay_position rp) noexcept {
     segment_replay_failed = true;
     if (!first_failed_rp || rp < *first_failed_rp) {
@@ -867,9 +962,11 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
     timespec last_mod = get_last_file_modification(fname).get0();
     gc_clock::duration secs_since_file_mod = std::chrono::seconds(last_mod.tv_sec);
     lw_shared_ptr<send_one_file_ctx> ctx_ptr = make_lw_shared<send_one_file_ctx>(_last_schema_ver_to_column_mapping);
+    // Hints are sent in batches only if every node knows the HINT_MUTATIONS verb.
+    const bool send_in_batches = _proxy.features().cluster_supports_hint_mutations_batch();
 
     try {
-        commitlog::read_log_file(fname, manager::FILENAME_PREFIX, service::get_local_streaming_priority(), [this, secs_since_file_mod, &fname, ctx_ptr] (commitlog::buffer_and_replay_position buf_rp) mutable {
+        commitlog::read_log_file(fname, manager::FILENAME_PREFIX, service::get_local_streaming_priority(), [this, secs_since_file_mod, &fname, ctx_ptr, send_in_batches] (commitlog::buffer_and_replay_position buf_rp) mutable {
             auto& buf = buf_rp.buffer;
             auto& rp = buf_rp.position;
             // Check that we can still send the next hint. Don't try to send it if the destination host
@@ -884,7 +981,10 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
                 return make_ready_future<>();
             }
 
-            return flush_maybe().finally([this, ctx_ptr, buf = std::move(buf), rp, secs_since_file_mod, &fname] () mutable {
+            return flush_maybe().finally([this, ctx_ptr, buf = std::move(buf), rp, secs_since_file_mod, &fname, send_in_batches] () mutable {
+                if (send_in_batches) {
+                    return batch_one_hint(std::move(ctx_ptr), std::move(buf), rp, secs_since_file_mod, fname);
+                }
                 return send_one_hint(std::move(ctx_ptr), std::move(buf), rp, secs_since_file_mod, fname);
             });
         }, _last_not_complete_rp.pos, &_db.extensions()).get();
@@ -897,6 +997,9 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
         ctx_ptr->segment_replay_failed = true;
     }
 
+    // send out the hints which didn't fill a whole batch
+    send_hint_batch(ctx_ptr).get();
+
     // wait till all background hints sending is complete
     ctx_ptr->file_send_gate.close().get();
 
@@ -76,17 +76,20 @@ class directory_initializer {
 };
 
 class manager {
-private:
+public:
     struct stats {
         uint64_t size_of_hints_in_progress = 0;
         uint64_t written = 0;
         uint64_t errors = 0;
         uint64_t dropped = 0;
         uint64_t sent = 0;
+        uint64_t sent_bytes = 0;
+        uint64_t sent_batches = 0;
         uint64_t discarded = 0;
         uint64_t corrupted_files = 0;
     };
 
+private:
     // map: shard -> segments
     using hints_ep_segments_map = std::unordered_map<unsigned, std::list<fs::path>>;
     // map: IP -> map: shard -> segments
@@ -130,10 +133,18 @@ class manager {
                 std::optional<db::replay_position> first_failed_rp;
                 std::optional<db::replay_position> last_attempted_rp;
                 bool segment_replay_failed = false;
+                // Hints waiting to be sent with a single message, see send_hint_batch().
+                std::vector<frozen_mutation_and_schema> batch;
+                size_t batch_size = 0;
+                std::optional<db::replay_position> batch_first_rp;
 
                 void on_hint_send_failure(db::replay_position rp) noexcept;
             };
 
+            // Limits of a batch of hints sent with a single HINT_MUTATIONS message.
+            static constexpr size_t max_hints_per_batch = 128;
+            static constexpr size_t max_batch_size = 1024 * 1024;
+
         private:
             std::list<sstring> _segments_to_replay;
             replay_position _last_not_complete_rp;
@@ -255,6 +266,29 @@ class manager {
             /// \return future that resolves when next hint may be sent
             future<> send_one_hint(lw_shared_ptr<send_one_file_ctx> ctx_ptr, fragmented_temporary_buffer buf, db::replay_position rp, gc_clock::duration secs_since_file_mod, const sstring& fname);
 
+            /// \brief Add one hint read from the file to the batch of the file, and send the batch once it is full.
+            ///
+            /// Used instead of send_one_hint() when the cluster supports the HINT_MUTATIONS verb. Hints for which
+            /// the destination is no longer a replica are applied "from scratch" one by one, like in send_one_hint().
+            /// The parameters have the same meaning as in send_one_hint().
+            ///
+            /// \return future that resolves when next hint may be sent
+            future<> batch_one_hint(lw_shared_ptr<send_one_file_ctx> ctx_ptr, fragmented_temporary_buffer buf, db::replay_position rp, gc_clock::duration secs_since_file_mod, const sstring& fname);
+
+            /// \brief Send the hints batched in the file sending context with a single message.
+            ///
+            /// The memory budget is taken for the batch as a whole. If sending fails, the replay of the file is going to
+            /// be retried from the first hint of the batch.
+            ///
+            /// \param ctx_ptr shared pointer to the file sending context
+            /// \return future that resolves when next hint may be sent
+            future<> send_hint_batch(lw_shared_ptr<send_one_file_ctx> ctx_ptr);
+
+            /// \brief Handle an error thrown while restoring a hint or preparing it to be sent.
+            ///
+            /// Hints of dropped tables and keyspaces are discarded, other errors fail the replay of the file at \ref rp.
+            void on_hint_read_error(lw_shared_ptr<send_one_file_ctx> ctx_ptr, db::replay_position rp, const sstring& fname, std::exception_ptr eptr) noexcept;
+
             /// \brief Send all hint from a single file and delete it after it has been successfully sent.
             /// Send all hints from the given file. If we failed to send the current segment we will pick up in the next
             /// iteration from where we left in this one.
@@ -587,6 +621,10 @@ class manager {
         return _stats.size_of_hints_in_progress;
     }
 
+    const stats& get_stats() const noexcept {
+        return _stats;
+    }
+
     /// \brief Get the number of in-flight (to the disk) hints to a given end point.
     /// \param ep End point identificator
     /// \return Number of hints in-flight to \param ep.
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2021-present ScyllaDB
+ */
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "serializer.hh"
+#include "schema.hh"
+#include "exceptions/exceptions.hh"
+
+namespace db {
+
+/**
+ * \brief Schema extension which represents `sstable_index_format` per-table option.
+ *
+ * The option selects the partition index written to new sstables of the table:
+ *  - 'standard': the Summary and Index components, compatible with Cassandra.
+ *    A lookup searches the summary, which is kept in memory, and then scans
+ *    an index page;
+ *  - 'trie': the Summary and Index components, and a trie over the partition
+ *    keys in the Partitions component, which readers use to find partitions
+ *    in one or two page reads, see sstables/trie_index.hh.
+ *
+ * Existing sstables keep their indexes until they are rewritten.
+ */
+class sstable_index_format_extension : public schema_extension {
+    sstable_index_format _format = sstable_index_format::standard;
+public:
+    static constexpr auto NAME = "sstable_index_format";
+
+    sstable_index_format_extension() = default;
+
+    explicit sstable_index_format_extension(sstable_index_format format)
+        : _format(format)
+    {}
+
+    explicit sstable_index_format_extension(const std::map<sstring, sstring>& map) {
+        throw exceptions::configuration_exception(format("{} must be a string", NAME));
+    }
+
+    explicit sstable_index_format_extension(bytes b) : _format(parse(deserialize(b)))
+    {}
+
+    explicit sstable_index_format_extension(const sstring& s) : _format(parse(s))
+    {}
+
+    bytes serialize() const override {
+        return ser::serialize_to_buffer<bytes>(name(_format));
+    }
+
+    static sstring deserialize(const bytes_view& buffer) {
+        return ser::deserialize_from_buffer(buffer, boost::type<sstring>());
+    }
+
+    static sstable_index_format parse(const sstring& s) {
+        if (s == "standard") {
+            return sstable_index_format::standard;
+        } else if (s == "trie") {
+            return sstable_index_format::trie;
+        }
+        throw exceptions::configuration_exception(format("Invalid {} '{}': must be 'standard' or 'trie'", NAME, s));
+    }
+
+    static sstring name(sstable_index_format format) {
+        return format == sstable_index_format::trie ? "trie" : "standard";
+    }
+
+    sstable_index_format get_format() const {
+        return _format;
+    }
+};
+
+} // namespace db
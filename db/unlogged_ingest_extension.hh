@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021-present ScyllaDB
+ */
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include "serializer.hh"
+#include "schema.hh"
+#include "exceptions/exceptions.hh"
+
+namespace db {
+
+/**
+ * \brief Schema extension which represents `unlogged_ingest` per-table option.
+ *
+ * When enabled, writes to the table are not written to the commitlog, like
+ * writes to tables of a keyspace with durable_writes = false, while other
+ * tables of the keyspace and of the node keep using it. It is meant for bulk
+ * loads which can be repeated: writes become durable only once the memtables
+ * holding them are flushed to sstables, e.g. with `nodetool flush`, and all
+ * writes acknowledged before such a flush started are lost if a node
+ * restarts before it completes.
+ */
+class unlogged_ingest_extension : public schema_extension {
+    bool _enabled = false;
+public:
+    static constexpr auto NAME = "unlogged_ingest";
+
+    unlogged_ingest_extension() = default;
+
+    explicit unlogged_ingest_extension(bool enabled)
+        : _enabled(enabled)
+    {}
+
+    explicit unlogged_ingest_extension(const std::map<sstring, sstring>& map) {
+        throw exceptions::configuration_exception(format("{} must be a boolean", NAME));
+    }
+
+    explicit unlogged_ingest_extension(bytes b) : _enabled(deserialize(b))
+    {}
+
+    explicit unlogged_ingest_extension(const sstring& s) : _enabled(parse(s))
+    {}
+
+    bytes serialize() const override {
+        return ser::serialize_to_buffer<bytes>(_enabled);
+    }
+
+    static bool deserialize(const bytes_view& buffer) {
+        return ser::deserialize_from_buffer(buffer, boost::type<bool>());
+    }
+
+    static bool parse(const sstring& s) {
+        if (boost::iequals(s, "true")) {
+            return true;
+        } else if (boost::iequals(s, "false")) {
+            return false;
+        }
+        throw exceptions::configuration_exception(format("Invalid {} '{}': must be true or false", NAME, s));
+    }
+
+    bool is_enabled() const {
+        return _enabled;
+    }
+};
+
+} // namespace db
@@ -65,6 +65,11 @@ row_locker::lock_holder::lock_holder(row_locker* locker, const dht::decorated_ke
     , _row_exclusive(exclusive) {
 }
 
+row_locker::lock_holder::lock_holder(lw_shared_ptr<lock_holder> shared)
+    : lock_holder() {
+    _shared = std::move(shared);
+}
+
 future<row_locker::lock_holder>
 row_locker::lock_pk(const dht::decorated_key& pk, bool exclusive, db::timeout_clock::time_point timeout, stats& stats) {
     mylog.debug("taking {} lock on entire partition {}", (exclusive ? "exclusive" : "shared"), pk);
@@ -134,6 +139,7 @@ row_locker::lock_holder::lock_holder(row_locker::lock_holder&& old) noexcept
         , _partition_exclusive(old._partition_exclusive)
         , _row(old._row)
         , _row_exclusive(old._row_exclusive)
+        , _shared(std::move(old._shared))
 {
     // We also need to zero old's _partition and _row, so when destructed
     // the destructor will do nothing and further moves will not create
@@ -144,12 +150,15 @@ row_locker::lock_holder::lock_holder(row_locker::lock_holder&& old) noexcept
 
 row_locker::lock_holder& row_locker::lock_holder::operator=(row_locker::lock_holder&& old) noexcept {
     if (this != &old) {
-        this->~lock_holder();
+        if (_locker) {
+            _locker->unlock(_partition,  _partition_exclusive, _row, _row_exclusive);
+        }
         _locker = old._locker;
         _partition = old._partition;
         _partition_exclusive = old._partition_exclusive;
         _row = old._row;
         _row_exclusive = old._row_exclusive;
+        _shared = std::move(old._shared);
         // As above, need to also zero other's data
         old._partition = nullptr;
         old._row = nullptr;
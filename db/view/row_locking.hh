@@ -37,6 +37,7 @@
 
 #include <seastar/core/rwlock.hh>
 #include <seastar/core/future.hh>
+#include <seastar/core/shared_ptr.hh>
 
 #include "db/timeout_clock.hh"
 #include "schema_fwd.hh"
@@ -71,10 +72,15 @@ class row_locker {
         bool _partition_exclusive;
         const clustering_key_prefix* _row;
         bool _row_exclusive;
+        // A lock held on behalf of several writers, released when the last
+        // of their lock_holder objects is destroyed.
+        lw_shared_ptr<lock_holder> _shared;
     public:
         lock_holder();
         lock_holder(row_locker* locker, const dht::decorated_key* pk, bool exclusive);
         lock_holder(row_locker* locker, const dht::decorated_key* pk, const clustering_key_prefix* cpk, bool exclusive);
+        // Shares a lock taken once for several writers.
+        explicit lock_holder(lw_shared_ptr<lock_holder> shared);
         ~lock_holder();
         // Allow move (noexcept) but disallow copy
         lock_holder(lock_holder&&) noexcept;
@@ -146,6 +146,13 @@ extern const std::string_view CORRECT_IDX_TOKEN_IN_SECONDARY_INDEX;
 extern const std::string_view ALTERNATOR_STREAMS;
 extern const std::string_view RANGE_SCAN_DATA_VARIANT;
 extern const std::string_view CDC_GENERATIONS_V2;
+extern const std::string_view SPLIT_BLOCK_BLOOM_FILTER;
+extern const std::string_view HINT_MUTATIONS_BATCH;
+extern const std::string_view STREAM_SSTABLE_FILES;
+extern const std::string_view COMPRESSION_DICTIONARY;
+extern const std::string_view MUTATIONS_BATCH;
+extern const std::string_view INCREMENTAL_REPAIR;
+extern const std::string_view SSTABLE_TRIE_INDEX;
 
 }
 
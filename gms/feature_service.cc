@@ -66,6 +66,13 @@ constexpr std::string_view features::CORRECT_IDX_TOKEN_IN_SECONDARY_INDEX = "COR
 constexpr std::string_view features::ALTERNATOR_STREAMS = "ALTERNATOR_STREAMS";
 constexpr std::string_view features::RANGE_SCAN_DATA_VARIANT = "RANGE_SCAN_DATA_VARIANT";
 constexpr std::string_view features::CDC_GENERATIONS_V2 = "CDC_GENERATIONS_V2";
+constexpr std::string_view features::SPLIT_BLOCK_BLOOM_FILTER = "SPLIT_BLOCK_BLOOM_FILTER";
+constexpr std::string_view features::HINT_MUTATIONS_BATCH = "HINT_MUTATIONS_BATCH";
+constexpr std::string_view features::STREAM_SSTABLE_FILES = "STREAM_SSTABLE_FILES";
+constexpr std::string_view features::COMPRESSION_DICTIONARY = "COMPRESSION_DICTIONARY";
+constexpr std::string_view features::MUTATIONS_BATCH = "MUTATIONS_BATCH";
+constexpr std::string_view features::INCREMENTAL_REPAIR = "INCREMENTAL_REPAIR";
+constexpr std::string_view features::SSTABLE_TRIE_INDEX = "SSTABLE_TRIE_INDEX";
 
 static logging::logger logger("features");
 
@@ -89,6 +96,13 @@ feature_service::feature_service(feature_config cfg) : _config(cfg)
         , _alternator_streams_feature(*this, features::ALTERNATOR_STREAMS)
         , _range_scan_data_variant(*this, features::RANGE_SCAN_DATA_VARIANT)
         , _cdc_generations_v2(*this, features::CDC_GENERATIONS_V2)
+        , _split_block_bloom_filter(*this, features::SPLIT_BLOCK_BLOOM_FILTER)
+        , _hint_mutations_batch(*this, features::HINT_MUTATIONS_BATCH)
+        , _stream_sstable_files(*this, features::STREAM_SSTABLE_FILES)
+        , _compression_dictionary(*this, features::COMPRESSION_DICTIONARY)
+        , _mutations_batch(*this, features::MUTATIONS_BATCH)
+        , _incremental_repair(*this, features::INCREMENTAL_REPAIR)
+        , _sstable_trie_index(*this, features::SSTABLE_TRIE_INDEX)
 {}
 
 feature_config feature_config_from_db_config(db::config& cfg, std::set<sstring> disabled) {
@@ -184,6 +198,13 @@ std::set<std::string_view> feature_service::known_feature_set() {
         gms::features::ALTERNATOR_STREAMS,
         gms::features::RANGE_SCAN_DATA_VARIANT,
         gms::features::CDC_GENERATIONS_V2,
+        gms::features::SPLIT_BLOCK_BLOOM_FILTER,
+        gms::features::HINT_MUTATIONS_BATCH,
+        gms::features::STREAM_SSTABLE_FILES,
+        gms::features::COMPRESSION_DICTIONARY,
+        gms::features::MUTATIONS_BATCH,
+        gms::features::INCREMENTAL_REPAIR,
+        gms::features::SSTABLE_TRIE_INDEX,
     };
 
     for (const sstring& s : _config._disabled_features) {
@@ -262,6 +283,13 @@ void feature_service::enable(const std::set<std::string_view>& list) {
         std::ref(_alternator_streams_feature),
         std::ref(_range_scan_data_variant),
         std::ref(_cdc_generations_v2),
+        std::ref(_split_block_bloom_filter),
+        std::ref(_hint_mutations_batch),
+        std::ref(_stream_sstable_files),
+        std::ref(_compression_dictionary),
+        std::ref(_mutations_batch),
+        std::ref(_incremental_repair),
+        std::ref(_sstable_trie_index),
     })
     {
         if (list.contains(f.name())) {
@@ -91,6 +91,13 @@ class feature_service final {
     gms::feature _alternator_streams_feature;
     gms::feature _range_scan_data_variant;
     gms::feature _cdc_generations_v2;
+    gms::feature _split_block_bloom_filter;
+    gms::feature _hint_mutations_batch;
+    gms::feature _stream_sstable_files;
+    gms::feature _compression_dictionary;
+    gms::feature _mutations_batch;
+    gms::feature _incremental_repair;
+    gms::feature _sstable_trie_index;
 
 public:
     bool cluster_supports_user_defined_functions() const {
@@ -157,6 +164,41 @@ class feature_service final {
     bool cluster_supports_cdc_generations_v2() const {
         return bool(_cdc_generations_v2);
     }
+
+    // Sstables may have a split block bloom filter, which older nodes would misread.
+    bool cluster_supports_split_block_bloom_filter() const {
+        return bool(_split_block_bloom_filter);
+    }
+
+    // Hints may be replayed in batches with the HINT_MUTATIONS verb.
+    bool cluster_supports_hint_mutations_batch() const {
+        return bool(_hint_mutations_batch);
+    }
+
+    // Sstables may be streamed as whole files with the STREAM_SSTABLE_FILES verb.
+    bool cluster_supports_stream_sstable_files() const {
+        return bool(_stream_sstable_files);
+    }
+
+    // Sstables may be compressed with a dictionary, stored in a component older nodes don't know.
+    bool cluster_supports_compression_dictionary() const {
+        return bool(_compression_dictionary);
+    }
+
+    // The mutations of a batch for the same replica may be sent with a single MUTATIONS message.
+    bool cluster_supports_mutations_batch() const {
+        return bool(_mutations_batch);
+    }
+
+    // Repair may be incremental, using the REPAIR_INCREMENTAL_PREPARE and REPAIR_INCREMENTAL_FINISH verbs.
+    bool cluster_supports_incremental_repair() const {
+        return bool(_incremental_repair);
+    }
+
+    // Sstables may have a trie index, stored in a component older nodes don't know.
+    bool cluster_supports_sstable_trie_index() const {
+        return bool(_sstable_trie_index);
+    }
 };
 
 } // namespace gms
@@ -23,6 +23,16 @@ class repair_hash {
     uint64_t hash;
 };
 
+struct repair_hash_iblt_cell {
+    int32_t count;
+    uint64_t hash_sum;
+    uint64_t check_sum;
+};
+
+class repair_hash_iblt {
+    std::vector<repair_hash_iblt_cell> get_cells();
+};
+
 enum class bound_weight : int8_t {
     before_all_prefixed = -1,
     equal = 0,
@@ -63,6 +73,7 @@ struct get_sync_boundary_response {
 enum class row_level_diff_detect_algorithm : uint8_t {
     send_full_set,
     send_full_set_rpc_stream,
+    send_iblt_rpc_stream,
 };
 
 enum class repair_stream_cmd : uint8_t {
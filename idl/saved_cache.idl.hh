@@ -0,0 +1,46 @@
+/*
+ * Copyright 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+namespace db {
+
+struct saved_row_cache_entry {
+    partition_key key;
+    std::vector<nonwrapping_range<clustering_key_prefix>> ranges;
+};
+
+struct saved_row_cache {
+    uint32_t format_version;
+    utils::UUID table_id;
+    std::vector<db::saved_row_cache_entry> entries;
+};
+
+struct saved_index_pages {
+    int64_t generation;
+    std::vector<uint64_t> summary_indexes;
+};
+
+struct saved_key_cache {
+    uint32_t format_version;
+    utils::UUID table_id;
+    std::vector<db::saved_index_pages> sstables;
+};
+
+}
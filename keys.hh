@@ -622,10 +622,10 @@ class prefix_compound_wrapper : public compound_wrapper<TopLevel, TopLevelView>
         { }
 
         bool operator()(const TopLevel& k1, const TopLevel& k2) const {
-            return prefix_equality_tri_compare(prefix_type->types().begin(),
+            return prefix_equality_tri_compare(prefix_type->comparators().begin(),
                 prefix_type->begin(k1.representation()), prefix_type->end(k1.representation()),
                 prefix_type->begin(k2.representation()), prefix_type->end(k2.representation()),
-                tri_compare) < 0;
+                component_tri_compare{}) < 0;
         }
     };
 
@@ -638,10 +638,10 @@ class prefix_compound_wrapper : public compound_wrapper<TopLevel, TopLevelView>
         { }
 
         std::strong_ordering operator()(const TopLevel& k1, const TopLevel& k2) const {
-            return prefix_equality_tri_compare(prefix_type->types().begin(),
+            return prefix_equality_tri_compare(prefix_type->comparators().begin(),
                 prefix_type->begin(k1.representation()), prefix_type->end(k1.representation()),
                 prefix_type->begin(k2.representation()), prefix_type->end(k2.representation()),
-                tri_compare) <=> 0;
+                component_tri_compare{}) <=> 0;
         }
     };
 };
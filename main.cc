@@ -69,6 +69,7 @@
 #include <seastar/core/abort_on_ebadf.hh>
 
 #include "db/view/view_update_generator.hh"
+#include "db/cache_saver.hh"
 #include "service/cache_hitrate_calculator.hh"
 #include "compaction/compaction_manager.hh"
 #include "sstables/sstables.hh"
@@ -86,6 +87,9 @@
 #include "cdc/generation_service.hh"
 #include "alternator/tags_extension.hh"
 #include "db/paxos_grace_seconds_extension.hh"
+#include "db/bloom_filter_format_extension.hh"
+#include "db/unlogged_ingest_extension.hh"
+#include "db/sstable_index_format_extension.hh"
 #include "service/qos/standard_service_level_distributed_data_accessor.hh"
 #include "service/storage_proxy.hh"
 #include "alternator/controller.hh"
@@ -445,6 +449,9 @@ int main(int ac, char** av) {
     ext->add_schema_extension<alternator::tags_extension>(alternator::tags_extension::NAME);
     ext->add_schema_extension<cdc::cdc_extension>(cdc::cdc_extension::NAME);
     ext->add_schema_extension<db::paxos_grace_seconds_extension>(db::paxos_grace_seconds_extension::NAME);
+    ext->add_schema_extension<db::bloom_filter_format_extension>(db::bloom_filter_format_extension::NAME);
+    ext->add_schema_extension<db::unlogged_ingest_extension>(db::unlogged_ingest_extension::NAME);
+    ext->add_schema_extension<db::sstable_index_format_extension>(db::sstable_index_format_extension::NAME);
 
     auto cfg = make_lw_shared<db::config>(ext);
     auto init = app.get_options_description().add_options();
@@ -614,6 +621,7 @@ int main(int ac, char** av) {
                 st_cfg.defragment_on_idle = cfg->defragment_memory_on_idle();
                 st_cfg.abort_on_lsa_bad_alloc = cfg->abort_on_lsa_bad_alloc();
                 st_cfg.lsa_reclamation_step = cfg->lsa_reclamation_step();
+                st_cfg.use_transparent_hugepages = cfg->lsa_transparent_hugepages();
                 st_cfg.background_reclaim_sched_group = background_reclaim_scheduling_group;
                 st_cfg.sanitizer_report_backtrace = cfg->sanitizer_report_backtrace();
                 logalloc::shard_tracker().configure(st_cfg);
@@ -1221,6 +1229,18 @@ int main(int ac, char** av) {
 
             sst_format_selector.sync();
 
+            // Preload the caches before the node announces itself to the
+            // cluster, so that it doesn't start serving reads with cold caches.
+            supervisor::notify("preloading caches");
+            static sharded<db::cache_saver> cache_saver;
+            cache_saver.start(std::ref(db), std::ref(*cfg)).get();
+            auto stop_cache_saver = defer_verbose_shutdown("cache saver", [] {
+                cache_saver.stop().get();
+            });
+            cache_saver.invoke_on_all(&db::cache_saver::preload_key_caches).get();
+            cache_saver.invoke_on_all(&db::cache_saver::preload_row_caches).get();
+            cache_saver.invoke_on_all(&db::cache_saver::start).get();
+
             with_scheduling_group(maintenance_scheduling_group, [&] {
                 return ss.local().join_cluster();
             }).get();
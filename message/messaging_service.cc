@@ -102,6 +102,7 @@
 #include "flat_mutation_reader.hh"
 #include "streaming/stream_manager.hh"
 #include "streaming/stream_mutation_fragments_cmd.hh"
+#include "streaming/stream_sstable_files_cmd.hh"
 #include "locator/snitch_base.hh"
 
 namespace netw {
@@ -556,9 +557,11 @@ static constexpr unsigned do_get_rpc_client_idx(messaging_verb verb) {
     case messaging_verb::REPLICATION_FINISHED:
     case messaging_verb::UNUSED__REPAIR_CHECKSUM_RANGE:
     case messaging_verb::STREAM_MUTATION_FRAGMENTS:
+    case messaging_verb::STREAM_SSTABLE_FILES:
     case messaging_verb::REPAIR_ROW_LEVEL_START:
     case messaging_verb::REPAIR_ROW_LEVEL_STOP:
     case messaging_verb::REPAIR_GET_FULL_ROW_HASHES:
+    case messaging_verb::REPAIR_GET_ROW_HASHES_IBLT:
     case messaging_verb::REPAIR_GET_COMBINED_ROW_HASH:
     case messaging_verb::REPAIR_GET_SYNC_BOUNDARY:
     case messaging_verb::REPAIR_GET_ROW_DIFF:
@@ -569,13 +572,17 @@ static constexpr unsigned do_get_rpc_client_idx(messaging_verb verb) {
     case messaging_verb::REPAIR_GET_ROW_DIFF_WITH_RPC_STREAM:
     case messaging_verb::REPAIR_PUT_ROW_DIFF_WITH_RPC_STREAM:
     case messaging_verb::REPAIR_GET_FULL_ROW_HASHES_WITH_RPC_STREAM:
+    case messaging_verb::REPAIR_INCREMENTAL_PREPARE:
+    case messaging_verb::REPAIR_INCREMENTAL_FINISH:
     case messaging_verb::NODE_OPS_CMD:
     case messaging_verb::HINT_MUTATION:
+    case messaging_verb::HINT_MUTATIONS:
     case messaging_verb::HINT_SYNC_POINT_CREATE:
     case messaging_verb::HINT_SYNC_POINT_CHECK:
         return 1;
     case messaging_verb::CLIENT_ID:
     case messaging_verb::MUTATION:
+    case messaging_verb::MUTATIONS:
     case messaging_verb::READ_DATA:
     case messaging_verb::READ_MUTATION_DATA:
     case messaging_verb::READ_DIGEST:
@@ -894,6 +901,36 @@ future<> messaging_service::unregister_stream_mutation_fragments() {
     return unregister_handler(messaging_verb::STREAM_MUTATION_FRAGMENTS);
 }
 
+rpc::sink<int32_t> messaging_service::make_sink_for_stream_sstable_files(rpc::source<streaming::stream_sstable_files_cmd, sstring, fragmented_temporary_buffer, uint32_t>& source) {
+    return source.make_sink<netw::serializer, int32_t>();
+}
+
+future<std::tuple<rpc::sink<streaming::stream_sstable_files_cmd, sstring, fragmented_temporary_buffer, uint32_t>, rpc::source<int32_t>>>
+messaging_service::make_sink_and_source_for_stream_sstable_files(utils::UUID plan_id, utils::UUID cf_id, sstring version, streaming::stream_reason reason, msg_addr id) {
+    using sink_type = rpc::sink<streaming::stream_sstable_files_cmd, sstring, fragmented_temporary_buffer, uint32_t>;
+    using value_type = std::tuple<sink_type, rpc::source<int32_t>>;
+    if (is_shutting_down()) {
+        return make_exception_future<value_type>(rpc::closed_error());
+    }
+    auto rpc_client = get_rpc_client(messaging_verb::STREAM_SSTABLE_FILES, id);
+    return rpc_client->make_stream_sink<netw::serializer, streaming::stream_sstable_files_cmd, sstring, fragmented_temporary_buffer, uint32_t>().then([this, plan_id, cf_id, version = std::move(version), reason, rpc_client] (sink_type sink) mutable {
+        auto rpc_handler = rpc()->make_client<rpc::source<int32_t> (utils::UUID, utils::UUID, sstring, streaming::stream_reason, sink_type)>(messaging_verb::STREAM_SSTABLE_FILES);
+        return rpc_handler(*rpc_client, plan_id, cf_id, version, reason, sink).then_wrapped([sink, rpc_client] (future<rpc::source<int32_t>> source) mutable {
+            return (source.failed() ? sink.close() : make_ready_future<>()).then([sink = std::move(sink), source = std::move(source)] () mutable {
+                return make_ready_future<value_type>(value_type(std::move(sink), source.get0()));
+            });
+        });
+    });
+}
+
+void messaging_service::register_stream_sstable_files(std::function<future<rpc::sink<int32_t>> (const rpc::client_info& cinfo, UUID plan_id, UUID cf_id, sstring version, streaming::stream_reason reason, rpc::source<streaming::stream_sstable_files_cmd, sstring, fragmented_temporary_buffer, uint32_t> source)>&& func) {
+    register_handler(this, messaging_verb::STREAM_SSTABLE_FILES, std::move(func));
+}
+
+future<> messaging_service::unregister_stream_sstable_files() {
+    return unregister_handler(messaging_verb::STREAM_SSTABLE_FILES);
+}
+
 template<class SinkType, class SourceType>
 future<std::tuple<rpc::sink<SinkType>, rpc::source<SourceType>>>
 do_make_sink_source(messaging_verb verb, uint32_t repair_meta_id, shared_ptr<messaging_service::rpc_protocol_client_wrapper> rpc_client, std::unique_ptr<messaging_service::rpc_protocol_wrapper>& rpc) {
@@ -1202,6 +1239,19 @@ future<> messaging_service::send_mutation(msg_addr id, clock_type::time_point ti
         std::move(reply_to), shard, std::move(response_id), std::move(trace_info));
 }
 
+void messaging_service::register_mutations(std::function<future<rpc::no_wait_type> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms,
+    inet_address reply_to, unsigned shard, std::vector<response_id_type> response_ids, std::optional<tracing::trace_info> trace_info)>&& func) {
+    register_handler(this, netw::messaging_verb::MUTATIONS, std::move(func));
+}
+future<> messaging_service::unregister_mutations() {
+    return unregister_handler(netw::messaging_verb::MUTATIONS);
+}
+future<> messaging_service::send_mutations(msg_addr id, clock_type::time_point timeout, std::vector<frozen_mutation> fms,
+    inet_address reply_to, unsigned shard, std::vector<response_id_type> response_ids, std::optional<tracing::trace_info> trace_info) {
+    return send_message_oneway_timeout(this, timeout, messaging_verb::MUTATIONS, std::move(id), std::move(fms),
+        std::move(reply_to), shard, std::move(response_ids), std::move(trace_info));
+}
+
 void messaging_service::register_counter_mutation(std::function<future<> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms, db::consistency_level cl, std::optional<tracing::trace_info> trace_info)>&& func) {
     register_handler(this, netw::messaging_verb::COUNTER_MUTATION, std::move(func));
 }
@@ -1318,6 +1368,17 @@ future<repair_hash_set> messaging_service::send_repair_get_full_row_hashes(msg_a
     return send_message<future<repair_hash_set>>(this, messaging_verb::REPAIR_GET_FULL_ROW_HASHES, std::move(id), repair_meta_id);
 }
 
+// Wrapper for REPAIR_GET_ROW_HASHES_IBLT
+void messaging_service::register_repair_get_row_hashes_iblt(std::function<future<repair_hash_iblt> (const rpc::client_info& cinfo, uint32_t repair_meta_id, uint64_t cell_count)>&& func) {
+    register_handler(this, messaging_verb::REPAIR_GET_ROW_HASHES_IBLT, std::move(func));
+}
+future<> messaging_service::unregister_repair_get_row_hashes_iblt() {
+    return unregister_handler(messaging_verb::REPAIR_GET_ROW_HASHES_IBLT);
+}
+future<repair_hash_iblt> messaging_service::send_repair_get_row_hashes_iblt(msg_addr id, uint32_t repair_meta_id, uint64_t cell_count) {
+    return send_message<future<repair_hash_iblt>>(this, messaging_verb::REPAIR_GET_ROW_HASHES_IBLT, std::move(id), repair_meta_id, cell_count);
+}
+
 // Wrapper for REPAIR_GET_COMBINED_ROW_HASH
 void messaging_service::register_repair_get_combined_row_hash(std::function<future<get_combined_row_hash_response> (const rpc::client_info& cinfo, uint32_t repair_meta_id, std::optional<repair_sync_boundary> common_sync_boundary)>&& func) {
     register_handler(this, messaging_verb::REPAIR_GET_COMBINED_ROW_HASH, std::move(func));
@@ -1362,14 +1423,14 @@ future<> messaging_service::send_repair_put_row_diff(msg_addr id, uint32_t repai
 }
 
 // Wrapper for REPAIR_ROW_LEVEL_START
-void messaging_service::register_repair_row_level_start(std::function<future<repair_row_level_start_response> (const rpc::client_info& cinfo, uint32_t repair_meta_id, sstring keyspace_name, sstring cf_name, dht::token_range range, row_level_diff_detect_algorithm algo, uint64_t max_row_buf_size, uint64_t seed, unsigned remote_shard, unsigned remote_shard_count, unsigned remote_ignore_msb, sstring remote_partitioner_name, table_schema_version schema_version, rpc::optional<streaming::stream_reason> reason)>&& func) {
+void messaging_service::register_repair_row_level_start(std::function<future<repair_row_level_start_response> (const rpc::client_info& cinfo, uint32_t repair_meta_id, sstring keyspace_name, sstring cf_name, dht::token_range range, row_level_diff_detect_algorithm algo, uint64_t max_row_buf_size, uint64_t seed, unsigned remote_shard, unsigned remote_shard_count, unsigned remote_ignore_msb, sstring remote_partitioner_name, table_schema_version schema_version, rpc::optional<streaming::stream_reason> reason, rpc::optional<bool> incremental)>&& func) {
     register_handler(this, messaging_verb::REPAIR_ROW_LEVEL_START, std::move(func));
 }
 future<> messaging_service::unregister_repair_row_level_start() {
     return unregister_handler(messaging_verb::REPAIR_ROW_LEVEL_START);
 }
-future<rpc::optional<repair_row_level_start_response>> messaging_service::send_repair_row_level_start(msg_addr id, uint32_t repair_meta_id, sstring keyspace_name, sstring cf_name, dht::token_range range, row_level_diff_detect_algorithm algo, uint64_t max_row_buf_size, uint64_t seed, unsigned remote_shard, unsigned remote_shard_count, unsigned remote_ignore_msb, sstring remote_partitioner_name, table_schema_version schema_version, streaming::stream_reason reason) {
-    return send_message<rpc::optional<repair_row_level_start_response>>(this, messaging_verb::REPAIR_ROW_LEVEL_START, std::move(id), repair_meta_id, std::move(keyspace_name), std::move(cf_name), std::move(range), algo, max_row_buf_size, seed, remote_shard, remote_shard_count, remote_ignore_msb, std::move(remote_partitioner_name), std::move(schema_version), reason);
+future<rpc::optional<repair_row_level_start_response>> messaging_service::send_repair_row_level_start(msg_addr id, uint32_t repair_meta_id, sstring keyspace_name, sstring cf_name, dht::token_range range, row_level_diff_detect_algorithm algo, uint64_t max_row_buf_size, uint64_t seed, unsigned remote_shard, unsigned remote_shard_count, unsigned remote_ignore_msb, sstring remote_partitioner_name, table_schema_version schema_version, streaming::stream_reason reason, bool incremental) {
+    return send_message<rpc::optional<repair_row_level_start_response>>(this, messaging_verb::REPAIR_ROW_LEVEL_START, std::move(id), repair_meta_id, std::move(keyspace_name), std::move(cf_name), std::move(range), algo, max_row_buf_size, seed, remote_shard, remote_shard_count, remote_ignore_msb, std::move(remote_partitioner_name), std::move(schema_version), reason, incremental);
 }
 
 // Wrapper for REPAIR_ROW_LEVEL_STOP
@@ -1416,6 +1477,28 @@ future<std::vector<row_level_diff_detect_algorithm>> messaging_service::send_rep
     return send_message<future<std::vector<row_level_diff_detect_algorithm>>>(this, messaging_verb::REPAIR_GET_DIFF_ALGORITHMS, std::move(id));
 }
 
+// Wrapper for REPAIR_INCREMENTAL_PREPARE
+void messaging_service::register_repair_incremental_prepare(std::function<future<> (const rpc::client_info& cinfo, utils::UUID repair_uuid, std::vector<utils::UUID> table_ids)>&& func) {
+    register_handler(this, messaging_verb::REPAIR_INCREMENTAL_PREPARE, std::move(func));
+}
+future<> messaging_service::unregister_repair_incremental_prepare() {
+    return unregister_handler(messaging_verb::REPAIR_INCREMENTAL_PREPARE);
+}
+future<> messaging_service::send_repair_incremental_prepare(msg_addr id, utils::UUID repair_uuid, std::vector<utils::UUID> table_ids) {
+    return send_message<void>(this, messaging_verb::REPAIR_INCREMENTAL_PREPARE, std::move(id), std::move(repair_uuid), std::move(table_ids));
+}
+
+// Wrapper for REPAIR_INCREMENTAL_FINISH
+void messaging_service::register_repair_incremental_finish(std::function<future<> (const rpc::client_info& cinfo, utils::UUID repair_uuid, dht::token_range_vector ranges, uint64_t repaired_at)>&& func) {
+    register_handler(this, messaging_verb::REPAIR_INCREMENTAL_FINISH, std::move(func));
+}
+future<> messaging_service::unregister_repair_incremental_finish() {
+    return unregister_handler(messaging_verb::REPAIR_INCREMENTAL_FINISH);
+}
+future<> messaging_service::send_repair_incremental_finish(msg_addr id, utils::UUID repair_uuid, dht::token_range_vector ranges, uint64_t repaired_at) {
+    return send_message<void>(this, messaging_verb::REPAIR_INCREMENTAL_FINISH, std::move(id), std::move(repair_uuid), std::move(ranges), repaired_at);
+}
+
 // Wrapper for NODE_OPS_CMD
 void messaging_service::register_node_ops_cmd(std::function<future<node_ops_cmd_response> (const rpc::client_info& cinfo, node_ops_cmd_request)>&& func) {
     register_handler(this, messaging_verb::NODE_OPS_CMD, std::move(func));
@@ -1501,6 +1584,16 @@ future<> messaging_service::send_hint_mutation(msg_addr id, clock_type::time_poi
         std::move(reply_to), shard, std::move(response_id), std::move(trace_info));
 }
 
+void messaging_service::register_hint_mutations(std::function<future<> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms)>&& func) {
+    register_handler(this, netw::messaging_verb::HINT_MUTATIONS, std::move(func));
+}
+future<> messaging_service::unregister_hint_mutations() {
+    return unregister_handler(netw::messaging_verb::HINT_MUTATIONS);
+}
+future<> messaging_service::send_hint_mutations(msg_addr id, clock_type::time_point timeout, std::vector<frozen_mutation> fms) {
+    return send_message_timeout<void>(this, messaging_verb::HINT_MUTATIONS, std::move(id), timeout, std::move(fms));
+}
+
 void messaging_service::register_raft_send_snapshot(std::function<future<raft::snapshot_reply> (const rpc::client_info&, rpc::opt_time_point, raft::group_id gid, raft::server_id from_id, raft::server_id dst_id, raft::install_snapshot)>&& func) {
    register_handler(this, netw::messaging_verb::RAFT_SEND_SNAPSHOT, std::move(func));
 }
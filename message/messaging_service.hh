@@ -38,6 +38,8 @@
 #include "digest_algorithm.hh"
 #include "streaming/stream_reason.hh"
 #include "streaming/stream_mutation_fragments_cmd.hh"
+#include "streaming/stream_sstable_files_cmd.hh"
+#include "utils/fragmented_temporary_buffer.hh"
 #include "cache_temperature.hh"
 #include "service/paxos/prepare_response.hh"
 #include "raft/raft.hh"
@@ -162,7 +164,13 @@ enum class messaging_verb : int32_t {
     RAFT_TIMEOUT_NOW = 51,
     HINT_SYNC_POINT_CREATE = 52,
     HINT_SYNC_POINT_CHECK = 53,
-    LAST = 54,
+    HINT_MUTATIONS = 54,
+    REPAIR_GET_ROW_HASHES_IBLT = 55,
+    STREAM_SSTABLE_FILES = 56,
+    REPAIR_INCREMENTAL_PREPARE = 57,
+    REPAIR_INCREMENTAL_FINISH = 58,
+    MUTATIONS = 59,
+    LAST = 60,
 };
 
 } // namespace netw
@@ -332,6 +340,13 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     rpc::sink<int32_t> make_sink_for_stream_mutation_fragments(rpc::source<frozen_mutation_fragment, rpc::optional<streaming::stream_mutation_fragments_cmd>>& source);
     future<std::tuple<rpc::sink<frozen_mutation_fragment, streaming::stream_mutation_fragments_cmd>, rpc::source<int32_t>>> make_sink_and_source_for_stream_mutation_fragments(utils::UUID schema_id, utils::UUID plan_id, utils::UUID cf_id, uint64_t estimated_partitions, streaming::stream_reason reason, msg_addr id);
 
+    // Wrapper for STREAM_SSTABLE_FILES
+    // Sends the components of one sstable, see streaming::stream_sstable_files_cmd. The receiver replies with a status code like for STREAM_MUTATION_FRAGMENTS.
+    void register_stream_sstable_files(std::function<future<rpc::sink<int32_t>> (const rpc::client_info& cinfo, UUID plan_id, UUID cf_id, sstring version, streaming::stream_reason reason, rpc::source<streaming::stream_sstable_files_cmd, sstring, fragmented_temporary_buffer, uint32_t> source)>&& func);
+    future<> unregister_stream_sstable_files();
+    rpc::sink<int32_t> make_sink_for_stream_sstable_files(rpc::source<streaming::stream_sstable_files_cmd, sstring, fragmented_temporary_buffer, uint32_t>& source);
+    future<std::tuple<rpc::sink<streaming::stream_sstable_files_cmd, sstring, fragmented_temporary_buffer, uint32_t>, rpc::source<int32_t>>> make_sink_and_source_for_stream_sstable_files(utils::UUID plan_id, utils::UUID cf_id, sstring version, streaming::stream_reason reason, msg_addr id);
+
     // Wrapper for REPAIR_GET_ROW_DIFF_WITH_RPC_STREAM
     future<std::tuple<rpc::sink<repair_hash_with_cmd>, rpc::source<repair_row_on_wire_with_cmd>>> make_sink_and_source_for_repair_get_row_diff_with_rpc_stream(uint32_t repair_meta_id, msg_addr id);
     rpc::sink<repair_row_on_wire_with_cmd> make_sink_for_repair_get_row_diff_with_rpc_stream(rpc::source<repair_hash_with_cmd>& source);
@@ -363,6 +378,11 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     future<> unregister_repair_get_full_row_hashes();
     future<repair_hash_set> send_repair_get_full_row_hashes(msg_addr id, uint32_t repair_meta_id);
 
+    // Wrapper for REPAIR_GET_ROW_HASHES_IBLT
+    void register_repair_get_row_hashes_iblt(std::function<future<repair_hash_iblt> (const rpc::client_info& cinfo, uint32_t repair_meta_id, uint64_t cell_count)>&& func);
+    future<> unregister_repair_get_row_hashes_iblt();
+    future<repair_hash_iblt> send_repair_get_row_hashes_iblt(msg_addr id, uint32_t repair_meta_id, uint64_t cell_count);
+
     // Wrapper for REPAIR_GET_COMBINED_ROW_HASH
     void register_repair_get_combined_row_hash(std::function<future<get_combined_row_hash_response> (const rpc::client_info& cinfo, uint32_t repair_meta_id, std::optional<repair_sync_boundary> common_sync_boundary)>&& func);
     future<> unregister_repair_get_combined_row_hash();
@@ -384,9 +404,9 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     future<> send_repair_put_row_diff(msg_addr id, uint32_t repair_meta_id, repair_rows_on_wire row_diff);
 
     // Wrapper for REPAIR_ROW_LEVEL_START
-    void register_repair_row_level_start(std::function<future<repair_row_level_start_response> (const rpc::client_info& cinfo, uint32_t repair_meta_id, sstring keyspace_name, sstring cf_name, dht::token_range range, row_level_diff_detect_algorithm algo, uint64_t max_row_buf_size, uint64_t seed, unsigned remote_shard, unsigned remote_shard_count, unsigned remote_ignore_msb, sstring remote_partitioner_name, table_schema_version schema_version, rpc::optional<streaming::stream_reason> reason)>&& func);
+    void register_repair_row_level_start(std::function<future<repair_row_level_start_response> (const rpc::client_info& cinfo, uint32_t repair_meta_id, sstring keyspace_name, sstring cf_name, dht::token_range range, row_level_diff_detect_algorithm algo, uint64_t max_row_buf_size, uint64_t seed, unsigned remote_shard, unsigned remote_shard_count, unsigned remote_ignore_msb, sstring remote_partitioner_name, table_schema_version schema_version, rpc::optional<streaming::stream_reason> reason, rpc::optional<bool> incremental)>&& func);
     future<> unregister_repair_row_level_start();
-    future<rpc::optional<repair_row_level_start_response>> send_repair_row_level_start(msg_addr id, uint32_t repair_meta_id, sstring keyspace_name, sstring cf_name, dht::token_range range, row_level_diff_detect_algorithm algo, uint64_t max_row_buf_size, uint64_t seed, unsigned remote_shard, unsigned remote_shard_count, unsigned remote_ignore_msb, sstring remote_partitioner_name, table_schema_version schema_version, streaming::stream_reason reason);
+    future<rpc::optional<repair_row_level_start_response>> send_repair_row_level_start(msg_addr id, uint32_t repair_meta_id, sstring keyspace_name, sstring cf_name, dht::token_range range, row_level_diff_detect_algorithm algo, uint64_t max_row_buf_size, uint64_t seed, unsigned remote_shard, unsigned remote_shard_count, unsigned remote_ignore_msb, sstring remote_partitioner_name, table_schema_version schema_version, streaming::stream_reason reason, bool incremental);
 
     // Wrapper for REPAIR_ROW_LEVEL_STOP
     void register_repair_row_level_stop(std::function<future<> (const rpc::client_info& cinfo, uint32_t repair_meta_id, sstring keyspace_name, sstring cf_name, dht::token_range range)>&& func);
@@ -408,6 +428,16 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     future<> unregister_repair_get_diff_algorithms();
     future<std::vector<row_level_diff_detect_algorithm>> send_repair_get_diff_algorithms(msg_addr id);
 
+    // Wrapper for REPAIR_INCREMENTAL_PREPARE
+    void register_repair_incremental_prepare(std::function<future<> (const rpc::client_info& cinfo, utils::UUID repair_uuid, std::vector<utils::UUID> table_ids)>&& func);
+    future<> unregister_repair_incremental_prepare();
+    future<> send_repair_incremental_prepare(msg_addr id, utils::UUID repair_uuid, std::vector<utils::UUID> table_ids);
+
+    // Wrapper for REPAIR_INCREMENTAL_FINISH
+    void register_repair_incremental_finish(std::function<future<> (const rpc::client_info& cinfo, utils::UUID repair_uuid, dht::token_range_vector ranges, uint64_t repaired_at)>&& func);
+    future<> unregister_repair_incremental_finish();
+    future<> send_repair_incremental_finish(msg_addr id, utils::UUID repair_uuid, dht::token_range_vector ranges, uint64_t repaired_at);
+
     // Wrapper for NODE_OPS_CMD
     void register_node_ops_cmd(std::function<future<node_ops_cmd_response> (const rpc::client_info& cinfo, node_ops_cmd_request)>&& func);
     future<> unregister_node_ops_cmd();
@@ -465,6 +495,15 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     future<> send_mutation(msg_addr id, clock_type::time_point timeout, const frozen_mutation& fm, inet_address_vector_replica_set forward,
         inet_address reply_to, unsigned shard, response_id_type response_id, std::optional<tracing::trace_info> trace_info = std::nullopt);
 
+    // Wrapper for MUTATIONS
+    // Like MUTATION, for several mutations without forwarding. Each one is acknowledged
+    // separately, with MUTATION_DONE or MUTATION_FAILED for its response id.
+    void register_mutations(std::function<future<rpc::no_wait_type> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms,
+        inet_address reply_to, unsigned shard, std::vector<response_id_type> response_ids, std::optional<tracing::trace_info> trace_info)>&& func);
+    future<> unregister_mutations();
+    future<> send_mutations(msg_addr id, clock_type::time_point timeout, std::vector<frozen_mutation> fms,
+        inet_address reply_to, unsigned shard, std::vector<response_id_type> response_ids, std::optional<tracing::trace_info> trace_info = std::nullopt);
+
     // Wrapper for COUNTER_MUTATION
     void register_counter_mutation(std::function<future<> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms, db::consistency_level cl, std::optional<tracing::trace_info> trace_info)>&& func);
     future<> unregister_counter_mutation();
@@ -560,6 +599,11 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     future<> send_hint_mutation(msg_addr id, clock_type::time_point timeout, const frozen_mutation& fm, inet_address_vector_replica_set forward,
         inet_address reply_to, unsigned shard, response_id_type response_id, std::optional<tracing::trace_info> trace_info = std::nullopt);
 
+    // Wrapper for HINT_MUTATIONS
+    void register_hint_mutations(std::function<future<> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms)>&& func);
+    future<> unregister_hint_mutations();
+    future<> send_hint_mutations(msg_addr id, clock_type::time_point timeout, std::vector<frozen_mutation> fms);
+
     void register_hint_sync_point_create(std::function<future<db::hints::sync_point_create_response> (db::hints::sync_point_create_request request)>&& func);
     future<> unregister_hint_sync_point_create();
     future<db::hints::sync_point_create_response> send_hint_sync_point_create(msg_addr id, clock_type::time_point timeout, db::hints::sync_point_create_request request);
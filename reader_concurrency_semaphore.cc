@@ -92,6 +92,7 @@ class reader_permit::impl
     bool _marked_as_used = false;
     uint64_t _blocked_branches = 0;
     bool _marked_as_blocked = false;
+    bool _sequential_scan = false;
 
 private:
     void on_permit_used() {
@@ -244,6 +245,14 @@ class reader_permit::impl
         return _base_resources;
     }
 
+    void set_sequential_scan() noexcept {
+        _sequential_scan = true;
+    }
+
+    bool is_sequential_scan() const noexcept {
+        return _sequential_scan;
+    }
+
     sstring description() const {
         return format("{}.{}:{}",
                 _schema ? _schema->ks_name() : "*",
@@ -366,6 +375,14 @@ sstring reader_permit::description() const {
     return _impl->description();
 }
 
+void reader_permit::set_sequential_scan() noexcept {
+    _impl->set_sequential_scan();
+}
+
+bool reader_permit::is_sequential_scan() const noexcept {
+    return _impl->is_sequential_scan();
+}
+
 void reader_permit::mark_used() noexcept {
     _impl->mark_used();
 }
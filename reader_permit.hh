@@ -161,6 +161,12 @@ class reader_permit {
     reader_resources base_resources() const;
 
     sstring description() const;
+
+    /// Mark the read as a scan of whole token ranges, such as those of
+    /// streaming and repair, which sstables serve with fewer, larger reads.
+    void set_sequential_scan() noexcept;
+
+    bool is_sequential_scan() const noexcept;
 };
 
 using reader_permit_opt = optimized_optional<reader_permit>;
@@ -38,6 +38,7 @@
 #include "hashers.hh"
 #include "locator/network_topology_strategy.hh"
 #include "utils/bit_cast.hh"
+#include "utils/div_ceil.hh"
 #include "service/migration_manager.hh"
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -146,6 +147,8 @@ std::ostream& operator<<(std::ostream& out, row_level_diff_detect_algorithm algo
         return out << "send_full_set";
     case row_level_diff_detect_algorithm::send_full_set_rpc_stream:
         return out << "send_full_set_rpc_stream";
+    case row_level_diff_detect_algorithm::send_iblt_rpc_stream:
+        return out << "send_iblt_rpc_stream";
     };
     return out << "unknown";
 }
@@ -822,11 +825,117 @@ static sstring get_local_dc() {
             utils::fb_utilities::get_broadcast_address());
 }
 
+static uint64_t iblt_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static uint64_t iblt_check_sum(uint64_t h) {
+    return iblt_mix(h ^ 0x9e3779b97f4a7c15ULL);
+}
+
+// Calls func on the cells h is added to, one in each part of the table.
+template <typename Func>
+static void for_each_iblt_cell(std::vector<repair_hash_iblt_cell>& cells, uint64_t h, Func&& func) {
+    const size_t part_size = cells.size() / repair_hash_iblt::hash_count;
+    for (size_t i = 0; i < repair_hash_iblt::hash_count; ++i) {
+        func(cells[i * part_size + iblt_mix(h + i) % part_size]);
+    }
+}
+
+static void update_iblt_cell(repair_hash_iblt_cell& cell, uint64_t h, int32_t count) {
+    cell.count += count;
+    cell.hash_sum ^= h;
+    cell.check_sum ^= iblt_check_sum(h);
+}
+
+static bool is_pure_iblt_cell(const repair_hash_iblt_cell& cell) {
+    return (cell.count == 1 || cell.count == -1) && cell.check_sum == iblt_check_sum(cell.hash_sum);
+}
+
+repair_hash_iblt::repair_hash_iblt(size_t cell_count)
+    : _cells(div_ceil(std::max(cell_count, hash_count), hash_count) * hash_count) {
+}
+
+repair_hash_iblt::repair_hash_iblt(std::vector<repair_hash_iblt_cell> cells)
+    : _cells(std::move(cells)) {
+    if (_cells.empty() || _cells.size() % hash_count) {
+        throw std::invalid_argument(format("repair_hash_iblt: invalid number of cells {}", _cells.size()));
+    }
+}
+
+void repair_hash_iblt::add(const repair_hash& h) {
+    for_each_iblt_cell(_cells, h.hash, [&h] (repair_hash_iblt_cell& cell) {
+        update_iblt_cell(cell, h.hash, 1);
+    });
+}
+
+void repair_hash_iblt::remove(const repair_hash& h) {
+    for_each_iblt_cell(_cells, h.hash, [&h] (repair_hash_iblt_cell& cell) {
+        update_iblt_cell(cell, h.hash, -1);
+    });
+}
+
+bool repair_hash_iblt::decode(repair_hash_set& added, repair_hash_set& removed) {
+    std::vector<size_t> pure_cells;
+    for (size_t i = 0; i < _cells.size(); ++i) {
+        if (is_pure_iblt_cell(_cells[i])) {
+            pure_cells.push_back(i);
+        }
+    }
+    while (!pure_cells.empty()) {
+        const auto& cell = _cells[pure_cells.back()];
+        pure_cells.pop_back();
+        // The cell may have been emptied by peeling another one since it was queued.
+        if (!is_pure_iblt_cell(cell)) {
+            continue;
+        }
+        const uint64_t h = cell.hash_sum;
+        const int32_t count = cell.count;
+        (count > 0 ? added : removed).insert(repair_hash(h));
+        for_each_iblt_cell(_cells, h, [this, h, count, &pure_cells] (repair_hash_iblt_cell& c) {
+            update_iblt_cell(c, h, -count);
+            if (is_pure_iblt_cell(c)) {
+                pure_cells.push_back(&c - _cells.data());
+            }
+        });
+    }
+    return std::all_of(_cells.begin(), _cells.end(), [] (const repair_hash_iblt_cell& c) {
+        return c.count == 0 && c.hash_sum == 0 && c.check_sum == 0;
+    });
+}
+
+future<std::optional<repair_hash_set_difference>> find_repair_hash_set_difference(const repair_hash_set& local_hashes,
+        size_t min_cell_count, size_t max_cell_count,
+        noncopyable_function<future<repair_hash_iblt> (size_t cell_count)> get_peer_iblt) {
+    size_t cell_count = std::min(min_cell_count, max_cell_count);
+    for (;;) {
+        repair_hash_iblt iblt = co_await get_peer_iblt(cell_count);
+        for (const auto& h : local_hashes) {
+            iblt.remove(h);
+        }
+        repair_hash_set_difference diff;
+        diff.cell_count = iblt.size();
+        if (iblt.decode(diff.only_on_peer, diff.only_on_local)) {
+            co_return diff;
+        }
+        if (cell_count >= max_cell_count) {
+            co_return std::nullopt;
+        }
+        cell_count = std::min(cell_count * 2, max_cell_count);
+    }
+}
+
 void repair_stats::add(const repair_stats& o) {
     round_nr += o.round_nr;
     round_nr_fast_path_already_synced += o.round_nr_fast_path_already_synced;
     round_nr_fast_path_same_combined_hashes += o.round_nr_fast_path_same_combined_hashes;
     round_nr_slow_path += o.round_nr_slow_path;
+    round_nr_iblt += o.round_nr_iblt;
     rpc_call_nr += o.rpc_call_nr;
     tx_hashes_nr += o.tx_hashes_nr;
     rx_hashes_nr += o.rx_hashes_nr;
@@ -863,11 +972,12 @@ sstring repair_stats::get_stats() {
             row_from_disk_rows_per_sec[x.first] = 0;
         }
     }
-    return format("round_nr={}, round_nr_fast_path_already_synced={}, round_nr_fast_path_same_combined_hashes={}, round_nr_slow_path={}, rpc_call_nr={}, tx_hashes_nr={}, rx_hashes_nr={}, duration={} seconds, tx_row_nr={}, rx_row_nr={}, tx_row_bytes={}, rx_row_bytes={}, row_from_disk_bytes={}, row_from_disk_nr={}, row_from_disk_bytes_per_sec={} MiB/s, row_from_disk_rows_per_sec={} Rows/s, tx_row_nr_peer={}, rx_row_nr_peer={}",
+    return format("round_nr={}, round_nr_fast_path_already_synced={}, round_nr_fast_path_same_combined_hashes={}, round_nr_slow_path={}, round_nr_iblt={}, rpc_call_nr={}, tx_hashes_nr={}, rx_hashes_nr={}, duration={} seconds, tx_row_nr={}, rx_row_nr={}, tx_row_bytes={}, rx_row_bytes={}, row_from_disk_bytes={}, row_from_disk_nr={}, row_from_disk_bytes_per_sec={} MiB/s, row_from_disk_rows_per_sec={} Rows/s, tx_row_nr_peer={}, rx_row_nr_peer={}",
             round_nr,
             round_nr_fast_path_already_synced,
             round_nr_fast_path_same_combined_hashes,
             round_nr_slow_path,
+            round_nr_iblt,
             rpc_call_nr,
             tx_hashes_nr,
             rx_hashes_nr,
@@ -916,6 +1026,10 @@ struct repair_options {
     // The node starting the repair must be in the data center; Issuing a
     // repair to a data center other than the named one returns an error.
     std::vector<sstring> data_centers;
+    // If incremental is true, only the sstables which weren't repaired yet are
+    // read, and those that existed when the repair started are marked as
+    // repaired once it finishes successfully.
+    bool incremental = false;
 
     repair_options(std::unordered_map<sstring, sstring> options) {
         bool_opt(primary_range, options, PRIMARY_RANGE_KEY);
@@ -924,14 +1038,7 @@ struct repair_options {
         list_opt(hosts, options, HOSTS_KEY);
         list_opt(ignore_nodes, options, IGNORE_NODES_KEY);
         list_opt(data_centers, options, DATACENTERS_KEY);
-        // We currently do not support incremental repair. We could probably
-        // ignore this option as it is just an optimization, but for now,
-        // let's make it an error.
-        bool incremental = false;
         bool_opt(incremental, options, INCREMENTAL_KEY);
-        if (incremental) {
-            throw std::runtime_error("unsupported incremental repair");
-        }
         // We do not currently support the distinction between "parallel" and
         // "sequential" repair, and operate the same for both.
         // We don't currently support "dc parallel" parallelism.
@@ -1138,6 +1245,144 @@ static future<> try_wait_for_hints_to_be_replayed(repair_uniq_id id, std::vector
     co_return;
 }
 
+// Returns the ranges each node participating in the repair of the given
+// ranges repairs, including this node.
+static std::unordered_map<gms::inet_address, dht::token_range_vector> get_ranges_per_participant(database& db,
+        const sstring& ksname, const dht::token_range_vector& ranges) {
+    std::unordered_map<gms::inet_address, dht::token_range_vector> ret;
+    for (const auto& range : ranges) {
+        ret[utils::fb_utilities::get_broadcast_address()].push_back(range);
+        for (const auto& nb : get_neighbors(db, ksname, range, {}, {}, {})) {
+            ret[nb].push_back(range);
+        }
+        seastar::thread::maybe_yield();
+    }
+    return ret;
+}
+
+// Tells the participants of an incremental repair to mark the sstables they
+// had when it started as repaired at repaired_at, or to forget them if it is 0.
+// Failures are not fatal, the sstables of the node stay unrepaired.
+static future<> finish_incremental_repair_on_participants(netw::messaging_service& ms, repair_uniq_id id,
+        const std::unordered_map<gms::inet_address, dht::token_range_vector>& ranges_per_participant, uint64_t repaired_at) {
+    return parallel_for_each(ranges_per_participant, [&ms, id, repaired_at] (const auto& x) {
+        auto node = x.first;
+        return ms.send_repair_incremental_finish(netw::msg_addr(node), id.uuid, x.second, repaired_at).handle_exception([id, node] (std::exception_ptr ep) {
+            rlogger.warn("repair id {}: failed to finish incremental repair on node {}: {}", id, node, ep);
+        });
+    });
+}
+
+// Returns the number of sstables marked as repaired
+static future<size_t> mark_sstables_repaired(lw_shared_ptr<table> t, const std::unordered_set<int64_t>& generations,
+        const dht::token_range_vector& ranges, uint64_t repaired_at) {
+    size_t marked = 0;
+    auto sstables = t->get_sstables();
+    for (const auto& sst : *sstables) {
+        if (sst->is_repaired() || !generations.contains(sst->generation())) {
+            continue;
+        }
+        // There is no anticompaction: an sstable is marked only if all of it was repaired.
+        auto first = sst->get_first_decorated_key().token();
+        auto last = sst->get_last_decorated_key().token();
+        bool covered = std::any_of(ranges.begin(), ranges.end(), [&] (const dht::token_range& r) {
+            return r.contains(first, dht::token_comparator()) && r.contains(last, dht::token_comparator());
+        });
+        if (covered) {
+            co_await sst->mutate_repaired_at(repaired_at);
+            marked++;
+        }
+    }
+    co_return marked;
+}
+
+future<> repair_service::prepare_incremental_repair(utils::UUID repair_uuid, gms::inet_address master, std::vector<utils::UUID> table_ids) {
+    std::unordered_map<utils::UUID, std::unordered_set<int64_t>> candidates;
+    for (auto table_id : table_ids) {
+        lw_shared_ptr<table> t;
+        try {
+            t = _db.local().find_column_family(table_id).shared_from_this();
+        } catch (no_such_column_family&) {
+            continue;
+        }
+        // Make the data written before the repair started part of the candidates.
+        co_await t->flush();
+        auto& generations = candidates[table_id];
+        for (const auto& sst : *t->get_sstables()) {
+            if (!sst->is_repaired()) {
+                generations.insert(sst->generation());
+            }
+        }
+    }
+    auto expiry = lowres_clock::now() + incremental_repair_timeout;
+    _incremental_repair_candidates[repair_uuid] = incremental_repair_candidates{master, expiry, std::move(candidates)};
+    if (!_incremental_repair_candidates_timer.armed()) {
+        _incremental_repair_candidates_timer.arm(expiry);
+    }
+}
+
+future<> repair_service::finish_incremental_repair(utils::UUID repair_uuid, dht::token_range_vector ranges, uint64_t repaired_at) {
+    auto it = _incremental_repair_candidates.find(repair_uuid);
+    if (it == _incremental_repair_candidates.end()) {
+        if (repaired_at) {
+            rlogger.warn("repair[{}]: no sstables are marked as repaired on shard {}, the repair timed out or was aborted", repair_uuid, this_shard_id());
+        }
+        co_return;
+    }
+    auto candidates = std::move(it->second.generations);
+    _incremental_repair_candidates.erase(it);
+    if (!repaired_at) {
+        co_return;
+    }
+    ranges = dht::token_range::deoverlap(std::move(ranges), dht::token_comparator());
+    for (const auto& [table_id, generations] : candidates) {
+        lw_shared_ptr<table> t;
+        try {
+            t = _db.local().find_column_family(table_id).shared_from_this();
+        } catch (no_such_column_family&) {
+            continue;
+        }
+        size_t marked = 0;
+        // Compaction would replace the candidates by unrepaired sstables while they are marked.
+        co_await t->run_with_compaction_disabled([&] {
+            return mark_sstables_repaired(t, generations, ranges, repaired_at).then([&marked] (size_t n) {
+                marked = n;
+            });
+        });
+        rlogger.info("repair[{}]: marked {} out of {} sstables of {}.{} on shard {} as repaired", repair_uuid, marked, generations.size(),
+                t->schema()->ks_name(), t->schema()->cf_name(), this_shard_id());
+    }
+}
+
+void repair_service::expire_incremental_repair_candidates() {
+    auto now = lowres_clock::now();
+    std::optional<lowres_clock::time_point> next_expiry;
+    for (auto it = _incremental_repair_candidates.begin(); it != _incremental_repair_candidates.end();) {
+        if (it->second.expiry <= now) {
+            rlogger.warn("repair[{}]: incremental repair started by {} did not finish in {} hours, dropping its sstables on shard {}",
+                    it->first, it->second.master, incremental_repair_timeout.count(), this_shard_id());
+            it = _incremental_repair_candidates.erase(it);
+        } else {
+            next_expiry = std::min(next_expiry.value_or(it->second.expiry), it->second.expiry);
+            ++it;
+        }
+    }
+    if (next_expiry) {
+        _incremental_repair_candidates_timer.arm(*next_expiry);
+    }
+}
+
+void repair_service::drop_incremental_repair_candidates(gms::inet_address master) {
+    for (auto it = _incremental_repair_candidates.begin(); it != _incremental_repair_candidates.end();) {
+        if (it->second.master == master) {
+            rlogger.warn("repair[{}]: incremental repair master {} is down, dropping its sstables on shard {}", it->first, master, this_shard_id());
+            it = _incremental_repair_candidates.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 // repair_start() can run on any cpu; It runs on cpu0 the function
 // do_repair_start(). The benefit of always running that function on the same
 // CPU is that it allows us to keep some state (like a list of ongoing
@@ -1190,6 +1435,14 @@ int repair_service::do_repair_start(sstring keyspace, std::unordered_map<sstring
     if (!options.ignore_nodes.empty() && !options.hosts.empty()) {
         throw std::runtime_error("Cannot combine ignore_nodes and hosts options.");
     }
+
+    // Sstables can only be marked as repaired if all of their replicas were repaired.
+    if (options.incremental && (!options.data_centers.empty() || !options.hosts.empty() || !options.ignore_nodes.empty())) {
+        throw std::runtime_error("Cannot combine incremental repair with data centers, hosts or ignore_nodes options.");
+    }
+    if (options.incremental && !db.local().features().cluster_supports_incremental_repair()) {
+        throw std::runtime_error("Incremental repair is not supported by all nodes in the cluster yet.");
+    }
     std::unordered_set<gms::inet_address> ignore_nodes;
     for (const auto& n: options.ignore_nodes) {
         try {
@@ -1251,6 +1504,23 @@ int repair_service::do_repair_start(sstring keyspace, std::unordered_map<sstring
         std::vector<future<>> repair_results;
         repair_results.reserve(smp::count);
         auto table_ids = get_table_ids(db.local(), keyspace, cfs);
+
+        std::unordered_map<gms::inet_address, dht::token_range_vector> incremental_ranges;
+        uint64_t repaired_at = 0;
+        if (options.incremental) {
+            repaired_at = std::chrono::duration_cast<std::chrono::milliseconds>(db_clock::now().time_since_epoch()).count();
+            incremental_ranges = get_ranges_per_participant(db.local(), keyspace, ranges);
+            try {
+                parallel_for_each(incremental_ranges | boost::adaptors::map_keys, [this, id, &table_ids] (gms::inet_address node) {
+                    return _messaging.send_repair_incremental_prepare(netw::msg_addr(node), id.uuid, table_ids);
+                }).get();
+            } catch (...) {
+                finish_incremental_repair_on_participants(_messaging, id, incremental_ranges, 0).get();
+                throw;
+            }
+            rlogger.info("repair id {}: incremental repair, reading unrepaired sstables only", id);
+        }
+
         abort_source as;
         auto uuid = id.uuid;
         auto off_strategy_updater = seastar::async([this, uuid, &table_ids, &participants, &as] {
@@ -1284,29 +1554,40 @@ int repair_service::do_repair_start(sstring keyspace, std::unordered_map<sstring
 
         for (auto shard : boost::irange(unsigned(0), smp::count)) {
             auto f = container().invoke_on(shard, [keyspace, table_ids, id, ranges,
-                    data_centers = options.data_centers, hosts = options.hosts, ignore_nodes] (repair_service& local_repair) mutable {
+                    data_centers = options.data_centers, hosts = options.hosts, ignore_nodes, incremental = options.incremental] (repair_service& local_repair) mutable {
                 _node_ops_metrics.repair_total_ranges_sum += ranges.size();
                 auto ri = make_lw_shared<repair_info>(local_repair,
                         std::move(keyspace), std::move(ranges), std::move(table_ids),
                         id, std::move(data_centers), std::move(hosts), std::move(ignore_nodes), streaming::stream_reason::repair, id.uuid);
+                ri->incremental = incremental;
                 return repair_ranges(ri);
             });
             repair_results.push_back(std::move(f));
         }
-        when_all(repair_results.begin(), repair_results.end()).then([id] (std::vector<future<>> results) mutable {
-            std::vector<sstring> errors;
-            for (unsigned shard = 0; shard < results.size(); shard++) {
-                auto& f = results[shard];
-                if (f.failed()) {
-                    auto ep = f.get_exception();
-                    errors.push_back(format("shard {}: {}", shard, ep));
+        try {
+            when_all(repair_results.begin(), repair_results.end()).then([id] (std::vector<future<>> results) mutable {
+                std::vector<sstring> errors;
+                for (unsigned shard = 0; shard < results.size(); shard++) {
+                    auto& f = results[shard];
+                    if (f.failed()) {
+                        auto ep = f.get_exception();
+                        errors.push_back(format("shard {}: {}", shard, ep));
+                    }
                 }
+                if (!errors.empty()) {
+                    return make_exception_future<>(std::runtime_error(format("{}", errors)));
+                }
+                return make_ready_future<>();
+            }).get();
+        } catch (...) {
+            if (options.incremental) {
+                finish_incremental_repair_on_participants(_messaging, id, incremental_ranges, 0).get();
             }
-            if (!errors.empty()) {
-                return make_exception_future<>(std::runtime_error(format("{}", errors)));
-            }
-            return make_ready_future<>();
-        }).get();
+            throw;
+        }
+        if (options.incremental) {
+            finish_incremental_repair_on_participants(_messaging, id, incremental_ranges, repaired_at).get();
+        }
     }).handle_exception([id] (std::exception_ptr ep) {
         rlogger.warn("repair_tracker run for repair id {} failed: {}", id, ep);
     });
@@ -1923,6 +2204,17 @@ future<> repair_service::init_metrics() {
 future<> repair_service::init_ms_handlers() {
     auto& ms = this->_messaging;
 
+    ms.register_repair_incremental_prepare([this] (const rpc::client_info& cinfo, utils::UUID repair_uuid, std::vector<utils::UUID> table_ids) {
+        auto master = cinfo.retrieve_auxiliary<gms::inet_address>("baddr");
+        return container().invoke_on_all([repair_uuid, master, table_ids] (repair_service& local_repair) {
+            return local_repair.prepare_incremental_repair(repair_uuid, master, table_ids);
+        });
+    });
+    ms.register_repair_incremental_finish([this] (const rpc::client_info& cinfo, utils::UUID repair_uuid, dht::token_range_vector ranges, uint64_t repaired_at) {
+        return container().invoke_on_all([repair_uuid, ranges, repaired_at] (repair_service& local_repair) {
+            return local_repair.finish_incremental_repair(repair_uuid, ranges, repaired_at);
+        });
+    });
 
     ms.register_node_ops_cmd([] (const rpc::client_info& cinfo, node_ops_cmd_request req) {
         auto src_cpu_id = cinfo.retrieve_auxiliary<uint32_t>("src_cpu_id");
@@ -1938,5 +2230,8 @@ future<> repair_service::init_ms_handlers() {
 future<> repair_service::uninit_ms_handlers() {
     auto& ms = this->_messaging;
 
-    return when_all_succeed(ms.unregister_node_ops_cmd()).discard_result();
+    return when_all_succeed(
+        ms.unregister_repair_incremental_prepare(),
+        ms.unregister_repair_incremental_finish(),
+        ms.unregister_node_ops_cmd()).discard_result();
 }
@@ -32,6 +32,7 @@
 #include <seastar/core/future.hh>
 #include <seastar/core/condition-variable.hh>
 #include <seastar/core/gate.hh>
+#include <seastar/util/noncopyable_function.hh>
 
 #include "database_fwd.hh"
 #include "frozen_mutation.hh"
@@ -133,6 +134,8 @@ class repair_stats {
     uint64_t round_nr_fast_path_already_synced = 0;
     uint64_t round_nr_fast_path_same_combined_hashes= 0;
     uint64_t round_nr_slow_path = 0;
+    // Rounds in which the row hashes of a peer were decoded from an IBLT
+    uint64_t round_nr_iblt = 0;
 
     uint64_t rpc_call_nr = 0;
 
@@ -191,6 +194,8 @@ class repair_info {
     std::unordered_set<gms::inet_address> ignore_nodes;
     streaming::stream_reason reason;
     std::unordered_map<dht::token_range, repair_neighbors> neighbors;
+    // Incremental repair reads only sstables not marked as repaired yet.
+    bool incremental = false;
     uint64_t nr_ranges_finished = 0;
     uint64_t nr_ranges_total;
     size_t nr_failed_ranges = 0;
@@ -365,6 +370,66 @@ class repair_hash {
 
 using repair_hash_set = absl::btree_set<repair_hash>;
 
+struct repair_hash_iblt_cell {
+    int32_t count = 0;
+    uint64_t hash_sum = 0;
+    uint64_t check_sum = 0;
+};
+
+// Invertible Bloom lookup table of repair row hashes.
+//
+// Every hash is added to hash_count cells, one in each of hash_count equal
+// parts of the table. Subtracting the table of one node from a table of the
+// same size built by another node leaves only the hashes which are present on
+// one of the nodes. They can be listed as long as there are not many more of
+// them than half of the cells, so the size of the table has to be proportional
+// to the size of the difference, not to the number of rows.
+class repair_hash_iblt {
+    std::vector<repair_hash_iblt_cell> _cells;
+public:
+    static constexpr size_t hash_count = 4;
+
+    repair_hash_iblt() = default;
+    // Rounds cell_count up to a multiple of hash_count.
+    explicit repair_hash_iblt(size_t cell_count);
+    explicit repair_hash_iblt(std::vector<repair_hash_iblt_cell> cells);
+
+    const std::vector<repair_hash_iblt_cell>& get_cells() const {
+        return _cells;
+    }
+    size_t size() const {
+        return _cells.size();
+    }
+
+    void add(const repair_hash& h);
+    void remove(const repair_hash& h);
+
+    // Lists the hashes left in the table, which is emptied in the process.
+    // Hashes added more times than removed go to `added`, the others to
+    // `removed`. Returns false if the table could not be fully decoded,
+    // in which case both sets are incomplete.
+    bool decode(repair_hash_set& added, repair_hash_set& removed);
+};
+
+// The row hashes present on only one of two nodes.
+struct repair_hash_set_difference {
+    repair_hash_set only_on_peer;
+    repair_hash_set only_on_local;
+    // Number of cells of the IBLT the difference was decoded from
+    size_t cell_count = 0;
+};
+
+// Finds the difference between the local row hashes and those of a peer,
+// using IBLTs of the peer's hashes obtained with get_peer_iblt(cell_count).
+// The first table has min_cell_count cells, and the size is doubled as long
+// as the difference can't be decoded, so the tables stay small when the
+// nodes are nearly in sync, whatever the number of rows. Returns a
+// disengaged optional if a table of max_cell_count cells can't be decoded
+// either.
+future<std::optional<repair_hash_set_difference>> find_repair_hash_set_difference(const repair_hash_set& local_hashes,
+        size_t min_cell_count, size_t max_cell_count,
+        noncopyable_function<future<repair_hash_iblt> (size_t cell_count)> get_peer_iblt);
+
 enum class repair_row_level_start_status: uint8_t {
     ok,
     no_such_column_family,
@@ -443,6 +508,7 @@ struct repair_row_on_wire_with_cmd {
 enum class row_level_diff_detect_algorithm : uint8_t {
     send_full_set,
     send_full_set_rpc_stream,
+    send_iblt_rpc_stream,
 };
 
 std::ostream& operator<<(std::ostream& out, row_level_diff_detect_algorithm algo);
@@ -46,6 +46,7 @@
 #include "gms/i_endpoint_state_change_subscriber.hh"
 #include "gms/gossiper.hh"
 #include "repair/row_level.hh"
+#include "repair/reader.hh"
 #include "mutation_source_metadata.hh"
 #include "utils/stall_free.hh"
 #include "service/migration_manager.hh"
@@ -82,6 +83,8 @@ enum class repair_state : uint16_t {
     get_full_row_hashes_with_rpc_stream_finished,
     get_full_row_hashes_started,
     get_full_row_hashes_finished,
+    get_row_hashes_iblt_started,
+    get_row_hashes_iblt_finished,
     get_row_diff_started,
     get_row_diff_finished,
     put_row_diff_with_rpc_stream_started,
@@ -177,6 +180,8 @@ struct row_level_repair_metrics {
     uint64_t row_from_disk_bytes{0};
     uint64_t tx_hashes_nr{0};
     uint64_t rx_hashes_nr{0};
+    uint64_t tx_iblt_cells_nr{0};
+    uint64_t rx_iblt_cells_nr{0};
     row_level_repair_metrics() {
         namespace sm = seastar::metrics;
         _metrics.add_group("repair", {
@@ -192,6 +197,10 @@ struct row_level_repair_metrics {
                             sm::description("Total number of row hashes sent on this shard.")),
             sm::make_derive("rx_hashes_nr", rx_hashes_nr,
                             sm::description("Total number of row hashes received on this shard.")),
+            sm::make_derive("tx_iblt_cells_nr", tx_iblt_cells_nr,
+                            sm::description("Total number of cells of row hash IBLTs sent on this shard.")),
+            sm::make_derive("rx_iblt_cells_nr", rx_iblt_cells_nr,
+                            sm::description("Total number of cells of row hash IBLTs received on this shard.")),
             sm::make_derive("row_from_disk_nr", row_from_disk_nr,
                             sm::description("Total number of rows read from disk on this shard.")),
             sm::make_derive("row_from_disk_bytes", row_from_disk_bytes,
@@ -206,6 +215,7 @@ static const std::vector<row_level_diff_detect_algorithm>& suportted_diff_detect
     static std::vector<row_level_diff_detect_algorithm> _algorithms = {
         row_level_diff_detect_algorithm::send_full_set,
         row_level_diff_detect_algorithm::send_full_set_rpc_stream,
+        row_level_diff_detect_algorithm::send_iblt_rpc_stream,
     };
     return _algorithms;
 };
@@ -249,17 +259,12 @@ static uint64_t get_random_seed() {
     return random_dist(random_engine);
 }
 
-class decorated_key_with_hash {
-public:
-    dht::decorated_key dk;
-    repair_hash hash;
-    decorated_key_with_hash(const schema& s, dht::decorated_key key, uint64_t seed)
-        : dk(key) {
-        xx_hasher h(seed);
-        feed_hash(h, dk.key(), s);
-        hash = repair_hash(h.finalize_uint64());
-    }
-};
+decorated_key_with_hash::decorated_key_with_hash(const schema& s, dht::decorated_key key, uint64_t seed)
+    : dk(key) {
+    xx_hasher h(seed);
+    feed_hash(h, dk.key(), s);
+    hash = repair_hash(h.finalize_uint64());
+}
 
 class fragment_hasher {
     const schema& _schema;
@@ -414,126 +419,149 @@ class repair_row {
     }
 };
 
-class repair_reader {
-public:
-using is_local_reader = bool_class<class is_local_reader_tag>;
+repair_reader::repair_reader(
+        seastar::sharded<database>& db,
+        column_family& cf,
+        schema_ptr s,
+        reader_permit permit,
+        dht::token_range range,
+        const dht::sharder& remote_sharder,
+        unsigned remote_shard,
+        uint64_t seed,
+        is_local_reader local_reader,
+        unrepaired_only only_unrepaired)
+        : _schema(s)
+        , _permit(std::move(permit))
+        , _range(dht::to_partition_range(range))
+        , _sharder(remote_sharder, range, remote_shard)
+        , _seed(seed)
+        , _local_read_op(local_reader ? std::optional(cf.read_in_progress()) : std::nullopt)
+        , _reader(nullptr)
+        , _ready(_permit) {
+    if (local_reader) {
+        auto ms = mutation_source([&cf, only_unrepaired] (
+                    schema_ptr s,
+                    reader_permit permit,
+                    const dht::partition_range& pr,
+                    const query::partition_slice& ps,
+                    const io_priority_class& pc,
+                    tracing::trace_state_ptr,
+                    streamed_mutation::forwarding,
+                    mutation_reader::forwarding fwd_mr) {
+            return cf.make_streaming_reader(std::move(s), std::move(permit), pr, ps, fwd_mr, only_unrepaired);
+        });
+        std::tie(_reader, _reader_handle) = make_manually_paused_evictable_reader(
+                std::move(ms),
+                _schema,
+                _permit,
+                _range,
+                _schema->full_slice(),
+                service::get_local_streaming_priority(),
+                {},
+                mutation_reader::forwarding::no);
+    } else {
+        _reader = make_multishard_streaming_reader(db, _schema, _permit, [this] {
+            auto shard_range = _sharder.next();
+            if (shard_range) {
+                return std::optional<dht::partition_range>(dht::to_partition_range(*shard_range));
+            }
+            return std::optional<dht::partition_range>();
+        }, only_unrepaired);
+    }
+    _reader.set_max_buffer_size(buffer_size);
+}
 
-private:
-    schema_ptr _schema;
-    reader_permit _permit;
-    dht::partition_range _range;
-    // Used to find the range that repair master will work on
-    dht::selective_token_range_sharder _sharder;
-    // Seed for the repair row hashing
-    uint64_t _seed;
-    // Pin the table while the reader is alive.
-    // Only needed for local readers, the multishard reader takes care
-    // of pinning tables on used shards.
-    std::optional<utils::phased_barrier::operation> _local_read_op;
-    // Local reader or multishard reader to read the range
-    flat_mutation_reader _reader;
-    std::optional<evictable_reader_handle> _reader_handle;
-    // Current partition read from disk
-    lw_shared_ptr<const decorated_key_with_hash> _current_dk;
-    uint64_t _reads_issued = 0;
-    uint64_t _reads_finished = 0;
+future<> repair_reader::wait_for_read_ahead() {
+    if (!_read_ahead) {
+        return make_ready_future<>();
+    }
+    auto f = std::move(*_read_ahead);
+    _read_ahead.reset();
+    return f;
+}
 
-public:
-    repair_reader(
-            seastar::sharded<database>& db,
-            column_family& cf,
-            schema_ptr s,
-            reader_permit permit,
-            dht::token_range range,
-            const dht::sharder& remote_sharder,
-            unsigned remote_shard,
-            uint64_t seed,
-            is_local_reader local_reader)
-            : _schema(s)
-            , _permit(std::move(permit))
-            , _range(dht::to_partition_range(range))
-            , _sharder(remote_sharder, range, remote_shard)
-            , _seed(seed)
-            , _local_read_op(local_reader ? std::optional(cf.read_in_progress()) : std::nullopt)
-            , _reader(nullptr) {
-        if (local_reader) {
-            auto ms = mutation_source([&cf] (
-                        schema_ptr s,
-                        reader_permit permit,
-                        const dht::partition_range& pr,
-                        const query::partition_slice& ps,
-                        const io_priority_class& pc,
-                        tracing::trace_state_ptr,
-                        streamed_mutation::forwarding,
-                        mutation_reader::forwarding fwd_mr) {
-                return cf.make_streaming_reader(std::move(s), std::move(permit), pr, ps, fwd_mr);
-            });
-            std::tie(_reader, _reader_handle) = make_manually_paused_evictable_reader(
-                    std::move(ms),
-                    _schema,
-                    _permit,
-                    _range,
-                    _schema->full_slice(),
-                    service::get_local_streaming_priority(),
-                    {},
-                    mutation_reader::forwarding::no);
-        } else {
-            _reader = make_multishard_streaming_reader(db, _schema, _permit, [this] {
-                auto shard_range = _sharder.next();
-                if (shard_range) {
-                    return std::optional<dht::partition_range>(dht::to_partition_range(*shard_range));
-                }
-                return std::optional<dht::partition_range>();
+future<> repair_reader::wait_for_read_ahead_noexcept() noexcept {
+    return wait_for_read_ahead().handle_exception([] (std::exception_ptr ep) {
+        rlogger.debug("repair_reader: read ahead failed: {}", ep);
+    });
+}
+
+future<> repair_reader::refill() {
+    return wait_for_read_ahead().then([this] {
+        if (_reader.is_buffer_empty()) {
+            if (_reader.is_end_of_stream()) {
+                return make_ready_future<>();
+            }
+            return _reader.fill_buffer(db::no_timeout).then([this] {
+                return refill();
             });
         }
-    }
-
-    future<mutation_fragment_opt>
-    read_mutation_fragment() {
-        ++_reads_issued;
-        return _reader(db::no_timeout).then([this] (mutation_fragment_opt mfopt) {
-            ++_reads_finished;
-            return mfopt;
-        });
-    }
+        _ready = _reader.detach_buffer();
+        if (!_reader.is_end_of_stream()) {
+            _read_ahead = _reader.fill_buffer(db::no_timeout);
+        }
+        return make_ready_future<>();
+    });
+}
 
-    future<> on_end_of_stream() noexcept {
-      return _reader.close().then([this] {
-        _reader = make_empty_flat_reader(_schema, _permit);
-        _reader_handle.reset();
-      });
+mutation_fragment_opt repair_reader::pop_ready() {
+    if (_ready.empty()) {
+        return {};
     }
+    auto mf = std::move(_ready.front());
+    _ready.pop_front();
+    return mf;
+}
 
-    future<> close() noexcept {
-      return _reader.close().then([this] {
-        _reader_handle.reset();
-      });
+future<mutation_fragment_opt>
+repair_reader::read_mutation_fragment() {
+    ++_reads_issued;
+    if (!_ready.empty()) {
+        ++_reads_finished;
+        return make_ready_future<mutation_fragment_opt>(pop_ready());
     }
+    return refill().then([this] {
+        ++_reads_finished;
+        return pop_ready();
+    });
+}
 
-    lw_shared_ptr<const decorated_key_with_hash>& get_current_dk() {
-        return _current_dk;
-    }
+future<> repair_reader::on_end_of_stream() noexcept {
+  return wait_for_read_ahead_noexcept().then([this] {
+    _ready.clear();
+    return _reader.close();
+  }).then([this] {
+    _reader = make_empty_flat_reader(_schema, _permit);
+    _reader_handle.reset();
+  });
+}
 
-    void set_current_dk(const dht::decorated_key& key) {
-        _current_dk = make_lw_shared<const decorated_key_with_hash>(*_schema, key, _seed);
-    }
+future<> repair_reader::close() noexcept {
+  return wait_for_read_ahead_noexcept().then([this] {
+    _ready.clear();
+    return _reader.close();
+  }).then([this] {
+    _reader_handle.reset();
+  });
+}
 
-    void clear_current_dk() {
-        _current_dk = {};
-    }
+void repair_reader::set_current_dk(const dht::decorated_key& key) {
+    _current_dk = make_lw_shared<const decorated_key_with_hash>(*_schema, key, _seed);
+}
 
-    void check_current_dk() {
-        if (!_current_dk) {
-            throw std::runtime_error("Current partition_key is unknown");
-        }
+void repair_reader::check_current_dk() {
+    if (!_current_dk) {
+        throw std::runtime_error("Current partition_key is unknown");
     }
+}
 
-    void pause() {
+future<> repair_reader::pause() {
+    return wait_for_read_ahead().then([this] {
         if (_reader_handle) {
             _reader_handle->pause();
         }
-    }
-};
+    });
+}
 
 class repair_writer : public enable_lw_shared_from_this<repair_writer> {
     schema_ptr _schema;
@@ -710,6 +738,8 @@ class repair_meta {
     gms::inet_address _myip;
     uint32_t _repair_meta_id;
     streaming::stream_reason _reason;
+    // Set for incremental repair, which reads only unrepaired sstables
+    unrepaired_only _only_unrepaired;
     // Repair master's sharding configuration
     shard_config _master_node_shard_config;
     // sharding info of repair master
@@ -780,6 +810,9 @@ class repair_meta {
     bool use_rpc_stream() const {
         return is_rpc_stream_supported(_algo);
     }
+    bool use_iblt() const {
+        return _algo == row_level_diff_detect_algorithm::send_iblt_rpc_stream;
+    }
 
 public:
     repair_meta(
@@ -797,6 +830,7 @@ class repair_meta {
             repair_master master,
             uint32_t repair_meta_id,
             streaming::stream_reason reason,
+            unrepaired_only only_unrepaired,
             shard_config master_node_shard_config,
             std::vector<gms::inet_address> all_live_peer_nodes,
             size_t nr_peer_nodes = 1,
@@ -817,6 +851,7 @@ class repair_meta {
             , _myip(utils::fb_utilities::get_broadcast_address())
             , _repair_meta_id(repair_meta_id)
             , _reason(reason)
+            , _only_unrepaired(only_unrepaired)
             , _master_node_shard_config(std::move(master_node_shard_config))
             , _remote_sharder(make_remote_sharder())
             , _same_sharding_config(is_same_sharding_config())
@@ -830,7 +865,8 @@ class repair_meta {
                     _remote_sharder,
                     _master_node_shard_config.shard,
                     _seed,
-                    repair_reader::is_local_reader(_repair_master || _same_sharding_config)
+                    repair_reader::is_local_reader(_repair_master || _same_sharding_config),
+                    _only_unrepaired
               )
             , _repair_writer(make_lw_shared<repair_writer>(_schema, _permit, _estimated_partitions, _reason))
             , _sink_source_for_get_full_row_hashes(_repair_meta_id, _nr_peer_nodes,
@@ -920,7 +956,8 @@ class repair_meta {
             uint64_t seed,
             shard_config master_node_shard_config,
             table_schema_version schema_version,
-            streaming::stream_reason reason) {
+            streaming::stream_reason reason,
+            unrepaired_only only_unrepaired) {
         return repair.get_migration_manager().get_schema_for_write(schema_version, {from, src_cpu_id}, repair.get_messaging()).then([&repair,
                 from,
                 repair_meta_id,
@@ -930,7 +967,8 @@ class repair_meta {
                 seed,
                 master_node_shard_config,
                 schema_version,
-                reason] (schema_ptr s) {
+                reason,
+                only_unrepaired] (schema_ptr s) {
             auto& db = repair.get_db();
             auto& cf = db.local().find_column_family(s->id());
           return db.local().obtain_reader_permit(cf, "repair-meta", db::no_timeout).then([s = std::move(s),
@@ -945,7 +983,8 @@ class repair_meta {
                     seed,
                     master_node_shard_config,
                     schema_version,
-                    reason] (reader_permit permit) mutable {
+                    reason,
+                    only_unrepaired] (reader_permit permit) mutable {
             node_repair_meta_id id{from, repair_meta_id};
             auto rm = make_lw_shared<repair_meta>(db,
                     repair.get_messaging().container(),
@@ -961,6 +1000,7 @@ class repair_meta {
                     repair_meta::repair_master::no,
                     repair_meta_id,
                     reason,
+                    only_unrepaired,
                     std::move(master_node_shard_config),
                     std::vector<gms::inet_address>{from});
             rm->set_repair_state_for_local_node(repair_state::row_level_start_started);
@@ -1247,8 +1287,9 @@ class repair_meta {
                         return _repair_reader.on_end_of_stream();
                     });
                 }
-                _repair_reader.pause();
-                return make_ready_future<value_type>(value_type(std::move(cur_rows), new_rows_size));
+                return _repair_reader.pause().then([&cur_rows, &new_rows_size] () mutable {
+                    return value_type(std::move(cur_rows), new_rows_size);
+                });
             });
         });
     }
@@ -1668,6 +1709,79 @@ class repair_meta {
         });
     }
 
+    // RPC API
+    // Return an IBLT with cell_count cells of the hashes of the rows in _working_row_buf
+    future<repair_hash_iblt>
+    get_row_hashes_iblt(gms::inet_address remote_node, uint64_t cell_count) {
+        if (remote_node == _myip) {
+            return get_row_hashes_iblt_handler(cell_count);
+        }
+        return _messaging.local().send_repair_get_row_hashes_iblt(msg_addr(remote_node),
+                _repair_meta_id, cell_count).then([this, remote_node] (repair_hash_iblt iblt) {
+            rlogger.debug("Got row hashes IBLT from peer={}, nr_cells={}", remote_node, iblt.size());
+            _metrics.rx_iblt_cells_nr += iblt.size();
+            stats().rpc_call_nr++;
+            return iblt;
+        });
+    }
+
+    // RPC handler
+    future<repair_hash_iblt>
+    get_row_hashes_iblt_handler(uint64_t cell_count) {
+        return with_gate(_gate, [this, cell_count] {
+            return do_with(repair_hash_iblt(cell_count), [this] (repair_hash_iblt& iblt) {
+                return do_for_each(_working_row_buf, [&iblt] (repair_row& r) {
+                    iblt.add(r.hash());
+                }).then([&iblt] {
+                    return std::move(iblt);
+                });
+            });
+        });
+    }
+
+    // An IBLT is only used when the working row buf has at least
+    // min_rows_for_iblt rows. The first table has min_iblt_cells cells, which
+    // is doubled until the difference can be decoded, that is until there are
+    // about twice as many cells as differing rows. The table gets at most a
+    // cell for every iblt_rows_per_cell rows. Beyond that the full row hashes
+    // are requested, so the failed attempts cost less than the full hashes'
+    // traffic.
+    static constexpr size_t min_rows_for_iblt = 512;
+    static constexpr size_t min_iblt_cells = 64;
+    static constexpr size_t iblt_rows_per_cell = 8;
+
+    // Find the row hashes of the peer from IBLTs of its working row buf,
+    // with the local row hashes removed, which leaves only the difference.
+    // Returns false, without touching peer_row_hash_sets(node_idx), when
+    // the difference is too big to be decoded.
+    future<bool>
+    get_peer_row_hashes_with_iblt(gms::inet_address remote_node, unsigned node_idx) {
+        return working_row_hashes().then([this, remote_node, node_idx] (repair_hash_set hashes) {
+            if (hashes.size() < min_rows_for_iblt) {
+                return make_ready_future<bool>(false);
+            }
+            const size_t max_cell_count = hashes.size() / iblt_rows_per_cell;
+            return do_with(std::move(hashes), [this, remote_node, node_idx, max_cell_count] (repair_hash_set& hashes) {
+                return find_repair_hash_set_difference(hashes, min_iblt_cells, max_cell_count, [this, remote_node] (size_t cell_count) {
+                    return get_row_hashes_iblt(remote_node, cell_count);
+                }).then([this, remote_node, node_idx, &hashes] (std::optional<repair_hash_set_difference> diff) {
+                    if (!diff) {
+                        rlogger.debug("Failed to decode row hashes IBLT from peer={}, local nr_hashes={}", remote_node, hashes.size());
+                        return false;
+                    }
+                    rlogger.debug("Decoded row hashes IBLT from peer={}, nr_cells={}, only_on_peer={}, only_on_local={}",
+                            remote_node, diff->cell_count, diff->only_on_peer.size(), diff->only_on_local.size());
+                    for (const auto& h : diff->only_on_local) {
+                        hashes.erase(h);
+                    }
+                    hashes.insert(diff->only_on_peer.begin(), diff->only_on_peer.end());
+                    peer_row_hash_sets(node_idx) = std::move(hashes);
+                    return true;
+                });
+            });
+        });
+    }
+
     // RPC API
     // Return the combined hashes of the current working row buf
     future<get_combined_row_hash_response>
@@ -1712,7 +1826,7 @@ class repair_meta {
         return _messaging.local().send_repair_row_level_start(msg_addr(remote_node),
                 _repair_meta_id, ks_name, cf_name, std::move(range), _algo, _max_row_buf_size, _seed,
                 _master_node_shard_config.shard, _master_node_shard_config.shard_count, _master_node_shard_config.ignore_msb,
-                remote_partitioner_name, std::move(schema_version), reason).then([ks_name, cf_name] (rpc::optional<repair_row_level_start_response> resp) {
+                remote_partitioner_name, std::move(schema_version), reason, bool(_only_unrepaired)).then([ks_name, cf_name] (rpc::optional<repair_row_level_start_response> resp) {
             if (resp && resp->status == repair_row_level_start_status::no_such_column_family) {
                 return make_exception_future<>(no_such_column_family(ks_name, cf_name));
             } else {
@@ -1725,10 +1839,12 @@ class repair_meta {
     static future<repair_row_level_start_response>
     repair_row_level_start_handler(repair_service& repair, gms::inet_address from, uint32_t src_cpu_id, uint32_t repair_meta_id, sstring ks_name, sstring cf_name,
             dht::token_range range, row_level_diff_detect_algorithm algo, uint64_t max_row_buf_size,
-            uint64_t seed, shard_config master_node_shard_config, table_schema_version schema_version, streaming::stream_reason reason) {
-        rlogger.debug(">>> Started Row Level Repair (Follower): local={}, peers={}, repair_meta_id={}, keyspace={}, cf={}, schema_version={}, range={}, seed={}, max_row_buf_siz={}",
-            utils::fb_utilities::get_broadcast_address(), from, repair_meta_id, ks_name, cf_name, schema_version, range, seed, max_row_buf_size);
-        return insert_repair_meta(repair, from, src_cpu_id, repair_meta_id, std::move(range), algo, max_row_buf_size, seed, std::move(master_node_shard_config), std::move(schema_version), reason).then([] {
+            uint64_t seed, shard_config master_node_shard_config, table_schema_version schema_version, streaming::stream_reason reason,
+            unrepaired_only only_unrepaired) {
+        rlogger.debug(">>> Started Row Level Repair (Follower): local={}, peers={}, repair_meta_id={}, keyspace={}, cf={}, schema_version={}, range={}, seed={}, max_row_buf_siz={}, only_unrepaired={}",
+            utils::fb_utilities::get_broadcast_address(), from, repair_meta_id, ks_name, cf_name, schema_version, range, seed, max_row_buf_size, only_unrepaired);
+        return insert_repair_meta(repair, from, src_cpu_id, repair_meta_id, std::move(range), algo, max_row_buf_size, seed, std::move(master_node_shard_config), std::move(schema_version), reason,
+                only_unrepaired).then([] {
             return repair_row_level_start_response{repair_row_level_start_status::ok};
         }).handle_exception_type([] (no_such_column_family&) {
             return repair_row_level_start_response{repair_row_level_start_status::no_such_column_family};
@@ -2371,6 +2487,19 @@ future<> repair_service::init_row_level_ms_handlers() {
             });
         }) ;
     });
+    ms.register_repair_get_row_hashes_iblt([] (const rpc::client_info& cinfo, uint32_t repair_meta_id, uint64_t cell_count) {
+        auto src_cpu_id = cinfo.retrieve_auxiliary<uint32_t>("src_cpu_id");
+        auto from = cinfo.retrieve_auxiliary<gms::inet_address>("baddr");
+        return smp::submit_to(src_cpu_id % smp::count, [from, repair_meta_id, cell_count] {
+            auto rm = repair_meta::get_repair_meta(from, repair_meta_id);
+            rm->set_repair_state_for_local_node(repair_state::get_row_hashes_iblt_started);
+            return rm->get_row_hashes_iblt_handler(cell_count).then([rm] (repair_hash_iblt iblt) {
+                rm->set_repair_state_for_local_node(repair_state::get_row_hashes_iblt_finished);
+                _metrics.tx_iblt_cells_nr += iblt.size();
+                return iblt;
+            });
+        });
+    });
     ms.register_repair_get_combined_row_hash([] (const rpc::client_info& cinfo, uint32_t repair_meta_id,
             std::optional<repair_sync_boundary> common_sync_boundary) {
         auto src_cpu_id = cinfo.retrieve_auxiliary<uint32_t>("src_cpu_id");
@@ -2443,11 +2572,12 @@ future<> repair_service::init_row_level_ms_handlers() {
     });
     ms.register_repair_row_level_start([this] (const rpc::client_info& cinfo, uint32_t repair_meta_id, sstring ks_name,
             sstring cf_name, dht::token_range range, row_level_diff_detect_algorithm algo, uint64_t max_row_buf_size, uint64_t seed,
-            unsigned remote_shard, unsigned remote_shard_count, unsigned remote_ignore_msb, sstring remote_partitioner_name, table_schema_version schema_version, rpc::optional<streaming::stream_reason> reason) {
+            unsigned remote_shard, unsigned remote_shard_count, unsigned remote_ignore_msb, sstring remote_partitioner_name, table_schema_version schema_version, rpc::optional<streaming::stream_reason> reason,
+            rpc::optional<bool> incremental) {
         auto src_cpu_id = cinfo.retrieve_auxiliary<uint32_t>("src_cpu_id");
         auto from = cinfo.retrieve_auxiliary<gms::inet_address>("baddr");
         return container().invoke_on(src_cpu_id % smp::count, [from, src_cpu_id, repair_meta_id, ks_name, cf_name,
-                range, algo, max_row_buf_size, seed, remote_shard, remote_shard_count, remote_ignore_msb, schema_version, reason] (repair_service& local_repair) mutable {
+                range, algo, max_row_buf_size, seed, remote_shard, remote_shard_count, remote_ignore_msb, schema_version, reason, incremental] (repair_service& local_repair) mutable {
             if (!local_repair._sys_dist_ks.local_is_initialized() || !local_repair._view_update_generator.local_is_initialized()) {
                 return make_exception_future<repair_row_level_start_response>(std::runtime_error(format("Node {} is not fully initialized for repair, try again later",
                         utils::fb_utilities::get_broadcast_address())));
@@ -2456,7 +2586,7 @@ future<> repair_service::init_row_level_ms_handlers() {
             return repair_meta::repair_row_level_start_handler(local_repair, from, src_cpu_id, repair_meta_id, std::move(ks_name),
                     std::move(cf_name), std::move(range), algo, max_row_buf_size, seed,
                     shard_config{remote_shard, remote_shard_count, remote_ignore_msb},
-                    schema_version, r);
+                    schema_version, r, unrepaired_only(incremental && *incremental));
         });
     });
     ms.register_repair_row_level_stop([] (const rpc::client_info& cinfo, uint32_t repair_meta_id,
@@ -2498,6 +2628,7 @@ future<> repair_service::uninit_row_level_ms_handlers() {
         ms.unregister_repair_put_row_diff_with_rpc_stream(),
         ms.unregister_repair_get_full_row_hashes_with_rpc_stream(),
         ms.unregister_repair_get_full_row_hashes(),
+        ms.unregister_repair_get_row_hashes_iblt(),
         ms.unregister_repair_get_combined_row_hash(),
         ms.unregister_repair_get_sync_boundary(),
         ms.unregister_repair_get_row_diff(),
@@ -2753,8 +2884,19 @@ class row_level_repair {
 
             rlogger.debug("Before master.get_full_row_hashes for node {}, hash_sets={}",
                 node, master.peer_row_hash_sets(node_idx).size());
+            // When the nodes are nearly in sync, an IBLT of the peer's row
+            // hashes tells the difference with much less traffic than the
+            // full list of hashes.
+            bool got_peer_row_hashes = false;
+            if (master.use_iblt()) {
+                ns.state = repair_state::get_row_hashes_iblt_started;
+                got_peer_row_hashes = master.get_peer_row_hashes_with_iblt(node, node_idx).get0();
+                ns.state = repair_state::get_row_hashes_iblt_finished;
+            }
             // Ask the peer to send the full list hashes in the working row buf.
-            if (master.use_rpc_stream()) {
+            if (got_peer_row_hashes) {
+                master.stats().round_nr_iblt++;
+            } else if (master.use_rpc_stream()) {
                 ns.state = repair_state::get_full_row_hashes_with_rpc_stream_started;
                 master.peer_row_hash_sets(node_idx) = master.get_full_row_hashes_with_rpc_stream(node, node_idx).get0();
                 ns.state = repair_state::get_full_row_hashes_with_rpc_stream_finished;
@@ -2860,6 +3002,7 @@ class row_level_repair {
                     repair_meta::repair_master::yes,
                     repair_meta_id,
                     _ri.reason,
+                    unrepaired_only(_ri.incremental),
                     std::move(master_node_shard_config),
                     _all_live_peer_nodes,
                     _all_live_peer_nodes.size(),
@@ -2965,9 +3108,12 @@ future<> shutdown_all_row_level_repair() {
 }
 
 class row_level_repair_gossip_helper : public gms::i_endpoint_state_change_subscriber {
+    repair_service& _rs;
+
     void remove_row_level_repair(gms::inet_address node) {
         rlogger.debug("Started to remove row level repair on all shards for node {}", node);
-        smp::invoke_on_all([node] {
+        _rs.container().invoke_on_all([node] (repair_service& local_repair) {
+            local_repair.drop_incremental_repair_candidates(node);
             return repair_meta::remove_repair_meta(node);
         }).then([node] {
             rlogger.debug("Finished to remove row level repair on all shards for node {}", node);
@@ -2975,6 +3121,9 @@ class row_level_repair_gossip_helper : public gms::i_endpoint_state_change_subsc
             rlogger.warn("Failed to remove row level repair for node {}: {}", node, ep);
         }).get();
     }
+public:
+    explicit row_level_repair_gossip_helper(repair_service& rs) : _rs(rs) {
+    }
     virtual void on_join(
             gms::inet_address endpoint,
             gms::endpoint_state ep_state) override {
@@ -3023,9 +3172,10 @@ repair_service::repair_service(distributed<gms::gossiper>& gossiper,
     , _sys_dist_ks(sys_dist_ks)
     , _view_update_generator(vug)
     , _mm(mm)
+    , _incremental_repair_candidates_timer([this] { expire_incremental_repair_candidates(); })
 {
     if (this_shard_id() == 0) {
-        _gossip_helper = make_shared<row_level_repair_gossip_helper>();
+        _gossip_helper = make_shared<row_level_repair_gossip_helper>(*this);
         _tracker = std::make_unique<tracker>(smp::count, max_repair_memory);
         _gossiper.local().register_(_gossip_helper);
     }
@@ -3044,6 +3194,8 @@ future<> repair_service::stop() {
             uninit_ms_handlers(),
             uninit_row_level_ms_handlers()
     ).discard_result().then([this] {
+        _incremental_repair_candidates_timer.cancel();
+        _incremental_repair_candidates.clear();
         if (this_shard_id() != 0) {
             _stopped = true;
             return make_ready_future<>();
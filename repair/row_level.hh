@@ -25,6 +25,8 @@
 #include "gms/inet_address.hh"
 #include "repair/repair.hh"
 #include <seastar/core/distributed.hh>
+#include <seastar/core/timer.hh>
+#include <seastar/core/lowres_clock.hh>
 
 class row_level_repair_gossip_helper;
 
@@ -53,6 +55,20 @@ class repair_service : public seastar::peering_sharded_service<repair_service> {
     shared_ptr<row_level_repair_gossip_helper> _gossip_helper;
     std::unique_ptr<tracker> _tracker;
     bool _stopped = false;
+    struct incremental_repair_candidates {
+        // The node which started the repair.
+        gms::inet_address master;
+        // The candidates are dropped if the repair didn't finish by then.
+        lowres_clock::time_point expiry;
+        // Generations of the unrepaired sstables by table id.
+        std::unordered_map<utils::UUID, std::unordered_set<int64_t>> generations;
+    };
+    // The sstables which existed when an incremental repair started, by repair
+    // uuid. Only these sstables may be marked as repaired when the repair
+    // finishes. They are dropped when the repair fails, when its master goes
+    // down and when it doesn't finish in time.
+    std::unordered_map<utils::UUID, incremental_repair_candidates> _incremental_repair_candidates;
+    timer<lowres_clock> _incremental_repair_candidates_timer;
 
     future<> init_ms_handlers();
     future<> uninit_ms_handlers();
@@ -96,6 +112,24 @@ class repair_service : public seastar::peering_sharded_service<repair_service> {
             streaming::stream_reason reason,
             std::optional<utils::UUID> ops_uuid);
 
+    // Called on every shard of every node participating in an incremental repair,
+    // before any of the ranges is repaired and after all of them are.
+    future<> prepare_incremental_repair(utils::UUID repair_uuid, gms::inet_address master, std::vector<utils::UUID> table_ids);
+    // Marks the candidate sstables fully contained in the given ranges as repaired
+    // at repaired_at, or drops the candidates if repaired_at is 0 (failed repair).
+    future<> finish_incremental_repair(utils::UUID repair_uuid, dht::token_range_vector ranges, uint64_t repaired_at);
+    // Drops the candidates of the incremental repairs which didn't finish in time.
+    void expire_incremental_repair_candidates();
+
+public:
+    // How long the candidates of an incremental repair are kept. A repair which
+    // takes longer doesn't mark any sstable as repaired.
+    static constexpr auto incremental_repair_timeout = std::chrono::hours(24);
+
+    // Drops the candidates of the incremental repairs started by the given node,
+    // which won't finish them.
+    void drop_incremental_repair_candidates(gms::inet_address master);
+
 public:
     netw::messaging_service& get_messaging() noexcept { return _messaging; }
     sharded<database>& get_db() noexcept { return _db; }
@@ -27,12 +27,14 @@
 #include <seastar/util/defer.hh>
 #include "memtable.hh"
 #include <chrono>
+#include <unordered_set>
 #include <boost/version.hpp>
 #include <sys/sdt.h>
 #include "read_context.hh"
 #include "dirty_memory_manager.hh"
 #include "cache_flat_mutation_reader.hh"
 #include "real_dirty_memory_accounter.hh"
+#include "clustering_interval_set.hh"
 
 namespace cache {
 
@@ -886,6 +888,88 @@ cache_entry& row_cache::lookup(const dht::decorated_key& key) {
     });
 }
 
+// Returns the clustering ranges which are continuous in cache, so that reading
+// them later populates the same rows, and nothing else.
+static query::clustering_row_ranges cached_clustering_ranges(const schema& s, partition_entry& pe) {
+    clustering_interval_set continuous;
+    for (partition_version& pv : pe.versions_from_oldest()) {
+        continuous.add(s, pv.partition().get_continuity(s));
+    }
+    auto ranges = continuous.to_clustering_row_ranges();
+    // Bounds before and after all rows come out as empty prefixes.
+    auto open_if_empty = [] (const std::optional<query::clustering_range::bound>& b) -> std::optional<query::clustering_range::bound> {
+        if (b && b->value().is_empty()) {
+            return std::nullopt;
+        }
+        return b;
+    };
+    for (auto& r : ranges) {
+        r = query::clustering_range(open_if_empty(r.start()), open_if_empty(r.end()));
+    }
+    return ranges;
+}
+
+// Returns the cache entry of the latest version of the partition the row belongs to,
+// or nullptr if the row belongs to an older version.
+static cache_entry* owning_cache_entry(rows_entry& row) noexcept {
+    mutation_partition::rows_type::iterator it(&row);
+    partition_version& pv = partition_version::container_of(mutation_partition::container_of(*it.owning_tree()));
+    if (!pv.is_referenced_from_entry()) {
+        return nullptr;
+    }
+    return &cache_entry::container_of(partition_entry::container_of(pv));
+}
+
+bool row_cache::cached_partitions_collector::consume(evictable& e) {
+    auto* row = dynamic_cast<rows_entry*>(&e);
+    if (!row) {
+        return false;
+    }
+    cache_entry* ce = owning_cache_entry(*row);
+    if (!ce || full()) {
+        return true;
+    }
+    auto s = ce->schema();
+    auto it = _seen.find(s->id());
+    if (it == _seen.end()) {
+        key_set keys(0, std::hash<dht::decorated_key>(), dht::decorated_key_equals_comparator(*s));
+        it = _seen.emplace(s->id(), table_keys{s, std::move(keys)}).first;
+    }
+    if (it->second.keys.insert(ce->key()).second) {
+        _partitions[s->id()].push_back(cached_partition{ce->key(), cached_clustering_ranges(*s, ce->partition())});
+        ++_nr_partitions;
+    }
+    return true;
+}
+
+future<row_cache::cached_partitions> row_cache::get_cached_partitions(cache_tracker& tracker, size_t max_partitions) {
+    return seastar::async([&tracker, max_partitions] {
+        cached_partitions_collector collector(max_partitions);
+        logalloc::allocating_section read_section;
+        // The LRU also holds the entries of the partition index caches.
+        lru_cursor cursor;
+        bool started = false;
+        while (!collector.full()) {
+            if (started && !cursor.is_linked()) {
+                // Reached the end, or the cursor was evicted.
+                break;
+            }
+            started = true;
+            auto done = read_section(tracker.region(), [&] {
+                return tracker.get_lru().walk(cursor, [&] (evictable& e) {
+                    collector.consume(e);
+                    return stop_iteration(collector.full() || need_preempt());
+                });
+            });
+            if (done) {
+                break;
+            }
+            seastar::thread::yield();
+        }
+        return std::move(collector).get();
+    });
+}
+
 mutation_source& row_cache::snapshot_for_phase(phase_type phase) {
     if (phase == _underlying_phase) {
         return _underlying;
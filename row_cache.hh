@@ -395,6 +395,46 @@ class row_cache final {
     // Intended to be used only in tests.
     cache_entry& lookup(const dht::decorated_key& key);
 
+    // Describes the cached part of a partition.
+    struct cached_partition {
+        dht::decorated_key key;
+        // Covers all rows of the partition present in cache.
+        // Empty when only the static row and the partition tombstone are cached.
+        query::clustering_row_ranges ranges;
+    };
+
+    // Partitions present in the caches of all tables, by table id.
+    using cached_partitions = std::unordered_map<utils::UUID, std::vector<cached_partition>>;
+
+    // Collects partitions present in the caches of all tables while the LRU of
+    // their tracker is walked, taking a partition when the first of its rows is seen.
+    class cached_partitions_collector {
+        using key_set = std::unordered_set<dht::decorated_key, std::hash<dht::decorated_key>, dht::decorated_key_equals_comparator>;
+        struct table_keys {
+            // Keeps the schema referenced by the comparator alive
+            schema_ptr schema;
+            key_set keys;
+        };
+        size_t _max_partitions;
+        size_t _nr_partitions = 0;
+        std::unordered_map<utils::UUID, table_keys> _seen;
+        cached_partitions _partitions;
+    public:
+        explicit cached_partitions_collector(size_t max_partitions) : _max_partitions(max_partitions) {}
+        // Returns false if the entry is not a row of the cache.
+        // Must be called with reclaiming disabled.
+        bool consume(evictable&);
+        bool full() const noexcept { return _nr_partitions >= _max_partitions; }
+        cached_partitions get() && { return std::move(_partitions); }
+    };
+
+    // Walks the LRU of the tracker, which is shared by the caches of all tables,
+    // once, and returns up to max_partitions partitions present in them, from the
+    // most recently used one, going by the most recently used row of each partition.
+    // The result is meant to be used for re-populating caches after a restart.
+    // Defers between batches. Partitions used concurrently may be missed.
+    static future<cached_partitions> get_cached_partitions(cache_tracker&, size_t max_partitions);
+
     // Synchronizes cache with the underlying data source from a memtable which
     // has just been flushed to the underlying data source.
     // The memtable can be queried during the process, but must not be written.
@@ -41,6 +41,9 @@
 #include "dht/token-sharding.hh"
 #include "cdc/cdc_extension.hh"
 #include "db/paxos_grace_seconds_extension.hh"
+#include "db/bloom_filter_format_extension.hh"
+#include "db/unlogged_ingest_extension.hh"
+#include "db/sstable_index_format_extension.hh"
 #include "utils/rjson.hh"
 
 constexpr int32_t schema::NAME_LENGTH;
@@ -1204,6 +1207,21 @@ schema_ptr schema_builder::build() {
             dynamic_pointer_cast<db::paxos_grace_seconds_extension>(it->second)->get_paxos_grace_seconds();
     }
 
+    // likewise for `bloom_filter_format`, used whenever an sstable is written
+    if (auto it = new_raw._extensions.find(db::bloom_filter_format_extension::NAME); it != new_raw._extensions.end()) {
+        new_raw._bloom_filter_format = dynamic_pointer_cast<db::bloom_filter_format_extension>(it->second)->get_format();
+    }
+
+    // and `unlogged_ingest`, used for every write
+    if (auto it = new_raw._extensions.find(db::unlogged_ingest_extension::NAME); it != new_raw._extensions.end()) {
+        new_raw._unlogged_ingest = dynamic_pointer_cast<db::unlogged_ingest_extension>(it->second)->is_enabled();
+    }
+
+    // and `sstable_index_format`, used whenever an sstable is written
+    if (auto it = new_raw._extensions.find(db::sstable_index_format_extension::NAME); it != new_raw._extensions.end()) {
+        new_raw._sstable_index_format = dynamic_pointer_cast<db::sstable_index_format_extension>(it->second)->get_format();
+    }
+
     return make_lw_shared<schema>(schema(new_raw, _view_info));
 }
 
@@ -1227,6 +1245,21 @@ schema_builder& schema_builder::set_paxos_grace_seconds(int32_t seconds) {
     return *this;
 }
 
+schema_builder& schema_builder::set_bloom_filter_format(utils::filter_format format) {
+    add_extension(db::bloom_filter_format_extension::NAME, ::make_shared<db::bloom_filter_format_extension>(format));
+    return *this;
+}
+
+schema_builder& schema_builder::set_unlogged_ingest(bool enabled) {
+    add_extension(db::unlogged_ingest_extension::NAME, ::make_shared<db::unlogged_ingest_extension>(enabled));
+    return *this;
+}
+
+schema_builder& schema_builder::set_sstable_index_format(sstable_index_format format) {
+    add_extension(db::sstable_index_format_extension::NAME, ::make_shared<db::sstable_index_format_extension>(format));
+    return *this;
+}
+
 gc_clock::duration schema::paxos_grace_seconds() const {
     return std::chrono::duration_cast<gc_clock::duration>(
         std::chrono::seconds(
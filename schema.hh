@@ -38,6 +38,7 @@
 #include "utils/UUID.hh"
 #include "compress.hh"
 #include "compaction_strategy_type.hh"
+#include "utils/i_filter.hh"
 #include "caching_options.hh"
 #include "column_computation.hh"
 #include "timestamp.hh"
@@ -176,6 +177,12 @@ inline cf_type sstring_to_cf_type(sstring name) {
     throw std::invalid_argument(format("unknown type: {}\n", name));
 }
 
+// Partition index written to new sstables of a table.
+enum class sstable_index_format : uint8_t {
+    standard, // Summary and Index components
+    trie,     // also the Partitions component
+};
+
 struct speculative_retry {
     enum class type {
         NONE, CUSTOM, PERCENTILE, ALWAYS
@@ -616,6 +623,9 @@ class schema final : public enable_lw_shared_from_this<schema> {
         data_type _regular_column_name_type;
         data_type _default_validation_class = bytes_type;
         double _bloom_filter_fp_chance = 0.01;
+        utils::filter_format _bloom_filter_format = utils::filter_format::m_format;
+        bool _unlogged_ingest = false;
+        sstable_index_format _sstable_index_format = sstable_index_format::standard;
         compression_parameters _compressor_params;
         extensions_map _extensions;
         bool _is_dense = false;
@@ -707,6 +717,18 @@ class schema final : public enable_lw_shared_from_this<schema> {
     double bloom_filter_fp_chance() const {
         return _raw._bloom_filter_fp_chance;
     }
+    // Kind of bloom filter of new sstables, see db::bloom_filter_format_extension.
+    utils::filter_format bloom_filter_format() const {
+        return _raw._bloom_filter_format;
+    }
+    // Whether writes skip the commitlog, see db::unlogged_ingest_extension.
+    bool unlogged_ingest() const {
+        return _raw._unlogged_ingest;
+    }
+    // Partition index of new sstables, see db::sstable_index_format_extension.
+    sstable_index_format get_sstable_index_format() const {
+        return _raw._sstable_index_format;
+    }
     sstring thrift_key_validator() const;
     const compression_parameters& get_compressor_params() const {
         return _raw._compressor_params;
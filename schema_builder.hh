@@ -188,6 +188,9 @@ struct schema_builder {
     double get_bloom_filter_fp_chance() const {
         return _raw._bloom_filter_fp_chance;
     }
+    schema_builder& set_bloom_filter_format(utils::filter_format format);
+    schema_builder& set_unlogged_ingest(bool enabled);
+    schema_builder& set_sstable_index_format(sstable_index_format format);
     schema_builder& set_compressor_params(const compression_parameters& cp) {
         _raw._compressor_params = cp;
         return *this;
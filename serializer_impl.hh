@@ -24,6 +24,7 @@
 #include "serializer.hh"
 #include <seastar/util/bool_class.hh>
 #include "utils/small_vector.hh"
+#include "utils/fragmented_temporary_buffer.hh"
 #include <absl/container/btree_set.h>
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/on_internal_error.hh>
@@ -584,6 +585,34 @@ void serialize_fragmented(Output& out, FragmentedBuffer&& v) {
     serializer<bytes>::write_fragmented(out, std::forward<FragmentedBuffer>(v));
 }
 
+// Serialized like bytes. Writing doesn't linearize the buffer, and reading
+// splits the data into fragments of the default size.
+template<>
+struct serializer<fragmented_temporary_buffer> {
+    template<typename Input>
+    static fragmented_temporary_buffer read(Input& in) {
+        auto sz = deserialize(in, boost::type<uint32_t>());
+        std::vector<seastar::temporary_buffer<char>> fragments;
+        fragments.reserve((sz + fragmented_temporary_buffer::default_fragment_size - 1) / fragmented_temporary_buffer::default_fragment_size);
+        for (size_t left = sz; left;) {
+            auto n = std::min(left, fragmented_temporary_buffer::default_fragment_size);
+            seastar::temporary_buffer<char> fragment(n);
+            in.read(fragment.get_write(), n);
+            fragments.push_back(std::move(fragment));
+            left -= n;
+        }
+        return fragmented_temporary_buffer(std::move(fragments), sz);
+    }
+    template<typename Output>
+    static void write(Output& out, const fragmented_temporary_buffer& v) {
+        serializer<bytes>::write_fragmented(out, fragmented_temporary_buffer::view(v));
+    }
+    template<typename Input>
+    static void skip(Input& in) {
+        serializer<bytes>::skip(in);
+    }
+};
+
 template<typename T>
 struct serializer<std::optional<T>> {
     template<typename Input>
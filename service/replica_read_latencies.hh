@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <seastar/core/lowres_clock.hh>
+
+#include "gms/inet_address.hh"
+#include "inet_address_vectors.hh"
+#include "utils/estimated_histogram.hh"
+
+namespace service {
+
+// Recent read latencies of each replica, as seen by a coordinator shard.
+//
+// The histograms are decayed periodically with decay(), independently of how
+// often they are sampled or queried, and replicas whose samples all decayed
+// away are forgotten. Each sample is counted sample_weight times, so that
+// decaying doesn't truncate the counts of a replica sampled only a few times
+// a period to zero.
+class replica_read_latencies {
+public:
+    // Minimum number of recent samples for a replica's latency percentile to be used.
+    static constexpr int64_t min_samples = 100;
+private:
+    static constexpr int64_t sample_weight = 1024;
+    struct entry {
+        utils::estimated_histogram histogram;
+        seastar::lowres_clock::time_point percentile_cache_timestamp;
+        double cached_percentile = -1;
+        std::chrono::microseconds percentile_cache_value{0};
+    };
+    std::unordered_map<gms::inet_address, entry> _replicas;
+public:
+    void add(gms::inet_address ep, std::chrono::microseconds latency) {
+        _replicas[ep].histogram.add_weighted(latency.count(), sample_weight);
+    }
+
+    // Returns the given percentile of recent read latencies of the replica,
+    // or a disengaged optional if too few reads from it were sampled.
+    std::optional<std::chrono::microseconds> get_percentile(gms::inet_address ep, double percentile) {
+        using namespace std::chrono_literals;
+        auto it = _replicas.find(ep);
+        if (it == _replicas.end()) {
+            return std::nullopt;
+        }
+        auto& e = it->second;
+        auto now = seastar::lowres_clock::now();
+        if (e.cached_percentile != percentile || now - e.percentile_cache_timestamp > 1s) {
+            if (e.histogram.count() < min_samples * sample_weight) {
+                return std::nullopt;
+            }
+            e.percentile_cache_timestamp = now;
+            e.cached_percentile = percentile;
+            e.percentile_cache_value = std::max(e.histogram.percentile(percentile), int64_t(1)) * 1us;
+        }
+        return e.percentile_cache_value;
+    }
+
+    // Orders the replicas with enough samples by the given percentile of
+    // their recent read latencies, the fastest first. The others keep their
+    // positions, so they are still tried in the order given by the caller.
+    void sort(inet_address_vector_replica_set& endpoints, double percentile) {
+        std::vector<size_t> positions;
+        std::vector<std::pair<std::chrono::microseconds, gms::inet_address>> known;
+        for (size_t i = 0; i < endpoints.size(); ++i) {
+            if (auto l = get_percentile(endpoints[i], percentile)) {
+                positions.push_back(i);
+                known.emplace_back(*l, endpoints[i]);
+            }
+        }
+        std::stable_sort(known.begin(), known.end(), [] (const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+        for (size_t i = 0; i < positions.size(); ++i) {
+            endpoints[positions[i]] = known[i].second;
+        }
+    }
+
+    // Gives new samples more weight than old ones.
+    void decay() {
+        for (auto it = _replicas.begin(); it != _replicas.end();) {
+            auto& e = it->second;
+            e.histogram *= 0.9;
+            auto count = e.histogram.count();
+            if (count < sample_weight) {
+                // Less than a single sample is left
+                it = _replicas.erase(it);
+                continue;
+            }
+            if (count < min_samples * sample_weight) {
+                // The cached percentile must not outlive the samples it was computed from.
+                e.cached_percentile = -1;
+            }
+            ++it;
+        }
+    }
+
+    void remove(gms::inet_address ep) {
+        _replicas.erase(ep);
+    }
+
+    size_t size() const {
+        return _replicas.size();
+    }
+};
+
+}
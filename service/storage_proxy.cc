@@ -81,6 +81,7 @@
 #include <boost/range/algorithm/transform.hpp>
 #include <boost/range/algorithm/partition.hpp>
 #include <boost/intrusive/list.hpp>
+#include <boost/range/irange.hpp>
 #include "utils/latency.hh"
 #include "schema.hh"
 #include "schema_registry.hh"
@@ -183,6 +184,13 @@ class mutation_holder {
             storage_proxy::response_id_type response_id, storage_proxy::clock_type::time_point timeout,
             tracing::trace_state_ptr tr_state) = 0;
     virtual bool is_shared() = 0;
+    // The mutation written to every replica, if the holder allows writing it
+    // together with other mutations (with database::apply() on the local
+    // replica, with a MUTATIONS message to remote ones) instead of through
+    // apply_locally() and apply_remotely().
+    virtual const frozen_mutation* batchable_mutation() {
+        return nullptr;
+    }
     size_t size() const {
         return _size;
     }
@@ -289,6 +297,9 @@ class shared_mutation : public mutation_holder {
     virtual bool is_shared() override {
         return true;
     }
+    virtual const frozen_mutation* batchable_mutation() override {
+        return _mutation.get();
+    }
     virtual void release_mutation() override {
         _mutation.release();
     }
@@ -307,6 +318,9 @@ class hint_mutation : public shared_mutation {
         // becomes unavailable - this might include the current node
         return sp.mutate_hint(_schema, *_mutation, std::move(tr_state), timeout);
     }
+    virtual const frozen_mutation* batchable_mutation() override {
+        return nullptr;
+    }
     virtual future<> apply_remotely(storage_proxy& sp, gms::inet_address ep, inet_address_vector_replica_set&& forward,
             storage_proxy::response_id_type response_id, storage_proxy::clock_type::time_point timeout,
             tracing::trace_state_ptr tr_state) override {
@@ -607,6 +621,9 @@ class abstract_write_response_handler : public seastar::enable_shared_from_this<
     future<> apply_locally(storage_proxy::clock_type::time_point timeout, tracing::trace_state_ptr tr_state) {
         return _mutation_holder->apply_locally(*_proxy, timeout, std::move(tr_state));
     }
+    const frozen_mutation* get_batchable_mutation() {
+        return _mutation_holder->batchable_mutation();
+    }
     future<> apply_remotely(gms::inet_address ep, inet_address_vector_replica_set&& forward,
             storage_proxy::response_id_type response_id, storage_proxy::clock_type::time_point timeout,
             tracing::trace_state_ptr tr_state) {
@@ -1808,7 +1825,9 @@ storage_proxy::storage_proxy(distributed<database>& db, storage_proxy::config cf
     , _background_write_throttle_threahsold(cfg.available_memory / 10)
     , _mutate_stage{"storage_proxy_mutate", &storage_proxy::do_mutate}
     , _max_view_update_backlog(max_view_update_backlog)
-    , _view_update_handlers_list(std::make_unique<view_update_handlers_list>()) {
+    , _view_update_handlers_list(std::make_unique<view_update_handlers_list>())
+    , _replica_read_latencies_decay_timer([this] { _replica_read_latencies.decay(); }) {
+    _replica_read_latencies_decay_timer.arm_periodic(1s);
     namespace sm = seastar::metrics;
     _metrics.add_group(storage_proxy_stats::COORDINATOR_STATS_CATEGORY, {
         sm::make_queue_length("current_throttled_writes", [this] { return _throttled_writes.size(); },
@@ -1888,6 +1907,29 @@ storage_proxy::mutate_hint(const schema_ptr& s, const frozen_mutation& m, tracin
     });
 }
 
+future<>
+storage_proxy::mutate_hints(std::vector<frozen_mutation_and_schema> hints, clock_type::time_point timeout) {
+    using shard_hints = std::vector<std::pair<global_schema_ptr, const frozen_mutation*>>;
+    std::vector<shard_hints> hints_by_shard(smp::count);
+    for (auto& h : hints) {
+        auto shard = _db.local().shard_of(h.fm);
+        get_stats().replica_cross_shard_ops += shard != this_shard_id();
+        hints_by_shard[shard].emplace_back(h.s, &h.fm);
+    }
+    return do_with(std::move(hints), std::move(hints_by_shard), [this, timeout] (std::vector<frozen_mutation_and_schema>&, std::vector<shard_hints>& hints_by_shard) {
+        return parallel_for_each(boost::irange<unsigned>(0, smp::count), [this, timeout, &hints_by_shard] (unsigned shard) {
+            if (hints_by_shard[shard].empty()) {
+                return make_ready_future<>();
+            }
+            return _db.invoke_on(shard, {_hints_write_smp_service_group, timeout}, [&hs = hints_by_shard[shard], timeout] (database& db) {
+                return parallel_for_each(hs, [&db, timeout] (const std::pair<global_schema_ptr, const frozen_mutation*>& h) {
+                    return db.apply_hint(h.first, *h.second, tracing::trace_state_ptr(), timeout);
+                });
+            });
+        });
+    });
+}
+
 future<>
 storage_proxy::mutate_counters_on_leader(std::vector<frozen_mutation_and_schema> mutations, db::consistency_level cl, clock_type::time_point timeout,
                                          tracing::trace_state_ptr trace_state, service_permit permit) {
@@ -2078,7 +2120,13 @@ future<storage_proxy::unique_response_handler_vector> storage_proxy::mutate_prep
 
 future<> storage_proxy::mutate_begin(unique_response_handler_vector ids, db::consistency_level cl,
                                      tracing::trace_state_ptr trace_state, std::optional<clock_type::time_point> timeout_opt) {
-    return parallel_for_each(ids, [this, cl, timeout_opt] (unique_response_handler& protected_response) {
+    // Writes of a batch to the local replica are collected and applied with
+    // a single cross-shard call per owning shard, and writes to each remote
+    // replica with a single message, instead of one per mutation.
+    write_batch batch;
+    batch.batch_remote = _features.cluster_supports_mutations_batch();
+    auto timeout = timeout_opt.value_or(clock_type::now() + std::chrono::milliseconds(_db.local().get_config().write_request_timeout_in_ms()));
+    auto f = parallel_for_each(ids, [this, cl, timeout, &batch, batched = ids.size() > 1] (unique_response_handler& protected_response) {
         auto response_id = protected_response.id;
         // This function, mutate_begin(), is called after a preemption point
         // so it's possible that other code besides our caller just ran. In
@@ -2103,12 +2151,133 @@ future<> storage_proxy::mutate_begin(unique_response_handler_vector ids, db::con
         // frozen_mutation copy, or manage handler live time differently.
         hint_to_dead_endpoints(response_id, cl);
 
-        auto timeout = timeout_opt.value_or(clock_type::now() + std::chrono::milliseconds(_db.local().get_config().write_request_timeout_in_ms()));
         // call before send_to_live_endpoints() for the same reason as above
         auto f = response_wait(response_id, timeout);
-        send_to_live_endpoints(protected_response.release(), timeout); // response is now running and it will either complete or timeout
+        // response is now running and it will either complete or timeout
+        send_to_live_endpoints(protected_response.release(), timeout, batched ? &batch : nullptr);
         return f;
     });
+    // parallel_for_each() has invoked the function for all handlers by now,
+    // so all batched writes were collected.
+    if (!batch.local.empty()) {
+        apply_local_writes(std::move(batch.local), timeout);
+    }
+    for (auto& [ep, handlers] : batch.remote) {
+        send_remote_writes(ep, std::move(handlers), timeout);
+    }
+    return f;
+}
+
+void storage_proxy::apply_local_writes(write_handlers writes, clock_type::time_point timeout) {
+    struct local_write {
+        global_schema_ptr schema;
+        const frozen_mutation* mutation;
+        tracing::global_trace_state_ptr trace_state;
+    };
+    // The writes applied by one shard. Lives on this shard, and is only
+    // accessed here, also when the other shard reports a completed write.
+    struct shard_writes_state {
+        write_handlers handlers;
+        std::vector<bool> completed;
+    };
+
+    std::vector<lw_shared_ptr<shard_writes_state>> writes_per_shard(smp::count);
+    for (auto& handler : writes) {
+        auto shard = _db.local().shard_of(*handler->get_batchable_mutation());
+        if (!writes_per_shard[shard]) {
+            writes_per_shard[shard] = make_lw_shared<shard_writes_state>();
+        }
+        writes_per_shard[shard]->handlers.push_back(std::move(handler));
+    }
+
+    auto my_address = utils::fb_utilities::get_broadcast_address();
+    // Completes a write as soon as it is applied, not when the whole group is.
+    auto complete = [this, my_address] (shard_writes_state& state, size_t i, std::exception_ptr eptr) {
+        if (std::exchange(state.completed[i], true)) {
+            return;
+        }
+        auto& handler = *state.handlers[i];
+        if (eptr) {
+            handle_write_error(handler.id(), my_address, 0, handler.stats(), std::move(eptr));
+        } else {
+            got_response(handler.id(), my_address, get_view_update_backlog());
+        }
+    };
+
+    for (unsigned shard = 0; shard < smp::count; ++shard) {
+        auto state = writes_per_shard[shard];
+        if (!state) {
+            continue;
+        }
+        get_stats().replica_cross_shard_ops += shard != this_shard_id();
+        state->completed.resize(state->handlers.size());
+
+        std::vector<local_write> shard_writes;
+        shard_writes.reserve(state->handlers.size());
+        for (auto& handler : state->handlers) {
+            tracing::trace(handler->get_trace_state(), "Executing a mutation locally");
+            shard_writes.push_back(local_write{handler->get_schema(), handler->get_batchable_mutation(),
+                    tracing::global_trace_state_ptr(handler->get_trace_state())});
+        }
+
+        // Waited on indirectly, through the response handlers.
+        (void)_db.invoke_on(shard, {_write_smp_service_group, timeout}, [&proxy = container(), origin = this_shard_id(), state = state.get(), complete,
+                shard_writes = std::move(shard_writes), timeout] (database& db) mutable {
+            return do_with(std::move(shard_writes), [&db, &proxy, origin, state, complete, timeout] (std::vector<local_write>& shard_writes) {
+                return parallel_for_each(boost::irange<size_t>(0, shard_writes.size()), [&db, &proxy, origin, state, complete, &shard_writes, timeout] (size_t i) {
+                    auto& w = shard_writes[i];
+                    return futurize_invoke([&] {
+                        return db.apply(w.schema, *w.mutation, w.trace_state.get(), db::commitlog::force_sync::no, timeout);
+                    }).then_wrapped([&proxy, origin, state, complete, i] (future<> f) {
+                        auto eptr = f.failed() ? f.get_exception() : std::exception_ptr();
+                        return proxy.invoke_on(origin, [state, complete, i, eptr = std::move(eptr)] (storage_proxy&) mutable {
+                            complete(*state, i, std::move(eptr));
+                        });
+                    });
+                });
+            });
+        }).then_wrapped([p = shared_from_this(), state, complete] (future<> f) mutable {
+            // keep the handlers, and so the mutations, alive until they are applied
+            if (f.failed()) {
+                auto eptr = f.get_exception();
+                for (size_t i = 0; i < state->handlers.size(); ++i) {
+                    complete(*state, i, eptr);
+                }
+            }
+        });
+    }
+}
+
+void storage_proxy::send_remote_writes(gms::inet_address ep, write_handlers writes, clock_type::time_point timeout) {
+    std::vector<frozen_mutation> fms;
+    std::vector<response_id_type> response_ids;
+    fms.reserve(writes.size());
+    response_ids.reserve(writes.size());
+    size_t msize = 0;
+    for (auto& handler : writes) {
+        tracing::trace(handler->get_trace_state(), "Sending a mutation to /{} together with {} others", ep, writes.size() - 1);
+        fms.push_back(*handler->get_batchable_mutation());
+        response_ids.push_back(handler->id());
+        msize += handler->get_mutation_size();
+    }
+    _global_stats.queued_write_bytes += msize;
+
+    // All writes of a request share its trace state.
+    auto trace_info = tracing::make_trace_info(writes.front()->get_trace_state());
+    // Waited on indirectly, through the response handlers.
+    (void)_messaging.send_mutations(netw::messaging_service::msg_addr{ep, 0}, timeout, std::move(fms),
+            utils::fb_utilities::get_broadcast_address(), this_shard_id(), std::move(response_ids), std::move(trace_info)).then_wrapped(
+            [this, p = shared_from_this(), ep, writes = std::move(writes), msize] (future<> f) {
+        // keep the handlers alive until the mutations are sent
+        _global_stats.queued_write_bytes -= msize;
+        unthrottle();
+        if (f.failed()) {
+            auto eptr = f.get_exception();
+            for (auto& handler : writes) {
+                handle_write_error(handler->id(), ep, 0, handler->stats(), eptr);
+            }
+        }
+    });
 }
 
 // this function should be called with a future that holds result of mutation attempt (usually
@@ -2622,6 +2791,20 @@ future<> storage_proxy::send_hint_to_endpoint(frozen_mutation_and_schema fm_a_s,
             allow_hints::no);
 }
 
+future<> storage_proxy::send_hints_to_endpoint(std::vector<frozen_mutation_and_schema> hints, gms::inet_address target) {
+    auto timeout = clock_type::now() + std::chrono::milliseconds(_db.local().get_config().write_request_timeout_in_ms());
+    if (target == utils::fb_utilities::get_broadcast_address()) {
+        return mutate_hints(std::move(hints), timeout);
+    }
+
+    std::vector<frozen_mutation> fms;
+    fms.reserve(hints.size());
+    for (auto& h : hints) {
+        fms.push_back(std::move(h.fm));
+    }
+    return _messaging.send_hint_mutations(netw::messaging_service::msg_addr{target, 0}, timeout, std::move(fms));
+}
+
 future<> storage_proxy::send_hint_to_all_replicas(frozen_mutation_and_schema fm_a_s) {
     if (!_features.cluster_supports_hinted_handoff_separate_connection()) {
         std::array<mutation, 1> ms{fm_a_s.fm.unfreeze(fm_a_s.s)};
@@ -2647,7 +2830,7 @@ future<> storage_proxy::send_hint_to_all_replicas(frozen_mutation_and_schema fm_
  * @throws OverloadedException if the hints cannot be written/enqueued
  */
  // returned future is ready when sent is complete, not when mutation is executed on all (or any) targets!
-void storage_proxy::send_to_live_endpoints(storage_proxy::response_id_type response_id, clock_type::time_point timeout)
+void storage_proxy::send_to_live_endpoints(storage_proxy::response_id_type response_id, clock_type::time_point timeout, write_batch* batch)
 {
     // extra-datacenter replicas, grouped by dc
     std::unordered_map<sstring, inet_address_vector_replica_set> dc_groups;
@@ -2714,7 +2897,13 @@ void storage_proxy::send_to_live_endpoints(storage_proxy::response_id_type respo
                 ++stats.read_repair_write_attempts.get_ep_stat(coordinator);
             }
 
-            if (coordinator == my_address) {
+            if (batch && coordinator == my_address && handler.get_batchable_mutation()) {
+                batch->local.push_back(handler_ptr);
+                continue;
+            } else if (batch && batch->batch_remote && coordinator != my_address && forward.empty() && handler.get_batchable_mutation()) {
+                batch->remote[coordinator].push_back(handler_ptr);
+                continue;
+            } else if (coordinator == my_address) {
                 f = futurize_invoke(lmutate);
             } else {
                 f = futurize_invoke(rmutate, coordinator, std::move(forward));
@@ -2723,27 +2912,31 @@ void storage_proxy::send_to_live_endpoints(storage_proxy::response_id_type respo
 
         // Waited on indirectly.
         (void)f.handle_exception([response_id, forward_size, coordinator, handler_ptr, p = shared_from_this(), &stats] (std::exception_ptr eptr) {
-            ++stats.writes_errors.get_ep_stat(coordinator);
-            error err = error::FAILURE;
-            try {
-                std::rethrow_exception(eptr);
-            } catch(rpc::closed_error&) {
-                // ignore, disconnect will be logged by gossiper
-            } catch(seastar::gate_closed_exception&) {
-                // may happen during shutdown, ignore it
-            } catch(timed_out_error&) {
-                // from lmutate(). Ignore so that logs are not flooded
-                // database total_writes_timedout counter was incremented.
-                // It needs to be recorded that the timeout occurred locally though.
-                err = error::TIMEOUT;
-            } catch(...) {
-                slogger.error("exception during mutation write to {}: {}", coordinator, std::current_exception());
-            }
-            p->got_failure_response(response_id, coordinator, forward_size + 1, std::nullopt, err);
+            p->handle_write_error(response_id, coordinator, forward_size, stats, std::move(eptr));
         });
     }
 }
 
+void storage_proxy::handle_write_error(response_id_type response_id, gms::inet_address coordinator, size_t forward_size, write_stats& stats, std::exception_ptr eptr) {
+    ++stats.writes_errors.get_ep_stat(coordinator);
+    error err = error::FAILURE;
+    try {
+        std::rethrow_exception(eptr);
+    } catch(rpc::closed_error&) {
+        // ignore, disconnect will be logged by gossiper
+    } catch(seastar::gate_closed_exception&) {
+        // may happen during shutdown, ignore it
+    } catch(timed_out_error&) {
+        // from a local write. Ignore so that logs are not flooded
+        // database total_writes_timedout counter was incremented.
+        // It needs to be recorded that the timeout occurred locally though.
+        err = error::TIMEOUT;
+    } catch(...) {
+        slogger.error("exception during mutation write to {}: {}", coordinator, std::current_exception());
+    }
+    got_failure_response(response_id, coordinator, forward_size + 1, std::nullopt, err);
+}
+
 // returns number of hints stored
 template<typename Range>
 size_t storage_proxy::hint_to_dead_endpoints(std::unique_ptr<mutation_holder>& mh, const Range& targets, db::write_type type, tracing::trace_state_ptr tr_state) noexcept
@@ -3529,9 +3722,10 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     }
     void make_data_requests(digest_resolver_ptr resolver, targets_iterator begin, targets_iterator end, clock_type::time_point timeout, bool want_digest) {
         auto start = latency_clock::now();
+        auto timeout_latency = timeout - clock_type::now();
         for (const gms::inet_address& ep : boost::make_iterator_range(begin, end)) {
             // Waited on indirectly, shared_from_this keeps `this` alive
-            (void)make_data_request(ep, timeout, want_digest).then_wrapped([this, resolver, ep, start, exec = shared_from_this()] (future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> f) {
+            (void)make_data_request(ep, timeout, want_digest).then_wrapped([this, resolver, ep, start, timeout_latency, exec = shared_from_this()] (future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> f) {
                 try {
                     auto v = f.get0();
                     _cf->set_hit_rate(ep, std::get<1>(v));
@@ -3539,8 +3733,10 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
                     ++_proxy->get_stats().data_read_completed.get_ep_stat(ep);
                     _used_targets.push_back(ep);
                     register_request_latency(latency_clock::now() - start);
+                    add_replica_read_latency(ep, latency_clock::now() - start);
                 } catch(...) {
                     ++_proxy->get_stats().data_read_errors.get_ep_stat(ep);
+                    add_replica_read_failure(ep, latency_clock::now() - start, timeout_latency);
                     resolver->error(ep, std::current_exception());
                 }
             });
@@ -3548,9 +3744,10 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     }
     void make_digest_requests(digest_resolver_ptr resolver, targets_iterator begin, targets_iterator end, clock_type::time_point timeout) {
         auto start = latency_clock::now();
+        auto timeout_latency = timeout - clock_type::now();
         for (const gms::inet_address& ep : boost::make_iterator_range(begin, end)) {
             // Waited on indirectly, shared_from_this keeps `this` alive
-            (void)make_digest_request(ep, timeout).then_wrapped([this, resolver, ep, start, exec = shared_from_this()] (future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> f) {
+            (void)make_digest_request(ep, timeout).then_wrapped([this, resolver, ep, start, timeout_latency, exec = shared_from_this()] (future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> f) {
                 try {
                     auto v = f.get0();
                     _cf->set_hit_rate(ep, std::get<2>(v));
@@ -3558,8 +3755,10 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
                     ++_proxy->get_stats().digest_read_completed.get_ep_stat(ep);
                     _used_targets.push_back(ep);
                     register_request_latency(latency_clock::now() - start);
+                    add_replica_read_latency(ep, latency_clock::now() - start);
                 } catch(...) {
                     ++_proxy->get_stats().digest_read_errors.get_ep_stat(ep);
+                    add_replica_read_failure(ep, latency_clock::now() - start, timeout_latency);
                     resolver->error(ep, std::current_exception());
                 }
             });
@@ -3759,6 +3958,14 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     void register_request_latency(latency_clock::duration d) {
         _max_request_latency = std::max(_max_request_latency, d);
     }
+    void add_replica_read_latency(gms::inet_address ep, latency_clock::duration d) {
+        _proxy->_replica_read_latencies.add(ep, std::chrono::duration_cast<std::chrono::microseconds>(d));
+    }
+    // A failed or timed out read counts as taking at least the whole timeout,
+    // so that a replica isn't preferred for failing fast.
+    void add_replica_read_failure(gms::inet_address ep, latency_clock::duration d, clock_type::duration timeout_latency) {
+        add_replica_read_latency(ep, std::max(d, std::chrono::duration_cast<latency_clock::duration>(timeout_latency)));
+    }
 
     static constexpr latency_clock::duration NO_LATENCY{-1};
     latency_clock::duration _max_request_latency{NO_LATENCY};
@@ -3808,11 +4015,7 @@ class speculating_read_executor : public abstract_read_executor {
                 send_request(resolver->has_data());
             }
         });
-        auto& sr = _schema->speculative_retry();
-        auto t = (sr.get_type() == speculative_retry::type::PERCENTILE) ?
-            std::min(_cf->get_coordinator_read_latency_percentile(sr.get_value()), std::chrono::milliseconds(_proxy->get_db().local().get_config().read_request_timeout_in_ms()/2)) :
-            std::chrono::milliseconds(unsigned(sr.get_value()));
-        _speculate_timer.arm(t);
+        _speculate_timer.arm(speculation_delay());
 
         // if CL + RR result in covering all replicas, getReadExecutor forces AlwaysSpeculating.  So we know
         // that the last replica in our list is "extra."
@@ -3838,6 +4041,32 @@ class speculating_read_executor : public abstract_read_executor {
     virtual void adjust_targets_for_reconciliation() override {
         _targets = used_targets();
     }
+private:
+    storage_proxy::clock_type::duration speculation_delay() {
+        auto& sr = _schema->speculative_retry();
+        if (sr.get_type() != speculative_retry::type::PERCENTILE) {
+            return std::chrono::milliseconds(unsigned(sr.get_value()));
+        }
+        storage_proxy::clock_type::duration t = _cf->get_coordinator_read_latency_percentile(sr.get_value());
+        if (_proxy->get_db().local().get_config().replica_latency_read_balancing()) {
+            // Speculate once the slowest of the contacted replicas is past
+            // the percentile of its own latencies, if all of them are known.
+            std::chrono::microseconds replicas_t{0};
+            bool all_known = true;
+            for (auto ep : boost::make_iterator_range(_targets.begin(), _targets.end() - 1)) {
+                auto ep_t = _proxy->_replica_read_latencies.get_percentile(ep, sr.get_value());
+                if (!ep_t) {
+                    all_known = false;
+                    break;
+                }
+                replicas_t = std::max(replicas_t, *ep_t);
+            }
+            if (all_known) {
+                t = replicas_t;
+            }
+        }
+        return std::min(t, storage_proxy::clock_type::duration(std::chrono::milliseconds(_proxy->get_db().local().get_config().read_request_timeout_in_ms()/2)));
+    }
 };
 
 db::read_repair_decision storage_proxy::new_read_repair_decision(const schema& s) {
@@ -3897,6 +4126,12 @@ ::shared_ptr<abstract_read_executor> storage_proxy::get_read_executor(lw_shared_
 
     size_t block_for = db::block_for(ks, cl);
     auto p = shared_from_this();
+    auto maybe_sort_by_read_latency = [&] {
+        if (retry_type == speculative_retry::type::PERCENTILE && _db.local().get_config().replica_latency_read_balancing()) {
+            _replica_read_latencies.sort(target_replicas, schema->speculative_retry().get_value());
+            tracing::trace(trace_state, "Replicas ordered by read latency: {}", target_replicas);
+        }
+    };
     // Speculative retry is disabled *OR* there are simply no extra replicas to speculate.
     if (retry_type == speculative_retry::type::NONE || block_for == all_replicas.size()
             || (repair_decision == db::read_repair_decision::DC_LOCAL && is_datacenter_local(cl) && block_for == target_replicas.size())) {
@@ -3907,6 +4142,7 @@ ::shared_ptr<abstract_read_executor> storage_proxy::get_read_executor(lw_shared_
         // CL.ALL, RRD.GLOBAL or RRD.DC_LOCAL and a single-DC.
         // We are going to contact every node anyway, so ask for 2 full data requests instead of 1, for redundancy
         // (same amount of requests in total, but we turn 1 digest request into a full blown data request).
+        maybe_sort_by_read_latency();
         return ::make_shared<always_speculating_read_executor>(schema, cf, p, cmd, std::move(pr), cl, block_for, std::move(target_replicas), std::move(trace_state), std::move(permit));
     }
 
@@ -3921,6 +4157,7 @@ ::shared_ptr<abstract_read_executor> storage_proxy::get_read_executor(lw_shared_
         }
     }
 
+    maybe_sort_by_read_latency();
     if (retry_type == speculative_retry::type::ALWAYS) {
         return ::make_shared<always_speculating_read_executor>(schema, cf, p, cmd, std::move(pr), cl, block_for, std::move(target_replicas), std::move(trace_state), std::move(permit));
     } else {// PERCENTILE or CUSTOM.
@@ -4961,6 +5198,56 @@ void storage_proxy::init_messaging_service(shared_ptr<migration_manager> mm) {
     ms.register_mutation(std::bind_front<>(receive_mutation_handler, mm, _write_smp_service_group));
     ms.register_hint_mutation(std::bind_front<>(receive_mutation_handler, mm, _hints_write_smp_service_group));
 
+    ms.register_mutations([mm, smp_grp = _write_smp_service_group] (const rpc::client_info& cinfo, rpc::opt_time_point t, std::vector<frozen_mutation> fms,
+            gms::inet_address reply_to, unsigned shard, std::vector<storage_proxy::response_id_type> response_ids, std::optional<tracing::trace_info> trace_info) {
+        auto src_addr = netw::messaging_service::get_source(cinfo);
+        // Each mutation is handled, and acknowledged, as if it came in a MUTATION message of its own.
+        return do_with(std::move(fms), std::move(response_ids), [mm, smp_grp, src_addr, t, reply_to, shard, trace_info = std::move(trace_info)]
+                (std::vector<frozen_mutation>& fms, std::vector<storage_proxy::response_id_type>& response_ids) {
+            return parallel_for_each(boost::irange<size_t>(0, fms.size()), [&fms, &response_ids, mm, smp_grp, src_addr, t, reply_to, shard, &trace_info] (size_t i) {
+                utils::UUID schema_version = fms[i].schema_version();
+                return handle_write(src_addr, *mm, t, schema_version, std::move(fms[i]), {}, reply_to, shard, response_ids[i], trace_info,
+                        /* apply_fn */ [smp_grp] (shared_ptr<storage_proxy>& p, tracing::trace_state_ptr tr_state, schema_ptr s, const frozen_mutation& m,
+                                clock_type::time_point timeout) {
+                            return p->mutate_locally(std::move(s), m, std::move(tr_state), db::commitlog::force_sync::no, timeout, smp_grp);
+                        },
+                        /* forward_fn */ [] (shared_ptr<storage_proxy>& p, netw::messaging_service::msg_addr addr, clock_type::time_point timeout, const frozen_mutation& m,
+                                gms::inet_address reply_to, unsigned shard, response_id_type response_id,
+                                std::optional<tracing::trace_info> trace_info) {
+                            // MUTATIONS are never forwarded.
+                            return make_ready_future<>();
+                        }).discard_result();
+            });
+        }).then([] {
+            return netw::messaging_service::no_wait();
+        });
+    });
+
+    ms.register_hint_mutations([&ms, mm] (const rpc::client_info& cinfo, rpc::opt_time_point t, std::vector<frozen_mutation> fms) {
+        auto src_addr = netw::messaging_service::get_source(cinfo);
+        auto sp = get_local_shared_storage_proxy();
+        sp->get_stats().received_mutations += fms.size();
+
+        storage_proxy::clock_type::time_point timeout;
+        if (!t) {
+            timeout = clock_type::now() + std::chrono::milliseconds(sp->_db.local().get_config().write_request_timeout_in_ms());
+        } else {
+            timeout = *t;
+        }
+
+        return do_with(std::vector<frozen_mutation_and_schema>(), [src_addr, timeout, fms = std::move(fms), sp = std::move(sp), &ms, mm] (std::vector<frozen_mutation_and_schema>& hints) mutable {
+            hints.reserve(fms.size());
+            return parallel_for_each(std::move(fms), [&hints, src_addr, &ms, mm] (frozen_mutation& fm) {
+                auto schema_version = fm.schema_version();
+                return mm->get_schema_for_write(schema_version, src_addr, ms).then([&hints, fm = std::move(fm)] (schema_ptr s) mutable {
+                    hints.emplace_back(frozen_mutation_and_schema{std::move(fm), std::move(s)});
+                });
+            }).then([&hints, timeout, sp = std::move(sp)] {
+                return sp->mutate_hints(std::move(hints), timeout);
+            });
+        });
+    });
+
     ms.register_paxos_learn([mm] (const rpc::client_info& cinfo, rpc::opt_time_point t, paxos::proposal decision,
             std::vector<gms::inet_address> forward, gms::inet_address reply_to, unsigned shard,
             storage_proxy::response_id_type response_id, std::optional<tracing::trace_info> trace_info) {
@@ -5215,7 +5502,9 @@ future<> storage_proxy::uninit_messaging_service() {
     return when_all_succeed(
         ms.unregister_counter_mutation(),
         ms.unregister_mutation(),
+        ms.unregister_mutations(),
         ms.unregister_hint_mutation(),
+        ms.unregister_hint_mutations(),
         ms.unregister_mutation_done(),
         ms.unregister_mutation_failed(),
         ms.unregister_read_data(),
@@ -5438,6 +5727,7 @@ future<> storage_proxy::wait_for_hints_to_be_replayed(utils::UUID operation_id,
 void storage_proxy::on_join_cluster(const gms::inet_address& endpoint) {};
 
 void storage_proxy::on_leave_cluster(const gms::inet_address& endpoint) {
+    _replica_read_latencies.remove(endpoint);
     _hints_manager.drain_for(endpoint);
     _hints_for_views_manager.drain_for(endpoint);
 }
@@ -49,6 +49,7 @@
 #include <seastar/core/distributed.hh>
 #include <seastar/core/execution_stage.hh>
 #include <seastar/core/scheduling_specific.hh>
+#include <seastar/core/timer.hh>
 #include "db/consistency_level_type.hh"
 #include "db/read_repair_decision.hh"
 #include "db/write_type.hh"
@@ -68,6 +69,7 @@
 #include "db/hints/host_filter.hh"
 #include "utils/small_vector.hh"
 #include "service/endpoint_lifecycle_subscriber.hh"
+#include "service/replica_read_latencies.hh"
 
 class reconcilable_result;
 class frozen_mutation_and_schema;
@@ -315,6 +317,9 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
     cdc_stats _cdc_stats;
 
     std::unordered_set<utils::UUID> _hint_queue_checkpoints;
+
+    replica_read_latencies _replica_read_latencies;
+    timer<lowres_clock> _replica_read_latencies_decay_timer;
 private:
     future<coordinator_query_result> query_singular(lw_shared_ptr<query::read_command> cmd,
             dht::partition_range_vector&& partition_ranges,
@@ -340,7 +345,22 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
     response_id_type create_write_response_handler(const std::tuple<lw_shared_ptr<paxos::proposal>, schema_ptr, dht::token, inet_address_vector_replica_set>& meta,
             db::consistency_level cl, db::write_type type, tracing::trace_state_ptr tr_state, service_permit permit);
     void register_cdc_operation_result_tracker(const storage_proxy::unique_response_handler_vector& ids, lw_shared_ptr<cdc::operation_result_tracker> tracker);
-    void send_to_live_endpoints(response_id_type response_id, clock_type::time_point timeout);
+    using write_handlers = std::vector<::shared_ptr<abstract_write_response_handler>>;
+    // Writes of a multi-mutation request, collected by send_to_live_endpoints()
+    // to be sent together instead of one by one.
+    struct write_batch {
+        // Writes to the local replica, applied by apply_local_writes().
+        write_handlers local;
+        // Writes to each remote replica which doesn't have to forward them
+        // to other replicas, sent by send_remote_writes(). Collected only if
+        // the cluster supports the MUTATIONS verb.
+        std::unordered_map<gms::inet_address, write_handlers> remote;
+        bool batch_remote = false;
+    };
+    void send_to_live_endpoints(response_id_type response_id, clock_type::time_point timeout, write_batch* batch = nullptr);
+    void apply_local_writes(write_handlers writes, clock_type::time_point timeout);
+    void send_remote_writes(gms::inet_address ep, write_handlers writes, clock_type::time_point timeout);
+    void handle_write_error(response_id_type response_id, gms::inet_address coordinator, size_t forward_size, write_stats& stats, std::exception_ptr eptr);
     template<typename Range>
     size_t hint_to_dead_endpoints(std::unique_ptr<mutation_holder>& mh, const Range& targets, db::write_type type, tracing::trace_state_ptr tr_state) noexcept;
     void hint_to_dead_endpoints(response_id_type, db::consistency_level);
@@ -516,6 +536,9 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
 
     future<> mutate_hint(const schema_ptr&, const frozen_mutation& m, tracing::trace_state_ptr tr_state, clock_type::time_point timeout = clock_type::time_point::max());
 
+    // Applies the hints locally, with a single cross-shard call per shard owning any of them.
+    future<> mutate_hints(std::vector<frozen_mutation_and_schema> hints, clock_type::time_point timeout);
+
     /**
     * Use this method to have these Mutations applied
     * across all replicas. This method will take care
@@ -565,6 +588,10 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
     // and use different RPC verb.
     future<> send_hint_to_endpoint(frozen_mutation_and_schema fm_a_s, gms::inet_address target);
 
+    // Send hints to a specific target with a single HINT_MUTATIONS message.
+    // The target has to be a replica of all of them. Requires the HINT_MUTATIONS_BATCH cluster feature.
+    future<> send_hints_to_endpoint(std::vector<frozen_mutation_and_schema> hints, gms::inet_address target);
+
     /**
      * Performs the truncate operatoin, which effectively deletes all data from
      * the column family cfname
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <optional>
+#include <seastar/core/future.hh>
+#include <seastar/core/io_priority_class.hh>
+
+#include "dht/i_partitioner.hh"
+#include "keys.hh"
+#include "position_in_partition.hh"
+#include "reader_permit.hh"
+#include "sstables/shared_sstable.hh"
+#include "sstables/types.hh"
+#include "tracing/trace_state.hh"
+
+namespace sstables {
+
+// Stores information about open end RT marker
+// of the lower index bound
+struct open_rt_marker {
+    position_in_partition pos;
+    tombstone tomb;
+};
+
+// Cursors over the partition index of an sstable, as used by the sstable readers.
+//
+// Implemented by index_reader, which reads the Summary and Index components,
+// and by the reader of the trie index in the Partitions component, see trie_index.hh.
+// Both have the semantics documented in index_reader.
+class abstract_index_reader {
+public:
+    struct data_file_positions_range {
+        uint64_t start;
+        std::optional<uint64_t> end;
+    };
+
+    virtual ~abstract_index_reader() = default;
+
+    virtual future<> close() noexcept = 0;
+    virtual future<> advance_to(const dht::partition_range& range) = 0;
+    virtual future<> advance_to(dht::ring_position_view pos) = 0;
+    virtual future<> advance_to(position_in_partition_view pos) = 0;
+    virtual future<> advance_to_next_partition() = 0;
+    virtual future<bool> advance_lower_and_check_if_present(
+            dht::ring_position_view key, std::optional<position_in_partition_view> pos = {}) = 0;
+    virtual bool partition_data_ready() const = 0;
+    virtual future<> read_partition_data() = 0;
+    virtual std::optional<sstables::deletion_time> partition_tombstone() = 0;
+    virtual partition_key get_partition_key() = 0;
+    virtual data_file_positions_range data_file_positions() const = 0;
+    virtual indexable_element element_kind() const = 0;
+    virtual std::optional<open_rt_marker> end_open_marker() const = 0;
+    virtual bool eof() const = 0;
+};
+
+// Returns a reader of the trie index if the sstable has one, and an index_reader otherwise.
+std::unique_ptr<abstract_index_reader> make_index_reader(shared_sstable sst, reader_permit permit,
+        const io_priority_class& pc, tracing::trace_state_ptr trace_state);
+
+}
@@ -59,7 +59,13 @@ int binary_search(const dht::i_partitioner& partitioner, const T& entries, const
         // both parts of the comparison ourselves.
         mid = low + ((high - low) >> 1);
         key_view mid_key = entries[mid].get_key();
-        auto mid_token = partitioner.get_token(mid_key);
+        dht::token mid_token;
+        if constexpr (requires { entries[mid].get_token(); }) {
+            // Don't hash the key again if the entry knows its token.
+            mid_token = entries[mid].get_token();
+        } else {
+            mid_token = partitioner.get_token(mid_key);
+        }
 
         if (token == mid_token) {
             result = sk.tri_compare(mid_key);
@@ -62,6 +62,9 @@ class column_translation {
         bool is_collection;
         bool is_counter;
         bool schema_mismatch;
+        // Cells with timestamps not greater than this were written before
+        // the column was dropped, and are discarded when read.
+        api::timestamp_type dropped_at;
     };
 
 private:
@@ -263,25 +263,31 @@ local_compression::local_compression(compressor_ptr p)
     : _compressor(std::move(p))
 {}
 
-local_compression::local_compression(const compression& c)
-    : _compressor([&c] {
-        sstring n(c.name.value.begin(), c.name.value.end());
-        return compressor::create(n, [&c, &n](const sstring& key) -> compressor::opt_string {
-            if (key == compression_parameters::CHUNK_LENGTH_KB || key == compression_parameters::CHUNK_LENGTH_KB_ERR) {
-                return to_sstring(c.chunk_len / 1024);
-            }
-            if (key == compression_parameters::CLASS || key == compression_parameters::SSTABLE_COMPRESSION_DEPRECATED) {
-                return n;
-            }
-            for (auto& o : c.options.elements) {
-                if (key == sstring(o.key.value.begin(), o.key.value.end())) {
-                    return sstring(o.value.value.begin(), o.value.value.end());
-                }
+static compressor_ptr make_compressor(const compression& c) {
+    sstring n(c.name.value.begin(), c.name.value.end());
+    return compressor::create(n, [&c, &n](const sstring& key) -> compressor::opt_string {
+        if (key == compression_parameters::CHUNK_LENGTH_KB || key == compression_parameters::CHUNK_LENGTH_KB_ERR) {
+            return to_sstring(c.chunk_len / 1024);
+        }
+        if (key == compression_parameters::CLASS || key == compression_parameters::SSTABLE_COMPRESSION_DEPRECATED) {
+            return n;
+        }
+        for (auto& o : c.options.elements) {
+            if (key == sstring(o.key.value.begin(), o.key.value.end())) {
+                return sstring(o.value.value.begin(), o.value.value.end());
             }
-            return std::nullopt;
-        });
-    }())
-{}
+        }
+        return std::nullopt;
+    });
+}
+
+local_compression::local_compression(const compression& c)
+    : _compressor(make_compressor(c))
+{
+    if (_compressor && !c.dictionary.value.empty()) {
+        _compressor = _compressor->with_dictionary(c.dictionary.value);
+    }
+}
 
 size_t local_compression::uncompress(const char* input,
                 size_t input_len, char* output, size_t output_len) const {
@@ -321,6 +327,10 @@ void compression::update(uint64_t compressed_file_length) {
 }
 
 compressor_ptr get_sstable_compressor(const compression& c) {
+    return make_compressor(c);
+}
+
+compressor_ptr make_sstable_data_compressor(const compression& c) {
     return local_compression(c).compressor();
 }
 
@@ -357,10 +367,10 @@ class compressed_file_data_source_impl : public data_source_impl {
     uint64_t _end_pos;
 public:
     compressed_file_data_source_impl(file f, sstables::compression* cm,
-                uint64_t pos, size_t len, file_input_stream_options options)
+                uint64_t pos, size_t len, file_input_stream_options options, compressor_ptr c)
             : _compression_metadata(cm)
             , _offsets(_compression_metadata->offsets.get_accessor())
-            , _compression(*cm)
+            , _compression(c ? sstables::local_compression(std::move(c)) : sstables::local_compression(*cm))
     {
         _beg_pos = pos;
         if (pos > _compression_metadata->uncompressed_file_length()) {
@@ -457,9 +467,9 @@ requires ChecksumUtils<ChecksumType>
 class compressed_file_data_source : public data_source {
 public:
     compressed_file_data_source(file f, sstables::compression* cm,
-            uint64_t offset, size_t len, file_input_stream_options options)
+            uint64_t offset, size_t len, file_input_stream_options options, compressor_ptr c)
         : data_source(std::make_unique<compressed_file_data_source_impl<ChecksumType>>(
-                std::move(f), cm, offset, len, std::move(options)))
+                std::move(f), cm, offset, len, std::move(options), std::move(c)))
         {}
 };
 
@@ -467,10 +477,10 @@ template <typename ChecksumType>
 requires ChecksumUtils<ChecksumType>
 inline input_stream<char> make_compressed_file_input_stream(
         file f, sstables::compression *cm, uint64_t offset, size_t len,
-        file_input_stream_options options)
+        file_input_stream_options options, compressor_ptr c)
 {
     return input_stream<char>(compressed_file_data_source<ChecksumType>(
-            std::move(f), cm, offset, len, std::move(options)));
+            std::move(f), cm, offset, len, std::move(options), std::move(c)));
 }
 
 // For SSTables 2.x (formats 'ka' and 'la'), the full checksum is a combination of checksums of compressed chunks.
@@ -493,17 +503,28 @@ class compressed_file_data_sink_impl : public data_sink_impl {
     sstables::local_compression _compression;
     size_t _pos = 0;
     uint32_t _full_checksum;
-public:
-    compressed_file_data_sink_impl(output_stream<char> out, sstables::compression* cm, sstables::local_compression lc)
-            : _out(std::move(out))
-            , _compression_metadata(cm)
-            , _offsets(_compression_metadata->offsets.get_writer())
-            , _compression(lc)
-            , _full_checksum(ChecksumType::init_checksum())
-    {}
+    // If the compressor uses a dictionary, the first chunks are held back
+    // until there is enough of them to train the dictionary on.
+    size_t _dictionary_sample_size;
+    size_t _dictionary_samples_size = 0;
+    std::vector<temporary_buffer<char>> _dictionary_samples;
+private:
+    future<> train_dictionary_and_flush_samples() {
+        _dictionary_sample_size = 0;
+        return _compression.compressor()->train_dictionary(_dictionary_samples).then([this] (bytes dictionary) {
+            if (!dictionary.empty()) {
+                _compression = sstables::local_compression(_compression.compressor()->with_dictionary(dictionary));
+            }
+            _compression_metadata->dictionary.value = std::move(dictionary);
+            return do_with(std::exchange(_dictionary_samples, {}), [this] (std::vector<temporary_buffer<char>>& samples) {
+                return do_for_each(samples, [this] (temporary_buffer<char>& buf) {
+                    return compress_and_write(std::move(buf));
+                });
+            });
+        });
+    }
 
-    future<> put(net::packet data) { abort(); }
-    virtual future<> put(temporary_buffer<char> buf) override {
+    future<> compress_and_write(temporary_buffer<char> buf) {
         auto output_len = _compression.compress_max_size(buf.size());
 
         // account space for checksum that goes after compressed data.
@@ -543,8 +564,33 @@ class compressed_file_data_sink_impl : public data_sink_impl {
         auto f = _out.write(compressed.get(), compressed.size());
         return f.then([compressed = std::move(compressed)] {});
     }
+public:
+    compressed_file_data_sink_impl(output_stream<char> out, sstables::compression* cm, sstables::local_compression lc, bool allow_dictionary)
+            : _out(std::move(out))
+            , _compression_metadata(cm)
+            , _offsets(_compression_metadata->offsets.get_writer())
+            , _compression(lc)
+            , _full_checksum(ChecksumType::init_checksum())
+            , _dictionary_sample_size(allow_dictionary ? lc.compressor()->dictionary_sample_size() : 0)
+    {}
+
+    future<> put(net::packet data) { abort(); }
+    virtual future<> put(temporary_buffer<char> buf) override {
+        if (!_dictionary_sample_size) {
+            return compress_and_write(std::move(buf));
+        }
+        _dictionary_samples_size += buf.size();
+        _dictionary_samples.push_back(std::move(buf));
+        if (_dictionary_samples_size < _dictionary_sample_size) {
+            return make_ready_future<>();
+        }
+        return train_dictionary_and_flush_samples();
+    }
     virtual future<> close() override {
-        return _out.close();
+        auto f = _dictionary_sample_size ? train_dictionary_and_flush_samples() : make_ready_future<>();
+        return f.then([this] {
+            return _out.close();
+        });
     }
 
     virtual size_t buffer_size() const noexcept override {
@@ -556,16 +602,17 @@ template <typename ChecksumType, compressed_checksum_mode mode>
 requires ChecksumUtils<ChecksumType>
 class compressed_file_data_sink : public data_sink {
 public:
-    compressed_file_data_sink(output_stream<char> out, sstables::compression* cm, sstables::local_compression lc)
+    compressed_file_data_sink(output_stream<char> out, sstables::compression* cm, sstables::local_compression lc, bool allow_dictionary)
         : data_sink(std::make_unique<compressed_file_data_sink_impl<ChecksumType, mode>>(
-                std::move(out), cm, std::move(lc))) {}
+                std::move(out), cm, std::move(lc), allow_dictionary)) {}
 };
 
 template <typename ChecksumType, compressed_checksum_mode mode>
 requires ChecksumUtils<ChecksumType>
 inline output_stream<char> make_compressed_file_output_stream(output_stream<char> out,
          sstables::compression* cm,
-         const compression_parameters& cp) {
+         const compression_parameters& cp,
+         bool allow_dictionary) {
     // buffer of output stream is set to chunk length, because flush must
     // happen every time a chunk was filled up.
 
@@ -577,26 +624,27 @@ inline output_stream<char> make_compressed_file_output_stream(output_stream<char
     // defaults to 1.0.
     cm->options.elements.push_back({"crc_check_chance", "1.0"});
 
-    return output_stream<char>(compressed_file_data_sink<ChecksumType, mode>(std::move(out), cm, p));
+    return output_stream<char>(compressed_file_data_sink<ChecksumType, mode>(std::move(out), cm, p, allow_dictionary));
 }
 
 input_stream<char> sstables::make_compressed_file_k_l_format_input_stream(file f,
         sstables::compression* cm, uint64_t offset, size_t len,
         class file_input_stream_options options)
 {
-    return make_compressed_file_input_stream<adler32_utils>(std::move(f), cm, offset, len, std::move(options));
+    return make_compressed_file_input_stream<adler32_utils>(std::move(f), cm, offset, len, std::move(options), nullptr);
 }
 
 input_stream<char> sstables::make_compressed_file_m_format_input_stream(file f,
         sstables::compression *cm, uint64_t offset, size_t len,
-        class file_input_stream_options options) {
-    return make_compressed_file_input_stream<crc32_utils>(std::move(f), cm, offset, len, std::move(options));
+        class file_input_stream_options options, compressor_ptr c) {
+    return make_compressed_file_input_stream<crc32_utils>(std::move(f), cm, offset, len, std::move(options), std::move(c));
 }
 
 output_stream<char> sstables::make_compressed_file_m_format_output_stream(output_stream<char> out,
         sstables::compression* cm,
-        const compression_parameters& cp) {
+        const compression_parameters& cp,
+        bool allow_dictionary) {
     return make_compressed_file_output_stream<crc32_utils, compressed_checksum_mode::checksum_all>(
-            std::move(out), cm, cp);
+            std::move(out), cm, cp, allow_dictionary);
 }
 
@@ -309,6 +309,9 @@ struct compression {
     uint32_t chunk_len = 0;
     uint64_t data_len = 0;
     segmented_offsets offsets;
+    // Stored in the CompressionDictionary component, empty if the
+    // compressor doesn't use a dictionary or it couldn't be trained.
+    disk_string<uint32_t> dictionary;
 
 private:
     // Variables *not* found in the "Compression Info" file (added by update()):
@@ -377,6 +380,9 @@ struct compression {
 // for API query only. Free function just to distinguish it from an accessor in compression
 compressor_ptr get_sstable_compressor(const compression&);
 
+// Compressor for reading the data file, using the compression dictionary if the sstable has one.
+compressor_ptr make_sstable_data_compressor(const compression&);
+
 // Note: compression_metadata is passed by reference; The caller is
 // responsible for keeping the compression_metadata alive as long as there
 // are open streams on it. This should happen naturally on a higher level -
@@ -386,13 +392,17 @@ input_stream<char> make_compressed_file_k_l_format_input_stream(file f,
                 sstables::compression* cm, uint64_t offset, size_t len,
                 class file_input_stream_options options);
 
+// If c is null, a compressor is created from cm.
 input_stream<char> make_compressed_file_m_format_input_stream(file f,
                 sstables::compression* cm, uint64_t offset, size_t len,
-                class file_input_stream_options options);
+                class file_input_stream_options options, compressor_ptr c = {});
 
+// If allow_dictionary is false, the data is compressed without a dictionary
+// even if the compressor is configured to train one.
 output_stream<char> make_compressed_file_m_format_output_stream(output_stream<char> out,
                 sstables::compression* cm,
-                const compression_parameters& cp);
+                const compression_parameters& cp,
+                bool allow_dictionary = false);
 
 }
 
@@ -31,6 +31,7 @@
 #include "sstables/scanning_clustered_index_cursor.hh"
 #include "sstables/mx/bsearch_clustered_cursor.hh"
 #include "sstables/sstables_manager.hh"
+#include "sstables/abstract_index_reader.hh"
 
 namespace sstables {
 
@@ -376,13 +377,6 @@ class index_comparator {
     }
 };
 
-// Stores information about open end RT marker
-// of the lower index bound
-struct open_rt_marker {
-    position_in_partition pos;
-    tombstone tomb;
-};
-
 // Contains information about index_reader position in the index file
 struct index_bound {
     index_bound() = default;
@@ -423,7 +417,7 @@ struct index_bound {
 // Upper cursor can only be advanced along with the lower cursor and not accessed from outside.
 //
 // If eof() then the lower bound cursor is positioned past all partitions in the sstable.
-class index_reader {
+class index_reader : public abstract_index_reader {
     shared_sstable _sstable;
     reader_permit _permit;
     const io_priority_class& _pc;
@@ -746,9 +740,19 @@ class index_reader {
         sstlog.trace("index {}: index_reader for {}", fmt::ptr(this), _sstable->get_filename());
     }
 
+    // Loads the index page for given summary entry into the partition index cache.
+    // Doesn't move the cursors.
+    future<> prefetch_page(uint64_t summary_idx) {
+        return do_with(index_bound(), [this, summary_idx] (index_bound& bound) {
+            return advance_to_page(bound, summary_idx).finally([&bound] {
+                return close(bound);
+            });
+        });
+    }
+
     // Ensures that partition_data_ready() returns true.
     // Can be called only when !eof()
-    future<> read_partition_data() {
+    future<> read_partition_data() override {
         assert(!eof());
         if (partition_data_ready(_lower_bound)) {
             return make_ready_future<>();
@@ -759,7 +763,7 @@ class index_reader {
     }
 
     // Advance index_reader bounds to the bounds of the supplied range
-    future<> advance_to(const dht::partition_range& range) {
+    future<> advance_to(const dht::partition_range& range) override {
         return seastar::when_all_succeed(
             advance_lower_to_start(range),
             advance_upper_to_end(range)).discard_result();
@@ -807,13 +811,13 @@ class index_reader {
     // Returns tombstone for the current partition if it was recorded in the sstable.
     // It may be unavailable for old sstables for which this information was not generated.
     // Can be called only when partition_data_ready().
-    std::optional<sstables::deletion_time> partition_tombstone() {
+    std::optional<sstables::deletion_time> partition_tombstone() override {
         return current_partition_entry(_lower_bound).get_deletion_time();
     }
 
     // Returns the key for current partition.
     // Can be called only when partition_data_ready().
-    partition_key get_partition_key() {
+    partition_key get_partition_key() override {
         return _alloc_section(_region, [this] {
             index_entry& e = current_partition_entry(_lower_bound);
             return e.get_key().to_partition_key(*_sstable->_schema);
@@ -834,7 +838,7 @@ class index_reader {
         return e.get_promoted_index_size();
     }
 
-    bool partition_data_ready() const {
+    bool partition_data_ready() const override {
         return partition_data_ready(_lower_bound);
     }
 
@@ -846,7 +850,7 @@ class index_reader {
     //
     // Must be called for non-decreasing positions.
     // Must be called only after advanced to some partition and !eof().
-    future<> advance_to(position_in_partition_view pos) {
+    future<> advance_to(position_in_partition_view pos) override {
         sstlog.trace("index {}: advance_to({}), current data_file_pos={}",
                  fmt::ptr(this), pos, _lower_bound.data_file_position);
 
@@ -892,7 +896,7 @@ class index_reader {
     // Like advance_to(dht::ring_position_view), but returns information whether the key was found
     // If upper_bound is provided, the upper bound within position is looked up
     future<bool> advance_lower_and_check_if_present(
-            dht::ring_position_view key, std::optional<position_in_partition_view> pos = {}) {
+            dht::ring_position_view key, std::optional<position_in_partition_view> pos = {}) override {
         return advance_to(_lower_bound, key).then([this, key, pos] {
             if (eof()) {
                 return make_ready_future<bool>(false);
@@ -915,24 +919,19 @@ class index_reader {
 
     // Moves the cursor to the beginning of next partition.
     // Can be called only when !eof().
-    future<> advance_to_next_partition() {
+    future<> advance_to_next_partition() override {
         return advance_to_next_partition(_lower_bound);
     }
 
     // Positions the cursor on the first partition which is not smaller than pos (like std::lower_bound).
     // Must be called for non-decreasing positions.
-    future<> advance_to(dht::ring_position_view pos) {
+    future<> advance_to(dht::ring_position_view pos) override {
         return advance_to(_lower_bound, pos);
     }
 
-    struct data_file_positions_range {
-        uint64_t start;
-        std::optional<uint64_t> end;
-    };
-
     // Returns positions in the data file of the cursor.
     // End position may be unset
-    data_file_positions_range data_file_positions() const {
+    data_file_positions_range data_file_positions() const override {
         data_file_positions_range result;
         result.start = _lower_bound.data_file_position;
         if (_upper_bound) {
@@ -942,21 +941,21 @@ class index_reader {
     }
 
     // Returns the kind of sstable element the cursor is pointing at.
-    indexable_element element_kind() const {
+    indexable_element element_kind() const override {
         return _lower_bound.element;
     }
 
-    std::optional<open_rt_marker> end_open_marker() const {
+    std::optional<open_rt_marker> end_open_marker() const override {
         return _lower_bound.end_open_marker;
     }
 
-    bool eof() const {
+    bool eof() const override {
         return _lower_bound.data_file_position == data_file_end();
     }
 
     const shared_sstable& sstable() const { return _sstable; }
 
-    future<> close() noexcept {
+    future<> close() noexcept override {
         // index_bound::close must not fail
         return close(_lower_bound).then([this] {
             if (_upper_bound) {
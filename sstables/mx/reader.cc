@@ -543,6 +543,19 @@ class data_consume_rows_context_m : public data_consumer::continuous_data_consum
             }
             if (!_column_flags.has_value()) {
                 _column_value = fragmented_temporary_buffer();
+            } else if (_column_timestamp <= get_column_info().dropped_at) {
+                // The cell was written before its column was dropped and the consumer
+                // will discard it, so skip over the value instead of copying it.
+                _column_value = fragmented_temporary_buffer();
+                if (auto len = get_column_value_length()) {
+                    _u64 = *len;
+                } else {
+                    co_yield read_unsigned_vint(*_processing_data);
+                }
+                auto maybe_skip_bytes = skip(*_processing_data, _u64);
+                if (std::holds_alternative<skip_bytes>(maybe_skip_bytes)) {
+                    co_yield maybe_skip_bytes;
+                }
             } else {
                 read_status status = read_status::waiting;
                 if (auto len = get_column_value_length()) {
@@ -1260,7 +1273,7 @@ class mx_sstable_mutation_reader : public mp_row_consumer_reader_mx {
     bool _will_likely_slice = false;
     bool _read_enabled = true;
     std::unique_ptr<DataConsumeRowsContext> _context;
-    std::unique_ptr<index_reader> _index_reader;
+    std::unique_ptr<abstract_index_reader> _index_reader;
     // We avoid unnecessary lookup for single partition reads thanks to this flag
     bool _single_partition_read = false;
     const dht::partition_range& _pr;
@@ -1306,9 +1319,9 @@ class mx_sstable_mutation_reader : public mp_row_consumer_reader_mx {
         return (!slice.default_row_ranges().empty() && !slice.default_row_ranges()[0].is_full())
                || slice.get_specific_ranges();
     }
-    index_reader& get_index_reader() {
+    abstract_index_reader& get_index_reader() {
         if (!_index_reader) {
-            _index_reader = std::make_unique<index_reader>(_sst, _consumer.permit(), _consumer.io_priority(), _consumer.trace_state());
+            _index_reader = make_index_reader(_sst, _consumer.permit(), _consumer.io_priority(), _consumer.trace_state());
         }
         return *_index_reader;
     }
@@ -1419,7 +1432,7 @@ class mx_sstable_mutation_reader : public mp_row_consumer_reader_mx {
             return make_ready_future();
         }().then([this, pos] {
             return get_index_reader().advance_to(*pos).then([this] {
-                index_reader& idx = *_index_reader;
+                abstract_index_reader& idx = *_index_reader;
                 auto index_position = idx.data_file_positions();
                 if (index_position.start <= _context->position()) {
                     return make_ready_future<>();
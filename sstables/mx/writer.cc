@@ -21,6 +21,7 @@
 
 #include "sstables/mx/writer.hh"
 #include "sstables/writer.hh"
+#include "sstables/trie_index.hh"
 #include "encoding_stats.hh"
 #include "schema.hh"
 #include "mutation_fragment.hh"
@@ -544,6 +545,9 @@ class writer : public sstable_writer::writer_impl {
     bool _compression_enabled = false;
     std::unique_ptr<file_writer> _data_writer;
     std::unique_ptr<file_writer> _index_writer;
+    // Only when the sstable has the Partitions component.
+    std::unique_ptr<file_writer> _partitions_writer;
+    std::optional<trie_index_writer> _trie_writer;
     bool _tombstone_written = false;
     bool _static_row_written = false;
     // The length of partition header (partition key, partition deletion and static row, if present)
@@ -552,6 +556,7 @@ class writer : public sstable_writer::writer_impl {
     uint64_t _partition_header_length = 0;
     uint64_t _prev_row_start = 0;
     std::optional<key> _partition_key;
+    dht::token _partition_token;
     std::optional<key> _first_key, _last_key;
     index_sampling_state _index_sampling_state;
     reader_concurrency_semaphore _semaphore;
@@ -604,6 +609,14 @@ class writer : public sstable_writer::writer_impl {
 
     void init_file_writers();
 
+    utils::filter_format filter_format() const {
+        return _cfg.allow_split_block_bloom_filter ? _schema.bloom_filter_format() : utils::filter_format::m_format;
+    }
+
+    bool trie_index() const {
+        return _cfg.allow_trie_index && _schema.get_sstable_index_format() == sstable_index_format::trie;
+    }
+
     // Returns the closed writer
     std::unique_ptr<file_writer> close_writer(std::unique_ptr<file_writer>& w);
 
@@ -733,7 +746,8 @@ class writer : public sstable_writer::writer_impl {
         _prev_row_start = pos;
         maybe_add_pi_block();
     }
-    void write_promoted_index();
+    // Returns where the promoted index was written, if it was.
+    std::optional<trie_index_writer::promoted_index_info> write_promoted_index();
     void consume(rt_marker&& marker);
 
     // Must be called in a seastar thread.
@@ -793,7 +807,7 @@ class writer : public sstable_writer::writer_impl {
         // exactly what callers used to do anyway.
         estimated_partitions = std::max(uint64_t(1), estimated_partitions);
 
-        _sst.generate_toc(_schema.get_compressor_params().get_compressor(), _schema.bloom_filter_fp_chance());
+        _sst.generate_toc(_schema.get_compressor_params().get_compressor(), _schema.bloom_filter_fp_chance(), _cfg.allow_compression_dictionary, trie_index());
         _sst.write_toc(_pc);
         _sst.create_data().get();
         _compression_enabled = !_sst.has_component(component_type::CRC);
@@ -801,7 +815,7 @@ class writer : public sstable_writer::writer_impl {
         _sst._shards = { shard };
 
         _cfg.monitor->on_write_started(_data_writer->offset_tracker());
-        _sst._components->filter = utils::i_filter::get_filter(estimated_partitions, _schema.bloom_filter_fp_chance(), utils::filter_format::m_format);
+        _sst._components->filter = utils::i_filter::get_filter(estimated_partitions, _schema.bloom_filter_fp_chance(), filter_format());
         _pi_write_m.desired_block_size = cfg.promoted_index_block_size;
         _index_sampling_state.summary_byte_cost = _cfg.summary_byte_cost;
         prepare_summary(_sst._components->summary, estimated_partitions, _schema.min_index_interval());
@@ -832,6 +846,7 @@ writer::~writer() {
             }
         }
     };
+    close_writer(_partitions_writer);
     close_writer(_index_writer);
     close_writer(_data_writer);
     _range_tombstones.reset();
@@ -893,7 +908,12 @@ void writer::init_file_writers() {
             make_compressed_file_m_format_output_stream(
                 std::move(out),
                 &_sst._components->compression,
-                _schema.get_compressor_params()), _sst.filename(component_type::Data));
+                _schema.get_compressor_params(),
+                _cfg.allow_compression_dictionary), _sst.filename(component_type::Data));
+    }
+    if (_sst.has_component(component_type::Partitions)) {
+        _partitions_writer = std::make_unique<file_writer>(_sst.make_component_file_writer(component_type::Partitions, options).get0());
+        _trie_writer.emplace(*_partitions_writer);
     }
     auto w = file_writer::make(std::move(_sst._index_file), std::move(options), _sst.filename(component_type::Index));
     _index_writer = std::make_unique<file_writer>(w.get0());
@@ -995,6 +1015,7 @@ void writer::consume_new_partition(const dht::decorated_key& dk) {
     _prev_row_start = _data_writer->offset();
 
     _partition_key = key::from_partition_key(_schema, dk.key());
+    _partition_token = dk.token();
     maybe_add_summary_entry(dk.token(), bytes_view(*_partition_key));
 
     _sst._components->filter->add(bytes_view(*_partition_key));
@@ -1390,10 +1411,10 @@ static void write_clustering_prefix(sstable_version_types v, W& writer, bound_ki
     write_clustering_prefix(v, writer, s, clustering, is_ephemerally_full);
 }
 
-void writer::write_promoted_index() {
+std::optional<trie_index_writer::promoted_index_info> writer::write_promoted_index() {
     if (_pi_write_m.promoted_index_size < 2) {
         write_vint(*_index_writer, uint64_t(0));
-        return;
+        return std::nullopt;
     }
     write_vint(_tmp_bufs, _partition_header_length);
     write(_sst.get_version(), _tmp_bufs, to_deletion_time(_pi_write_m.tomb));
@@ -1401,8 +1422,11 @@ void writer::write_promoted_index() {
     uint64_t pi_size = _tmp_bufs.size() + _pi_write_m.blocks.size() + _pi_write_m.offsets.size();
     write_vint(*_index_writer, pi_size);
     flush_tmp_bufs(*_index_writer);
+    trie_index_writer::promoted_index_info info{to_deletion_time(_pi_write_m.tomb), _index_writer->offset(),
+            _pi_write_m.blocks.size() + _pi_write_m.offsets.size(), _pi_write_m.promoted_index_size};
     write(_sst.get_version(), *_index_writer, _pi_write_m.blocks);
     write(_sst.get_version(), *_index_writer, _pi_write_m.offsets);
+    return info;
 }
 
 void writer::write_pi_block(const pi_block& block) {
@@ -1457,7 +1481,10 @@ stop_iteration writer::consume_end_of_partition() {
         add_pi_block();
     }
 
-    write_promoted_index();
+    auto pi = write_promoted_index();
+    if (_trie_writer) {
+        _trie_writer->add(_partition_token, bytes_view(*_partition_key), _c_stats.start_offset, pi);
+    }
 
     // compute size of the current row.
     _c_stats.partition_size = _data_writer->offset() - _c_stats.start_offset;
@@ -1483,23 +1510,32 @@ void writer::consume_end_of_stream() {
 
     seal_summary(_sst._components->summary, std::move(_first_key), std::move(_last_key), _index_sampling_state).get();
 
+    // Closing the data writer flushes the chunks the compressor may have held back,
+    // so it has to happen before the compression ratio is computed.
+    close_data_writer();
     if (_sst.has_component(component_type::CompressionInfo)) {
         _collector.add_compression_ratio(_sst._components->compression.compressed_file_length(), _sst._components->compression.uncompressed_file_length());
     }
 
     close_writer(_index_writer);
+    if (_trie_writer) {
+        _trie_writer->finish();
+        close_writer(_partitions_writer);
+    }
     _sst.set_first_and_last_keys();
 
     _sst._components->statistics.contents[metadata_type::Serialization] = std::make_unique<serialization_header>(std::move(_sst_schema.header));
     seal_statistics(_sst.get_version(), _sst._components->statistics, _collector, _sst.compaction_ancestors(),
         _sst._schema->get_partitioner().name(), _schema.bloom_filter_fp_chance(),
         _sst._schema, _sst.get_first_decorated_key(), _sst.get_last_decorated_key(), _enc_stats);
-    close_data_writer();
     _sst.write_summary(_pc);
     _sst.write_filter(_pc);
     _sst.write_statistics(_pc);
     _sst.write_compression(_pc);
     auto features = sstable_enabled_features::all();
+    if (filter_format() != utils::filter_format::split_block_format) {
+        features.disable(sstable_feature::SplitBlockBloomFilter);
+    }
     run_identifier identifier{_run_identifier};
     std::optional<scylla_metadata::large_data_stats> ld_stats(std::move(_large_data_stats));
     _sst.write_scylla_metadata(_pc, _shard, std::move(features), std::move(identifier), std::move(ld_stats), _cfg.origin);
@@ -260,6 +260,31 @@ class partition_index_cache {
 
     static const stats& shard_stats() { return _shard_stats; }
 
+    // Returns keys of the loaded entries which are currently referenced, in key order.
+    // They are not linked in the LRU until released.
+    std::vector<key_type> referenced_keys() const {
+        std::vector<key_type> keys;
+        logalloc::reclaim_lock rl(_region);
+        for (auto i = _cache.begin(); i != _cache.end(); ++i) {
+            if (i->ready() && i->is_referenced()) {
+                keys.push_back(i->key());
+            }
+        }
+        return keys;
+    }
+
+    // If e is an entry of a partition index cache linked in the LRU, returns
+    // that cache and the key of the entry. Walking the LRU with this gives
+    // the loaded entries from the most recently used one, so the result can be
+    // used to warm up the cache after it's recreated.
+    static std::optional<std::pair<const partition_index_cache*, key_type>> lru_entry(const evictable& e) {
+        auto* ep = dynamic_cast<const entry*>(&e);
+        if (!ep || !ep->ready()) {
+            return std::nullopt;
+        }
+        return std::make_pair(ep->_parent, ep->key());
+    }
+
     // Evicts all unreferenced entries.
     future<> evict_gently() {
         auto i = _cache.begin();
@@ -143,8 +143,9 @@ inline std::unique_ptr<DataConsumeRowsContext> data_consume_rows(const schema& s
     // This potentially enables read-ahead beyond end, until last_end, which
     // can be beneficial if the user wants to fast_forward_to() on the
     // returned context, and may make small skips.
+    auto& history = consumer.permit().is_sequential_scan() ? sst->_sequential_scan_history : sst->_partition_range_history;
     auto input = sst->data_stream(toread.start, last_end - toread.start, consumer.io_priority(),
-            consumer.permit(), consumer.trace_state(), sst->_partition_range_history);
+            consumer.permit(), consumer.trace_state(), history);
     return std::make_unique<DataConsumeRowsContext>(s, std::move(sst), consumer, std::move(input), toread.start, toread.end - toread.start);
 }
 
@@ -187,7 +188,7 @@ concept RowConsumer =
  * For other consumers, it is a no-op.
  */
 template <typename Consumer>
-void set_range_tombstone_start_from_end_open_marker(Consumer& c, const schema& s, const index_reader& idx) {
+void set_range_tombstone_start_from_end_open_marker(Consumer& c, const schema& s, const abstract_index_reader& idx) {
     if constexpr (Consumer::is_setting_range_tombstone_start_supported) {
         auto open_end_marker = idx.end_open_marker();
         if (open_end_marker) {
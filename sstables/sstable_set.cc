@@ -28,6 +28,7 @@
 #include "compaction/compaction_strategy_impl.hh"
 #include "compaction/leveled_compaction_strategy.hh"
 #include "compaction/time_window_compaction_strategy.hh"
+#include "compaction/incremental_compaction_strategy.hh"
 
 #include "sstable_set_impl.hh"
 
@@ -574,6 +575,12 @@ std::unique_ptr<sstable_set_impl> time_window_compaction_strategy::make_sstable_
     return std::make_unique<time_series_sstable_set>(std::move(schema));
 }
 
+std::unique_ptr<sstable_set_impl> incremental_compaction_strategy::make_sstable_set(schema_ptr schema) const {
+    // Fragments of a run are disjoint, so all of them go to the interval map,
+    // regardless of their level, to avoid reading every fragment of every run.
+    return std::make_unique<partitioned_sstable_set>(std::move(schema), make_lw_shared<sstable_list>(), false);
+}
+
 sstable_set make_partitioned_sstable_set(schema_ptr schema, lw_shared_ptr<sstable_list> all, bool use_level_metadata) {
     return sstable_set(std::make_unique<partitioned_sstable_set>(schema, std::move(all), use_level_metadata), schema);
 }
@@ -559,8 +559,7 @@ future<> parse(const schema& schema, sstable_version_types v, random_access_read
                         // position is little-endian encoded
                         auto position = seastar::read_le<uint64_t>(buf.get());
                         auto token = schema.get_partitioner().get_token(key_view(key_data));
-                        s.add_summary_data(token.data());
-                        s.entries.push_back({ token, key_data, position });
+                        s.entries.push_back({ token.raw(), key_data, position });
                         return make_ready_future<>();
                     });
                 });
@@ -897,7 +896,7 @@ future<> sstable::read_toc() noexcept {
 
 }
 
-void sstable::generate_toc(compressor_ptr c, double filter_fp_chance) {
+void sstable::generate_toc(compressor_ptr c, double filter_fp_chance, bool allow_compression_dictionary, bool trie_index) {
     // Creating table of components.
     _recognized_components.insert(component_type::TOC);
     _recognized_components.insert(component_type::Statistics);
@@ -912,8 +911,14 @@ void sstable::generate_toc(compressor_ptr c, double filter_fp_chance) {
         _recognized_components.insert(component_type::CRC);
     } else {
         _recognized_components.insert(component_type::CompressionInfo);
+        if (allow_compression_dictionary && c->dictionary_sample_size()) {
+            _recognized_components.insert(component_type::CompressionDictionary);
+        }
     }
     _recognized_components.insert(component_type::Scylla);
+    if (trie_index) {
+        _recognized_components.insert(component_type::Partitions);
+    }
 }
 
 file_writer::~file_writer() {
@@ -1131,7 +1136,12 @@ future<> sstable::read_compression(const io_priority_class& pc) {
         return make_ready_future<>();
     }
 
-    return read_simple<component_type::CompressionInfo>(_components->compression, pc);
+    return read_simple<component_type::CompressionInfo>(_components->compression, pc).then([this, &pc] {
+        if (!has_component(component_type::CompressionDictionary)) {
+            return make_ready_future<>();
+        }
+        return read_simple<component_type::CompressionDictionary>(_components->compression.dictionary, pc);
+    });
 }
 
 void sstable::write_compression(const io_priority_class& pc) {
@@ -1140,6 +1150,16 @@ void sstable::write_compression(const io_priority_class& pc) {
     }
 
     write_simple<component_type::CompressionInfo>(_components->compression, pc);
+    if (has_component(component_type::CompressionDictionary)) {
+        write_simple<component_type::CompressionDictionary>(_components->compression.dictionary, pc);
+    }
+}
+
+const compressor_ptr& sstable::get_data_compressor() {
+    if (!_data_compressor) {
+        _data_compressor = make_sstable_data_compressor(_components->compression);
+    }
+    return _data_compressor;
 }
 
 void sstable::validate_partitioner() {
@@ -1353,6 +1373,22 @@ future<> sstable::update_info_for_opened_data() {
                                                                    _index_file_size);
             _index_file = make_cached_seastar_file(*_cached_index_file);
         });
+    }).then([this] {
+        if (!this->has_component(component_type::Partitions)) {
+            return make_ready_future<>();
+        }
+        return open_file(component_type::Partitions, open_flags::ro).then([this] (file f) {
+            _partitions_file = std::move(f);
+            return _partitions_file.size();
+        }).then([this] (uint64_t size) {
+            assert(!_cached_partitions_file);
+            _cached_partitions_file = seastar::make_shared<cached_file>(_partitions_file,
+                                                                        index_page_cache_metrics,
+                                                                        _manager.get_cache_tracker().get_lru(),
+                                                                        _manager.get_cache_tracker().region(),
+                                                                        size);
+            _partitions_file = make_cached_seastar_file(*_cached_partitions_file);
+        });
     }).then([this] {
         if (this->has_component(component_type::Filter)) {
             return io_check([&] {
@@ -1399,9 +1435,39 @@ future<> sstable::create_data() noexcept {
 future<> sstable::drop_caches() {
     return _cached_index_file->evict_gently().then([this] {
         return _index_cache->evict_gently();
+    }).then([this] {
+        if (_cached_partitions_file) {
+            return _cached_partitions_file->evict_gently();
+        }
+        return make_ready_future<>();
     });
 }
 
+const partition_index_cache& sstable::get_index_cache() const {
+    return *_index_cache;
+}
+
+future<> sstable::prefetch_index_pages(std::vector<uint64_t> summary_indexes, reader_permit permit, const io_priority_class& pc) {
+    std::sort(summary_indexes.begin(), summary_indexes.end());
+    auto summary_size = get_summary().header.size;
+    auto ir = std::make_unique<index_reader>(shared_from_this(), std::move(permit), pc, tracing::trace_state_ptr());
+    std::exception_ptr ex;
+    try {
+        for (auto summary_idx : summary_indexes) {
+            if (summary_idx >= summary_size) {
+                break;
+            }
+            co_await ir->prefetch_page(summary_idx);
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await ir->close();
+    if (ex) {
+        std::rethrow_exception(std::move(ex));
+    }
+}
+
 future<> sstable::read_filter(const io_priority_class& pc) {
     if (!has_component(component_type::Filter)) {
         _components->filter = std::make_unique<utils::filter::always_present_filter>();
@@ -1413,10 +1479,16 @@ future<> sstable::read_filter(const io_priority_class& pc) {
         read_simple<component_type::Filter>(filter, pc).get();
         auto nr_bits = filter.buckets.elements.size() * std::numeric_limits<typename decltype(filter.buckets.elements)::value_type>::digits;
         large_bitset bs(nr_bits, std::move(filter.buckets.elements));
-        utils::filter_format format = (_version >= sstable_version_types::mc)
-                                      ? utils::filter_format::m_format
-                                      : utils::filter_format::k_l_format;
-        _components->filter = utils::filter::create_filter(filter.hashes, std::move(bs), format);
+        utils::filter_format fformat = (_version >= sstable_version_types::mc)
+                                       ? utils::filter_format::m_format
+                                       : utils::filter_format::k_l_format;
+        if (has_scylla_component() && features().is_enabled(sstable_feature::SplitBlockBloomFilter)) {
+            if (nr_bits == 0 || nr_bits % utils::filter::split_block_bloom_filter::bits_per_block) {
+                throw malformed_sstable_exception(format("Split block bloom filter of {} bits is not made of whole blocks", nr_bits), filename(component_type::Filter));
+            }
+            fformat = utils::filter_format::split_block_format;
+        }
+        _components->filter = utils::filter::create_filter(filter.hashes, std::move(bs), fformat);
     });
 }
 
@@ -1425,7 +1497,7 @@ void sstable::write_filter(const io_priority_class& pc) {
         return;
     }
 
-    auto f = static_cast<utils::filter::murmur3_bloom_filter *>(_components->filter.get());
+    auto f = static_cast<utils::filter::bloom_filter *>(_components->filter.get());
 
     auto&& bs = f->bits();
     auto filter_ref = sstables::filter_ref(f->num_hashes(), bs.get_storage());
@@ -1599,9 +1671,8 @@ void maybe_add_summary_entry(summary& s, const dht::token& token, bytes_view key
     if (data_offset >= state.next_data_offset_to_write_summary) {
         auto entry_size = 8 + 2 + key.size();  // offset + key_size.size + key.size
         state.next_data_offset_to_write_summary += state.summary_byte_cost * entry_size;
-        s.add_summary_data(token.data());
         auto key_data = s.add_summary_data(key);
-        s.entries.push_back({ token, key_data, index_offset });
+        s.entries.push_back({ token.raw(), key_data, index_offset });
     }
 }
 
@@ -2225,6 +2296,13 @@ input_stream<char> sstable::data_stream(uint64_t pos, size_t len, const io_prior
     options.buffer_size = sstable_buffer_size;
     options.io_priority_class = pc;
     options.read_ahead = 4;
+    if (permit.is_sequential_scan()) {
+        // Fewer, larger requests, so that scanning cold data is bound by
+        // disk bandwidth. The memory in flight per sstable grows from
+        // 5 to 3 times the (larger) buffer size.
+        options.buffer_size = std::max(sstable_buffer_size, sequential_scan_buffer_size);
+        options.read_ahead = 2;
+    }
     options.dynamic_adjustments = std::move(history);
 
     file f = make_tracked_file(_data_file, std::move(permit));
@@ -2236,7 +2314,7 @@ input_stream<char> sstable::data_stream(uint64_t pos, size_t len, const io_prior
     if (_components->compression) {
         if (_version >= sstable_version_types::mc) {
              return make_compressed_file_m_format_input_stream(f, &_components->compression,
-                pos, len, std::move(options));
+                pos, len, std::move(options), get_data_compressor());
         } else {
             return make_compressed_file_k_l_format_input_stream(f, &_components->compression,
                 pos, len, std::move(options));
@@ -2355,6 +2433,29 @@ future<> sstable::mutate_sstable_level(uint32_t new_level) {
     });
 }
 
+future<> sstable::mutate_repaired_at(uint64_t repaired_at) {
+    auto entry = _components->statistics.contents.find(metadata_type::Stats);
+    if (!has_component(component_type::Statistics) || entry == _components->statistics.contents.end()) {
+        return make_exception_future<>(std::runtime_error(format("Cannot set repaired_at of {}: no stats metadata", get_filename())));
+    }
+
+    auto& p = entry->second;
+    if (!p) {
+        throw std::runtime_error("Statistics is malformed");
+    }
+    stats_metadata& s = *static_cast<stats_metadata *>(p.get());
+    if (s.repaired_at == repaired_at) {
+        return make_ready_future<>();
+    }
+
+    sstlog.debug("set repaired_at of {} from {} to {}", get_filename(), s.repaired_at, repaired_at);
+    s.repaired_at = repaired_at;
+    // See mutate_sstable_level()
+    return seastar::async([this] {
+        rewrite_statistics(default_priority_class());
+    });
+}
+
 int sstable::compare_by_max_timestamp(const sstable& other) const {
     auto ts1 = get_stats_metadata().max_timestamp;
     auto ts2 = other.get_stats_metadata().max_timestamp;
@@ -2369,6 +2470,13 @@ future<> sstable::close_files() {
             general_disk_error();
         });
     }
+    auto partitions_closed = make_ready_future<>();
+    if (_partitions_file) {
+        partitions_closed = _partitions_file.close().handle_exception([me = shared_from_this()] (auto ep) {
+            sstlog.warn("sstable close partitions_file failed: {}", ep);
+            general_disk_error();
+        });
+    }
     auto data_closed = make_ready_future<>();
     if (_data_file) {
         data_closed = _data_file.close().handle_exception([me = shared_from_this()] (auto ep) {
@@ -2401,7 +2509,7 @@ future<> sstable::close_files() {
 
     _on_closed(*this);
 
-    return when_all_succeed(std::move(index_closed), std::move(data_closed), std::move(unlinked)).discard_result().then([this] {
+    return when_all_succeed(std::move(index_closed), std::move(partitions_closed), std::move(data_closed), std::move(unlinked)).discard_result().then([this] {
         if (_open_mode) {
             if (_open_mode.value() == open_flags::ro) {
                 _stats.on_close_for_reading();
@@ -2701,7 +2809,7 @@ future<bool> sstable::has_partition_key(const utils::hashed_key& hk, const dht::
     std::exception_ptr ex;
     auto sem = reader_concurrency_semaphore(reader_concurrency_semaphore::no_limits{}, "sstables::has_partition_key()");
     try {
-        auto lh_index_ptr = std::make_unique<sstables::index_reader>(s, sem.make_tracking_only_permit(_schema.get(), s->get_filename()), default_priority_class(), tracing::trace_state_ptr());
+        auto lh_index_ptr = make_index_reader(s, sem.make_tracking_only_permit(_schema.get(), s->get_filename()), default_priority_class(), tracing::trace_state_ptr());
         present = co_await lh_index_ptr->advance_lower_and_check_if_present(dk);
     } catch (...) {
         ex = std::current_exception();
@@ -3032,6 +3140,11 @@ future<> sstable::destroy() {
             } else {
                 return make_ready_future<>();
             }
+        }).then([this] {
+            if (_cached_partitions_file) {
+                return _cached_partitions_file->evict_gently();
+            }
+            return make_ready_future<>();
         });
     });
 }
@@ -3063,6 +3176,8 @@ std::ostream& operator<<(std::ostream& out, const sstables::component_type& comp
     case ct::TemporaryTOC: out << "TemporaryTOC"; break;
     case ct::TemporaryStatistics: out << "TemporaryStatistics"; break;
     case ct::Scylla: out << "Scylla"; break;
+    case ct::CompressionDictionary: out << "CompressionDictionary"; break;
+    case ct::Partitions: out << "Partitions"; break;
     case ct::Unknown: out << "Unknown"; break;
     }
     return out;
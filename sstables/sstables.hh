@@ -116,10 +116,24 @@ struct sstable_writer_config {
     mutation_fragment_stream_validation_level validation_level;
     std::optional<db::replay_position> replay_position;
     std::optional<int> sstable_level;
+    // Time (in milliseconds since the epoch) of the repair the written data
+    // was verified by, 0 if it is unrepaired.
+    uint64_t repaired_at = 0;
     write_monitor* monitor = &default_write_monitor();
     utils::UUID run_identifier = utils::make_random_uuid();
     size_t summary_byte_cost;
     sstring origin;
+    // Whether the schema's bloom_filter_format may be used. Otherwise, a standard
+    // bloom filter is written, as some nodes may not be able to read other kinds.
+    bool allow_split_block_bloom_filter = false;
+    // Whether the data may be compressed with a dictionary trained for the
+    // sstable, stored in a CompressionDictionary component which some nodes
+    // may not be able to read.
+    bool allow_compression_dictionary = false;
+    // Whether the schema's sstable_index_format may be used. Otherwise, only the
+    // Summary and Index components are written, as some nodes may not be able to
+    // read the Partitions component.
+    bool allow_trie_index = false;
 
 private:
     explicit sstable_writer_config() {}
@@ -306,6 +320,10 @@ class sstable : public enable_lw_shared_from_this<sstable> {
         return _version;
     }
 
+    format_types get_format() const {
+        return _format;
+    }
+
     // Returns the total bytes of all components.
     uint64_t bytes_on_disk() const;
 
@@ -459,6 +477,9 @@ class sstable : public enable_lw_shared_from_this<sstable> {
     std::vector<sstring> _unrecognized_components;
 
     foreign_ptr<lw_shared_ptr<shareable_components>> _components = make_foreign(make_lw_shared<shareable_components>());
+    // Decompresses the data file. Created on first read, so that compressors
+    // with expensive state, e.g. a digested dictionary, are not rebuilt per reader.
+    compressor_ptr _data_compressor;
     column_translation _column_translation;
     std::optional<open_flags> _open_mode;
     // _compaction_ancestors track which sstable generations were used to generate this sstable.
@@ -466,6 +487,9 @@ class sstable : public enable_lw_shared_from_this<sstable> {
     std::set<int> _compaction_ancestors;
     file _index_file;
     seastar::shared_ptr<cached_file> _cached_index_file;
+    // The trie index, opened if has_component(component_type::Partitions).
+    file _partitions_file;
+    seastar::shared_ptr<cached_file> _cached_partitions_file;
     file _data_file;
     uint64_t _data_file_size;
     uint64_t _index_file_size;
@@ -481,6 +505,9 @@ class sstable : public enable_lw_shared_from_this<sstable> {
 
     lw_shared_ptr<file_input_stream_history> _single_partition_history = make_lw_shared<file_input_stream_history>();
     lw_shared_ptr<file_input_stream_history> _partition_range_history = make_lw_shared<file_input_stream_history>();
+    // Kept apart from _partition_range_history so that the read-ahead of
+    // sequential scans does not adapt to that of user range scans.
+    lw_shared_ptr<file_input_stream_history> _sequential_scan_history = make_lw_shared<file_input_stream_history>();
     lw_shared_ptr<file_input_stream_history> _index_history = make_lw_shared<file_input_stream_history>();
 
     schema_ptr _schema;
@@ -547,12 +574,13 @@ class sstable : public enable_lw_shared_from_this<sstable> {
     future<> touch_temp_dir();
     future<> remove_temp_dir();
 
-    void generate_toc(compressor_ptr c, double filter_fp_chance);
+    void generate_toc(compressor_ptr c, double filter_fp_chance, bool allow_compression_dictionary, bool trie_index);
     void write_toc(const io_priority_class& pc);
     future<> seal_sstable();
 
     future<> read_compression(const io_priority_class& pc);
     void write_compression(const io_priority_class& pc);
+    const compressor_ptr& get_data_compressor();
 
     future<> read_scylla_metadata(const io_priority_class& pc) noexcept;
     void write_scylla_metadata(const io_priority_class& pc, shard_id shard, sstable_enabled_features features, run_identifier identifier,
@@ -604,7 +632,8 @@ class sstable : public enable_lw_shared_from_this<sstable> {
     // data incrementally as a stream. Knowing in advance the exact amount
     // of bytes to be read using this stream, we can make better choices
     // about the buffer size to read, and where exactly to stop reading
-    // (even when a large buffer size is used).
+    // (even when a large buffer size is used). Reads of permits marked as
+    // sequential scans are done in larger chunks.
     input_stream<char> data_stream(uint64_t pos, size_t len, const io_priority_class& pc,
             reader_permit permit, tracing::trace_state_ptr trace_state, lw_shared_ptr<file_input_stream_history> history);
 
@@ -769,6 +798,16 @@ class sstable : public enable_lw_shared_from_this<sstable> {
     // This will change sstable level only in memory.
     void set_sstable_level(uint32_t);
 
+    // Time (in milliseconds since the epoch) of the incremental repair which
+    // verified all data of this sstable, or 0 if it wasn't repaired.
+    uint64_t get_repaired_at() const {
+        return get_stats_metadata().repaired_at;
+    }
+
+    bool is_repaired() const {
+        return get_repaired_at() != 0;
+    }
+
     double get_compression_ratio() const;
 
     const sstables::compression& get_compression() const {
@@ -777,6 +816,9 @@ class sstable : public enable_lw_shared_from_this<sstable> {
 
     future<> mutate_sstable_level(uint32_t);
 
+    // Changes the repaired-at time of the sstable, in memory and on disk.
+    future<> mutate_repaired_at(uint64_t repaired_at);
+
     const summary& get_summary() const {
         return _components->summary;
     }
@@ -818,6 +860,15 @@ class sstable : public enable_lw_shared_from_this<sstable> {
     // Drops all evictable in-memory caches of on-disk content.
     future<> drop_caches();
 
+    // The cache of partition index pages of this sstable. Its unreferenced
+    // pages are linked in the LRU of the cache tracker, see
+    // partition_index_cache::lru_entry().
+    const partition_index_cache& get_index_cache() const;
+
+    // Reads the partition index pages for given summary indexes into the cache.
+    // Indexes which are out of range are ignored.
+    future<> prefetch_index_pages(std::vector<uint64_t> summary_indexes, reader_permit permit, const io_priority_class& pc);
+
     // Allow the test cases from sstable_test.cc to test private methods. We use
     // a placeholder to avoid cluttering this class too much. The sstable_test class
     // will then re-export as public every method it needs.
@@ -827,6 +878,7 @@ class sstable : public enable_lw_shared_from_this<sstable> {
     friend class sstable_writer;
     friend class mc::writer;
     friend class index_reader;
+    friend class trie_index_reader;
     friend class promoted_index;
     friend class compaction;
     friend class sstables_manager;
@@ -61,6 +61,9 @@ sstable_writer_config sstables_manager::configure_writer(sstring origin) const {
             ? mutation_fragment_stream_validation_level::clustering_key
             : mutation_fragment_stream_validation_level::token;
     cfg.summary_byte_cost = summary_byte_cost(_db_config.sstable_summary_ratio());
+    cfg.allow_split_block_bloom_filter = _features.cluster_supports_split_block_bloom_filter();
+    cfg.allow_compression_dictionary = _features.cluster_supports_compression_dictionary();
+    cfg.allow_trie_index = _features.cluster_supports_sstable_trie_index();
 
     cfg.origin = std::move(origin);
 
@@ -52,6 +52,7 @@ using schema_ptr = lw_shared_ptr<const schema>;
 using shareable_components_ptr = lw_shared_ptr<shareable_components>;
 
 static constexpr size_t default_sstable_buffer_size = 128 * 1024;
+static constexpr size_t sequential_scan_buffer_size = 512 * 1024;
 
 class sstables_manager {
     using list_type = boost::intrusive::list<sstable,
@@ -0,0 +1,722 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <seastar/core/byteorder.hh>
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/when_all.hh>
+
+#include "sstables/trie_index.hh"
+#include "sstables/index_reader.hh"
+#include "sstables/writer.hh"
+#include "vint-serialization.hh"
+
+namespace sstables {
+
+bytes trie_index_key(const dht::token& token, bytes_view key) {
+    bytes ret(bytes::initialized_later(), sizeof(uint64_t) + key.size());
+    // Flipping the sign bit makes the unsigned order of the bytes the signed order of tokens.
+    write_be<uint64_t>(reinterpret_cast<char*>(ret.begin()), uint64_t(dht::token::to_int64(token)) ^ (uint64_t(1) << 63));
+    std::copy(key.begin(), key.end(), ret.begin() + sizeof(uint64_t));
+    return ret;
+}
+
+static size_t common_prefix_length(bytes_view a, bytes_view b) {
+    return std::mismatch(a.begin(), a.begin() + std::min(a.size(), b.size()), b.begin()).first - a.begin();
+}
+
+trie_index_writer::trie_index_writer(file_writer& out)
+    : _out(out)
+{
+    _path.emplace_back();
+}
+
+uint64_t trie_index_writer::write_node(const node& n) {
+    uint64_t pos = _out.offset();
+    bytes_ostream body;
+    write_vint(body, uint64_t(n.payload.size()));
+    body.write(n.payload);
+    write_vint(body, uint64_t(n.children.size()));
+    for (auto& [transition, child_pos] : n.children) {
+        body.write(bytes_view(reinterpret_cast<const int8_t*>(&transition), 1));
+    }
+    for (auto& [transition, child_pos] : n.children) {
+        write_vint(body, pos - child_pos);
+    }
+    write_vint(_out, uint64_t(body.size()));
+    for (bytes_view frag : body) {
+        _out.write(frag);
+    }
+    return pos;
+}
+
+void trie_index_writer::write_nodes_below(size_t depth) {
+    while (_path.size() > depth + 1) {
+        auto pos = write_node(_path.back());
+        _path.pop_back();
+        _path.back().children.emplace_back(_path_transitions.back(), pos);
+        _path_transitions.pop_back();
+    }
+}
+
+// The pending partition is stored at the shortest prefix of its key which is
+// longer than the common prefixes with both of its neighbours, or at its whole
+// key if it is a prefix of the next one. The previous partition is stored
+// deeper than their common prefix, so the nodes below it are complete.
+void trie_index_writer::place_pending(size_t next_lcp) {
+    auto depth = std::min(std::max(_pending_lcp, next_lcp) + 1, _pending_key.size());
+    write_nodes_below(_pending_lcp);
+    for (auto d = _pending_lcp; d < depth; ++d) {
+        _path.emplace_back();
+        _path_transitions.push_back(uint8_t(_pending_key[d]));
+    }
+    bytes_ostream payload;
+    auto suffix = bytes_view(_pending_key).substr(depth);
+    write_vint(payload, uint64_t(suffix.size()));
+    payload.write(suffix);
+    payload.write(_pending_value);
+    _path.back().payload = bytes(payload.linearize());
+}
+
+void trie_index_writer::add(const dht::token& token, bytes_view key, uint64_t data_file_position, const std::optional<promoted_index_info>& pi) {
+    auto k = trie_index_key(token, key);
+    if (_has_pending) {
+        auto lcp = common_prefix_length(_pending_key, k);
+        place_pending(lcp);
+        _pending_lcp = lcp;
+    }
+    bytes_ostream value;
+    write_vint(value, data_file_position);
+    int8_t flags = pi ? 1 : 0;
+    value.write(bytes_view(&flags, 1));
+    if (pi) {
+        std::array<char, sizeof(uint32_t) + sizeof(uint64_t)> dt;
+        write_be<uint32_t>(dt.data(), pi->del_time.local_deletion_time);
+        write_be<int64_t>(dt.data() + sizeof(uint32_t), pi->del_time.marked_for_delete_at);
+        value.write(dt.data(), dt.size());
+        write_vint(value, pi->start);
+        write_vint(value, pi->size);
+        write_vint(value, pi->num_blocks);
+    }
+    _pending_key = std::move(k);
+    _pending_value = bytes(value.linearize());
+    _has_pending = true;
+}
+
+void trie_index_writer::finish() {
+    if (_has_pending) {
+        place_pending(0);
+        _has_pending = false;
+    }
+    write_nodes_below(0);
+    auto root = write_node(_path.back());
+    std::array<char, trie_index_trailer_size> trailer;
+    write_be<uint64_t>(trailer.data(), root);
+    write_be<uint64_t>(trailer.data() + sizeof(uint64_t), trie_index_magic);
+    _out.write(trailer.data(), trailer.size());
+}
+
+namespace {
+
+// A node of the trie, as read from the Partitions component.
+struct trie_node {
+    // Empty if no partition is stored in the node.
+    temporary_buffer<char> payload;
+    temporary_buffer<char> transitions;
+    std::vector<uint64_t> children;
+};
+
+using trie_node_ptr = lw_shared_ptr<trie_node>;
+
+// The partition the cursor is at.
+struct trie_entry {
+    bytes key;
+    uint64_t data_file_position;
+    std::optional<parsed_promoted_index_entry> promoted_index;
+};
+
+// A node on the path to the partition of a cursor.
+struct trie_path_element {
+    trie_node_ptr node;
+    // The child the path goes on with, if the node is not the last one.
+    size_t child = 0;
+};
+
+// Contains information about trie_index_reader position in the trie
+struct trie_index_bound {
+    trie_index_bound() = default;
+    // From the root to the node of the partition, empty until the partition is read.
+    std::vector<trie_path_element> path;
+    std::optional<trie_entry> entry;
+    uint64_t data_file_position = 0;
+    indexable_element element = indexable_element::partition;
+    std::optional<open_rt_marker> end_open_marker;
+
+    // Holds the cursor for the current partition. Lazily initialized.
+    std::unique_ptr<clustered_index_cursor> clustered_cursor;
+
+    // Cannot use default implementation because clustered_cursor is non-copyable.
+    trie_index_bound(const trie_index_bound& other)
+            : path(other.path)
+            , entry(other.entry)
+            , data_file_position(other.data_file_position)
+            , element(other.element)
+            , end_open_marker(other.end_open_marker)
+    { }
+
+    trie_index_bound(trie_index_bound&&) noexcept = default;
+    trie_index_bound& operator=(trie_index_bound&&) noexcept = default;
+};
+
+class buffer_parser {
+    temporary_buffer<char> _buf;
+    const sstable& _sst;
+
+    void check(size_t n) const {
+        if (_buf.size() < n) {
+            throw malformed_sstable_exception("truncated trie index node", _sst.filename(component_type::Partitions));
+        }
+    }
+public:
+    buffer_parser(temporary_buffer<char> buf, const sstable& sst) : _buf(std::move(buf)), _sst(sst) {}
+
+    uint64_t read_vint() {
+        check(1);
+        auto len = unsigned_vint::serialized_size_from_first_byte(_buf[0]);
+        check(len);
+        auto v = unsigned_vint::deserialize(bytes_view(reinterpret_cast<const int8_t*>(_buf.get()), len));
+        _buf.trim_front(len);
+        return v;
+    }
+
+    temporary_buffer<char> read_bytes(size_t n) {
+        check(n);
+        auto ret = _buf.share(0, n);
+        _buf.trim_front(n);
+        return ret;
+    }
+
+    template <typename T>
+    T read_be() {
+        check(sizeof(T));
+        auto v = seastar::read_be<T>(_buf.get());
+        _buf.trim_front(sizeof(T));
+        return v;
+    }
+};
+
+}
+
+// Implements abstract_index_reader on top of the Partitions component.
+//
+// Each bound is positioned by a lookup from the root, as the trie is shallow
+// and its pages are cached. Moving to the next partition walks the trie
+// from the path of the current one.
+class trie_index_reader : public abstract_index_reader {
+    shared_sstable _sstable;
+    reader_permit _permit;
+    const io_priority_class& _pc;
+    tracing::trace_state_ptr _trace_state;
+    cached_file& _file;
+    std::optional<uint64_t> _root;
+
+    trie_index_bound _lower_bound;
+    // Upper bound may remain uninitialized
+    std::optional<trie_index_bound> _upper_bound;
+private:
+    [[noreturn]] void throw_malformed(sstring msg) const {
+        throw malformed_sstable_exception(std::move(msg), _sstable->filename(component_type::Partitions));
+    }
+
+    // Reads the bytes [pos, pos + size) of the Partitions component.
+    future<temporary_buffer<char>> read(uint64_t pos, uint64_t size) {
+        if (pos + size > _file.size()) {
+            throw_malformed(format("trie index read of {} bytes at {} past the end of the file", size, pos));
+        }
+        auto stream = _file.read(pos, _pc, _permit, _trace_state);
+        auto buf = co_await stream.next();
+        if (buf.size() >= size) {
+            buf.trim(size);
+            co_return buf;
+        }
+        temporary_buffer<char> ret(size);
+        size_t copied = 0;
+        while (true) {
+            auto n = std::min<size_t>(size - copied, buf.size());
+            std::copy_n(buf.get(), n, ret.get_write() + copied);
+            copied += n;
+            if (copied == size) {
+                co_return ret;
+            }
+            buf = co_await stream.next();
+            if (buf.empty()) {
+                throw_malformed("unexpected end of the trie index");
+            }
+        }
+    }
+
+    future<trie_node_ptr> read_node(uint64_t pos) {
+        if (pos >= _file.size()) {
+            throw_malformed(format("trie index node position {} past the end of the file", pos));
+        }
+        auto head = co_await read(pos, std::min<uint64_t>(max_vint_length, _file.size() - pos));
+        auto len = unsigned_vint::serialized_size_from_first_byte(head[0]);
+        auto size = buffer_parser(std::move(head), *_sstable).read_vint();
+        buffer_parser p(co_await read(pos + len, size), *_sstable);
+        auto n = make_lw_shared<trie_node>();
+        n->payload = p.read_bytes(p.read_vint());
+        auto nr_children = p.read_vint();
+        n->transitions = p.read_bytes(nr_children);
+        n->children.reserve(nr_children);
+        for (uint64_t i = 0; i < nr_children; ++i) {
+            auto distance = p.read_vint();
+            if (distance == 0 || distance > pos) {
+                throw_malformed(format("bad distance {} to a child of the trie index node at {}", distance, pos));
+            }
+            n->children.push_back(pos - distance);
+        }
+        co_return n;
+    }
+
+    future<trie_node_ptr> read_root() {
+        if (!_root) {
+            if (_file.size() < trie_index_trailer_size) {
+                throw_malformed("trie index too short for its trailer");
+            }
+            buffer_parser p(co_await read(_file.size() - trie_index_trailer_size, trie_index_trailer_size), *_sstable);
+            auto root = p.read_be<uint64_t>();
+            if (p.read_be<uint64_t>() != trie_index_magic) {
+                throw_malformed("bad trie index magic");
+            }
+            _root = root;
+        }
+        co_return co_await read_node(*_root);
+    }
+
+    static future<> reset_clustered_cursor(trie_index_bound& bound) noexcept {
+        if (bound.clustered_cursor) {
+            return bound.clustered_cursor->close().then([&bound] {
+                bound.clustered_cursor.reset();
+            });
+        }
+        return make_ready_future<>();
+    }
+
+    future<> advance_to_end(trie_index_bound& bound) {
+        sstlog.trace("trie index {}: advance_to_end() bound {}", fmt::ptr(this), fmt::ptr(&bound));
+        bound.path.clear();
+        bound.entry.reset();
+        bound.data_file_position = data_file_end();
+        bound.element = indexable_element::partition;
+        bound.end_open_marker.reset();
+        return reset_clustered_cursor(bound);
+    }
+
+    // Makes the partition stored in the last node of the path the current one.
+    void set_entry(trie_index_bound& bound) {
+        auto depth = bound.path.size() - 1;
+        buffer_parser p(bound.path.back().node->payload.share(), *_sstable);
+        auto suffix = p.read_bytes(p.read_vint());
+        if (depth + suffix.size() < sizeof(uint64_t)) {
+            throw_malformed("trie index key shorter than a token");
+        }
+        bytes k(bytes::initialized_later(), depth + suffix.size());
+        for (size_t i = 0; i < depth; ++i) {
+            k[i] = bound.path[i].node->transitions[bound.path[i].child];
+        }
+        std::copy_n(suffix.get(), suffix.size(), k.begin() + depth);
+        trie_entry e{std::move(k), p.read_vint(), std::nullopt};
+        auto flags = p.read_bytes(1);
+        if (flags[0]) {
+            parsed_promoted_index_entry pi;
+            pi.del_time.local_deletion_time = p.read_be<uint32_t>();
+            pi.del_time.marked_for_delete_at = p.read_be<int64_t>();
+            pi.promoted_index_start = p.read_vint();
+            pi.promoted_index_size = p.read_vint();
+            pi.num_blocks = p.read_vint();
+            if (_sstable->has_correct_promoted_index_entries()) {
+                e.promoted_index = pi;
+            }
+        }
+        bound.data_file_position = e.data_file_position;
+        bound.entry = std::move(e);
+        bound.element = indexable_element::partition;
+        bound.end_open_marker.reset();
+        sstlog.trace("trie index {} bound {}: at partition, pos={}", fmt::ptr(this), fmt::ptr(&bound), bound.data_file_position);
+    }
+
+    // Positions the bound at the smallest partition stored in the subtree of the last node of the path.
+    future<> descend_leftmost(trie_index_bound& bound) {
+        while (bound.path.back().node->payload.empty()) {
+            auto& last = bound.path.back();
+            if (last.node->children.empty()) {
+                if (bound.path.size() != 1) {
+                    throw_malformed("trie index node without partitions");
+                }
+                // The sstable has no partitions.
+                co_return co_await advance_to_end(bound);
+            }
+            last.child = 0;
+            auto child_pos = last.node->children[0];
+            auto child = co_await read_node(child_pos);
+            bound.path.push_back({std::move(child)});
+        }
+        set_entry(bound);
+    }
+
+    // Positions the bound at the smallest partition stored under the children of the last node of the path,
+    // starting with the child at index first_child, and at the next partition after that node if there are none.
+    future<> descend_from_child(trie_index_bound& bound, size_t first_child) {
+        while (!bound.path.empty()) {
+            auto& last = bound.path.back();
+            if (first_child < last.node->children.size()) {
+                last.child = first_child;
+                auto child_pos = last.node->children[first_child];
+                auto child = co_await read_node(child_pos);
+                bound.path.push_back({std::move(child)});
+                co_return co_await descend_leftmost(bound);
+            }
+            bound.path.pop_back();
+            if (!bound.path.empty()) {
+                first_child = bound.path.back().child + 1;
+            }
+        }
+        co_await advance_to_end(bound);
+    }
+
+    // Positions the bound at the first partition whose key is not smaller than target,
+    // or greater than target if after is set.
+    future<> seek(trie_index_bound& bound, bytes_view target, bool after) {
+        co_await reset_clustered_cursor(bound);
+        bound.path.clear();
+        bound.path.push_back({co_await read_root()});
+        size_t depth = 0;
+        while (true) {
+            auto& last = bound.path.back();
+            auto& node = *last.node;
+            if (!node.payload.empty()) {
+                // The partition stored in the node is the smallest one in its subtree.
+                buffer_parser p(node.payload.share(), *_sstable);
+                auto suffix = p.read_bytes(p.read_vint());
+                auto c = compare_unsigned(bytes_view(reinterpret_cast<const int8_t*>(suffix.get()), suffix.size()), target.substr(depth));
+                if (c > 0 || (c == 0 && !after)) {
+                    set_entry(bound);
+                    co_return;
+                }
+            }
+            if (depth == target.size()) {
+                // All partitions in the subtree are greater than target, save for the one stored in the node.
+                co_return co_await descend_from_child(bound, 0);
+            }
+            auto transition = char(target[depth]);
+            auto begin = node.transitions.begin();
+            auto it = std::lower_bound(begin, node.transitions.end(), transition, [] (char a, char b) {
+                return uint8_t(a) < uint8_t(b);
+            });
+            size_t idx = it - begin;
+            if (it == node.transitions.end() || *it != transition) {
+                co_return co_await descend_from_child(bound, idx);
+            }
+            last.child = idx;
+            auto child_pos = node.children[idx];
+            auto child = co_await read_node(child_pos);
+            bound.path.push_back({std::move(child)});
+            ++depth;
+        }
+    }
+
+    future<> advance_to(trie_index_bound& bound, dht::ring_position_view pos) {
+        sstlog.trace("trie index {} bound {}: advance_to({})", fmt::ptr(this), fmt::ptr(&bound), pos);
+        if (pos.is_min()) {
+            sstlog.trace("trie index {}: first entry", fmt::ptr(this));
+            return make_ready_future<>();
+        } else if (pos.is_max()) {
+            return advance_to_end(bound);
+        }
+        if (pos.key()) {
+            auto k = sstables::key::from_partition_key(*_sstable->_schema, *pos.key());
+            auto target = trie_index_key(pos.token(), bytes_view(k));
+            return do_with(std::move(target), [this, &bound, after = bool(pos.is_after_key())] (const bytes& target) {
+                return seek(bound, target, after);
+            });
+        }
+        auto target = trie_index_key(pos.token(), bytes_view());
+        if (pos.get_token_bound() == dht::ring_position::token_bound::end) {
+            // Past all keys of the token, so at the first key of the next token, if any.
+            auto t = dht::token::to_int64(pos.token());
+            if (t == std::numeric_limits<int64_t>::max()) {
+                return advance_to_end(bound);
+            }
+            target = trie_index_key(dht::token::from_int64(t + 1), bytes_view());
+        }
+        return do_with(std::move(target), [this, &bound] (const bytes& target) {
+            return seek(bound, target, false);
+        });
+    }
+
+    future<> advance_to_next_partition(trie_index_bound& bound) {
+        sstlog.trace("trie index {} bound {}: advance_to_next_partition()", fmt::ptr(this), fmt::ptr(&bound));
+        if (bound.data_file_position == data_file_end()) {
+            co_return;
+        }
+        if (!partition_data_ready(bound)) {
+            co_await read_first_partition(bound);
+            if (!partition_data_ready(bound)) {
+                co_return;
+            }
+        }
+        co_await reset_clustered_cursor(bound);
+        // Partitions under the node of the current one are greater than it.
+        co_await descend_from_child(bound, 0);
+    }
+
+    future<> read_first_partition(trie_index_bound& bound) {
+        co_await reset_clustered_cursor(bound);
+        bound.path.clear();
+        bound.path.push_back({co_await read_root()});
+        co_await descend_leftmost(bound);
+    }
+
+    future<> advance_lower_to_start(const dht::partition_range& range) {
+        if (range.start()) {
+            return advance_to(_lower_bound,
+                dht::ring_position_view(range.start()->value(),
+                    dht::ring_position_view::after_key(!range.start()->is_inclusive())));
+        }
+        return make_ready_future<>();
+    }
+
+    future<> advance_upper_to_end(const dht::partition_range& range) {
+        if (!_upper_bound) {
+            _upper_bound.emplace();
+        }
+        if (range.end()) {
+            return advance_to(*_upper_bound,
+                dht::ring_position_view(range.end()->value(),
+                    dht::ring_position_view::after_key(range.end()->is_inclusive())));
+        }
+        return advance_to_end(*_upper_bound);
+    }
+
+    bool partition_data_ready(const trie_index_bound& bound) const {
+        return bool(bound.entry);
+    }
+
+    file_input_stream_options get_file_input_stream_options() {
+        file_input_stream_options options;
+        options.buffer_size = _sstable->sstable_buffer_size;
+        options.read_ahead = 2;
+        options.io_priority_class = _pc;
+        options.dynamic_adjustments = _sstable->_index_history;
+        return options;
+    }
+
+    // Returns a pointer to the clustered index cursor for the current partition
+    // or nullptr if there is no clustered index in the current partition.
+    // Returns the same instance until we move to a different partition.
+    clustered_index_cursor* current_clustered_cursor(trie_index_bound& bound) {
+        if (!bound.clustered_cursor) {
+            auto& pi = bound.entry->promoted_index;
+            if (!pi) {
+                return nullptr;
+            }
+            promoted_index index(*_sstable->_schema, pi->del_time, pi->promoted_index_start, pi->promoted_index_size, pi->num_blocks);
+            bound.clustered_cursor = index.make_cursor(_sstable, _permit, _trace_state, get_file_input_stream_options());
+        }
+        return &*bound.clustered_cursor;
+    }
+
+    // Forwards the upper bound cursor to a position which is greater than given position in current partition.
+    // See index_reader::advance_upper_past().
+    future<> advance_upper_past(position_in_partition_view pos) {
+        sstlog.trace("trie index {}: advance_upper_past({})", fmt::ptr(this), pos);
+        if (!partition_data_ready(_lower_bound)) {
+            co_await read_partition_data();
+        }
+        if (!_upper_bound) {
+            _upper_bound = _lower_bound;
+        }
+        auto e_pos = _upper_bound->entry->data_file_position;
+        clustered_index_cursor* cur = current_clustered_cursor(*_upper_bound);
+        if (!cur) {
+            sstlog.trace("trie index {}: no promoted index", fmt::ptr(this));
+            co_return co_await advance_to_next_partition(*_upper_bound);
+        }
+        auto off = co_await cur->probe_upper_bound(pos);
+        if (!off) {
+            co_return co_await advance_to_next_partition(*_upper_bound);
+        }
+        _upper_bound->data_file_position = e_pos + *off;
+        _upper_bound->element = indexable_element::cell;
+        sstlog.trace("trie index {} upper bound: skipped to cell, _data_file_position={}", fmt::ptr(this), _upper_bound->data_file_position);
+    }
+
+    // Returns position right after all partitions in the sstable
+    uint64_t data_file_end() const {
+        return _sstable->data_size();
+    }
+public:
+    trie_index_reader(shared_sstable sst, reader_permit permit, const io_priority_class& pc, tracing::trace_state_ptr trace_state)
+        : _sstable(std::move(sst))
+        , _permit(std::move(permit))
+        , _pc(pc)
+        , _trace_state(std::move(trace_state))
+        , _file(*_sstable->_cached_partitions_file)
+    {
+        sstlog.trace("trie index {}: trie_index_reader for {}", fmt::ptr(this), _sstable->get_filename());
+    }
+
+    future<> read_partition_data() override {
+        assert(!eof());
+        if (partition_data_ready(_lower_bound)) {
+            return make_ready_future<>();
+        }
+        // The only case when the entry may be missing is when the cursor is at the beginning
+        return read_first_partition(_lower_bound);
+    }
+
+    future<> advance_to(const dht::partition_range& range) override {
+        return seastar::when_all_succeed(
+            advance_lower_to_start(range),
+            advance_upper_to_end(range)).discard_result();
+    }
+
+    std::optional<sstables::deletion_time> partition_tombstone() override {
+        auto& pi = _lower_bound.entry->promoted_index;
+        if (!pi) {
+            return std::nullopt;
+        }
+        return pi->del_time;
+    }
+
+    partition_key get_partition_key() override {
+        auto key = bytes_view(_lower_bound.entry->key).substr(sizeof(uint64_t));
+        return key_view(key).to_partition_key(*_sstable->_schema);
+    }
+
+    bool partition_data_ready() const override {
+        return partition_data_ready(_lower_bound);
+    }
+
+    // See index_reader::advance_to(position_in_partition_view).
+    future<> advance_to(position_in_partition_view pos) override {
+        sstlog.trace("trie index {}: advance_to({}), current data_file_pos={}",
+                 fmt::ptr(this), pos, _lower_bound.data_file_position);
+
+        const schema& s = *_sstable->_schema;
+        if (pos.is_before_all_fragments(s)) {
+            co_return;
+        }
+        if (!partition_data_ready()) {
+            co_await read_partition_data();
+        }
+
+        auto e_pos = _lower_bound.entry->data_file_position;
+        clustered_index_cursor* cur = current_clustered_cursor(_lower_bound);
+        if (!cur) {
+            sstlog.trace("trie index {}: no promoted index", fmt::ptr(this));
+            co_return;
+        }
+
+        auto si = co_await cur->advance_to(pos);
+        if (!si) {
+            sstlog.trace("trie index {}: position in the same block", fmt::ptr(this));
+            co_return;
+        }
+        if (!si->active_tombstone) {
+            _lower_bound.end_open_marker.reset();
+        } else {
+            _lower_bound.end_open_marker = open_rt_marker{std::move(si->active_tombstone_pos), si->active_tombstone};
+        }
+        _lower_bound.data_file_position = e_pos + si->offset;
+        _lower_bound.element = indexable_element::cell;
+        sstlog.trace("trie index {}: skipped to cell, _data_file_position={}", fmt::ptr(this), _lower_bound.data_file_position);
+    }
+
+    future<bool> advance_lower_and_check_if_present(
+            dht::ring_position_view key, std::optional<position_in_partition_view> pos = {}) override {
+        co_await advance_to(_lower_bound, key);
+        if (eof()) {
+            co_return false;
+        }
+        co_await read_partition_data();
+        if (!key.key()) {
+            co_return false;
+        }
+        auto k = sstables::key::from_partition_key(*_sstable->_schema, *key.key());
+        if (_lower_bound.entry->key != trie_index_key(key.token(), bytes_view(k))) {
+            co_return false;
+        }
+        if (pos) {
+            co_await advance_upper_past(*pos);
+        }
+        co_return true;
+    }
+
+    future<> advance_to_next_partition() override {
+        return advance_to_next_partition(_lower_bound);
+    }
+
+    future<> advance_to(dht::ring_position_view pos) override {
+        return advance_to(_lower_bound, pos);
+    }
+
+    data_file_positions_range data_file_positions() const override {
+        data_file_positions_range result;
+        result.start = _lower_bound.data_file_position;
+        if (_upper_bound) {
+            result.end = _upper_bound->data_file_position;
+        }
+        return result;
+    }
+
+    indexable_element element_kind() const override {
+        return _lower_bound.element;
+    }
+
+    std::optional<open_rt_marker> end_open_marker() const override {
+        return _lower_bound.end_open_marker;
+    }
+
+    bool eof() const override {
+        return _lower_bound.data_file_position == data_file_end();
+    }
+
+    future<> close() noexcept override {
+        return reset_clustered_cursor(_lower_bound).then([this] {
+            if (_upper_bound) {
+                return reset_clustered_cursor(*_upper_bound);
+            }
+            return make_ready_future<>();
+        });
+    }
+};
+
+std::unique_ptr<abstract_index_reader> make_index_reader(shared_sstable sst, reader_permit permit,
+        const io_priority_class& pc, tracing::trace_state_ptr trace_state) {
+    if (sst->has_component(component_type::Partitions)) {
+        return std::make_unique<trie_index_reader>(std::move(sst), std::move(permit), pc, std::move(trace_state));
+    }
+    return std::make_unique<index_reader>(std::move(sst), std::move(permit), pc, std::move(trace_state));
+}
+
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "bytes.hh"
+#include "dht/token.hh"
+#include "sstables/abstract_index_reader.hh"
+#include "sstables/types.hh"
+
+// The trie index, stored in the Partitions component.
+//
+// The partition index of an sstable, as a trie over the byte-comparable form
+// of the partition keys: the token, as 8 big-endian bytes with the sign bit
+// flipped, followed by the key in its sstable form. The byte-wise order of
+// these keys is the order of partitions in the sstable.
+//
+// Every partition is stored in the node of the shortest prefix of its key
+// which tells it apart from the partitions next to it, and the rest of the
+// key is stored in the node, so that lookups compare whole keys. A lookup
+// reads the nodes on the path to the partition, which are close to each
+// other as subtrees are contiguous, so it usually reads one or two pages,
+// and it doesn't need the summary.
+//
+// The node of a partition has children only if its key is a prefix of the
+// keys of the following partitions, so it is smaller than all of them.
+//
+// Nodes are written as the partitions are, children before their parent,
+// so the writer keeps only the path to the last partition in memory and
+// every subtree is contiguous in the file. The root is the last node,
+// and the file ends with a trailer which points at it.
+//
+// Node:
+//   vint size of the rest of the node
+//   vint payload size, 0 if no partition is stored in the node
+//   payload
+//   vint number of children
+//   child transition bytes, increasing
+//   vint distances back from the node to each child
+//
+// Payload:
+//   vint size of the rest of the key, bytes of the rest of the key
+//   vint position of the partition in the data file
+//   byte 1 if the partition has a promoted index, 0 otherwise
+//   if it has one:
+//     deletion_time of the partition
+//     vint position of the promoted index blocks in the Index component
+//     vint size of the promoted index blocks and their offsets
+//     vint number of promoted index blocks
+//
+// Trailer:
+//   8 bytes position of the root node
+//   8 bytes magic
+//
+// The row index of large partitions is the promoted index of the Index
+// component, which readers go to from the payload, without reading the
+// partition's entry in the Index component.
+
+namespace sstables {
+
+class file_writer;
+
+constexpr uint64_t trie_index_magic = 0x5343594c4c415452; // "SCYLLATR"
+constexpr size_t trie_index_trailer_size = 16;
+
+// Writes the Partitions component.
+// Must be used in a seastar thread.
+class trie_index_writer {
+public:
+    struct promoted_index_info {
+        deletion_time del_time;
+        uint64_t start;
+        uint64_t size;
+        uint64_t num_blocks;
+    };
+private:
+    struct node {
+        // Empty if no partition is stored in the node.
+        bytes payload;
+        // Transitions and positions of the written children.
+        std::vector<std::pair<uint8_t, uint64_t>> children;
+    };
+
+    file_writer& _out;
+    // Nodes on the path to the last partition placed in the trie, the root first.
+    // Nodes are written once no more partitions can be placed under them.
+    std::vector<node> _path;
+    // The transitions to the nodes of _path.
+    std::vector<uint8_t> _path_transitions;
+    // The last added partition, placed in the trie once the next one is added,
+    // as the length of its prefix depends on both of its neighbours.
+    bytes _pending_key;
+    bytes _pending_value;
+    bool _has_pending = false;
+    // The length of the common prefix of the pending partition and the previous one.
+    size_t _pending_lcp = 0;
+
+    uint64_t write_node(const node& n);
+    // Writes the nodes of _path deeper than depth.
+    void write_nodes_below(size_t depth);
+    void place_pending(size_t next_lcp);
+public:
+    explicit trie_index_writer(file_writer& out);
+
+    // Must be called for increasing keys.
+    void add(const dht::token& token, bytes_view key, uint64_t data_file_position, const std::optional<promoted_index_info>& pi);
+
+    // Writes the rest of the trie and the trailer.
+    void finish();
+};
+
+// Returns the byte-comparable form of a partition key in the trie index.
+bytes trie_index_key(const dht::token& token, bytes_view key);
+
+}
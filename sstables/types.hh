@@ -137,16 +137,22 @@ inline std::ostream& operator<<(std::ostream& o, indexable_element e) {
 
 class summary_entry {
 public:
-    dht::token token;
+    // Summaries only sample keys, so only the value of the token is kept,
+    // not its kind, to keep the entry small. Use get_token().
+    int64_t token_data;
     bytes_view key;
     uint64_t position;
 
+    dht::token get_token() const {
+        return dht::token(dht::token::kind::key, token_data);
+    }
+
     key_view get_key() const {
         return key_view{key};
     }
 
     decorated_key_view get_decorated_key() const {
-        return decorated_key_view(token, get_key());
+        return decorated_key_view(get_token(), get_key());
     }
 
     bool operator==(const summary_entry& x) const {
@@ -470,7 +476,8 @@ enum sstable_feature : uint8_t {
     CorrectStaticCompact = 3, // See #4139
     CorrectEmptyCounters = 4, // See #4363
     CorrectUDTsInCollections = 5, // See #6130
-    End = 6,
+    SplitBlockBloomFilter = 6, // Filter component is a utils::filter::split_block_bloom_filter
+    End = 7,
 };
 
 // Scylla-specific features enabled for a particular sstable.
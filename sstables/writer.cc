@@ -38,6 +38,7 @@ sstable_writer::sstable_writer(sstable& sst, const schema& s, uint64_t estimated
     if (cfg.sstable_level) {
         _impl->_collector.set_sstable_level(cfg.sstable_level.value());
     }
+    _impl->_collector.set_repaired_at(cfg.repaired_at);
 }
 
 void sstable_writer::consume_new_partition(const dht::decorated_key& dk) {
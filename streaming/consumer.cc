@@ -31,6 +31,19 @@
 
 namespace streaming {
 
+future<> add_streamed_sstable(lw_shared_ptr<table> cf, sstables::shared_sstable sst, sharded<db::view::view_update_generator>& vug,
+        stream_reason reason, sstables::offstrategy offstrategy) {
+    if (offstrategy && (reason == stream_reason::repair)) {
+        sstables::sstlog.debug("Enabled automatic off-strategy trigger for table {}.{}",
+                cf->schema()->ks_name(), cf->schema()->cf_name());
+        cf->enable_off_strategy_trigger();
+    }
+    co_await cf->add_sstable_and_update_cache(sst, offstrategy);
+    if (sst->requires_view_building()) {
+        co_await vug.local().register_staging_sstable(sst, std::move(cf));
+    }
+}
+
 std::function<future<> (flat_mutation_reader)> make_streaming_consumer(sstring origin,
         sharded<database>& db,
         sharded<db::system_distributed_keyspace>& sys_dist_ks,
@@ -64,18 +77,8 @@ std::function<future<> (flat_mutation_reader)> make_streaming_consumer(sstring o
                                              cf->get_sstables_manager().configure_writer(origin),
                                              encoding_stats{}, pc).then([sst] {
                     return sst->open_data();
-                }).then([cf, sst, offstrategy, reason] {
-                    if (offstrategy && (reason == stream_reason::repair)) {
-                        sstables::sstlog.debug("Enabled automatic off-strategy trigger for table {}.{}",
-                                cf->schema()->ks_name(), cf->schema()->cf_name());
-                        cf->enable_off_strategy_trigger();
-                    }
-                    return cf->add_sstable_and_update_cache(sst, offstrategy);
-                }).then([cf, s, sst, use_view_update_path, &vug]() mutable -> future<> {
-                    if (!use_view_update_path) {
-                        return make_ready_future<>();
-                    }
-                    return vug.local().register_staging_sstable(sst, std::move(cf));
+                }).then([cf, sst, offstrategy, reason, &vug] {
+                    return add_streamed_sstable(cf, sst, vug, reason, offstrategy);
                 });
             });
             co_return co_await consumer(std::move(reader));
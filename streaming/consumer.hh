@@ -23,6 +23,7 @@
 #include "streaming/stream_reason.hh"
 
 class database;
+class table;
 namespace db {
 class system_distributed_keyspace;
 namespace view {
@@ -32,6 +33,11 @@ class view_update_generator;
 
 namespace streaming {
 
+// Adds an sstable written by streaming to the table. An sstable written to
+// the staging directory is registered for view building.
+future<> add_streamed_sstable(lw_shared_ptr<table> cf, sstables::shared_sstable sst, sharded<db::view::view_update_generator>& vug,
+    stream_reason reason, sstables::offstrategy offstrategy);
+
 std::function<future<>(flat_mutation_reader)> make_streaming_consumer(sstring origin,
     sharded<database>& db,
     sharded<db::system_distributed_keyspace>& sys_dist_ks,
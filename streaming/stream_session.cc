@@ -68,7 +68,12 @@
 #include "../db/view/view_update_generator.hh"
 #include "mutation_source_metadata.hh"
 #include "streaming/stream_mutation_fragments_cmd.hh"
+#include "streaming/stream_sstable_files_cmd.hh"
+#include "streaming/stream_sstable_files.hh"
 #include "consumer.hh"
+#include "utils/crc.hh"
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/fstream.hh>
 
 namespace streaming {
 
@@ -112,6 +117,167 @@ static sstables::offstrategy is_offstrategy_supported(streaming::stream_reason r
     return sstables::offstrategy(operations_supported.contains(reason));
 }
 
+using sstable_files_source = rpc::source<stream_sstable_files_cmd, sstring, fragmented_temporary_buffer, uint32_t>;
+
+// Writes the components received with STREAM_SSTABLE_FILES. The TOC, which
+// comes first, is written as the temporary TOC, so that an sstable which
+// was not received completely is removed on boot.
+static future<> write_sstable_files(sstables::shared_sstable sst, sstable_files_receiver& next_message, bool& toc_written) {
+    const auto& components = sstables::sstable_version_constants::get_component_map(sst->get_version());
+    const auto& toc = components.at(sstables::component_type::TOC);
+    file_output_stream_options options;
+    options.buffer_size = sstables::sequential_scan_buffer_size;
+    options.io_priority_class = service::get_local_streaming_priority();
+
+    std::optional<output_stream<char>> out;
+    sstring component;
+    utils::crc32 checksum;
+    auto open_component = [&] (const sstring& name) -> future<> {
+        if (name != toc && !toc_written) {
+            throw std::runtime_error(format("Got component {} before the TOC", name));
+        }
+        auto c = std::find_if(components.begin(), components.end(), [&name] (const auto& e) { return e.second == name; });
+        if (c == components.end() || c->first == sstables::component_type::TemporaryTOC) {
+            throw std::runtime_error(format("Got unknown component {}", name));
+        }
+        auto type = name == toc ? sstables::component_type::TemporaryTOC : c->first;
+        auto f = co_await open_file_dma(sst->filename(type), open_flags::wo | open_flags::create | open_flags::exclusive);
+        toc_written = true;
+        out = co_await make_file_output_stream(std::move(f), options);
+        component = name;
+        checksum = utils::crc32();
+    };
+
+    bool got_end_of_stream = false;
+    std::exception_ptr ex;
+    try {
+        while (auto msg = co_await next_message()) {
+            auto& [cmd, name, data, crc] = *msg;
+            if (got_end_of_stream) {
+                throw std::runtime_error("Sender sent data after end_of_stream");
+            }
+            switch (cmd) {
+            case stream_sstable_files_cmd::error:
+                throw std::runtime_error("Sender failed");
+            case stream_sstable_files_cmd::component_data:
+            case stream_sstable_files_cmd::component_end:
+                if (!out) {
+                    co_await open_component(name);
+                } else if (name != component) {
+                    throw std::runtime_error(format("Got component {} before the end of {}", name, component));
+                }
+                if (cmd == stream_sstable_files_cmd::component_data) {
+                    for (bytes_view frag : fragmented_temporary_buffer::view(data)) {
+                        checksum.process(reinterpret_cast<const uint8_t*>(frag.data()), frag.size());
+                        co_await out->write(reinterpret_cast<const char*>(frag.data()), frag.size());
+                    }
+                    break;
+                }
+                co_await out->flush();
+                co_await out->close();
+                out.reset();
+                if (checksum.get() != crc) {
+                    throw std::runtime_error(format("Checksum mismatch for component {}: got {}, expected {}", name, checksum.get(), crc));
+                }
+                if (name == toc) {
+                    // Make sure the temporary TOC reached the disk before the other components.
+                    co_await sync_directory(sst->get_dir());
+                }
+                break;
+            case stream_sstable_files_cmd::end_of_stream:
+                if (out) {
+                    throw std::runtime_error(format("Got end_of_stream before the end of component {}", component));
+                }
+                got_end_of_stream = true;
+                break;
+            default:
+                throw std::runtime_error("Sender sent wrong cmd");
+            }
+        }
+        if (!got_end_of_stream) {
+            throw std::runtime_error("Sender did not sent end_of_stream");
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    if (out) {
+        try {
+            co_await out->close();
+        } catch (...) {
+            sslog.debug("Failed to close component {} of {}: {}", component, sst->get_filename(), std::current_exception());
+        }
+    }
+    if (ex) {
+        std::rethrow_exception(std::move(ex));
+    }
+}
+
+static future<> add_received_sstable_on_shard(sharded<database>& db, utils::UUID cf_id, sstring dir, sstables::foreign_sstable_open_info info,
+        stream_reason reason, sstables::offstrategy offstrategy, sharded<db::view::view_update_generator>& vug) {
+    auto cf = db.local().find_column_family(cf_id).shared_from_this();
+    auto sst = cf->make_sstable(std::move(dir), info.generation, info.version, info.format);
+    co_await sst->load(std::move(info));
+    co_await add_streamed_sstable(std::move(cf), std::move(sst), vug, reason, offstrategy);
+}
+
+future<> receive_sstable_files(sharded<database>& db, sharded<db::system_distributed_keyspace>& sys_dist_ks,
+        sharded<db::view::view_update_generator>& vug, utils::UUID plan_id, gms::inet_address from, utils::UUID cf_id,
+        sstables::sstable_version_types version, stream_reason reason, sstable_files_receiver next_message) {
+    auto cf = db.local().find_column_family(cf_id).shared_from_this();
+    auto op = cf->stream_in_progress();
+    auto use_view_update_path = co_await db::view::check_needs_view_update_path(sys_dist_ks.local(), *cf, reason);
+    auto sst = cf->make_streaming_sstable_for_write(version, sstables::sstable_format_types::big,
+            use_view_update_path ? std::make_optional<sstring>("staging") : std::nullopt);
+    const auto& s = *cf->schema();
+
+    bool toc_written = false;
+    std::exception_ptr ex;
+    try {
+        co_await write_sstable_files(sst, next_message, toc_written);
+        co_await sst->seal_sstable(false);
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    if (ex) {
+        if (toc_written) {
+            co_await sstables::sstable::remove_sstable_with_temp_toc(s.ks_name(), s.cf_name(), sst->get_dir(), sst->generation(),
+                    sst->get_version(), sst->get_format());
+        }
+        std::rethrow_exception(std::move(ex));
+    }
+
+    try {
+        co_await sst->load(service::get_local_streaming_priority());
+        auto shards = sst->get_shards_for_this_sstable();
+        sslog.debug("[Stream #{}] Received sstable {} from {}", plan_id, sst->get_filename(), from);
+        if (shards.size() != 1) {
+            // The sender checked that this cannot happen, but the sharding
+            // may have changed since. Rewrite it as if it was streamed as
+            // mutation fragments.
+            auto permit = co_await db.local().obtain_reader_permit(*cf, "stream-session", db::no_timeout);
+            auto reader = sst->make_reader(cf->schema(), std::move(permit), query::full_partition_range, cf->schema()->full_slice(),
+                    service::get_local_streaming_priority(), {}, streamed_mutation::forwarding::no, mutation_reader::forwarding::no);
+            co_await mutation_writer::distribute_reader_and_consume_on_shards(cf->schema(), std::move(reader),
+                    make_streaming_consumer("streaming", db, sys_dist_ks, vug, sst->get_estimated_key_count(), reason, is_offstrategy_supported(reason)),
+                    std::move(op));
+            sst->mark_for_deletion();
+        } else if (shards[0] == this_shard_id()) {
+            co_await add_streamed_sstable(std::move(cf), sst, vug, reason, is_offstrategy_supported(reason));
+        } else {
+            auto info = co_await sst->get_open_info();
+            co_await db.invoke_on(shards[0], [&db, &vug, cf_id, dir = sst->get_dir(), info = std::move(info), reason] (database&) mutable {
+                return add_received_sstable_on_shard(db, cf_id, std::move(dir), std::move(info), reason, is_offstrategy_supported(reason), vug);
+            });
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    if (ex) {
+        sst->mark_for_deletion();
+        std::rethrow_exception(std::move(ex));
+    }
+}
+
 void stream_session::init_messaging_service_handler(netw::messaging_service& ms, shared_ptr<service::migration_manager> mm) {
     ms.register_prepare_message([] (const rpc::client_info& cinfo, prepare_message msg, UUID plan_id, sstring description, rpc::optional<stream_reason> reason_opt) {
         const auto& src_cpu_id = cinfo.retrieve_auxiliary<uint32_t>("src_cpu_id");
@@ -217,6 +383,41 @@ void stream_session::init_messaging_service_handler(netw::messaging_service& ms,
         });
       });
     });
+    ms.register_stream_sstable_files([] (const rpc::client_info& cinfo, UUID plan_id, UUID cf_id, sstring version, stream_reason reason, sstable_files_source source) {
+        auto from = netw::messaging_service::get_source(cinfo);
+        sslog.trace("Got stream_sstable_files from {} reason {}", from, int(reason));
+        if (!_sys_dist_ks->local_is_initialized() || !_view_update_generator->local_is_initialized()) {
+            return make_exception_future<rpc::sink<int>>(std::runtime_error(format("Node {} is not fully initialized for streaming, try again later",
+                    utils::fb_utilities::get_broadcast_address())));
+        }
+        auto sink = stream_session::ms().make_sink_for_stream_sstable_files(source);
+        //FIXME: discarded future.
+        (void)futurize_invoke([&] {
+            return receive_sstable_files(*_db, *_sys_dist_ks, *_view_update_generator, plan_id, from.addr, cf_id,
+                    sstables::from_string(version), reason, [source, plan_id, from] () mutable {
+                return source().then([plan_id, from] (std::optional<sstable_files_message> msg) {
+                    if (msg) {
+                        streaming::get_local_stream_manager().update_progress(plan_id, from.addr, progress_info::direction::IN, std::get<2>(*msg).size_bytes());
+                    }
+                    return msg;
+                });
+            });
+        }).then_wrapped([plan_id, from, cf_id, sink] (future<> f) mutable {
+            int32_t status = 0;
+            if (f.failed()) {
+                sslog.error("[Stream #{}] Failed to handle STREAM_SSTABLE_FILES for cf_id={}, peer={}: {}",
+                        plan_id, cf_id, from.addr, f.get_exception());
+                status = -1;
+            }
+            return sink(status).finally([sink] () mutable {
+                return sink.close();
+            });
+        }).handle_exception([plan_id, from, cf_id] (std::exception_ptr ep) {
+            sslog.error("[Stream #{}] Failed to handle STREAM_SSTABLE_FILES (respond phase) for cf_id={}, peer={}: {}",
+                    plan_id, cf_id, from.addr, ep);
+        });
+        return make_ready_future<rpc::sink<int>>(sink);
+    });
     ms.register_stream_mutation_done([] (const rpc::client_info& cinfo, UUID plan_id, dht::token_range_vector ranges, UUID cf_id, unsigned dst_cpu_id) {
         const auto& from = cinfo.retrieve_auxiliary<gms::inet_address>("baddr");
         return smp::submit_to(dst_cpu_id, [ranges = std::move(ranges), plan_id, cf_id, from] () mutable {
@@ -246,6 +447,7 @@ future<> stream_session::uninit_messaging_service_handler(netw::messaging_servic
         ms.unregister_prepare_message(),
         ms.unregister_prepare_done_message(),
         ms.unregister_stream_mutation_fragments(),
+        ms.unregister_stream_sstable_files(),
         ms.unregister_stream_mutation_done(),
         ms.unregister_complete_message()).discard_result();
 }
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include <seastar/core/future.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/util/noncopyable_function.hh>
+
+#include "database_fwd.hh"
+#include "dht/i_partitioner.hh"
+#include "gms/inet_address.hh"
+#include "sstables/shared_sstable.hh"
+#include "sstables/version.hh"
+#include "streaming/stream_reason.hh"
+#include "streaming/stream_sstable_files_cmd.hh"
+#include "utils/fragmented_temporary_buffer.hh"
+#include "utils/UUID.hh"
+
+namespace db {
+class system_distributed_keyspace;
+namespace view {
+class view_update_generator;
+}
+}
+
+namespace streaming {
+
+// A STREAM_SSTABLE_FILES message: the command, the name of the component,
+// a chunk of its content and a checksum, see stream_sstable_files_cmd.
+using sstable_files_message = std::tuple<stream_sstable_files_cmd, sstring, fragmented_temporary_buffer, uint32_t>;
+using sstable_files_sender = noncopyable_function<future<> (sstable_files_message)>;
+// Returns a disengaged optional at the end of the stream.
+using sstable_files_receiver = noncopyable_function<future<std::optional<sstable_files_message>> ()>;
+
+// Sstables of the table which can be sent to the peer as whole files
+// instead of as mutation fragments: the ones fully contained in the streamed
+// ranges and owned by this shard only. The peer must shard the table the
+// same way, so that such an sstable is owned by a single shard of the peer
+// as well. Empty when files can't be streamed for the reason, or when the
+// cluster or the configuration don't allow it.
+std::vector<sstables::shared_sstable> select_sstables_to_send_as_files(const database& db, const table& cf,
+        gms::inet_address peer, const dht::token_range_vector& ranges, stream_reason reason);
+
+// Sends the components of the sstable as they are on disk with send_message,
+// the TOC first. Stops with an exception as soon as got_error_from_peer is set.
+future<> send_sstable_components(sstables::shared_sstable sst, sstable_files_sender send_message, const bool& got_error_from_peer);
+
+// Writes the sstable sent with send_sstable_components(), read with
+// next_message, to the table and adds it on the shard which owns it.
+// The files written are removed if the sstable can't be received.
+future<> receive_sstable_files(sharded<database>& db, sharded<db::system_distributed_keyspace>& sys_dist_ks,
+        sharded<db::view::view_update_generator>& vug, utils::UUID plan_id, gms::inet_address from, utils::UUID cf_id,
+        sstables::sstable_version_types version, stream_reason reason, sstable_files_receiver next_message);
+
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace streaming {
+
+// Messages of STREAM_SSTABLE_FILES. Each carries the command, the name of
+// the component (e.g. "Data.db"), a chunk of its content and a checksum.
+enum class stream_sstable_files_cmd : uint8_t {
+    error,
+    // The next chunk of the component. Chunks of a component are sent in
+    // order, the first component being the TOC.
+    component_data,
+    // The component is complete, the checksum is the crc32 of all of it.
+    component_end,
+    end_of_stream,
+};
+
+}
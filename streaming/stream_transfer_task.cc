@@ -43,6 +43,8 @@
 #include "streaming/stream_manager.hh"
 #include "streaming/stream_reason.hh"
 #include "streaming/stream_mutation_fragments_cmd.hh"
+#include "streaming/stream_sstable_files_cmd.hh"
+#include "streaming/stream_sstable_files.hh"
 #include "mutation_reader.hh"
 #include "flat_mutation_reader.hh"
 #include "mutation_fragment_stream_validator.hh"
@@ -57,8 +59,15 @@
 #include <boost/icl/interval.hpp>
 #include <boost/icl/interval_set.hpp>
 #include "sstables/sstables.hh"
+#include "sstables/sstables_manager.hh"
 #include "database.hh"
+#include "db/config.hh"
+#include "db/extensions.hh"
 #include "gms/feature_service.hh"
+#include "gms/gossiper.hh"
+#include "utils/crc.hh"
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/fstream.hh>
 
 namespace streaming {
 
@@ -72,6 +81,48 @@ stream_transfer_task::stream_transfer_task(shared_ptr<stream_session> session, U
 
 stream_transfer_task::~stream_transfer_task() = default;
 
+std::vector<sstables::shared_sstable> select_sstables_to_send_as_files(const database& db, const table& cf,
+        gms::inet_address peer, const dht::token_range_vector& ranges, stream_reason reason) {
+    std::vector<sstables::shared_sstable> ssts;
+    if ((reason != stream_reason::bootstrap && reason != stream_reason::decommission)
+            || !db.get_config().enable_sstable_file_streaming()
+            || !db.features().cluster_supports_stream_sstable_files()
+            // The files may be encrypted with a key of this node
+            || !db.get_config().extensions().sstable_file_io_extensions().empty()) {
+        return ssts;
+    }
+    auto& g = gms::get_local_gossiper();
+    auto shard_count = g.get_application_state_ptr(peer, gms::application_state::SHARD_COUNT);
+    auto ignore_msb = g.get_application_state_ptr(peer, gms::application_state::IGNORE_MSB_BITS);
+    const auto& sharder = cf.schema()->get_sharder();
+    if (!shard_count || !ignore_msb
+            || unsigned(std::stoi(shard_count->value)) != sharder.shard_count()
+            || unsigned(std::stoi(ignore_msb->value)) != sharder.sharding_ignore_msb()) {
+        return ssts;
+    }
+    auto contained_in_ranges = [&ranges] (const sstables::shared_sstable& sst) {
+        auto& first = sst->get_first_decorated_key().token();
+        auto& last = sst->get_last_decorated_key().token();
+        return std::any_of(ranges.begin(), ranges.end(), [&first, &last] (const dht::token_range& r) {
+            return r.contains(first, dht::token_comparator()) && r.contains(last, dht::token_comparator());
+        });
+    };
+    // The receiver only accepts the components it knows
+    auto has_unknown_components = [] (const sstables::shared_sstable& sst) {
+        auto components = sst->all_components();
+        return std::any_of(components.begin(), components.end(), [] (const auto& c) {
+            return c.first == sstables::component_type::Unknown;
+        });
+    };
+    for (auto& sst : *cf.get_sstables()) {
+        auto& shards = sst->get_shards_for_this_sstable();
+        if (shards.size() == 1 && shards[0] == this_shard_id() && contained_in_ranges(sst) && !has_unknown_components(sst)) {
+            ssts.push_back(sst);
+        }
+    }
+    return ssts;
+}
+
 struct send_info {
     database& db;
     netw::messaging_service& ms;
@@ -86,6 +137,8 @@ struct send_info {
     column_family& cf;
     dht::token_range_vector ranges;
     dht::partition_range_vector prs;
+    // Sent as files, excluded from the reader
+    std::vector<sstables::shared_sstable> files;
     flat_mutation_reader reader;
     send_info(database& db_, netw::messaging_service& ms_, utils::UUID plan_id_, table& tbl_, reader_permit permit_,
               dht::token_range_vector ranges_, netw::messaging_service::msg_addr id_,
@@ -100,7 +153,9 @@ struct send_info {
         , cf(tbl_)
         , ranges(std::move(ranges_))
         , prs(dht::to_partition_ranges(ranges))
-        , reader(cf.make_streaming_reader(cf.schema(), std::move(permit_), prs)) {
+        , files(select_sstables_to_send_as_files(db, cf, id.addr, ranges, reason))
+        , reader(files.empty() ? cf.make_streaming_reader(cf.schema(), std::move(permit_), prs)
+                : cf.make_streaming_reader(cf.schema(), std::move(permit_), prs, files)) {
     }
     future<bool> has_relevant_range_on_this_shard() {
         return do_with(false, ranges.begin(), [this] (bool& found_relevant_range, dht::token_range_vector::iterator& ranges_it) {
@@ -123,6 +178,9 @@ struct send_info {
     future<size_t> estimate_partitions() {
         return do_with(cf.get_sstables(), size_t(0), [this] (auto& sstables, size_t& partition_count) {
             return do_for_each(*sstables, [this, &partition_count] (auto& sst) {
+                if (std::find(files.begin(), files.end(), sst) != files.end()) {
+                    return make_ready_future<>();
+                }
                 return do_for_each(ranges, [this, &sst, &partition_count] (auto& range) {
                     partition_count += sst->estimated_keys_for_range(range);
                 });
@@ -213,6 +271,120 @@ future<> send_mutation_fragments(lw_shared_ptr<send_info> si) {
  });
 }
 
+using sstable_files_sink = rpc::sink<stream_sstable_files_cmd, sstring, fragmented_temporary_buffer, uint32_t>;
+
+static future<> wait_for_sstable_files_status(rpc::source<int32_t> source, bool& got_error_from_peer, lw_shared_ptr<send_info> si) {
+    // Read until EOS even after an error, see send_mutation_fragments()
+    while (auto status_opt = co_await source()) {
+        auto status = std::get<0>(*status_opt);
+        got_error_from_peer = status == -1;
+        sslog.debug("Got status code from peer={}, plan_id={}, cf_id={}, status={}", si->id.addr, si->plan_id, si->cf_id, status);
+    }
+}
+
+// Sends the component as it is on disk, in chunks, followed by its checksum.
+// The chunks are handed over as read, without being copied.
+static future<> send_sstable_component(sstable_files_sender& send_message, sstring filename, sstring component,
+        const bool& got_error_from_peer) {
+    file_input_stream_options options;
+    options.buffer_size = sstables::sequential_scan_buffer_size;
+    options.read_ahead = 2;
+    options.io_priority_class = service::get_local_streaming_priority();
+    auto f = co_await open_file_dma(filename, open_flags::ro);
+    auto in = make_file_input_stream(std::move(f), 0, std::move(options));
+    utils::crc32 checksum;
+    std::exception_ptr ex;
+    try {
+        for (;;) {
+            auto buf = co_await in.read();
+            if (buf.empty()) {
+                break;
+            }
+            if (got_error_from_peer) {
+                throw std::runtime_error("Got status error code from peer");
+            }
+            checksum.process(reinterpret_cast<const uint8_t*>(buf.get()), buf.size());
+            const size_t size = buf.size();
+            std::vector<temporary_buffer<char>> fragments;
+            fragments.push_back(std::move(buf));
+            co_await send_message(sstable_files_message(stream_sstable_files_cmd::component_data, component,
+                    fragmented_temporary_buffer(std::move(fragments), size), 0));
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await in.close();
+    if (ex) {
+        std::rethrow_exception(std::move(ex));
+    }
+    co_await send_message(sstable_files_message(stream_sstable_files_cmd::component_end, component, fragmented_temporary_buffer(), checksum.get()));
+}
+
+future<> send_sstable_components(sstables::shared_sstable sst, sstable_files_sender send_message, const bool& got_error_from_peer) {
+    auto components = sst->all_components();
+    // The TOC goes first, the receiver writes it as the temporary TOC.
+    std::stable_partition(components.begin(), components.end(), [] (const auto& c) {
+        return c.first == sstables::component_type::TOC;
+    });
+    const auto& s = *sst->get_schema();
+    for (auto& [type, component] : components) {
+        auto filename = sstables::sstable::filename(sst->get_dir(), s.ks_name(), s.cf_name(), sst->get_version(), sst->generation(),
+                sst->get_format(), component);
+        co_await send_sstable_component(send_message, std::move(filename), component, got_error_from_peer);
+    }
+    co_await send_message(sstable_files_message(stream_sstable_files_cmd::end_of_stream, sstring(), fragmented_temporary_buffer(), 0));
+}
+
+static future<> send_sstable_components_to_sink(sstable_files_sink sink, sstables::shared_sstable sst, const bool& got_error_from_peer, lw_shared_ptr<send_info> si) {
+    std::exception_ptr ex;
+    try {
+        co_await send_sstable_components(sst, [&sink, si] (sstable_files_message msg) {
+            streaming::get_local_stream_manager().update_progress(si->plan_id, si->id.addr, streaming::progress_info::direction::OUT, std::get<2>(msg).size_bytes());
+            return std::apply(sink, std::move(msg));
+        }, got_error_from_peer);
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    if (ex) {
+        // Notify the receiver the sender has failed
+        try {
+            co_await sink(stream_sstable_files_cmd::error, sstring(), fragmented_temporary_buffer(), 0);
+        } catch (...) {
+            sslog.debug("[Stream #{}] Failed to notify peer={} of the error: {}", si->plan_id, si->id.addr, std::current_exception());
+        }
+    }
+    co_await sink.close();
+    if (ex) {
+        std::rethrow_exception(std::move(ex));
+    }
+}
+
+// Sends the sstable as files to the shard of the peer owning it. It's the
+// same shard as here, since the peer shards the table the same way.
+static future<> send_sstable_files(lw_shared_ptr<send_info> si, sstables::shared_sstable sst) {
+    sslog.debug("[Stream #{}] Sending sstable {} as files to {}", si->plan_id, sst->get_filename(), si->id.addr);
+    auto id = netw::messaging_service::msg_addr{si->id.addr, this_shard_id()};
+    auto [sink, source] = co_await si->ms.make_sink_and_source_for_stream_sstable_files(si->plan_id, si->cf_id,
+            sstables::to_string(sst->get_version()), si->reason, id);
+    bool got_error_from_peer = false;
+    co_await when_all_succeed(wait_for_sstable_files_status(std::move(source), got_error_from_peer, si),
+            send_sstable_components_to_sink(std::move(sink), sst, got_error_from_peer, si)).discard_result();
+    if (got_error_from_peer) {
+        throw std::runtime_error(format("Peer failed to load sstable {} peer={}, plan_id={}, cf_id={}", sst->get_filename(), si->id.addr, si->plan_id, si->cf_id));
+    }
+}
+
+static future<> send_sstables_as_files(lw_shared_ptr<send_info> si) {
+    if (si->files.empty()) {
+        co_return;
+    }
+    sslog.info("[Stream #{}] Start sending ks={}, cf={}, sstables={}, as files", si->plan_id, si->cf.schema()->ks_name(),
+            si->cf.schema()->cf_name(), si->files.size());
+    for (auto& sst : si->files) {
+        co_await send_sstable_files(si, sst);
+    }
+}
+
 future<> stream_transfer_task::execute() {
     auto plan_id = session->plan_id();
     auto cf_id = this->cf_id;
@@ -231,7 +403,9 @@ future<> stream_transfer_task::execute() {
                         plan_id, cf_id, this_shard_id());
                 return make_ready_future<>();
             }
-            return send_mutation_fragments(std::move(si));
+            return send_sstables_as_files(si).then([si] {
+                return send_mutation_fragments(si);
+            });
         }).finally([si] {
             return si->reader.close();
         });
@@ -21,6 +21,7 @@
 
 #include <seastar/core/seastar.hh>
 #include <seastar/core/coroutine.hh>
+#include <seastar/core/timed_out_error.hh>
 #include <seastar/util/closeable.hh>
 
 #include "database.hh"
@@ -192,11 +193,17 @@ table::make_reader(schema_ptr s,
 }
 
 sstables::shared_sstable table::make_streaming_sstable_for_write(std::optional<sstring> subdir) {
+    return make_streaming_sstable_for_write(get_sstables_manager().get_highest_supported_format(), sstables::sstable::format_types::big,
+            std::move(subdir));
+}
+
+sstables::shared_sstable table::make_streaming_sstable_for_write(sstables::sstable_version_types v, sstables::sstable_format_types f,
+        std::optional<sstring> subdir) {
     sstring dir = _config.datadir;
     if (subdir) {
         dir += "/" + *subdir;
     }
-    auto newtab = make_sstable(dir);
+    auto newtab = make_sstable(dir, calculate_generation_for_new_table(), v, f);
     tlogger.debug("Created sstable for streaming: ks={}, cf={}, dir={}", schema()->ks_name(), schema()->cf_name(), dir);
     return newtab;
 }
@@ -206,6 +213,7 @@ table::make_streaming_reader(schema_ptr s, reader_permit permit,
                            const dht::partition_range_vector& ranges) const {
     auto& slice = s->full_slice();
     auto& pc = service::get_local_streaming_priority();
+    permit.set_sequential_scan();
 
     auto source = mutation_source([this] (schema_ptr s, reader_permit permit, const dht::partition_range& range, const query::partition_slice& slice,
                                       const io_priority_class& pc, tracing::trace_state_ptr trace_state, streamed_mutation::forwarding fwd, mutation_reader::forwarding fwd_mr) {
@@ -221,9 +229,25 @@ table::make_streaming_reader(schema_ptr s, reader_permit permit,
     return make_flat_multi_range_reader(s, std::move(permit), std::move(source), ranges, slice, pc, nullptr, mutation_reader::forwarding::no);
 }
 
+flat_mutation_reader
+table::make_streaming_reader(schema_ptr s, reader_permit permit,
+                           const dht::partition_range_vector& ranges, std::vector<sstables::shared_sstable> excluded) const {
+    auto& slice = s->full_slice();
+    auto& pc = service::get_local_streaming_priority();
+    permit.set_sequential_scan();
+
+    auto source = mutation_source([this, excluded = std::move(excluded)] (schema_ptr s, reader_permit permit, const dht::partition_range& range, const query::partition_slice& slice,
+                                      const io_priority_class& pc, tracing::trace_state_ptr trace_state, streamed_mutation::forwarding fwd, mutation_reader::forwarding fwd_mr) mutable {
+        return make_reader_excluding_sstables(std::move(s), std::move(permit), excluded, range, slice, pc, std::move(trace_state), fwd, fwd_mr);
+    });
+
+    return make_flat_multi_range_reader(s, std::move(permit), std::move(source), ranges, slice, pc, nullptr, mutation_reader::forwarding::no);
+}
+
 flat_mutation_reader table::make_streaming_reader(schema_ptr schema, reader_permit permit, const dht::partition_range& range,
-        const query::partition_slice& slice, mutation_reader::forwarding fwd_mr) const {
+        const query::partition_slice& slice, mutation_reader::forwarding fwd_mr, unrepaired_only only_unrepaired) const {
     const auto& pc = service::get_local_streaming_priority();
+    permit.set_sequential_scan();
     auto trace_state = tracing::trace_state_ptr();
     const auto fwd = streamed_mutation::forwarding::no;
 
@@ -232,7 +256,16 @@ flat_mutation_reader table::make_streaming_reader(schema_ptr schema, reader_perm
     for (auto&& mt : *_memtables) {
         readers.emplace_back(mt->make_flat_reader(schema, permit, range, slice, pc, trace_state, fwd, fwd_mr));
     }
-    readers.emplace_back(make_sstable_reader(schema, permit, _sstables, range, slice, pc, std::move(trace_state), fwd, fwd_mr));
+    auto sstables = _sstables;
+    if (only_unrepaired) {
+        sstables = make_lw_shared(_compaction_strategy.make_sstable_set(_schema));
+        _sstables->for_each_sstable([&sstables] (const sstables::shared_sstable& sst) {
+            if (!sst->is_repaired()) {
+                sstables->insert(sst);
+            }
+        });
+    }
+    readers.emplace_back(make_sstable_reader(schema, permit, std::move(sstables), range, slice, pc, std::move(trace_state), fwd, fwd_mr));
     return make_combined_reader(std::move(schema), std::move(permit), std::move(readers), fwd, fwd_mr);
 }
 
@@ -240,6 +273,7 @@ flat_mutation_reader table::make_streaming_reader(schema_ptr schema, reader_perm
         lw_shared_ptr<sstables::sstable_set> sstables) const {
     auto& slice = schema->full_slice();
     const auto& pc = service::get_local_streaming_priority();
+    permit.set_sequential_scan();
     auto trace_state = tracing::trace_state_ptr();
     const auto fwd = streamed_mutation::forwarding::no;
     const auto fwd_mr = mutation_reader::forwarding::no;
@@ -1670,6 +1704,15 @@ future<> table::generate_and_propagate_view_updates(const schema_ptr& base,
     }
 }
 
+// Returns the single clustering row locked for a write affecting the given
+// rows, or a disengaged optional if the whole partition is locked.
+static std::optional<clustering_key_prefix> locked_row(const schema& s, const query::clustering_row_ranges& rows) {
+    if (rows.size() == 1 && rows[0].is_singular() && rows[0].start() && !rows[0].start()->value().is_empty(s)) {
+        return rows[0].start()->value();
+    }
+    return std::nullopt;
+}
+
 /**
  * Shard-local locking of clustering rows or entire partitions of the base
  * table during a Materialized-View read-modify-update:
@@ -1738,9 +1781,9 @@ table::local_base_lock(
     // This will allow more parallelism in concurrent modifications to the
     // same row - probably not a very urgent case.
     _row_locker.upgrade(s);
-    if (rows.size() == 1 && rows[0].is_singular() && rows[0].start() && !rows[0].start()->value().is_empty(*s)) {
+    if (auto row = locked_row(*s, rows)) {
         // A single clustering row is involved.
-        return _row_locker.lock_ck(pk, rows[0].start()->value(), true, timeout, _row_locker_stats);
+        return _row_locker.lock_ck(pk, *row, true, timeout, _row_locker_stats);
     } else {
         // More than a single clustering row is involved. Most commonly it's
         // the entire partition, so let's lock the entire partition. We could
@@ -2227,8 +2270,28 @@ future<row_locker::lock_holder> table::push_view_replica_updates(const schema_pt
     return push_view_replica_updates(s, std::move(m), timeout, std::move(tr_state), sem);
 }
 
+// The slice reading the existing rows affected by a base table write, to
+// generate its view updates.
+static query::partition_slice make_view_update_read_slice(const schema& base, query::clustering_row_ranges cr_ranges,
+        query::partition_slice::option_set custom_opts) {
+    // We read the whole set of regular columns in case the update now causes a base row to pass
+    // a view's filters, and a view happens to include columns that have no value in this update.
+    // Also, one of those columns can determine the lifetime of the base row, if it has a TTL.
+    auto columns = boost::copy_range<query::column_id_vector>(
+            base.regular_columns() | boost::adaptors::transformed(std::mem_fn(&column_definition::id)));
+    query::partition_slice::option_set opts;
+    opts.set(query::partition_slice::option::send_partition_key);
+    opts.set(query::partition_slice::option::send_clustering_key);
+    opts.set(query::partition_slice::option::send_timestamp);
+    opts.set(query::partition_slice::option::send_ttl);
+    opts.add(custom_opts);
+    return query::partition_slice(
+            std::move(cr_ranges), { }, std::move(columns), std::move(opts), { }, cql_serialization_format::internal(), query::max_rows);
+}
+
 future<row_locker::lock_holder> table::do_push_view_replica_updates(schema_ptr s, mutation m, db::timeout_clock::time_point timeout, mutation_source source,
-        tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem, const io_priority_class& io_priority, query::partition_slice::option_set custom_opts) const {
+        tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem, const io_priority_class& io_priority, query::partition_slice::option_set custom_opts,
+        bool coalesce) const {
     if (!_config.view_update_concurrency_semaphore->current()) {
         // We don't have resources to generate view updates for this write. If we reached this point, we failed to
         // throttle the client. The memory queue is already full, waiting on the semaphore would cause this node to
@@ -2256,19 +2319,10 @@ future<row_locker::lock_holder> table::do_push_view_replica_updates(schema_ptr s
         // write, so no lock is needed.
         co_return row_locker::lock_holder();
     }
-    // We read the whole set of regular columns in case the update now causes a base row to pass
-    // a view's filters, and a view happens to include columns that have no value in this update.
-    // Also, one of those columns can determine the lifetime of the base row, if it has a TTL.
-    auto columns = boost::copy_range<query::column_id_vector>(
-            base->regular_columns() | boost::adaptors::transformed(std::mem_fn(&column_definition::id)));
-    query::partition_slice::option_set opts;
-    opts.set(query::partition_slice::option::send_partition_key);
-    opts.set(query::partition_slice::option::send_clustering_key);
-    opts.set(query::partition_slice::option::send_timestamp);
-    opts.set(query::partition_slice::option::send_ttl);
-    opts.add(custom_opts);
-    auto slice = query::partition_slice(
-            std::move(cr_ranges), { }, std::move(columns), std::move(opts), { }, cql_serialization_format::internal(), query::max_rows);
+    if (coalesce) {
+        co_return co_await push_coalesced_view_replica_updates(std::move(base), std::move(m), std::move(cr_ranges), timeout, std::move(tr_state), sem, now);
+    }
+    auto slice = make_view_update_read_slice(*base, std::move(cr_ranges), custom_opts);
     // Take the shard-local lock on the base-table row or partition as needed.
     // We'll return this lock to the caller, which will release it after
     // writing the base-table update.
@@ -2287,10 +2341,136 @@ future<row_locker::lock_holder> table::do_push_view_replica_updates(schema_ptr s
 
 }
 
+/**
+ * Generates and sends the view updates of a base table write which needs to
+ * read existing rows, together with the concurrent writes to the same rows.
+ *
+ * The first such write opens a group and waits for the lock the write would
+ * take on its own: the lock of its row if it affects a single row, or else
+ * the lock of the whole partition. The writes arriving while it waits join
+ * the group if the lock covers them, instead of waiting for the lock
+ * themselves; writes to other rows keep locking only their own rows. Once
+ * the lock is taken, the group is closed, the rows affected by all of its
+ * writes are read at once, and the view updates are generated from the
+ * merged writes, so each affected view partition receives a single update
+ * for the whole group. All the writes of the group share the lock, which is
+ * released after the last of them was applied to the base table.
+ *
+ * A write which joined a group fails at its own timeout if the group didn't
+ * take the lock by then, and its view updates are not generated. If the
+ * first write fails to take the lock, the writes which joined it wait for
+ * the lock on their own.
+ */
+future<row_locker::lock_holder> table::push_coalesced_view_replica_updates(schema_ptr base, mutation m, query::clustering_row_ranges cr_ranges,
+        db::timeout_clock::time_point timeout, tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem, gc_clock::time_point now) const {
+    using joined_write = view_update_group::joined_write;
+    auto token = m.token();
+    auto row = locked_row(*base, cr_ranges);
+    auto units = seastar::consume_units(*_config.view_update_concurrency_semaphore, m.partition().external_memory_usage(*base));
+    auto [first, last] = _view_update_groups.equal_range(token);
+    auto it = std::find_if(first, last, [&] (const auto& x) {
+        const view_update_group& g = *x.second;
+        // A write of another schema version, or to another partition with the same token, can't join.
+        if (g.m.schema() != base || !g.m.decorated_key().equal(*base, m.decorated_key())) {
+            return false;
+        }
+        return !g.row || (row && clustering_key_prefix::equality(*base)(*g.row, *row));
+    });
+    if (it != last) {
+        auto group = it->second;
+        tracing::trace(tr_state, "Coalescing view updates with {} other writes", group->joined.size() + 1);
+        auto w = make_lw_shared<joined_write>(std::move(m), std::move(units));
+        if (timeout != db::no_timeout) {
+            w->expiry.set_callback([w = w.get()] {
+                w->timed_out = true;
+                w->units.return_all();
+                w->done.set_exception(timed_out_error());
+            });
+            w->expiry.arm(timeout);
+        }
+        group->joined.push_back(w);
+        auto lock = co_await w->done.get_future();
+        if (!lock) {
+            tracing::trace(tr_state, "Coalesced write failed to take the lock, taking it alone");
+            co_return co_await do_push_view_replica_updates(std::move(base), std::move(w->m), timeout, as_mutation_source(),
+                    std::move(tr_state), sem, service::get_local_sstable_query_read_priority(), {}, false);
+        }
+        co_return row_locker::lock_holder(std::move(lock));
+    }
+
+    auto group = make_lw_shared<view_update_group>(std::move(m), std::move(row), std::move(units));
+    _view_update_groups.emplace(token, group);
+    auto close_group = [this, &token, &group] {
+        auto range = _view_update_groups.equal_range(token);
+        auto open = std::find_if(range.first, range.second, [&group] (const auto& x) { return x.second == group; });
+        if (open != range.second) {
+            _view_update_groups.erase(open);
+        }
+    };
+    lw_shared_ptr<row_locker::lock_holder> lock;
+    std::exception_ptr ex;
+    try {
+        future<row_locker::lock_holder> lockf = local_base_lock(base, group->m.decorated_key(), cr_ranges, timeout);
+        co_await utils::get_local_injector().inject("table_push_view_replica_updates_timeout", timeout);
+        lock = make_lw_shared<row_locker::lock_holder>(co_await std::move(lockf));
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    close_group();
+    std::vector<lw_shared_ptr<joined_write>> joined;
+    for (auto& w : group->joined) {
+        if (w->timed_out) {
+            continue;
+        }
+        w->expiry.cancel();
+        if (ex) {
+            // Let the write wait for the lock with its own timeout
+            w->units.return_all();
+            w->done.set_value(nullptr);
+            continue;
+        }
+        group->m.apply(std::move(w->m));
+        group->units.adopt(std::move(w->units));
+        joined.push_back(std::move(w));
+    }
+    if (ex) {
+        std::rethrow_exception(std::move(ex));
+    }
+    _config.cf_stats->total_view_updates_coalesced += joined.size();
+    try {
+        if (!joined.empty()) {
+            tracing::trace(tr_state, "Generating view updates for {} writes", joined.size() + 1);
+        }
+        auto views = db::view::with_base_info_snapshot(affected_views(base, group->m));
+        auto merged_ranges = co_await db::view::calculate_affected_clustering_ranges(*base, group->m.decorated_key(), group->m.partition(), views);
+        auto slice = make_view_update_read_slice(*base, std::move(merged_ranges), {});
+        auto pk = dht::partition_range::make_singular(group->m.decorated_key());
+        auto permit = sem.make_tracking_only_permit(base.get(), "push-view-updates-2");
+        auto reader = as_mutation_source().make_reader(base, permit, pk, slice, service::get_local_sstable_query_read_priority(), tr_state,
+                streamed_mutation::forwarding::no, mutation_reader::forwarding::no);
+        co_await this->generate_and_propagate_view_updates(base, std::move(permit), std::move(views), std::move(group->m), std::move(reader), tr_state, now);
+        tracing::trace(tr_state, "View updates for {}.{} were generated and propagated", base->ks_name(), base->cf_name());
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    group->units.return_all();
+    for (auto& w : joined) {
+        if (ex) {
+            w->done.set_exception(ex);
+        } else {
+            w->done.set_value(lock);
+        }
+    }
+    if (ex) {
+        std::rethrow_exception(std::move(ex));
+    }
+    co_return row_locker::lock_holder(std::move(lock));
+}
+
 future<row_locker::lock_holder> table::push_view_replica_updates(const schema_ptr& s, mutation&& m, db::timeout_clock::time_point timeout,
         tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem) const {
     return do_push_view_replica_updates(s, std::move(m), timeout, as_mutation_source(),
-            std::move(tr_state), sem, service::get_local_sstable_query_read_priority(), {});
+            std::move(tr_state), sem, service::get_local_sstable_query_read_priority(), {}, _config.enable_view_update_coalescing());
 }
 
 future<row_locker::lock_holder>
@@ -2304,7 +2484,8 @@ table::stream_view_replica_updates(const schema_ptr& s, mutation&& m, db::timeou
             tracing::trace_state_ptr(),
             *_config.streaming_read_concurrency_semaphore,
             service::get_local_streaming_priority(),
-            query::partition_slice::option_set::of<query::partition_slice::option::bypass_cache>());
+            query::partition_slice::option_set::of<query::partition_slice::option::bypass_cache>(),
+            false);
 }
 
 mutation_source
@@ -22,6 +22,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <boost/range/adaptor/map.hpp>
+#include <boost/range/irange.hpp>
 
 #include <stdlib.h>
 #include <iostream>
@@ -109,6 +110,30 @@ SEASTAR_TEST_CASE(test_commitlog_written_to_disk_batch){
         });
 }
 
+// check that concurrent writes are all synced when batch syncs may be delayed
+SEASTAR_TEST_CASE(test_commitlog_written_to_disk_group_commit){
+    commitlog::config cfg;
+    cfg.mode = commitlog::sync_mode::BATCH;
+    cfg.max_group_commit_delay = std::chrono::milliseconds(10);
+    return cl_test(cfg, [](commitlog& log) {
+        return do_for_each(boost::irange(0, 10), [&log] (int) {
+            return parallel_for_each(boost::irange(0, 100), [&log] (int) {
+                sstring tmp = "hej bubba cow";
+                return log.add_mutation(utils::UUID_gen::get_time_UUID(), tmp.size(), db::commitlog::force_sync::no, [tmp](db::commitlog::output& dst) {
+                    dst.write(tmp.data(), tmp.size());
+                }).then([&log](replay_position rp) {
+                    BOOST_CHECK_NE(rp, db::replay_position());
+                    BOOST_REQUIRE(log.get_flush_count() > 0);
+                });
+            });
+        }).then([&log] {
+            // Some syncs were delayed, so writes were committed together.
+            BOOST_REQUIRE_GT(log.get_delayed_syncs(), 0);
+            BOOST_REQUIRE_LT(log.get_flush_count(), 1000);
+        });
+    });
+}
+
 // check that an entry marked as sync is immediately flushed to a storage
 SEASTAR_TEST_CASE(test_commitlog_written_to_disk_sync){
     commitlog::config cfg;
@@ -400,3 +400,33 @@ SEASTAR_THREAD_TEST_CASE(test_prefix_compound_validity) {
     BOOST_REQUIRE_THROW(validate({'\x00', '\x01', 0, '\x00', '\x02', 'a', 'b', '\x00', '\x01', 'a'}), marshal_exception); // to many components
     BOOST_REQUIRE_THROW(validate({'\x00', '\x02', 'a', 'b', '\x00', '\x01', 0}), marshal_exception); // wrong order of components
 }
+
+SEASTAR_THREAD_TEST_CASE(test_component_comparators_agree_with_types) {
+    auto random_value = [] {
+        bytes b(bytes::initialized_later(), tests::random::get_int<size_t>(0, 8));
+        for (auto& c : b) {
+            // Include bytes with the most significant bit set, which compare
+            // differently as signed and unsigned.
+            c = tests::random::get_int<unsigned>(0, 255);
+        }
+        return b;
+    };
+    auto sign = [] (int c) { return c < 0 ? -1 : c > 0 ? 1 : 0; };
+
+    for (data_type type : std::vector<data_type>{bytes_type, reversed_type_impl::get_instance(bytes_type), int32_type, reversed_type_impl::get_instance(int32_type)}) {
+        compound_type<allow_prefixes::yes> t({type});
+        BOOST_REQUIRE_EQUAL(t.comparators().size(), 1);
+        auto& cmp = t.comparators().front();
+        for (int i = 0; i < 1000; ++i) {
+            auto v1 = random_value();
+            auto v2 = random_value();
+            if (!type->without_reversed().is_byte_order_comparable()) {
+                // Only valid values of other types can be compared.
+                v1 = type->decompose(tests::random::get_int<int32_t>(std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+                v2 = type->decompose(tests::random::get_int<int32_t>(std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+            }
+            BOOST_REQUIRE_EQUAL(sign(cmp(managed_bytes_view(bytes_view(v1)), managed_bytes_view(bytes_view(v2)))), sign(type->compare(v1, v2)));
+            BOOST_REQUIRE_EQUAL(sign(t.compare(managed_bytes_view(t.serialize_single(v1)), managed_bytes_view(t.serialize_single(v2)))), sign(type->compare(v1, v2)));
+        }
+    }
+}
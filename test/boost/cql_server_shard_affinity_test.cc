@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/testing/test_case.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+#include "transport/server.hh"
+
+using cql_transport::shard_affinity;
+
+SEASTAR_THREAD_TEST_CASE(test_shard_affinity_follows_required_shards) {
+    const unsigned other = this_shard_id() + 1;
+    shard_affinity a;
+    BOOST_REQUIRE(!a.affine_shard());
+
+    for (unsigned i = 0; i < shard_affinity::threshold - 1; ++i) {
+        a.required_shard(other);
+    }
+    BOOST_REQUIRE(!a.affine_shard());
+    a.required_shard(other);
+    BOOST_REQUIRE_EQUAL(a.affine_shard().value_or(this_shard_id()), other);
+
+    // Statements which had to run elsewhere weaken the affinity.
+    a.required_shard(this_shard_id());
+    BOOST_REQUIRE(!a.affine_shard());
+    a.required_shard(other);
+    BOOST_REQUIRE(a.affine_shard());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_shard_affinity_moves_to_new_shard) {
+    const unsigned first = this_shard_id() + 1;
+    const unsigned second = this_shard_id() + 2;
+    shard_affinity a;
+
+    for (unsigned i = 0; i < shard_affinity::max_score * 2; ++i) {
+        a.required_shard(first);
+    }
+    BOOST_REQUIRE_EQUAL(a.affine_shard().value_or(this_shard_id()), first);
+
+    // The score is capped, so the affinity moves after a bounded number of
+    // statements which required another shard.
+    for (unsigned i = 0; i < shard_affinity::max_score - shard_affinity::threshold + 1; ++i) {
+        a.required_shard(second);
+    }
+    BOOST_REQUIRE(!a.affine_shard());
+    for (unsigned i = 0; i < shard_affinity::threshold * 2 + 1; ++i) {
+        a.required_shard(second);
+    }
+    BOOST_REQUIRE_EQUAL(a.affine_shard().value_or(this_shard_id()), second);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_shard_affinity_to_own_shard) {
+    shard_affinity a;
+    for (unsigned i = 0; i < shard_affinity::max_score; ++i) {
+        a.required_shard(this_shard_id());
+    }
+    // Statements are executed here anyway.
+    BOOST_REQUIRE(!a.affine_shard());
+}
@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <set>
+
+#include <seastar/core/iostream.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/net/api.hh>
+#include <seastar/testing/test_case.hh>
+#include <seastar/util/defer.hh>
+
+#include "db/config.hh"
+#include "service/memory_limiter.hh"
+#include "timeout_config.hh"
+#include "transport/response.hh"
+#include "transport/server.hh"
+#include "test/lib/cql_assertions.hh"
+#include "test/lib/cql_test_env.hh"
+
+using namespace std::chrono_literals;
+using cql_transport::cql_binary_opcode;
+
+// A minimal client of version 4 of the native protocol, which sends
+// requests and reads responses as they are, so that they can be pipelined.
+class test_client {
+    connected_socket _socket;
+    input_stream<char> _in;
+    output_stream<char> _out;
+public:
+    struct response {
+        int16_t stream;
+        cql_binary_opcode opcode;
+        bytes body;
+    };
+
+    explicit test_client(socket_address addr)
+        : _socket(seastar::connect(addr).get0())
+        , _in(_socket.input())
+        , _out(_socket.output())
+    {
+        send(0, cql_binary_opcode::STARTUP, string_map_body({{"CQL_VERSION", "3.0.0"}}));
+        BOOST_REQUIRE(receive().opcode == cql_binary_opcode::READY);
+    }
+
+    void close() {
+        _out.close().get();
+        _in.close().get();
+    }
+
+    static void write_short(std::string& body, uint16_t v) {
+        body.push_back(char(v >> 8));
+        body.push_back(char(v));
+    }
+
+    static void write_int(std::string& body, uint32_t v) {
+        write_short(body, v >> 16);
+        write_short(body, v);
+    }
+
+    static std::string string_map_body(const std::map<std::string, std::string>& map) {
+        std::string body;
+        write_short(body, map.size());
+        for (auto& [k, v] : map) {
+            write_short(body, k.size());
+            body += k;
+            write_short(body, v.size());
+            body += v;
+        }
+        return body;
+    }
+
+    static std::string query_body(std::string_view query) {
+        std::string body;
+        write_int(body, query.size());
+        body += query;
+        write_short(body, uint16_t(db::consistency_level::ONE));
+        body.push_back(0); // flags
+        return body;
+    }
+
+    static std::string prepare_body(std::string_view query) {
+        std::string body;
+        write_int(body, query.size());
+        body += query;
+        return body;
+    }
+
+    static std::string execute_body(bytes_view id) {
+        std::string body;
+        write_short(body, id.size());
+        body.append(reinterpret_cast<const char*>(id.data()), id.size());
+        write_short(body, uint16_t(db::consistency_level::ONE));
+        body.push_back(0); // flags
+        return body;
+    }
+
+    // Requests sent without waiting for the responses of each other are
+    // sent by a single write.
+    void send_all(const std::vector<std::tuple<int16_t, cql_binary_opcode, std::string>>& requests) {
+        std::string frames;
+        for (auto& [stream, opcode, body] : requests) {
+            frames.push_back(char(0x04)); // version
+            frames.push_back(0); // flags
+            write_short(frames, stream);
+            frames.push_back(char(opcode));
+            write_int(frames, body.size());
+            frames += body;
+        }
+        _out.write(frames.data(), frames.size()).get();
+        _out.flush().get();
+    }
+
+    void send(int16_t stream, cql_binary_opcode opcode, std::string body) {
+        send_all({{stream, opcode, std::move(body)}});
+    }
+
+    response receive() {
+        auto header = _in.read_exactly(9).get0();
+        BOOST_REQUIRE_EQUAL(header.size(), 9);
+        auto p = reinterpret_cast<const uint8_t*>(header.get());
+        BOOST_REQUIRE_EQUAL(p[0], 0x84);
+        int16_t stream = (p[2] << 8) | p[3];
+        auto opcode = cql_binary_opcode(p[4]);
+        uint32_t length = (uint32_t(p[5]) << 24) | (uint32_t(p[6]) << 16) | (uint32_t(p[7]) << 8) | p[8];
+        auto body = _in.read_exactly(length).get0();
+        BOOST_REQUIRE_EQUAL(body.size(), length);
+        return response{stream, opcode, bytes(reinterpret_cast<const int8_t*>(body.get()), body.size())};
+    }
+
+    // Returns the id of the prepared statement.
+    bytes prepare(std::string_view query) {
+        send(1, cql_binary_opcode::PREPARE, prepare_body(query));
+        auto r = receive();
+        BOOST_REQUIRE(r.opcode == cql_binary_opcode::RESULT);
+        // [int kind = Prepared][short bytes id]...
+        auto p = reinterpret_cast<const uint8_t*>(r.body.data());
+        BOOST_REQUIRE_EQUAL(p[3], 0x04);
+        uint16_t id_size = (p[4] << 8) | p[5];
+        return bytes(r.body.data() + 6, id_size);
+    }
+
+    response execute(bytes_view id) {
+        send(1, cql_binary_opcode::EXECUTE, execute_body(id));
+        return receive();
+    }
+};
+
+// The port is picked by the kernel.
+static socket_address free_local_address() {
+    listen_options lo;
+    lo.reuse_address = true;
+    auto ss = seastar::listen(socket_address(net::inet_address("127.0.0.1"), 0), lo);
+    auto addr = ss.local_address();
+    ss.abort_accept();
+    return addr;
+}
+
+static void with_cql_server(cql_test_env& e, std::chrono::microseconds flush_delay,
+        std::function<void (sharded<cql_transport::cql_server>&, socket_address)> func) {
+    auto& cfg = e.local_db().get_config();
+    sharded<service::memory_limiter> ml;
+    ml.start(memory::stats().total_memory()).get();
+    auto stop_ml = defer([&ml] { ml.stop().get(); });
+
+    cql_transport::cql_server_config config;
+    config.timeout_config = make_timeout_config(cfg);
+    config.max_request_size = ml.local().total_memory();
+    config.partitioner_name = cfg.partitioner();
+    config.sharding_ignore_msb = cfg.murmur3_partitioner_ignore_msb_bits();
+    config.response_flush_delay = flush_delay;
+
+    sharded<cql_transport::cql_server> server;
+    server.start(std::ref(e.qp()),
+            sharded_parameter([&e] { return std::ref(e.local_auth_service()); }),
+            sharded_parameter([&e] { return std::ref(e.local_mnotifier()); }),
+            std::ref(ml), config, std::cref(cfg),
+            sharded_parameter([&e] { return std::ref(e.local_sl_controller()); })).get();
+    auto stop_server = defer([&server] { server.stop().get(); });
+
+    auto addr = free_local_address();
+    server.invoke_on_all(&cql_transport::cql_server::listen, addr, std::shared_ptr<seastar::tls::credentials_builder>(), false, false).get();
+    func(server, addr);
+}
+
+template <typename Func>
+static uint64_t sum_stats(sharded<cql_transport::cql_server>& server, Func func) {
+    return server.map_reduce0([func] (const cql_transport::cql_server& s) {
+        return uint64_t(func(s.get_stats()));
+    }, uint64_t(0), std::plus<uint64_t>()).get0();
+}
+
+SEASTAR_TEST_CASE(test_execute) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE ks.t (p int PRIMARY KEY, v int)").get();
+        with_cql_server(e, 0us, [&e] (sharded<cql_transport::cql_server>& server, socket_address addr) {
+            test_client c(addr);
+            // The conditional statement has to run on the shard owning the
+            // partition, the other one runs on any shard.
+            auto insert = c.prepare("INSERT INTO ks.t (p, v) VALUES (1, 1) IF NOT EXISTS");
+            auto select = c.prepare("SELECT v FROM ks.t WHERE p = 1");
+            for (int i = 0; i < 3; ++i) {
+                BOOST_REQUIRE(c.execute(insert).opcode == cql_binary_opcode::RESULT);
+                BOOST_REQUIRE(c.execute(select).opcode == cql_binary_opcode::RESULT);
+            }
+
+            // A statement which isn't prepared is reported as such.
+            auto r = c.execute(bytes(16, int8_t(0)));
+            BOOST_REQUIRE(r.opcode == cql_binary_opcode::ERROR);
+            auto p = reinterpret_cast<const uint8_t*>(r.body.data());
+            BOOST_REQUIRE_EQUAL((uint32_t(p[2]) << 8) | p[3], uint32_t(exceptions::exception_code::UNPREPARED));
+
+            BOOST_REQUIRE_EQUAL(sum_stats(server, [] (auto& stats) { return stats.execute_requests; }), 7);
+            c.close();
+        });
+        assert_that(e.execute_cql("SELECT v FROM ks.t WHERE p = 1").get0()).is_rows().with_rows({{int32_type->decompose(1)}});
+    });
+}
+
+// Pipelines requests on a single connection, and returns the number of
+// times their responses were flushed.
+static uint64_t pipeline_requests(cql_test_env& e, std::chrono::microseconds flush_delay, int16_t nr_requests) {
+    uint64_t flushes = 0;
+    with_cql_server(e, flush_delay, [&] (sharded<cql_transport::cql_server>& server, socket_address addr) {
+        test_client c(addr);
+        auto flushes_before = sum_stats(server, [] (auto& stats) { return stats.response_flushes; });
+        std::vector<std::tuple<int16_t, cql_binary_opcode, std::string>> requests;
+        for (int16_t stream = 1; stream <= nr_requests; ++stream) {
+            requests.emplace_back(stream, cql_binary_opcode::QUERY, test_client::query_body(format("SELECT v FROM ks.t WHERE p = {}", stream)));
+        }
+        c.send_all(requests);
+
+        std::set<int16_t> streams;
+        for (int16_t i = 0; i < nr_requests; ++i) {
+            auto r = c.receive();
+            BOOST_REQUIRE(r.opcode == cql_binary_opcode::RESULT);
+            streams.insert(r.stream);
+        }
+        BOOST_REQUIRE_EQUAL(streams.size(), size_t(nr_requests));
+        BOOST_REQUIRE_EQUAL(*streams.begin(), 1);
+        BOOST_REQUIRE_EQUAL(*streams.rbegin(), nr_requests);
+        flushes = sum_stats(server, [] (auto& stats) { return stats.response_flushes; }) - flushes_before;
+        c.close();
+    });
+    return flushes;
+}
+
+SEASTAR_TEST_CASE(test_pipelined_responses_flush) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE ks.t (p int PRIMARY KEY, v int)").get();
+        constexpr int16_t nr_requests = 16;
+
+        // Without a delay, responses written while others are queued behind
+        // them are still sent together, but how many are depends on timing.
+        auto flushes = pipeline_requests(e, 0us, nr_requests);
+        BOOST_REQUIRE_GE(flushes, 1);
+        BOOST_REQUIRE_LE(flushes, nr_requests);
+
+        // With a delay, the responses of requests in flight together wait
+        // for each other.
+        flushes = pipeline_requests(e, 100ms, nr_requests);
+        BOOST_REQUIRE_GE(flushes, 1);
+        BOOST_REQUIRE_LT(flushes, nr_requests);
+    });
+}
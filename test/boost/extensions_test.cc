@@ -36,6 +36,9 @@
 #include "sstables/sstables.hh"
 #include "cdc/cdc_extension.hh"
 #include "db/paxos_grace_seconds_extension.hh"
+#include "db/bloom_filter_format_extension.hh"
+#include "db/sstable_index_format_extension.hh"
+#include "db/unlogged_ingest_extension.hh"
 #include "transport/messages/result_message.hh"
 #include "utils/overloaded_functor.hh"
 
@@ -175,6 +178,68 @@ SEASTAR_TEST_CASE(paxos_grace_seconds_extension) {
     }, cfg);
 }
 
+SEASTAR_TEST_CASE(bloom_filter_format_extension) {
+    auto ext = std::make_shared<db::extensions>();
+    ext->add_schema_extension<db::bloom_filter_format_extension>(db::bloom_filter_format_extension::NAME);
+    auto cfg = ::make_shared<db::config>(ext);
+
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE cf (pk int PRIMARY KEY) WITH bloom_filter_format='split_block'").get();
+        auto s = e.local_db().find_column_family("ks", "cf").schema();
+        BOOST_REQUIRE(s->bloom_filter_format() == utils::filter_format::split_block_format);
+
+        e.execute_cql("ALTER TABLE cf WITH bloom_filter_format='standard'").get();
+        s = e.local_db().find_column_family("ks", "cf").schema();
+        BOOST_REQUIRE(s->bloom_filter_format() == utils::filter_format::m_format);
+
+        BOOST_REQUIRE_THROW(e.execute_cql("CREATE TABLE cf2 (pk int PRIMARY KEY) WITH bloom_filter_format='xor'").get(),
+                exceptions::configuration_exception);
+    }, cfg);
+}
+
+SEASTAR_TEST_CASE(sstable_index_format_extension) {
+    auto ext = std::make_shared<db::extensions>();
+    ext->add_schema_extension<db::sstable_index_format_extension>(db::sstable_index_format_extension::NAME);
+    auto cfg = ::make_shared<db::config>(ext);
+
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE cf (pk int PRIMARY KEY) WITH sstable_index_format='trie'").get();
+        auto s = e.local_db().find_column_family("ks", "cf").schema();
+        BOOST_REQUIRE(s->get_sstable_index_format() == sstable_index_format::trie);
+
+        e.execute_cql("ALTER TABLE cf WITH sstable_index_format='standard'").get();
+        s = e.local_db().find_column_family("ks", "cf").schema();
+        BOOST_REQUIRE(s->get_sstable_index_format() == sstable_index_format::standard);
+
+        BOOST_REQUIRE_THROW(e.execute_cql("CREATE TABLE cf2 (pk int PRIMARY KEY) WITH sstable_index_format='btree'").get(),
+                exceptions::configuration_exception);
+    }, cfg);
+}
+
+SEASTAR_TEST_CASE(unlogged_ingest_extension) {
+    auto ext = std::make_shared<db::extensions>();
+    ext->add_schema_extension<db::unlogged_ingest_extension>(db::unlogged_ingest_extension::NAME);
+    auto cfg = ::make_shared<db::config>(ext);
+
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE cf (pk int PRIMARY KEY, v int) WITH unlogged_ingest=true").get();
+        e.execute_cql("CREATE TABLE cf2 (pk int PRIMARY KEY, v int)").get();
+        auto& cf = e.local_db().find_column_family("ks", "cf");
+        BOOST_REQUIRE(cf.schema()->unlogged_ingest());
+        BOOST_REQUIRE(!cf.durable_writes());
+        BOOST_REQUIRE(e.local_db().find_column_family("ks", "cf2").durable_writes());
+
+        e.execute_cql("INSERT INTO cf (pk, v) VALUES (1, 1)").get();
+        assert_that(e.execute_cql("SELECT v FROM cf WHERE pk = 1").get0()).is_rows().with_rows({{int32_type->decompose(1)}});
+
+        e.execute_cql("ALTER TABLE cf WITH unlogged_ingest=false").get();
+        BOOST_REQUIRE(e.local_db().find_column_family("ks", "cf").durable_writes());
+
+        BOOST_REQUIRE_THROW(e.execute_cql("CREATE TABLE cf3 (pk int PRIMARY KEY) WITH unlogged_ingest='maybe'").get(),
+                exceptions::configuration_exception);
+    }, cfg);
+}
+
 SEASTAR_TEST_CASE(test_extension_remove) {
     auto ext = std::make_shared<db::extensions>();
     ext->add_schema_extension("knas", [](db::extensions::schema_ext_config args) {
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/core/file.hh>
+#include <seastar/testing/test_case.hh>
+#include <seastar/util/defer.hh>
+
+#include "db/commitlog/commitlog.hh"
+#include "db/commitlog/commitlog_entry.hh"
+#include "db/hints/manager.hh"
+#include "db/hints/resource_manager.hh"
+#include "gms/feature.hh"
+#include "gms/gossiper.hh"
+#include "service/storage_proxy.hh"
+#include "utils/fb_utilities.hh"
+#include "test/lib/cql_test_env.hh"
+#include "test/lib/cql_assertions.hh"
+#include "test/lib/tmpdir.hh"
+
+using namespace std::chrono_literals;
+
+// More hints than fit in two HINT_MUTATIONS messages (128 hints each).
+static constexpr int hint_count = 300;
+
+// Writes hints towards the local node the way the hints manager stores them,
+// since the manager itself never hints for the local node.
+static void write_hints(cql_test_env& e, const sstring& hints_dir) {
+    auto s = e.local_db().find_schema("ks", "t");
+    const sstring ep_dir = format("{}/{:d}/{}", hints_dir, this_shard_id(), utils::fb_utilities::get_broadcast_address());
+    recursive_touch_directory(ep_dir).get();
+
+    db::commitlog::config cfg;
+    cfg.commit_log_location = ep_dir;
+    cfg.fname_prefix = db::hints::manager::FILENAME_PREFIX;
+    cfg.reuse_segments = false;
+    cfg.warn_about_segments_left_on_disk_after_shutdown = false;
+    cfg.extensions = &e.local_db().extensions();
+    auto log = db::commitlog::create_commitlog(std::move(cfg)).get0();
+    for (int i = 0; i < hint_count; ++i) {
+        mutation m(s, partition_key::from_single_value(*s, int32_type->decompose(i)));
+        m.set_clustered_cell(clustering_key::make_empty(), "v", data_value(i), api::new_timestamp());
+        auto fm = freeze(m);
+        commitlog_entry_writer cew(s, fm, db::commitlog::force_sync::no);
+        log.add_entry(s->id(), cew, db::timeout_clock::now() + 10s).get0().release();
+    }
+    log.shutdown().get();
+    log.release().get();
+}
+
+// Replays the hints written by write_hints() with a hints manager of its own
+// and returns the statistics of the replay.
+static db::hints::manager::stats replay_hints(cql_test_env& e, const sstring& hints_dir) {
+    auto& cfg = e.local_db().get_config();
+    db::hints::resource_manager res_manager(memory::stats().total_memory() / 10, cfg.max_hinted_handoff_concurrency);
+    db::hints::manager manager(hints_dir, db::hints::host_filter(), cfg.max_hint_window_in_ms(), res_manager, e.db());
+    res_manager.register_manager(manager).get();
+    res_manager.start(service::get_local_shared_storage_proxy(), gms::get_local_gossiper().shared_from_this()).get();
+    auto stop_res_manager = defer([&res_manager] { res_manager.stop().get(); });
+    res_manager.allow_replaying();
+
+    manager.wait_until_hints_are_replayed({utils::fb_utilities::get_broadcast_address()}, db::hints::timer_clock_type::now() + 60s).get();
+    return manager.get_stats();
+}
+
+static void check_hints_applied(cql_test_env& e) {
+    auto msg = e.execute_cql("SELECT pk FROM ks.t").get0();
+    assert_that(msg).is_rows().with_size(hint_count);
+}
+
+SEASTAR_TEST_CASE(test_hints_replayed_in_batches) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE ks.t (pk int PRIMARY KEY, v int)").get();
+        BOOST_REQUIRE(service::get_local_storage_proxy().features().cluster_supports_hint_mutations_batch());
+
+        tmpdir hints_dir;
+        write_hints(e, hints_dir.path().string());
+        auto stats = replay_hints(e, hints_dir.path().string());
+
+        BOOST_REQUIRE_EQUAL(stats.sent, uint64_t(hint_count));
+        BOOST_REQUIRE_GE(stats.sent_batches, 3u);
+        BOOST_REQUIRE_GT(stats.sent_bytes, 0u);
+        check_hints_applied(e);
+    });
+}
+
+SEASTAR_TEST_CASE(test_hints_replayed_one_by_one_without_batch_feature) {
+    cql_test_config cfg;
+    cfg.disabled_features.insert(sstring(gms::features::HINT_MUTATIONS_BATCH));
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE ks.t (pk int PRIMARY KEY, v int)").get();
+        BOOST_REQUIRE(!service::get_local_storage_proxy().features().cluster_supports_hint_mutations_batch());
+
+        tmpdir hints_dir;
+        write_hints(e, hints_dir.path().string());
+        auto stats = replay_hints(e, hints_dir.path().string());
+
+        BOOST_REQUIRE_EQUAL(stats.sent, uint64_t(hint_count));
+        BOOST_REQUIRE_EQUAL(stats.sent_batches, 0u);
+        check_hints_applied(e);
+    }, std::move(cfg));
+}
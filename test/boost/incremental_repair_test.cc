@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/range/algorithm/copy.hpp>
+
+#include <seastar/testing/test_case.hh>
+#include <seastar/util/closeable.hh>
+
+#include "database.hh"
+#include "compaction_strategy.hh"
+#include "sstables/sstables.hh"
+#include "test/lib/cql_test_env.hh"
+
+static constexpr uint64_t repaired_at = 1000;
+
+// Enough rows for every shard to get some of them.
+static constexpr int rows_per_sstable = 200;
+
+static void create_table(cql_test_env& e) {
+    e.execute_cql("CREATE TABLE ks.t (pk int PRIMARY KEY, v int)"
+            " WITH compaction = {'class': 'SizeTieredCompactionStrategy', 'min_threshold': 2}").get();
+    e.db().invoke_on_all([] (database& db) {
+        db.find_column_family("ks", "t").disable_auto_compaction();
+    }).get();
+}
+
+static void insert_rows(cql_test_env& e, int first, int last) {
+    for (int i = first; i < last; ++i) {
+        e.execute_cql(format("INSERT INTO ks.t (pk, v) VALUES ({}, {})", i, i)).get();
+    }
+}
+
+// Writes a new sstable with rows_per_sstable rows on every shard.
+static void write_sstable(cql_test_env& e, int first) {
+    insert_rows(e, first, first + rows_per_sstable);
+    e.db().invoke_on_all([] (database& db) {
+        return db.flush("ks", "t");
+    }).get();
+}
+
+// Marks all sstables of ks.t on all shards as repaired, the way a successful
+// incremental repair does.
+static void mark_all_repaired(cql_test_env& e) {
+    e.db().invoke_on_all([] (database& db) {
+        return do_with(db.find_column_family("ks", "t").get_sstables(), [] (auto& sstables) {
+            return parallel_for_each(*sstables, [] (const sstables::shared_sstable& sst) {
+                return sst->mutate_repaired_at(repaired_at);
+            });
+        });
+    }).get();
+}
+
+static std::vector<sstables::shared_sstable> local_sstables(cql_test_env& e) {
+    std::vector<sstables::shared_sstable> ret;
+    boost::copy(*e.local_db().find_column_family("ks", "t").get_sstables(), std::back_inserter(ret));
+    return ret;
+}
+
+static bool all_repaired(const std::vector<sstables::shared_sstable>& sstables) {
+    return std::all_of(sstables.begin(), sstables.end(), std::mem_fn(&sstables::sstable::is_repaired));
+}
+
+static bool none_repaired(const std::vector<sstables::shared_sstable>& sstables) {
+    return std::none_of(sstables.begin(), sstables.end(), std::mem_fn(&sstables::sstable::is_repaired));
+}
+
+static size_t count_streamed_partitions(cql_test_env& e, unrepaired_only only_unrepaired) {
+    auto s = e.local_db().find_schema("ks", "t");
+    auto reader = make_multishard_streaming_reader(e.db(), s, make_reader_permit(e),
+            [done = false] () mutable -> std::optional<dht::partition_range> {
+        if (std::exchange(done, true)) {
+            return std::nullopt;
+        }
+        return dht::partition_range::make_open_ended_both_sides();
+    }, only_unrepaired);
+    auto close_reader = deferred_close(reader);
+    size_t count = 0;
+    while (read_mutation_from_flat_mutation_reader(reader, db::no_timeout).get0()) {
+        ++count;
+    }
+    return count;
+}
+
+SEASTAR_TEST_CASE(test_compaction_never_mixes_repaired_and_unrepaired_sstables) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        create_table(e);
+        write_sstable(e, 0);
+        write_sstable(e, rows_per_sstable);
+        mark_all_repaired(e);
+        write_sstable(e, 2 * rows_per_sstable);
+        write_sstable(e, 3 * rows_per_sstable);
+
+        auto& cf = e.local_db().find_column_family("ks", "t");
+        auto& cs = cf.get_compaction_strategy();
+        auto [unrepaired, repaired] = sstables::partition_by_repaired_status(local_sstables(e));
+        BOOST_REQUIRE_EQUAL(unrepaired.size(), 2);
+        BOOST_REQUIRE_EQUAL(repaired.size(), 2);
+        BOOST_REQUIRE(none_repaired(unrepaired));
+        BOOST_REQUIRE(all_repaired(repaired));
+
+        // All four sstables are in the same size tier, but the unrepaired
+        // ones are compacted first, on their own.
+        auto desc = cs.get_sstables_for_compaction(cf, local_sstables(e));
+        BOOST_REQUIRE_EQUAL(desc.sstables.size(), 2);
+        BOOST_REQUIRE(none_repaired(desc.sstables));
+
+        // A single unrepaired sstable is not compacted with the repaired ones.
+        auto candidates = repaired;
+        candidates.push_back(unrepaired.front());
+        desc = cs.get_sstables_for_compaction(cf, candidates);
+        BOOST_REQUIRE_EQUAL(desc.sstables.size(), 2);
+        BOOST_REQUIRE(all_repaired(desc.sstables));
+
+        // Major compaction compacts each set into an sstable of its own, and
+        // the output of the repaired set stays repaired.
+        cf.compact_all_sstables().get();
+        std::tie(unrepaired, repaired) = sstables::partition_by_repaired_status(local_sstables(e));
+        BOOST_REQUIRE_EQUAL(unrepaired.size(), 1);
+        BOOST_REQUIRE_EQUAL(repaired.size(), 1);
+        BOOST_REQUIRE_EQUAL(repaired.front()->get_repaired_at(), repaired_at);
+    });
+}
+
+SEASTAR_TEST_CASE(test_streaming_reader_skips_repaired_sstables) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        create_table(e);
+        write_sstable(e, 0);
+        mark_all_repaired(e);
+        write_sstable(e, rows_per_sstable);
+        // Memtables are never repaired
+        insert_rows(e, 2 * rows_per_sstable, 3 * rows_per_sstable);
+
+        BOOST_REQUIRE_EQUAL(count_streamed_partitions(e, unrepaired_only::no), 3 * rows_per_sstable);
+        BOOST_REQUIRE_EQUAL(count_streamed_partitions(e, unrepaired_only::yes), 2 * rows_per_sstable);
+    });
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/testing/test_case.hh>
+#include <seastar/testing/thread_test_case.hh>
+#include "test/lib/random_utils.hh"
+
+#include "repair/repair.hh"
+
+static repair_hash_set random_hashes(size_t n) {
+    repair_hash_set hashes;
+    while (hashes.size() < n) {
+        hashes.insert(repair_hash(tests::random::get_int<uint64_t>()));
+    }
+    return hashes;
+}
+
+// Builds the IBLT of `remote` with the hashes of `local` removed, the way
+// the repair master does, and decodes it.
+static bool decode_difference(const repair_hash_set& local, const repair_hash_set& remote, size_t cell_count,
+        repair_hash_set& only_remote, repair_hash_set& only_local) {
+    repair_hash_iblt iblt(cell_count);
+    for (const auto& h : remote) {
+        iblt.add(h);
+    }
+    // Like the table sent over the wire
+    repair_hash_iblt received(iblt.get_cells());
+    for (const auto& h : local) {
+        received.remove(h);
+    }
+    return received.decode(only_remote, only_local);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_iblt_of_identical_sets_is_empty) {
+    auto hashes = random_hashes(10000);
+    repair_hash_set only_remote;
+    repair_hash_set only_local;
+    BOOST_REQUIRE(decode_difference(hashes, hashes, 30, only_remote, only_local));
+    BOOST_REQUIRE(only_remote.empty());
+    BOOST_REQUIRE(only_local.empty());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_iblt_decodes_small_difference) {
+    auto common = random_hashes(10000);
+    auto remote_extra = random_hashes(100);
+    auto local_extra = random_hashes(50);
+
+    auto local = common;
+    local.insert(local_extra.begin(), local_extra.end());
+    auto remote = common;
+    remote.insert(remote_extra.begin(), remote_extra.end());
+
+    repair_hash_set only_remote;
+    repair_hash_set only_local;
+    BOOST_REQUIRE(decode_difference(local, remote, 400, only_remote, only_local));
+    BOOST_REQUIRE(only_remote == remote_extra);
+    BOOST_REQUIRE(only_local == local_extra);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_iblt_reports_too_big_difference) {
+    auto local = random_hashes(1000);
+    auto remote = random_hashes(1000);
+
+    repair_hash_set only_remote;
+    repair_hash_set only_local;
+    BOOST_REQUIRE(!decode_difference(local, remote, 300, only_remote, only_local));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_iblt_cell_count) {
+    BOOST_REQUIRE_EQUAL(repair_hash_iblt(0).size(), repair_hash_iblt::hash_count);
+    BOOST_REQUIRE_EQUAL(repair_hash_iblt(100).size() % repair_hash_iblt::hash_count, 0);
+    BOOST_REQUIRE_GE(repair_hash_iblt(100).size(), 100);
+    BOOST_REQUIRE_THROW(repair_hash_iblt(std::vector<repair_hash_iblt_cell>(101)), std::invalid_argument);
+}
+
+// Finds the difference between `local` and `remote` the way the repair
+// master does, recording the sizes of the IBLTs requested from the peer.
+static std::optional<repair_hash_set_difference> find_difference(const repair_hash_set& local, const repair_hash_set& remote,
+        size_t max_cell_count, std::vector<size_t>& sizes) {
+    return find_repair_hash_set_difference(local, 64, max_cell_count, [&remote, &sizes] (size_t cell_count) {
+        repair_hash_iblt iblt(cell_count);
+        for (const auto& h : remote) {
+            iblt.add(h);
+        }
+        sizes.push_back(iblt.size());
+        return make_ready_future<repair_hash_iblt>(std::move(iblt));
+    }).get0();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_iblt_size_follows_difference) {
+    auto common = random_hashes(100000);
+    auto remote_extra = random_hashes(20);
+    auto local = common;
+    auto remote = common;
+    remote.insert(remote_extra.begin(), remote_extra.end());
+
+    std::vector<size_t> sizes;
+    auto diff = find_difference(local, remote, remote.size() / 8, sizes);
+    BOOST_REQUIRE(diff);
+    BOOST_REQUIRE(diff->only_on_peer == remote_extra);
+    BOOST_REQUIRE(diff->only_on_local.empty());
+    // The table is sized for the 20 differing rows, not for the 100000 rows.
+    BOOST_REQUIRE_LE(diff->cell_count, 128u);
+    BOOST_REQUIRE_EQUAL(sizes.back(), diff->cell_count);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_iblt_size_doubles_until_decoded) {
+    auto common = random_hashes(100000);
+    auto remote_extra = random_hashes(1000);
+    auto local = common;
+    auto remote = common;
+    remote.insert(remote_extra.begin(), remote_extra.end());
+
+    std::vector<size_t> sizes;
+    auto diff = find_difference(local, remote, remote.size() / 8, sizes);
+    BOOST_REQUIRE(diff);
+    BOOST_REQUIRE(diff->only_on_peer == remote_extra);
+    BOOST_REQUIRE_GT(sizes.size(), 1u);
+    for (size_t i = 1; i < sizes.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(sizes[i], sizes[i - 1] * 2);
+    }
+    BOOST_REQUIRE_LT(diff->cell_count, remote.size() / 8);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_iblt_size_is_capped) {
+    auto local = random_hashes(10000);
+    auto remote = random_hashes(10000);
+
+    std::vector<size_t> sizes;
+    BOOST_REQUIRE(!find_difference(local, remote, 1250, sizes));
+    BOOST_REQUIRE_EQUAL(sizes.front(), 64u);
+    BOOST_REQUIRE_GE(sizes.back(), 1250u);
+    BOOST_REQUIRE_LT(sizes.back(), 1250u + repair_hash_iblt::hash_count);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/testing/test_case.hh>
+#include <seastar/util/closeable.hh>
+
+#include "database.hh"
+#include "repair/reader.hh"
+#include "test/lib/cql_test_env.hh"
+
+static constexpr size_t value_size = 4 * 1024;
+
+// Writes enough data for the reader of every shard to fill several buffers.
+static void populate(cql_test_env& e) {
+    e.execute_cql("CREATE TABLE ks.t (pk int, ck int, v text, PRIMARY KEY (pk, ck))").get();
+    const auto value = sstring(value_size, 'x');
+    const int nr_rows = 4 * repair_reader::buffer_size * smp::count / value_size;
+    for (int i = 0; i < nr_rows; ++i) {
+        e.execute_cql(format("INSERT INTO ks.t (pk, ck, v) VALUES ({}, {}, '{}')", i % 64, i, value)).get();
+    }
+    e.db().invoke_on_all([] (database& db) {
+        return db.flush("ks", "t");
+    }).get();
+}
+
+static reader_permit make_permit(cql_test_env& e) {
+    return e.local_db().obtain_reader_permit(e.local_db().find_column_family("ks", "t"), "repair_reader_test", db::no_timeout).get0();
+}
+
+// What the reader of the local shard is expected to return.
+static std::vector<mutation_fragment> read_all(cql_test_env& e) {
+    auto& cf = e.local_db().find_column_family("ks", "t");
+    auto s = cf.schema();
+    auto reader = cf.make_streaming_reader(s, make_permit(e), query::full_partition_range);
+    auto close_reader = deferred_close(reader);
+    std::vector<mutation_fragment> ret;
+    while (auto mf = reader(db::no_timeout).get0()) {
+        ret.push_back(std::move(*mf));
+    }
+    return ret;
+}
+
+// Reads the local shard with a repair_reader, pausing it every pause_every
+// fragments. While paused, the reader is evicted, so it is recreated from
+// where it stopped once resumed.
+static void check_repair_reader(cql_test_env& e, std::optional<size_t> pause_every) {
+    auto& cf = e.local_db().find_column_family("ks", "t");
+    auto s = cf.schema();
+    auto expected = read_all(e);
+    BOOST_REQUIRE(!expected.empty());
+
+    auto permit = make_permit(e);
+    auto& semaphore = permit.semaphore();
+    repair_reader reader(e.db(), cf, s, permit, dht::token_range::make_open_ended_both_sides(),
+            s->get_sharder(), this_shard_id(), 0, repair_reader::is_local_reader::yes, unrepaired_only::no);
+    auto close_reader = deferred_close(reader);
+
+    size_t nr_fragments = 0;
+    uint64_t evictions = 0;
+    while (auto mf = reader.read_mutation_fragment().get0()) {
+        BOOST_REQUIRE_LT(nr_fragments, expected.size());
+        BOOST_REQUIRE(mf->equal(*s, expected[nr_fragments]));
+        ++nr_fragments;
+        if (pause_every && nr_fragments % *pause_every == 0) {
+            reader.pause().get();
+            while (semaphore.try_evict_one_inactive_read()) {
+                ++evictions;
+            }
+        }
+    }
+    BOOST_REQUIRE_EQUAL(nr_fragments, expected.size());
+    if (pause_every) {
+        BOOST_REQUIRE_GT(evictions, 0);
+    }
+    reader.on_end_of_stream().get();
+}
+
+SEASTAR_TEST_CASE(test_repair_reader_read_ahead) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        populate(e);
+        check_repair_reader(e, std::nullopt);
+    });
+}
+
+SEASTAR_TEST_CASE(test_repair_reader_read_ahead_survives_pause) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        populate(e);
+        // Pausing in the middle of a buffer, while the next one is filled.
+        check_repair_reader(e, 97);
+    });
+}
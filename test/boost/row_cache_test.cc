@@ -3777,3 +3777,87 @@ SEASTAR_TEST_CASE(test_scans_erase_dummies) {
         BOOST_REQUIRE_EQUAL(tracker.get_stats().rows, 2);
     });
 }
+
+SEASTAR_TEST_CASE(test_get_cached_partitions) {
+    return seastar::async([] {
+        simple_schema s;
+        tests::reader_concurrency_semaphore_wrapper semaphore;
+        auto cache_mt = make_lw_shared<memtable>(s.schema());
+
+        auto pkeys = s.make_pkeys(3);
+        for (auto&& pkey : pkeys) {
+            mutation m(s.schema(), pkey);
+            for (int i = 0; i < 10; ++i) {
+                s.add_row(m, s.make_ckey(i), "v");
+            }
+            cache_mt->apply(m);
+        }
+
+        cache_tracker tracker;
+        row_cache cache(s.schema(), snapshot_source_from_snapshot(cache_mt->as_data_source()), tracker);
+
+        auto get_cached_partitions = [&] (size_t max_partitions) {
+            auto cached = row_cache::get_cached_partitions(tracker, max_partitions).get0();
+            BOOST_REQUIRE_LE(cached.size(), 1);
+            return cached.empty() ? std::vector<row_cache::cached_partition>() : std::move(cached[s.schema()->id()]);
+        };
+
+        BOOST_REQUIRE(get_cached_partitions(100).empty());
+
+        auto read = [&] (const dht::decorated_key& pkey, const query::partition_slice& slice) {
+            auto pr = dht::partition_range::make_singular(pkey);
+            auto rd = cache.make_reader(s.schema(), semaphore.make_permit(), pr, slice);
+            auto close_rd = deferred_close(rd);
+            rd.consume_pausable([] (mutation_fragment) { return stop_iteration::no; }, db::no_timeout).get();
+        };
+
+        auto partial_slice = partition_slice_builder(*s.schema())
+                .with_range(query::clustering_range::make({s.make_ckey(2), true}, {s.make_ckey(5), false}))
+                .build();
+        auto disjoint_slice = partition_slice_builder(*s.schema())
+                .with_range(query::clustering_range::make({s.make_ckey(1), true}, {s.make_ckey(2), false}))
+                .with_range(query::clustering_range::make({s.make_ckey(6), true}, {s.make_ckey(8), false}))
+                .build();
+        read(pkeys[0], partial_slice);
+        read(pkeys[1], disjoint_slice);
+        read(pkeys[2], s.schema()->full_slice());
+
+        auto cached = get_cached_partitions(100);
+        BOOST_REQUIRE_EQUAL(cached.size(), 3);
+
+        auto cmp = clustering_key_prefix::prefix_equal_tri_compare(*s.schema());
+        auto covered = [&] (const query::clustering_row_ranges& ranges, int ck) {
+            return std::any_of(ranges.begin(), ranges.end(), [&] (const query::clustering_range& r) {
+                return r.contains(s.make_ckey(ck), cmp);
+            });
+        };
+
+        // The most recently read partition comes first
+        BOOST_REQUIRE(cached[0].key.equal(*s.schema(), pkeys[2]));
+        BOOST_REQUIRE_EQUAL(cached[0].ranges.size(), 1);
+        BOOST_REQUIRE(cached[0].ranges.front().is_full());
+
+        // Only the ranges which were read are saved, not the span between them
+        BOOST_REQUIRE(cached[1].key.equal(*s.schema(), pkeys[1]));
+        BOOST_REQUIRE_EQUAL(cached[1].ranges.size(), 2);
+        for (int ck = 0; ck < 10; ++ck) {
+            BOOST_REQUIRE_EQUAL(covered(cached[1].ranges, ck), ck == 1 || ck == 6 || ck == 7);
+        }
+
+        BOOST_REQUIRE(cached[2].key.equal(*s.schema(), pkeys[0]));
+        BOOST_REQUIRE_EQUAL(cached[2].ranges.size(), 1);
+        for (int ck = 0; ck < 10; ++ck) {
+            BOOST_REQUIRE_EQUAL(covered(cached[2].ranges, ck), ck >= 2 && ck < 5);
+        }
+
+        cached = get_cached_partitions(1);
+        BOOST_REQUIRE_EQUAL(cached.size(), 1);
+        BOOST_REQUIRE(cached[0].key.equal(*s.schema(), pkeys[2]));
+
+        // Truncation keeps the hottest partitions, not the lowest tokens
+        read(pkeys[0], partial_slice);
+        cached = get_cached_partitions(1);
+        BOOST_REQUIRE_EQUAL(cached.size(), 1);
+        BOOST_REQUIRE(cached[0].key.equal(*s.schema(), pkeys[0]));
+    });
+}
@@ -37,6 +37,7 @@
 #include "compaction/leveled_manifest.hh"
 #include "sstables/metadata_collector.hh"
 #include "sstables/sstable_writer.hh"
+#include "sstables/abstract_index_reader.hh"
 #include <memory>
 #include "test/boost/sstable_test.hh"
 #include <seastar/core/seastar.hh>
@@ -77,6 +78,7 @@
 #include "test/lib/reader_concurrency_semaphore.hh"
 #include "test/lib/sstable_utils.hh"
 #include "test/lib/random_utils.hh"
+#include "utils/bloom_filter.hh"
 
 namespace fs = std::filesystem;
 
@@ -3800,6 +3802,49 @@ SEASTAR_TEST_CASE(size_tiered_beyond_max_threshold_test) {
   });
 }
 
+SEASTAR_TEST_CASE(incremental_compaction_strategy_run_buckets_test) {
+  return test_env::do_with([] (test_env& env) {
+    column_family_for_tests cf(env.manager());
+    auto cs = sstables::make_compaction_strategy(sstables::compaction_strategy_type::incremental, cf.schema()->compaction_strategy_options());
+    constexpr uint64_t fragment_size = 100 * 1024 * 1024;
+
+    std::vector<sstables::shared_sstable> candidates;
+    std::unordered_set<sstables::shared_sstable> big_runs;
+    auto gen = 0;
+    auto add_run = [&] (unsigned fragments) {
+        auto run_id = utils::make_random_uuid();
+        for (auto i = 0U; i < fragments; i++) {
+            auto sst = env.make_sstable(cf.schema(), "", gen++, la, big);
+            sstables::test(sst).set_data_file_size(fragment_size);
+            sstables::test(sst).set_run_identifier(run_id);
+            if (fragments > 1) {
+                big_runs.insert(sst);
+            }
+            candidates.push_back(std::move(sst));
+        }
+    };
+    // 4 runs of 4 fragments each, and a run whose single fragment is as
+    // big as fragments of the others, so it belongs to a lower tier.
+    for (auto i = 0; i < 4; i++) {
+        add_run(4);
+    }
+    add_run(1);
+
+    auto desc = cs.get_sstables_for_compaction(*cf, candidates);
+    BOOST_REQUIRE_EQUAL(desc.sstables.size(), big_runs.size());
+    for (auto& sst : desc.sstables) {
+        BOOST_REQUIRE(big_runs.contains(sst));
+    }
+    // Output is written as a run of fragments, so that inputs can be released incrementally.
+    BOOST_REQUIRE(desc.max_sstable_bytes < compaction_descriptor::default_max_sstable_bytes);
+
+    desc = cs.get_major_compaction_job(*cf, candidates);
+    BOOST_REQUIRE_EQUAL(desc.sstables.size(), candidates.size());
+    BOOST_REQUIRE(desc.max_sstable_bytes < compaction_descriptor::default_max_sstable_bytes);
+    return cf.stop_and_keep_alive();
+  });
+}
+
 SEASTAR_TEST_CASE(sstable_set_incremental_selector) {
   return test_env::do_with([] (test_env& env) {
     auto s = make_shared_schema({}, some_keyspace, some_column_family,
@@ -3864,6 +3909,52 @@ SEASTAR_TEST_CASE(sstable_set_incremental_selector) {
   });
 }
 
+SEASTAR_TEST_CASE(incremental_compaction_strategy_sstable_set_selector) {
+  return test_env::do_with([] (test_env& env) {
+    auto s = make_shared_schema({}, some_keyspace, some_column_family,
+        {{"p1", utf8_type}}, {}, {}, {}, utf8_type);
+    auto cs = sstables::make_compaction_strategy(sstables::compaction_strategy_type::incremental, s->compaction_strategy_options());
+    auto key_and_token_pair = token_generation_for_current_shard(8);
+    auto decorated_keys = boost::copy_range<std::vector<dht::decorated_key>>(
+            key_and_token_pair | boost::adaptors::transformed([&s] (const std::pair<sstring, dht::token>& key_and_token) {
+                auto value = bytes(reinterpret_cast<const signed char*>(key_and_token.first.data()), key_and_token.first.size());
+                auto pk = sstables::key::from_bytes(value).to_partition_key(*s);
+                return dht::decorate_key(*s, std::move(pk));
+            }));
+
+    auto check = [] (sstable_set::incremental_selector& selector, const dht::decorated_key& key, std::unordered_set<int64_t> expected_gens) {
+        auto sstables = selector.select(key).sstables;
+        BOOST_REQUIRE_EQUAL(sstables.size(), expected_gens.size());
+        for (auto& sst : sstables) {
+            BOOST_REQUIRE(expected_gens.contains(sst->generation()));
+        }
+    };
+
+    // Two runs of disjoint level 0 fragments. A single partition read
+    // only selects the fragments which overlap the key, one per run.
+    sstable_set set = cs.make_sstable_set(s);
+    set.insert(sstable_for_overlapping_test(env, s, 1, key_and_token_pair[0].first, key_and_token_pair[1].first, 0));
+    set.insert(sstable_for_overlapping_test(env, s, 2, key_and_token_pair[2].first, key_and_token_pair[3].first, 0));
+    set.insert(sstable_for_overlapping_test(env, s, 3, key_and_token_pair[4].first, key_and_token_pair[5].first, 0));
+    set.insert(sstable_for_overlapping_test(env, s, 4, key_and_token_pair[0].first, key_and_token_pair[2].first, 0));
+    set.insert(sstable_for_overlapping_test(env, s, 5, key_and_token_pair[3].first, key_and_token_pair[6].first, 0));
+
+    sstable_set::incremental_selector sel = set.make_incremental_selector();
+    check(sel, decorated_keys[0], {1, 4});
+    check(sel, decorated_keys[1], {1, 4});
+    check(sel, decorated_keys[2], {2, 4});
+    check(sel, decorated_keys[3], {2, 5});
+    check(sel, decorated_keys[4], {3, 5});
+    check(sel, decorated_keys[5], {3, 5});
+    check(sel, decorated_keys[6], {5});
+    check(sel, decorated_keys[7], {});
+
+    BOOST_REQUIRE_EQUAL(set.select(dht::partition_range::make_singular(decorated_keys[6])).size(), 1);
+
+    return make_ready_future<>();
+  });
+}
+
 SEASTAR_TEST_CASE(sstable_set_erase) {
   return test_env::do_with([] (test_env& env) {
     auto s = make_shared_schema({}, some_keyspace, some_column_family,
@@ -7251,3 +7342,209 @@ SEASTAR_TEST_CASE(max_ongoing_compaction_test) {
         BOOST_REQUIRE(max_ongoing_compaction == 1);
     });
 }
+
+SEASTAR_TEST_CASE(test_split_block_bloom_filter) {
+    return test_env::do_with_async([] (test_env& env) {
+        simple_schema table;
+        auto s = schema_builder(table.schema())
+                .set_bloom_filter_format(utils::filter_format::split_block_format)
+                .build();
+        // Every third key is written, the others are used to check false positives.
+        auto all_keys = table.make_pkeys(300);
+        std::vector<mutation> muts;
+        for (size_t i = 0; i < all_keys.size(); i += 3) {
+            mutation m(s, all_keys[i]);
+            m.partition().apply(tombstone(api::new_timestamp(), gc_clock::now()));
+            muts.push_back(std::move(m));
+        }
+
+        auto check = [&] (bool split_block_allowed) {
+            auto tmp = tmpdir();
+            auto cfg = env.manager().configure_writer();
+            cfg.allow_split_block_bloom_filter = split_block_allowed;
+            auto version = sstables::get_highest_sstable_version();
+            make_sstable_easy(env, tmp.path(), flat_mutation_reader_from_mutations(env.make_reader_permit(), muts), cfg, version);
+
+            auto sst = env.reusable_sst(s, tmp.path().string(), 1, version).get0();
+            BOOST_REQUIRE_EQUAL(sst->features().is_enabled(sstable_feature::SplitBlockBloomFilter), split_block_allowed);
+            BOOST_REQUIRE_EQUAL(bool(dynamic_cast<utils::filter::split_block_bloom_filter*>(&sstables::test(sst).filter())), split_block_allowed);
+            size_t false_positives = 0;
+            for (size_t i = 0; i < all_keys.size(); i++) {
+                if (i % 3 == 0) {
+                    BOOST_REQUIRE(sst->filter_has_key(*s, all_keys[i]));
+                } else {
+                    false_positives += sst->filter_has_key(*s, all_keys[i]);
+                }
+            }
+            BOOST_REQUIRE_LT(false_positives, 20);
+        };
+
+        check(true);
+        // Nodes which can't read split block bloom filters may still be around.
+        check(false);
+    });
+}
+
+SEASTAR_TEST_CASE(test_trie_index) {
+    return test_env::do_with_async([] (test_env& env) {
+        simple_schema table;
+        auto s = schema_builder(table.schema())
+                .set_sstable_index_format(sstable_index_format::trie)
+                .build();
+        // Every other key is written, the others are used to check lookups of absent partitions.
+        auto all_keys = table.make_pkeys(200);
+        std::vector<mutation> muts;
+        for (size_t i = 0; i < all_keys.size(); i += 2) {
+            mutation m(s, all_keys[i]);
+            // Some partitions are large enough to have a promoted index.
+            const int nr_rows = i % 20 == 0 ? 100 : 1;
+            for (int j = 0; j < nr_rows; ++j) {
+                table.add_row(m, table.make_ckey(j), make_random_string(10));
+            }
+            muts.push_back(std::move(m));
+        }
+
+        auto check = [&] (bool trie_allowed) {
+            auto tmp = tmpdir();
+            auto cfg = env.manager().configure_writer();
+            cfg.allow_trie_index = trie_allowed;
+            cfg.promoted_index_block_size = 64;
+            auto version = sstables::get_highest_sstable_version();
+            make_sstable_easy(env, tmp.path(), flat_mutation_reader_from_mutations(env.make_reader_permit(), muts), cfg, version);
+
+            auto sst = env.reusable_sst(s, tmp.path().string(), 1, version).get0();
+            BOOST_REQUIRE_EQUAL(sst->has_component(component_type::Partitions), trie_allowed);
+
+            for (size_t i = 0; i < all_keys.size(); ++i) {
+                auto idx = make_index_reader(sst, env.make_reader_permit(), default_priority_class(), {});
+                auto close_idx = deferred_close(*idx);
+                BOOST_REQUIRE_EQUAL(idx->advance_lower_and_check_if_present(all_keys[i]).get0(), i % 2 == 0);
+                if (i % 2 == 0) {
+                    BOOST_REQUIRE(idx->get_partition_key().equal(*s, all_keys[i].key()));
+                }
+            }
+
+            assert_that(sstable_reader(sst, s, env.make_reader_permit()))
+                .produces(muts)
+                .produces_end_of_stream();
+
+            // Ranges starting and ending at both present and absent partitions.
+            for (size_t i = 0; i < all_keys.size(); i += 7) {
+                auto end = std::min(i + 31, all_keys.size() - 1);
+                auto pr = dht::partition_range::make({all_keys[i], i % 3 == 0}, {all_keys[end], end % 3 != 0});
+                auto assertions = assert_that(sstable_reader(sst, s, env.make_reader_permit(), pr));
+                for (auto& m : muts) {
+                    if (pr.contains(m.decorated_key(), dht::ring_position_comparator(*s))) {
+                        assertions.produces(m);
+                    }
+                }
+                assertions.produces_end_of_stream();
+            }
+
+            // Skipping within a partition goes through the promoted index.
+            auto ck_range = query::clustering_range::make({table.make_ckey(40)}, {table.make_ckey(60)});
+            auto slice = partition_slice_builder(*s).with_range(ck_range).build();
+            auto pr = dht::partition_range::make_singular(muts[0].decorated_key());
+            assert_that(sst->as_mutation_source().make_reader(s, env.make_reader_permit(), pr, slice))
+                .produces(muts[0], query::clustering_row_ranges{ck_range})
+                .produces_end_of_stream();
+        };
+
+        check(true);
+        // Nodes which can't read the trie index may still be around.
+        check(false);
+    });
+}
+
+SEASTAR_TEST_CASE(test_zstd_dictionary_compression) {
+    return test_env::do_with_async([] (test_env& env) {
+        simple_schema table;
+        auto s = schema_builder(table.schema())
+                .set_compressor_params(compression_parameters({
+                    {"sstable_compression", "org.apache.cassandra.io.compress.ZstdCompressor"},
+                    {"dictionary_size_in_kb", "1"},
+                }))
+                .build();
+
+        auto check = [&] (std::vector<mutation> muts, bool dictionary_allowed, bool dictionary_expected) {
+            auto tmp = tmpdir();
+            auto cfg = env.manager().configure_writer();
+            cfg.allow_compression_dictionary = dictionary_allowed;
+            auto version = sstables::get_highest_sstable_version();
+            make_sstable_easy(env, tmp.path(), flat_mutation_reader_from_mutations(env.make_reader_permit(), muts), cfg, version);
+
+            auto sst = env.reusable_sst(s, tmp.path().string(), 1, version).get0();
+            BOOST_REQUIRE_EQUAL(sst->has_component(component_type::CompressionDictionary), dictionary_allowed);
+            BOOST_REQUIRE_EQUAL(!sst->get_compression().dictionary.value.empty(), dictionary_expected);
+            auto rd = assert_that(sstable_reader(sst, s, env.make_reader_permit()));
+            for (auto& m : muts) {
+                rd.produces(m);
+            }
+            rd.produces_end_of_stream();
+        };
+
+        // Enough data to train the dictionary on.
+        std::vector<mutation> muts;
+        for (auto& pk : table.make_pkeys(10)) {
+            mutation m(s, pk);
+            for (int i = 0; i < 1000; i++) {
+                table.add_row(m, table.make_ckey(i), format("value of row {} of a partition", i));
+            }
+            muts.push_back(std::move(m));
+        }
+        check(muts, true, true);
+        // Nodes which can't read compression dictionaries may still be around.
+        check(muts, false, false);
+
+        // Not enough data to train the dictionary on. It's compressed without one.
+        mutation m(s, table.make_pkey());
+        table.add_row(m, table.make_ckey(0), "value");
+        check({m}, true, false);
+    });
+}
+
+SEASTAR_TEST_CASE(test_reading_cells_of_dropped_columns) {
+    return test_env::do_with_async([] (test_env& env) {
+        auto s = schema_builder("ks", "cf")
+                .with_column("pk", int32_type, column_kind::partition_key)
+                .with_column("ck", int32_type, column_kind::clustering_key)
+                .with_column("r1", int32_type)
+                .with_column("r2", utf8_type)
+                .with_column("r3", int32_type)
+                .build();
+
+        auto pk = partition_key::from_singular(*s, 0);
+        auto ck1 = clustering_key::from_singular(*s, 1);
+        auto ck2 = clustering_key::from_singular(*s, 2);
+        sstring value(1024, 'x');
+
+        mutation m(s, pk);
+        m.set_clustered_cell(ck1, "r1", data_value(1), 1);
+        m.set_clustered_cell(ck1, "r2", data_value(value), 1);
+        m.set_clustered_cell(ck1, "r3", data_value(1), 1);
+        m.set_clustered_cell(ck2, "r1", data_value(2), 1);
+        m.set_clustered_cell(ck2, "r2", data_value(value), 20);
+        m.set_clustered_cell(ck2, "r3", data_value(2), 1);
+
+        auto tmp = tmpdir();
+        auto version = sstables::get_highest_sstable_version();
+        make_sstable_easy(env, tmp.path(), flat_mutation_reader_from_mutations(env.make_reader_permit(), {m}), env.manager().configure_writer(), version);
+
+        // r2 dropped at 10 and added back, so only the cell written after the drop is visible.
+        auto s2 = schema_builder(s)
+                .without_column("r2", utf8_type, 10)
+                .with_column("r2", utf8_type)
+                .build();
+        mutation expected(s2, pk);
+        expected.set_clustered_cell(ck1, "r1", data_value(1), 1);
+        expected.set_clustered_cell(ck1, "r3", data_value(1), 1);
+        expected.set_clustered_cell(ck2, "r1", data_value(2), 1);
+        expected.set_clustered_cell(ck2, "r2", data_value(value), 20);
+        expected.set_clustered_cell(ck2, "r3", data_value(2), 1);
+
+        auto sst = env.reusable_sst(s2, tmp.path().string(), 1, version).get0();
+        assert_that(sstable_reader(sst, s2, env.make_reader_permit()))
+            .produces(expected)
+            .produces_end_of_stream();
+    });
+}
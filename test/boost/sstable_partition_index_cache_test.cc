@@ -234,3 +234,68 @@ SEASTAR_THREAD_TEST_CASE(test_evict_gently) {
 
     cache.evict_gently().get();
 }
+
+// Keys of the entries of cache linked in lru, from the most recently used one.
+static std::vector<partition_index_cache::key_type> lru_keys(lru& lru, const partition_index_cache& cache) {
+    std::vector<partition_index_cache::key_type> keys;
+    lru_cursor cursor;
+    lru.walk(cursor, [&] (evictable& e) {
+        auto entry = partition_index_cache::lru_entry(e);
+        if (entry && entry->first == &cache) {
+            keys.push_back(entry->second);
+        }
+        return stop_iteration::no;
+    });
+    return keys;
+}
+
+SEASTAR_THREAD_TEST_CASE(test_loaded_keys) {
+    ::lru lru;
+    simple_schema s;
+    logalloc::region r;
+    partition_index_cache cache(lru, r);
+
+    auto page0_loader = [&] (partition_index_cache::key_type k) {
+        return make_page0(r, s);
+    };
+
+    BOOST_REQUIRE(cache.referenced_keys().empty());
+    BOOST_REQUIRE(lru_keys(lru, cache).empty());
+
+    cache.get_or_load(0, page0_loader).get();
+    cache.get_or_load(3, page0_loader).get();
+    cache.get_or_load(7, page0_loader).get();
+
+    BOOST_REQUIRE(cache.referenced_keys().empty());
+    BOOST_REQUIRE_EQUAL(lru_keys(lru, cache), (std::vector<partition_index_cache::key_type>{7, 3, 0}));
+
+    // Using a page makes it the most recently used one
+    cache.get_or_load(0, page0_loader).get();
+    BOOST_REQUIRE_EQUAL(lru_keys(lru, cache), (std::vector<partition_index_cache::key_type>{0, 7, 3}));
+
+    // Pages in use are not in the LRU
+    {
+        auto ptr = cache.get_or_load(3, page0_loader).get0();
+        BOOST_REQUIRE_EQUAL(cache.referenced_keys(), (std::vector<partition_index_cache::key_type>{3}));
+        BOOST_REQUIRE_EQUAL(lru_keys(lru, cache), (std::vector<partition_index_cache::key_type>{0, 7}));
+    }
+
+    // A walk can be continued after stopping
+    lru_cursor cursor;
+    std::vector<partition_index_cache::key_type> keys;
+    auto walk_one = [&] {
+        return lru.walk(cursor, [&] (evictable& e) {
+            keys.push_back(partition_index_cache::lru_entry(e)->second);
+            return stop_iteration::yes;
+        });
+    };
+    BOOST_REQUIRE(!walk_one());
+    BOOST_REQUIRE(!walk_one());
+    BOOST_REQUIRE(!walk_one());
+    BOOST_REQUIRE(walk_one());
+    BOOST_REQUIRE_EQUAL(keys, (std::vector<partition_index_cache::key_type>{3, 0, 7}));
+    BOOST_REQUIRE(!cursor.is_linked());
+
+    cache.evict_gently().get();
+    BOOST_REQUIRE(lru_keys(lru, cache).empty());
+}
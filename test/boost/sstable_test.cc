@@ -919,6 +919,28 @@ SEASTAR_TEST_CASE(statistics_rewrite) {
     });
 }
 
+SEASTAR_TEST_CASE(repaired_at_rewrite) {
+    return test_setup::do_with_cloned_tmp_directory(uncompressed_dir(), [] (test_env& env, sstring uncompressed_dir, sstring generation_dir) {
+        return env.reusable_sst(uncompressed_schema(), uncompressed_dir, 1).then([generation_dir] (auto sstp) {
+            return sstp->create_links(generation_dir).then([sstp] {});
+        }).then([&env, generation_dir] {
+            return env.reusable_sst(uncompressed_schema(), generation_dir, 1).then([] (auto sstp) {
+                BOOST_REQUIRE(!sstp->is_repaired());
+                return sstp->mutate_repaired_at(1234).then([sstp] {});
+            });
+        }).then([&env, generation_dir] {
+            return env.reusable_sst(uncompressed_schema(), generation_dir, 1).then([] (auto sstp) {
+                BOOST_REQUIRE(sstp->is_repaired());
+                BOOST_REQUIRE_EQUAL(sstp->get_repaired_at(), 1234);
+                auto [unrepaired, repaired] = partition_by_repaired_status({sstp});
+                BOOST_REQUIRE(unrepaired.empty());
+                BOOST_REQUIRE_EQUAL(repaired.size(), 1);
+                return make_ready_future<>();
+            });
+        });
+    });
+}
+
 // Tests for reading a large partition for which the index contains a
 // "promoted index", i.e., a sample of the column names inside the partition,
 // with which we can avoid reading the entire partition when we look only
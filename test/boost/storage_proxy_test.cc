@@ -27,6 +27,7 @@
 #include "test/lib/cql_test_env.hh"
 #include "test/lib/mutation_source_test.hh"
 #include "test/lib/result_set_assertions.hh"
+#include "test/lib/cql_assertions.hh"
 #include "service/storage_proxy.hh"
 #include "partition_slice_builder.hh"
 #include "schema_builder.hh"
@@ -112,3 +113,92 @@ SEASTAR_TEST_CASE(test_get_restricted_ranges) {
         });
     });
 }
+
+SEASTAR_TEST_CASE(test_batch_writes_to_local_replica) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table ks.tbl (pk int, ck int, v int, primary key (pk, ck))").get();
+
+        const int partitions = 100;
+        sstring batch = "begin unlogged batch\n";
+        for (int pk = 0; pk < partitions; ++pk) {
+            batch += format("insert into ks.tbl (pk, ck, v) values ({}, 0, {});\n", pk, pk);
+        }
+        batch += "apply batch";
+
+        auto cross_shard_ops = [] {
+            return service::get_local_storage_proxy().get_stats().replica_cross_shard_ops;
+        };
+        auto before = cross_shard_ops();
+        e.execute_cql(batch).get();
+        // The writes owned by each shard are applied with a single cross-shard call.
+        BOOST_REQUIRE_LE(cross_shard_ops() - before, smp::count - 1);
+
+        std::vector<std::vector<bytes_opt>> rows;
+        for (int pk = 0; pk < partitions; ++pk) {
+            rows.push_back({int32_type->decompose(pk), int32_type->decompose(0), int32_type->decompose(pk)});
+        }
+        auto msg = e.execute_cql("select pk, ck, v from ks.tbl").get0();
+        assert_that(msg).is_rows().with_rows_ignore_order(std::move(rows));
+    });
+}
+
+SEASTAR_THREAD_TEST_CASE(test_replica_read_latencies) {
+    using namespace std::chrono_literals;
+    service::replica_read_latencies latencies;
+    gms::inet_address slow("127.0.0.1");
+    gms::inet_address fast("127.0.0.2");
+    gms::inet_address unknown("127.0.0.3");
+
+    for (int i = 0; i < service::replica_read_latencies::min_samples; ++i) {
+        latencies.add(slow, 10ms);
+        latencies.add(fast, 100us);
+    }
+    latencies.add(unknown, 1us);
+    BOOST_REQUIRE(latencies.get_percentile(slow, 0.99));
+    BOOST_REQUIRE(latencies.get_percentile(fast, 0.99));
+    BOOST_REQUIRE_LT(*latencies.get_percentile(fast, 0.99), *latencies.get_percentile(slow, 0.99));
+    // Too few samples.
+    BOOST_REQUIRE(!latencies.get_percentile(unknown, 0.99));
+
+    // Replicas with too few samples keep their positions.
+    inet_address_vector_replica_set endpoints{slow, unknown, fast};
+    latencies.sort(endpoints, 0.99);
+    BOOST_REQUIRE(endpoints == (inet_address_vector_replica_set{fast, unknown, slow}));
+    endpoints = {unknown, slow, fast};
+    latencies.sort(endpoints, 0.99);
+    BOOST_REQUIRE(endpoints == (inet_address_vector_replica_set{unknown, fast, slow}));
+
+    // Replicas which stopped being sampled are forgotten once their samples decayed away.
+    BOOST_REQUIRE_EQUAL(latencies.size(), 3u);
+    latencies.decay();
+    BOOST_REQUIRE_EQUAL(latencies.size(), 2u);
+    for (int i = 0; i < 100 && latencies.size(); ++i) {
+        latencies.decay();
+    }
+    BOOST_REQUIRE_EQUAL(latencies.size(), 0u);
+    BOOST_REQUIRE(!latencies.get_percentile(fast, 0.99));
+
+    latencies.add(fast, 100us);
+    latencies.remove(fast);
+    BOOST_REQUIRE_EQUAL(latencies.size(), 0u);
+
+    // A replica sampled a few times a period, with latencies spread over
+    // the buckets, accumulates enough samples.
+    for (int period = 0; period < 50; ++period) {
+        for (int i = 1; i <= 12; ++i) {
+            latencies.add(slow, i * 1ms);
+        }
+        latencies.decay();
+    }
+    for (int i = 1; i <= 12; ++i) {
+        latencies.add(slow, i * 1ms);
+    }
+    BOOST_REQUIRE(latencies.get_percentile(slow, 0.99));
+
+    // Once it's no longer sampled, the cached percentile is dropped as soon
+    // as too few samples are left.
+    latencies.decay();
+    BOOST_REQUIRE(latencies.get_percentile(slow, 0.99));
+    latencies.decay();
+    BOOST_REQUIRE(!latencies.get_percentile(slow, 0.99));
+}
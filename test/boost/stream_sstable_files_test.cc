@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <deque>
+
+#include <seastar/testing/test_case.hh>
+
+#include "streaming/stream_sstable_files.hh"
+#include "database.hh"
+#include "db/config.hh"
+#include "gms/feature.hh"
+#include "sstables/sstables.hh"
+#include "utils/fb_utilities.hh"
+#include "test/lib/cql_test_env.hh"
+#include "test/lib/cql_assertions.hh"
+
+using namespace streaming;
+
+static constexpr int row_count = 100;
+
+static void create_table(cql_test_env& e, const sstring& cf) {
+    e.execute_cql(format("CREATE TABLE ks.{} (pk int PRIMARY KEY, v int)", cf)).get();
+}
+
+static void populate(cql_test_env& e, const sstring& cf) {
+    create_table(e, cf);
+    for (int i = 0; i < row_count; ++i) {
+        e.execute_cql(format("INSERT INTO ks.{} (pk, v) VALUES ({}, {})", cf, i, i)).get();
+    }
+    e.db().invoke_on_all([cf] (database& db) {
+        return db.flush("ks", cf);
+    }).get();
+}
+
+// Sstables of ks.src on this shard which would be sent as files to a peer
+// sharding the table like this node.
+static std::vector<sstables::shared_sstable> select_sstables(cql_test_env& e, stream_reason reason,
+        dht::token_range_vector ranges = {dht::token_range::make_open_ended_both_sides()}) {
+    auto& db = e.local_db();
+    return select_sstables_to_send_as_files(db, db.find_column_family("ks", "src"), utils::fb_utilities::get_broadcast_address(), ranges, reason);
+}
+
+static std::deque<sstable_files_message> send_sstable(sstables::shared_sstable sst) {
+    std::deque<sstable_files_message> msgs;
+    bool got_error_from_peer = false;
+    send_sstable_components(sst, [&msgs] (sstable_files_message msg) {
+        msgs.push_back(std::move(msg));
+        return make_ready_future<>();
+    }, got_error_from_peer).get();
+    return msgs;
+}
+
+static void receive_sstable(cql_test_env& e, const sstring& cf, sstables::sstable_version_types version, std::deque<sstable_files_message>& msgs) {
+    auto cf_id = e.local_db().find_schema("ks", cf)->id();
+    receive_sstable_files(e.db(), e.sys_dist_ks(), e.view_update_generator(), utils::make_random_uuid(), utils::fb_utilities::get_broadcast_address(),
+            cf_id, version, stream_reason::bootstrap, [&msgs] {
+        std::optional<sstable_files_message> msg;
+        if (!msgs.empty()) {
+            msg = std::move(msgs.front());
+            msgs.pop_front();
+        }
+        return make_ready_future<std::optional<sstable_files_message>>(std::move(msg));
+    }).get();
+}
+
+// Number of the rows written by populate() which are owned by this shard.
+static size_t local_row_count(cql_test_env& e) {
+    auto s = e.local_db().find_schema("ks", "src");
+    size_t count = 0;
+    for (int i = 0; i < row_count; ++i) {
+        auto pk = partition_key::from_single_value(*s, int32_type->decompose(i));
+        count += s->get_sharder().shard_of(dht::get_token(*s, pk)) == this_shard_id();
+    }
+    return count;
+}
+
+SEASTAR_TEST_CASE(test_select_sstables_to_send_as_files) {
+    auto db_cfg = make_shared<db::config>();
+    return do_with_cql_env_thread([db_cfg] (cql_test_env& e) {
+        populate(e, "src");
+        auto all = e.local_db().find_column_family("ks", "src").get_sstables();
+        BOOST_REQUIRE(!all->empty());
+
+        BOOST_REQUIRE_EQUAL(select_sstables(e, stream_reason::bootstrap).size(), all->size());
+        BOOST_REQUIRE_EQUAL(select_sstables(e, stream_reason::decommission).size(), all->size());
+
+        // The other reasons stream mutation fragments
+        BOOST_REQUIRE(select_sstables(e, stream_reason::repair).empty());
+        BOOST_REQUIRE(select_sstables(e, stream_reason::rebuild).empty());
+
+        // Sstables which are not contained in the ranges are read
+        auto& sst = *all->begin();
+        auto first = sst->get_first_decorated_key().token();
+        BOOST_REQUIRE(select_sstables(e, stream_reason::bootstrap, {dht::token_range::make_singular(first)}).empty());
+
+        db_cfg->enable_sstable_file_streaming.set(false);
+        BOOST_REQUIRE(select_sstables(e, stream_reason::bootstrap).empty());
+    }, cql_test_config(db_cfg));
+}
+
+SEASTAR_TEST_CASE(test_sstables_streamed_as_mutations_without_feature) {
+    cql_test_config cfg;
+    cfg.disabled_features.insert(sstring(gms::features::STREAM_SSTABLE_FILES));
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        populate(e, "src");
+        BOOST_REQUIRE(!e.local_db().find_column_family("ks", "src").get_sstables()->empty());
+        BOOST_REQUIRE(select_sstables(e, stream_reason::bootstrap).empty());
+    }, std::move(cfg));
+}
+
+SEASTAR_TEST_CASE(test_send_and_receive_sstable_files) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        populate(e, "src");
+        create_table(e, "dst");
+
+        auto ssts = select_sstables(e, stream_reason::bootstrap);
+        BOOST_REQUIRE(!ssts.empty());
+        for (auto& sst : ssts) {
+            auto msgs = send_sstable(sst);
+            BOOST_REQUIRE(std::get<0>(msgs.front()) == stream_sstable_files_cmd::component_data);
+            BOOST_REQUIRE_EQUAL(std::get<1>(msgs.front()), sstables::sstable_version_constants::get_component_map(sst->get_version()).at(sstables::component_type::TOC));
+            BOOST_REQUIRE(std::get<0>(msgs.back()) == stream_sstable_files_cmd::end_of_stream);
+            receive_sstable(e, "dst", sst->get_version(), msgs);
+        }
+
+        auto msg = e.execute_cql("SELECT pk FROM ks.dst").get0();
+        assert_that(msg).is_rows().with_size(local_row_count(e));
+    });
+}
+
+SEASTAR_TEST_CASE(test_receive_sstable_files_rejects_corrupted_component) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        populate(e, "src");
+        create_table(e, "dst");
+
+        auto ssts = select_sstables(e, stream_reason::bootstrap);
+        BOOST_REQUIRE(!ssts.empty());
+        auto msgs = send_sstable(ssts.front());
+
+        // Flip a bit in the last chunk of data, the checksum won't match
+        auto it = std::find_if(msgs.rbegin(), msgs.rend(), [] (const sstable_files_message& m) {
+            return std::get<0>(m) == stream_sstable_files_cmd::component_data;
+        });
+        BOOST_REQUIRE(it != msgs.rend());
+        auto& data = std::get<2>(*it);
+        bytes b = linearized(fragmented_temporary_buffer::view(data));
+        b[0] ^= 1;
+        std::vector<temporary_buffer<char>> fragments;
+        fragments.emplace_back(reinterpret_cast<const char*>(b.data()), b.size());
+        data = fragmented_temporary_buffer(std::move(fragments), b.size());
+
+        BOOST_REQUIRE_THROW(receive_sstable(e, "dst", ssts.front()->get_version(), msgs), std::runtime_error);
+        auto msg = e.execute_cql("SELECT pk FROM ks.dst").get0();
+        assert_that(msg).is_rows().is_empty();
+    });
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/core/timed_out_error.hh>
+#include <seastar/core/with_timeout.hh>
+#include <seastar/testing/test_case.hh>
+
+#include "database.hh"
+#include "test/lib/cql_test_env.hh"
+#include "test/lib/cql_assertions.hh"
+#include "test/lib/eventually.hh"
+
+using namespace std::chrono_literals;
+
+// The view key contains a regular column of the base table, so the view
+// updates of every write need to read the existing base row, under its lock.
+static void create_table_and_view(cql_test_env& e) {
+    e.execute_cql("CREATE TABLE ks.t (p int, c int, v int, PRIMARY KEY (p, c))").get();
+    e.execute_cql("CREATE MATERIALIZED VIEW ks.mv AS SELECT * FROM ks.t "
+            "WHERE v IS NOT NULL AND p IS NOT NULL AND c IS NOT NULL PRIMARY KEY (v, p, c)").get();
+}
+
+static mutation make_row_write(schema_ptr s, int c, int v) {
+    mutation m(s, partition_key::from_single_value(*s, int32_type->decompose(0)));
+    m.set_clustered_cell(clustering_key::from_single_value(*s, int32_type->decompose(c)), "v", data_value(v), api::new_timestamp());
+    return m;
+}
+
+static mutation make_partition_delete(schema_ptr s) {
+    mutation m(s, partition_key::from_single_value(*s, int32_type->decompose(0)));
+    m.partition().apply(tombstone(api::new_timestamp(), gc_clock::now()));
+    return m;
+}
+
+// Generates the view updates of a write to ks.t, the way a base replica does
+// before applying it. The returned lock is held until the write is applied.
+static future<row_locker::lock_holder> push(cql_test_env& e, mutation m, db::timeout_clock::time_point timeout = db::no_timeout) {
+    auto& cf = e.local_db().find_column_family("ks", "t");
+    return cf.push_view_replica_updates(cf.schema(), std::move(m), timeout, nullptr, e.local_db().get_reader_concurrency_semaphore());
+}
+
+static uint64_t coalesced_writes(cql_test_env& e) {
+    return e.local_db().find_column_family("ks", "t").cf_stats()->total_view_updates_coalesced;
+}
+
+// The future must resolve without waiting for a lock held by the test.
+static row_locker::lock_holder get_unblocked(future<row_locker::lock_holder> f) {
+    return with_timeout(db::timeout_clock::now() + 10s, std::move(f)).get0();
+}
+
+static void check_view_values(cql_test_env& e, std::vector<int> values) {
+    std::vector<std::vector<bytes_opt>> rows;
+    for (auto v : values) {
+        rows.push_back({int32_type->decompose(v)});
+    }
+    eventually([&] {
+        auto msg = e.execute_cql("SELECT v FROM ks.mv").get0();
+        assert_that(msg).is_rows().with_rows_ignore_order(rows);
+    });
+}
+
+SEASTAR_TEST_CASE(test_concurrent_writes_to_a_row_are_coalesced) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        create_table_and_view(e);
+        auto s = e.local_db().find_schema("ks", "t");
+        auto coalesced_before = coalesced_writes(e);
+
+        // Hold the partition lock, so the writes below queue for their rows.
+        auto lock = get_unblocked(push(e, make_partition_delete(s)));
+        auto f1 = push(e, make_row_write(s, 1, 1));
+        auto f2 = push(e, make_row_write(s, 1, 2));
+        auto f3 = push(e, make_row_write(s, 2, 3));
+        auto f4 = push(e, make_row_write(s, 2, 4));
+        BOOST_REQUIRE(!f1.available() && !f2.available() && !f3.available() && !f4.available());
+
+        lock = row_locker::lock_holder();
+        get_unblocked(std::move(f1));
+        get_unblocked(std::move(f2));
+        get_unblocked(std::move(f3));
+        get_unblocked(std::move(f4));
+
+        // One group for each row, each generating the view updates of the
+        // merged writes, where the later write to the row wins.
+        BOOST_REQUIRE_EQUAL(coalesced_writes(e) - coalesced_before, 2);
+        check_view_values(e, {2, 4});
+    });
+}
+
+SEASTAR_TEST_CASE(test_coalescing_keeps_row_lock_granularity) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        create_table_and_view(e);
+        auto s = e.local_db().find_schema("ks", "t");
+
+        auto lock = get_unblocked(push(e, make_row_write(s, 1, 10)));
+        auto f1 = push(e, make_row_write(s, 1, 1));
+
+        // A write to another row doesn't wait for the locked row, and doesn't
+        // join the group waiting for it.
+        get_unblocked(push(e, make_row_write(s, 2, 2)));
+        BOOST_REQUIRE(!f1.available());
+
+        lock = row_locker::lock_holder();
+        get_unblocked(std::move(f1));
+        check_view_values(e, {10, 1, 2});
+    });
+}
+
+SEASTAR_TEST_CASE(test_coalesced_write_times_out_on_its_own) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        create_table_and_view(e);
+        auto s = e.local_db().find_schema("ks", "t");
+
+        auto lock = get_unblocked(push(e, make_row_write(s, 1, 10)));
+        auto f1 = push(e, make_row_write(s, 1, 1));
+        auto f2 = push(e, make_row_write(s, 1, 2), db::timeout_clock::now() + 100ms);
+
+        // The joined write fails at its own timeout, while the first write of
+        // its group keeps waiting for the lock.
+        BOOST_REQUIRE_THROW(f2.get(), timed_out_error);
+        BOOST_REQUIRE(!f1.available());
+
+        lock = row_locker::lock_holder();
+        get_unblocked(std::move(f1));
+        // The view updates of the timed out write were not generated.
+        check_view_values(e, {10, 1});
+    });
+}
+
+SEASTAR_TEST_CASE(test_coalesced_write_outlives_first_write_timeout) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        create_table_and_view(e);
+        auto s = e.local_db().find_schema("ks", "t");
+
+        auto lock = get_unblocked(push(e, make_row_write(s, 1, 10)));
+        auto f1 = push(e, make_row_write(s, 1, 1), db::timeout_clock::now() + 100ms);
+        auto f2 = push(e, make_row_write(s, 1, 2));
+
+        // The first write of the group times out, the joined write keeps
+        // waiting for the lock on its own.
+        BOOST_REQUIRE_THROW(f1.get(), timed_out_error);
+        BOOST_REQUIRE(!f2.available());
+
+        lock = row_locker::lock_holder();
+        get_unblocked(std::move(f2));
+        check_view_values(e, {10, 2});
+    });
+}
@@ -48,6 +48,10 @@ namespace auth {
 class service;
 }
 
+namespace qos {
+class service_level_controller;
+}
+
 namespace cql3 {
     class query_processor;
 }
@@ -59,6 +63,7 @@ class not_prepared_exception : public std::runtime_error {
 
 namespace db {
     class config;
+    class system_distributed_keyspace;
 }
 
 struct scheduling_groups {
@@ -151,8 +156,14 @@ class cql_test_env {
 
     virtual db::view::view_update_generator& local_view_update_generator() = 0;
 
+    virtual sharded<db::view::view_update_generator>& view_update_generator() = 0;
+
+    virtual sharded<db::system_distributed_keyspace>& sys_dist_ks() = 0;
+
     virtual service::migration_notifier& local_mnotifier() = 0;
 
+    virtual qos::service_level_controller& local_sl_controller() = 0;
+
     virtual sharded<service::migration_manager>& migration_manager() = 0;
 
     virtual future<> refresh_client_state() = 0;
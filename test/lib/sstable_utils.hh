@@ -96,6 +96,10 @@ class test {
         return _sst->_components->summary;
     }
 
+    utils::i_filter& filter() {
+        return *_sst->_components->filter;
+    }
+
     future<temporary_buffer<char>> data_read(reader_permit permit, uint64_t pos, size_t len) {
         return _sst->data_read(pos, len, default_priority_class(), std::move(permit));
     }
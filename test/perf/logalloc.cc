@@ -24,6 +24,7 @@
 #include <seastar/core/sstring.hh>
 #include <seastar/core/thread.hh>
 #include <seastar/core/reactor.hh>
+#include <seastar/util/defer.hh>
 
 #include <fmt/core.h>
 #include <random>
@@ -45,11 +46,56 @@ static constexpr unsigned nr_seq_allocations = 1024;
 static constexpr unsigned nr_iterations = 20000;
 static constexpr unsigned nr_sizes = 32;
 
+// Reads objects scattered over many segments in random order, like lookups
+// in a large cache do, so that most accesses miss the TLB unless segments
+// are backed by huge pages.
+static void run_lookups(logalloc::region& reg, size_t nr_objects, std::mt19937& g) {
+    auto& allocator = reg.allocator();
+    std::vector<piggie*> objects;
+    objects.reserve(nr_objects);
+    for (size_t i = 0; i < nr_objects; i++) {
+        auto size = i % nr_sizes;
+        void* mem = allocator.alloc<piggie>(sizeof(piggie) + size);
+        objects.push_back(new (mem) piggie(size));
+    }
+    std::shuffle(objects.begin(), objects.end(), g);
+
+    size_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto* obj : objects) {
+        sum += obj->storage_size();
+    }
+    std::chrono::duration<double> lookups = std::chrono::steady_clock::now() - start;
+
+    for (auto* obj : objects) {
+        allocator.destroy(obj);
+    }
+
+    fmt::print("Lookups: {} objects in {} segments, {:.2f} ns/lookup (checksum {})\n", nr_objects,
+            reg.occupancy().total_space() / logalloc::segment_size,
+            std::chrono::duration<double, std::nano>(lookups).count() / nr_objects, sum);
+}
+
 int main(int argc, char** argv) {
+    namespace bpo = boost::program_options;
     app_template app;
+    app.add_options()
+        ("transparent-hugepages", bpo::value<bool>()->default_value(false), "Back LSA segments with transparent huge pages")
+        ("lookup-objects", bpo::value<size_t>()->default_value(4 * 1024 * 1024), "Number of objects read in random order by the lookup test, 0 disables it")
+        ;
     return app.run(argc, argv, [&app] {
         return seastar::async([&] {
+            auto& opts = app.configuration();
             logalloc::prime_segment_pool(memory::stats().total_memory(), memory::min_free_memory()).get();
+            logalloc::tracker::config st_cfg;
+            st_cfg.defragment_on_idle = false;
+            st_cfg.abort_on_lsa_bad_alloc = false;
+            st_cfg.lsa_reclamation_step = 1;
+            st_cfg.use_transparent_hugepages = opts["transparent-hugepages"].as<bool>();
+            logalloc::shard_tracker().configure(st_cfg);
+            auto stop_tracker = defer([] {
+                logalloc::shard_tracker().stop().get();
+            });
             logalloc::region reg;
 
             std::array<piggie*, nr_seq_allocations> objects;
@@ -63,7 +109,8 @@ int main(int argc, char** argv) {
 
             auto& allocator = reg.allocator();
 
-            std::chrono::duration<double> total;
+            std::chrono::duration<double> total{};
+            std::chrono::duration<double> compaction{};
 
             for (int iter = 0; iter < nr_iterations; iter++) {
                 std::shuffle(sizes.begin(), sizes.end(), g);
@@ -82,10 +129,17 @@ int main(int argc, char** argv) {
                     allocator.destroy(objects[i]);
                 }
 
+                start = std::chrono::steady_clock::now();
                 reg.full_compaction();
+                compaction += std::chrono::steady_clock::now() - start;
             }
 
             fmt::print("Total time: {} s\n", total.count());
+            fmt::print("Compaction time: {} s\n", compaction.count());
+
+            if (auto nr_objects = opts["lookup-objects"].as<size_t>()) {
+                run_lookups(reg, nr_objects, g);
+            }
         });
     });
 }
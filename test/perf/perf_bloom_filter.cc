@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2021-present ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "seastar/include/seastar/testing/perf_tests.hh"
+#include <seastar/testing/test_runner.hh>
+
+#include <random>
+
+#include "utils/i_filter.hh"
+
+// Compares lookups in the standard bloom filter with lookups in the split block
+// one. The filters are sized for enough keys not to fit in the CPU caches,
+// as is the case for filters of large sstables.
+class bloom_filter {
+public:
+    static constexpr size_t elements = 4 * 1024 * 1024;
+    static constexpr size_t count = 1000;
+    static constexpr double false_positive_chance = 0.01;
+private:
+    utils::filter_ptr _standard;
+    utils::filter_ptr _split_block;
+    std::vector<utils::hashed_key> _present;
+    std::vector<utils::hashed_key> _absent;
+private:
+    static bytes make_key(uint64_t v) {
+        bytes b(bytes::initialized_later{}, sizeof(v));
+        std::copy_n(reinterpret_cast<const int8_t*>(&v), sizeof(v), b.begin());
+        return b;
+    }
+public:
+    bloom_filter()
+        : _standard(utils::i_filter::get_filter(elements, false_positive_chance, utils::filter_format::m_format))
+        , _split_block(utils::i_filter::get_filter(elements, false_positive_chance, utils::filter_format::split_block_format))
+    {
+        for (uint64_t i = 0; i < elements; i++) {
+            auto key = make_key(i);
+            _standard->add(key);
+            _split_block->add(key);
+        }
+        auto eng = seastar::testing::local_random_engine;
+        auto present = std::uniform_int_distribution<uint64_t>(0, elements - 1);
+        auto absent = std::uniform_int_distribution<uint64_t>(elements, std::numeric_limits<uint64_t>::max());
+        for (size_t i = 0; i < count; i++) {
+            _present.push_back(utils::make_hashed_key(make_key(present(eng))));
+            _absent.push_back(utils::make_hashed_key(make_key(absent(eng))));
+        }
+    }
+
+    size_t lookup(utils::i_filter& filter, const std::vector<utils::hashed_key>& keys) {
+        for (auto& k : keys) {
+            perf_tests::do_not_optimize(filter.is_present(k));
+        }
+        return keys.size();
+    }
+
+    utils::i_filter& standard() { return *_standard; }
+    utils::i_filter& split_block() { return *_split_block; }
+    const std::vector<utils::hashed_key>& present() const { return _present; }
+    const std::vector<utils::hashed_key>& absent() const { return _absent; }
+};
+
+PERF_TEST_F(bloom_filter, standard_present) {
+    return lookup(standard(), present());
+}
+
+PERF_TEST_F(bloom_filter, standard_absent) {
+    return lookup(standard(), absent());
+}
+
+PERF_TEST_F(bloom_filter, split_block_present) {
+    return lookup(split_block(), present());
+}
+
+PERF_TEST_F(bloom_filter, split_block_absent) {
+    return lookup(split_block(), absent());
+}
@@ -23,6 +23,7 @@
 #include "sstables/checksum_utils.hh"
 #include "test/lib/make_random_string.hh"
 #include "utils/gz/crc_combine.hh"
+#include "utils/crc.hh"
 
 #include "seastar/include/seastar/testing/perf_tests.hh"
 
@@ -31,6 +32,23 @@ struct crc_test {
     const sstring data2 = make_random_string(64*1024);
     const uint32_t sum1 = zlib_crc32_checksummer::checksum(data.data(), data.size());
     const uint32_t sum2 = zlib_crc32_checksummer::checksum(data2.data(), data2.size());
+
+    // Checksums data in pieces of the given size, like compressed chunks
+    // of sstables or commitlog entries. Returns the number of pieces.
+    template <typename Func>
+    size_t checksum_pieces(size_t piece_size, Func&& checksum) const {
+        size_t n = 0;
+        for (size_t pos = 0; pos + piece_size <= data.size(); pos += piece_size, ++n) {
+            perf_tests::do_not_optimize(checksum(data.data() + pos, piece_size));
+        }
+        return n;
+    }
+
+    static uint32_t crc32c(const char* input, size_t input_len) {
+        utils::crc32 c;
+        c.process(reinterpret_cast<const uint8_t*>(input), input_len);
+        return c.get();
+    }
 };
 
 PERF_TEST_F(crc_test, perf_deflate_crc32_combine) {
@@ -67,3 +85,21 @@ PERF_TEST_F(crc_test, perf_zlib_crc32_checksum) {
     perf_tests::do_not_optimize(
         zlib_crc32_checksummer::checksum(data.data(), data.size()));
 }
+
+PERF_TEST_F(crc_test, perf_deflate_crc32_checksum_4k_chunks) {
+    return checksum_pieces(4096, [] (const char* input, size_t len) {
+        return libdeflate_crc32_checksummer::checksum(input, len);
+    });
+}
+
+PERF_TEST_F(crc_test, perf_crc32c_checksum) {
+    perf_tests::do_not_optimize(crc32c(data.data(), data.size()));
+}
+
+PERF_TEST_F(crc_test, perf_crc32c_checksum_512b_pieces) {
+    return checksum_pieces(512, crc32c);
+}
+
+PERF_TEST_F(crc_test, perf_crc32c_checksum_128b_pieces) {
+    return checksum_pieces(128, crc32c);
+}
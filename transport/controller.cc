@@ -84,6 +84,7 @@ future<> controller::do_start_server() {
             cql_server_config.shard_aware_transport_port_ssl = cfg.native_shard_aware_transport_port_ssl();
         }
         cql_server_config.partitioner_name = cfg.partitioner();
+        cql_server_config.response_flush_delay = std::chrono::microseconds(cfg.native_transport_flush_delay_in_us());
         smp_service_group_config cql_server_smp_service_group_config;
         cql_server_smp_service_group_config.max_nonlocal_requests = 5000;
         cql_server_config.bounce_request_smp_service_group = create_smp_service_group(cql_server_smp_service_group_config).get0();
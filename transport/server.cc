@@ -47,6 +47,7 @@
 #include <seastar/net/byteorder.hh>
 #include <seastar/util/lazy.hh>
 #include <seastar/core/execution_stage.hh>
+#include <seastar/core/sleep.hh>
 
 #include "enum_set.hh"
 #include "service/query_state.hh"
@@ -184,6 +185,12 @@ cql_server::cql_server(distributed<cql3::query_processor>& qp, auth::service& au
         sm::make_derive("execute_requests", _stats.execute_requests,
                         sm::description("Counts the total number of received CQL EXECUTE messages.")),
 
+        sm::make_derive("requests_sent_to_affine_shard", _stats.requests_sent_to_affine_shard,
+                        sm::description("Counts the number of requests which were sent directly to the shard on which recent requests of their connection were executed.")),
+
+        sm::make_derive("response_flushes", _stats.response_flushes,
+                        sm::description("Counts the number of times responses were flushed to the clients. Responses which are ready together are sent with a single flush.")),
+
         sm::make_derive("batch_requests", _stats.batch_requests,
                         sm::description("Counts the total number of received CQL BATCH messages.")),
 
@@ -852,7 +859,7 @@ make_result(int16_t stream, messages::result_message& msg, const tracing::trace_
         cql_protocol_version_type version, bool skip_metadata = false);
 
 template<typename Process>
-future<foreign_ptr<std::unique_ptr<cql_server::response>>>
+future<std::variant<foreign_ptr<std::unique_ptr<cql_server::response>>, unsigned>>
 cql_server::connection::process_on_shard(unsigned shard, uint16_t stream, fragmented_temporary_buffer::istream is,
         service::client_state& cs, service_permit permit, tracing::trace_state_ptr trace_state, Process process_fn) {
     return _server.container().invoke_on(shard, _server._config.bounce_request_smp_service_group,
@@ -864,10 +871,7 @@ cql_server::connection::process_on_shard(unsigned shard, uint16_t stream, fragme
                                               (bytes_ostream& linearization_buffer, service::client_state& client_state) mutable {
             request_reader in(is, linearization_buffer);
             return process_fn(client_state, server._query_processor, in, stream, _version, _cql_serialization_format,
-                    /* FIXME */empty_service_permit(), std::move(trace_state), false).then([] (auto msg) {
-                // result here has to be foreign ptr
-                return std::get<foreign_ptr<std::unique_ptr<cql_server::response>>>(std::move(msg));
-            });
+                    /* FIXME */empty_service_permit(), std::move(trace_state), false);
         });
     });
 }
@@ -875,16 +879,34 @@ cql_server::connection::process_on_shard(unsigned shard, uint16_t stream, fragme
 template<typename Process>
 future<foreign_ptr<std::unique_ptr<cql_server::response>>>
 cql_server::connection::process(uint16_t stream, request_reader in, service::client_state& client_state, service_permit permit,
-        tracing::trace_state_ptr trace_state, Process process_fn) {
+        tracing::trace_state_ptr trace_state, Process process_fn, bool shard_bound) {
     fragmented_temporary_buffer::istream is = in.get_stream();
 
-    return process_fn(client_state, _server._query_processor, in, stream,
-            _version, _cql_serialization_format, permit, trace_state, true)
-            .then([stream, &client_state, this, is, permit, process_fn, trace_state]
+    // Traced requests are always started here, where their tracing is initialized.
+    auto affine_shard = shard_bound && !trace_state ? _shard_affinity.affine_shard() : std::nullopt;
+    auto f = make_ready_future<std::variant<foreign_ptr<std::unique_ptr<cql_server::response>>, unsigned>>();
+    if (affine_shard) {
+        ++_server._stats.requests_sent_to_affine_shard;
+        f = process_on_shard(*affine_shard, stream, is, client_state, permit, trace_state, process_fn);
+    } else {
+        f = process_fn(client_state, _server._query_processor, in, stream,
+                _version, _cql_serialization_format, permit, trace_state, true);
+    }
+    return f.then([stream, &client_state, this, is, permit, process_fn, trace_state, shard_bound, predicted = bool(affine_shard)]
                    (std::variant<foreign_ptr<std::unique_ptr<cql_server::response>>, unsigned> msg) mutable {
         unsigned* shard = std::get_if<unsigned>(&msg);
         if (shard) {
-            return process_on_shard(*shard, stream, is, client_state, std::move(permit), trace_state, process_fn);
+            // Only statements which have to run on a specific shard bounce.
+            _shard_affinity.required_shard(*shard);
+            return process_on_shard(*shard, stream, is, client_state, std::move(permit), trace_state, process_fn).then([] (auto msg) {
+                // result here has to be foreign ptr
+                return std::get<foreign_ptr<std::unique_ptr<cql_server::response>>>(std::move(msg));
+            });
+        }
+        // A statement sent to the affine shard which didn't bounce only
+        // confirms the prediction, so it doesn't reinforce it.
+        if (shard_bound && !predicted) {
+            _shard_affinity.required_shard(this_shard_id());
         }
         return make_ready_future<foreign_ptr<std::unique_ptr<cql_server::response>>>(std::get<foreign_ptr<std::unique_ptr<cql_server::response>>>(std::move(msg)));
     });
@@ -1033,7 +1055,13 @@ process_execute_internal(service::client_state& client_state, distributed<cql3::
 future<foreign_ptr<std::unique_ptr<cql_server::response>>> cql_server::connection::process_execute(uint16_t stream, request_reader in,
         service::client_state& client_state, service_permit permit, tracing::trace_state_ptr trace_state) {
     ++_server._stats.execute_requests;
-    return process(stream, in, client_state, std::move(permit), std::move(trace_state), process_execute_internal);
+    // Only LWT statements have to execute on a specific shard. Other statements
+    // neither use nor update the affinity of the connection.
+    request_reader id_in = in;
+    cql3::prepared_cache_key_type cache_key(id_in.read_short_bytes());
+    auto prepared = _server._query_processor.local().get_prepared(cache_key);
+    bool shard_bound = prepared && prepared->is_conditional;
+    return process(stream, in, client_state, std::move(permit), std::move(trace_state), process_execute_internal, shard_bound);
 }
 
 static future<std::variant<foreign_ptr<std::unique_ptr<cql_server::response>>, unsigned>>
@@ -1461,15 +1489,40 @@ cql_server::connection::make_schema_change_event(const event::schema_change& eve
 
 void cql_server::connection::write_response(foreign_ptr<std::unique_ptr<cql_server::response>>&& response, service_permit permit, cql_compression compression)
 {
+    ++_queued_responses;
     _ready_to_respond = _ready_to_respond.then([this, compression, response = std::move(response), permit = std::move(permit)] () mutable {
+        --_queued_responses;
         auto message = response->make_message(_version, compression);
         message.on_delete([response = std::move(response)] { });
         return _write_buf.write(std::move(message)).then([this] {
-            return _write_buf.flush();
+            // Responses queued behind this one are appended to the same
+            // output packet, so that they are all sent by a single flush.
+            if (_queued_responses) {
+                return make_ready_future<>();
+            }
+            return flush_responses();
         });
     });
 }
 
+future<> cql_server::connection::flush_responses() {
+    // The gate is held by the loop reading requests and by every request
+    // which wasn't answered yet, including the one whose response was just written.
+    auto other_requests_in_flight = [this] {
+        return _pending_requests_gate.get_count() > 2;
+    };
+    auto delay = _server._config.response_flush_delay;
+    auto f = delay.count() && other_requests_in_flight() ? seastar::sleep(delay) : make_ready_future<>();
+    return f.then([this] {
+        // Responses which got ready during the delay will flush.
+        if (_queued_responses) {
+            return make_ready_future<>();
+        }
+        ++_server._stats.response_flushes;
+        return _write_buf.flush();
+    });
+}
+
 scattered_message<char> cql_server::response::make_message(uint8_t version, cql_compression compression) {
     if (compression != cql_compression::none) {
         compress(compression);
@@ -122,6 +122,40 @@ struct cql_server_config {
     std::optional<uint16_t> shard_aware_transport_port_ssl;
     bool allow_shard_aware_drivers = true;
     smp_service_group bounce_request_smp_service_group = default_smp_service_group();
+    // How long a connection waits for responses of its in-flight requests
+    // before flushing the responses written so far.
+    std::chrono::microseconds response_flush_delay{0};
+};
+
+// Tracks the shards on which statements of a connection which have to be
+// executed on a specific shard (LWT statements, executed on the shard owning
+// their token) recently ran. If most of them had to run on the same other
+// shard, such statements are sent there directly, instead of being bounced
+// there after being processed on the shard which owns the connection.
+class shard_affinity {
+    unsigned _shard = this_shard_id();
+    unsigned _score = 0;
+public:
+    static constexpr unsigned threshold = 8;
+    static constexpr unsigned max_score = 16;
+
+    // Records that a statement had to be executed on the given shard.
+    void required_shard(unsigned shard) noexcept {
+        if (shard == _shard) {
+            _score = std::min(_score + 1, max_score);
+        } else if (_score > 0) {
+            --_score;
+        } else {
+            _shard = shard;
+            _score = 1;
+        }
+    }
+    std::optional<unsigned> affine_shard() const noexcept {
+        if (_score < threshold || _shard == this_shard_id()) {
+            return std::nullopt;
+        }
+        return _shard;
+    }
 };
 
 class cql_server : public seastar::peering_sharded_service<cql_server>, public generic_server::server {
@@ -144,6 +178,8 @@ class cql_server : public seastar::peering_sharded_service<cql_server>, public g
         uint64_t execute_requests;
         uint64_t batch_requests;
         uint64_t register_requests;
+        uint64_t requests_sent_to_affine_shard;
+        uint64_t response_flushes;
 
         std::unordered_map<exceptions::exception_code, uint64_t> errors;
     };
@@ -171,6 +207,8 @@ class cql_server : public seastar::peering_sharded_service<cql_server>, public g
             qos::service_level_controller& sl_controller);
 public:
     using response = cql_transport::response;
+
+    const transport_stats& get_stats() const noexcept { return _stats; }
 private:
     class fmt_visitor;
     friend class connection;
@@ -189,6 +227,10 @@ class cql_server : public seastar::peering_sharded_service<cql_server>, public g
         timer<lowres_clock> _shedding_timer;
         bool _shed_incoming_requests = false;
         unsigned _request_cpu = 0;
+        // Number of responses waiting in _ready_to_respond to be written.
+        unsigned _queued_responses = 0;
+
+        shard_affinity _shard_affinity;
 
         enum class tracing_request_type : uint8_t {
             not_requested,
@@ -251,17 +293,20 @@ class cql_server : public seastar::peering_sharded_service<cql_server>, public g
         std::unique_ptr<cql_server::response> make_auth_success(int16_t, bytes, const tracing::trace_state_ptr& tr_state) const;
         std::unique_ptr<cql_server::response> make_auth_challenge(int16_t, bytes, const tracing::trace_state_ptr& tr_state) const;
 
-        // Helper functions to encapsulate bounce_to_shard processing for query, execute and batch verbs
+        // Helper functions to encapsulate bounce_to_shard processing for query, execute and batch verbs.
+        // If shard_bound, the request is known to have to execute on a specific shard, and may be
+        // sent directly to the affine shard of the connection, see shard_affinity.
         template<typename Process>
         future<foreign_ptr<std::unique_ptr<cql_server::response>>>
         process(uint16_t stream, request_reader in, service::client_state& client_state, service_permit permit, tracing::trace_state_ptr trace_state,
-                Process process_fn);
+                Process process_fn, bool shard_bound = false);
         template<typename Process>
-        future<foreign_ptr<std::unique_ptr<cql_server::response>>>
+        future<std::variant<foreign_ptr<std::unique_ptr<cql_server::response>>, unsigned>>
         process_on_shard(unsigned shard, uint16_t stream, fragmented_temporary_buffer::istream is, service::client_state& cs,
                 service_permit permit, tracing::trace_state_ptr trace_state, Process process_fn);
 
         void write_response(foreign_ptr<std::unique_ptr<cql_server::response>>&& response, service_permit permit = empty_service_permit(), cql_compression compression = cql_compression::none);
+        future<> flush_responses();
 
         void init_cql_serialization_format();
 
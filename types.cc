@@ -853,6 +853,20 @@ struct is_byte_order_equal_visitor {
 
 bool abstract_type::is_byte_order_equal() const { return visit(*this, is_byte_order_equal_visitor{}); }
 
+namespace {
+// Must agree with compare_visitor.
+struct is_byte_order_comparable_visitor {
+    bool operator()(const abstract_type&) { return false; }
+    bool operator()(const string_type_impl&) { return true; }
+    bool operator()(const bytes_type_impl&) { return true; }
+    bool operator()(const inet_addr_type_impl&) { return true; }
+    bool operator()(const date_type_impl&) { return true; }
+    bool operator()(const simple_date_type_impl&) { return true; }
+};
+}
+
+bool abstract_type::is_byte_order_comparable() const { return visit(*this, is_byte_order_comparable_visitor{}); }
+
 static bool
 check_compatibility(const tuple_type_impl &t, const abstract_type& previous, bool (abstract_type::*predicate)(const abstract_type&) const);
 
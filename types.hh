@@ -569,6 +569,11 @@ class abstract_type : public enable_shared_from_this<abstract_type> {
      * When returns false, nothing can be inferred.
      */
     bool is_byte_order_equal() const;
+    /**
+     * When returns true then values compare the same way as their byte
+     * representations compared lexicographically as unsigned bytes.
+     */
+    bool is_byte_order_comparable() const;
     sstring get_string(const bytes& b) const;
     sstring to_string(bytes_view bv) const {
         return to_string_impl(deserialize(bv));
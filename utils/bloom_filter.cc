@@ -103,12 +103,65 @@ bool bloom_filter::is_present(const bytes_view& key) {
     return is_present(make_hashed_key(key));
 }
 
+// Odd constants used to derive the bit of each word of a block from the key's hash,
+// the same ones as used by the split block bloom filters of Parquet and Impala.
+static constexpr std::array<uint32_t, split_block_bloom_filter::words_per_block> split_block_salts = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
+
+static std::array<uint64_t, split_block_bloom_filter::words_per_block> split_block_masks(hashed_key key) {
+    auto h = static_cast<uint32_t>(key.hash()[1]);
+    std::array<uint64_t, split_block_bloom_filter::words_per_block> masks;
+    for (size_t i = 0; i < masks.size(); i++) {
+        // The top 6 bits of the product select one of the 64 bits of the word.
+        masks[i] = uint64_t(1) << ((h * split_block_salts[i]) >> 26);
+    }
+    return masks;
+}
+
+split_block_bloom_filter::split_block_bloom_filter(bitmap&& bs) noexcept
+    : bloom_filter(hash_count, std::move(bs), filter_format::split_block_format)
+    , _nr_blocks(bits().size() / bits_per_block)
+{ }
+
+size_t split_block_bloom_filter::block_of(hashed_key key) const {
+    // Maps the hash onto [0, _nr_blocks) with a multiplication instead of a division.
+    return (static_cast<unsigned __int128>(key.hash()[0]) * _nr_blocks) >> 64;
+}
+
+void split_block_bloom_filter::add(const bytes_view& key) {
+    auto hk = make_hashed_key(key);
+    auto masks = split_block_masks(hk);
+    auto block = bits().words(block_of(hk) * words_per_block);
+    for (size_t i = 0; i < words_per_block; i++) {
+        block[i] |= masks[i];
+    }
+}
+
+bool split_block_bloom_filter::is_present(hashed_key key) {
+    auto masks = split_block_masks(key);
+    auto block = bits().words(block_of(key) * words_per_block);
+    uint64_t missing = 0;
+    for (size_t i = 0; i < words_per_block; i++) {
+        missing |= masks[i] & ~block[i];
+    }
+    return !missing;
+}
+
 filter_ptr create_filter(int hash, large_bitset&& bitset, filter_format format) {
+    if (format == filter_format::split_block_format) {
+        return std::make_unique<split_block_bloom_filter>(std::move(bitset));
+    }
     return std::make_unique<murmur3_bloom_filter>(hash, std::move(bitset), format);
 }
 
 filter_ptr create_filter(int hash, int64_t num_elements, int buckets_per, filter_format format) {
     int64_t num_bits = (num_elements * buckets_per) + bloom_calculations::EXCESS;
+    if (format == filter_format::split_block_format) {
+        num_bits = align_up<int64_t>(num_bits, split_block_bloom_filter::bits_per_block);
+        return std::make_unique<split_block_bloom_filter>(large_bitset(num_bits));
+    }
     num_bits = align_up<int64_t>(num_bits, 64);  // Seems to be implied in origin
     large_bitset bitset(num_bits);
     return std::make_unique<murmur3_bloom_filter>(hash, std::move(bitset), format);
@@ -46,6 +46,7 @@
 #include "utils/murmur_hash.hh"
 #include "utils/large_bitset.hh"
 
+#include <limits>
 #include <vector>
 
 namespace utils {
@@ -100,6 +101,37 @@ struct murmur3_bloom_filter: public bloom_filter {
     {}
 };
 
+// A bloom filter made of blocks of the size of a cache line. A key selects
+// a block, and sets one bit in each of the block's words, so a lookup costs
+// at most one cache miss instead of up to one per hash. The per-word probes
+// don't depend on each other and are evaluated without branches, so that
+// the compiler can vectorize them.
+//
+// A block is eight 64-bit words (512 bits). The bit of each word is taken from
+// the top 6 bits of the 32-bit product of the key's hash and the salt of the
+// word. Parquet uses the same salts, but with 256-bit blocks of 32-bit words,
+// so the two layouts are not interchangeable.
+class split_block_bloom_filter: public bloom_filter {
+public:
+    static constexpr size_t words_per_block = 8;
+    static constexpr size_t bits_per_block = words_per_block * std::numeric_limits<uint64_t>::digits;
+    // Every key sets one bit per word.
+    static constexpr int hash_count = words_per_block;
+private:
+    size_t _nr_blocks;
+
+    size_t block_of(hashed_key key) const;
+public:
+    // The size of the bitset must be a non-zero multiple of bits_per_block.
+    explicit split_block_bloom_filter(bitmap&& bs) noexcept;
+
+    virtual void add(const bytes_view& key) override;
+
+    virtual bool is_present(hashed_key key) override;
+
+    using bloom_filter::is_present;
+};
+
 struct always_present_filter: public i_filter {
 
     virtual bool is_present(const bytes_view& key) override {
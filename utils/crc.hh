@@ -100,6 +100,37 @@ class crc32 {
         process_le(in);
     }
 
+    // Processes a block of 3*N+2 u64 words in three parallel loops, to hide
+    // the latency of the crc32 instruction, and combines their crcs using
+    // carry-less multiplication by K0 and K1, which are CRC32(x^(N*64*2))
+    // and CRC32(x^(N*64)) for the given N.
+    template <unsigned N, uint32_t K0, uint32_t K1>
+    static uint32_t process_block(uint32_t crc, const uint8_t* in) {
+        uint32_t crc0 = crc, crc1 = 0, crc2 = 0;
+
+        // calculate three blocks in parallel
+        // - crc0: in64[   0,     1, ...,   N-1]
+        // - crc1: in64[   N,   N+1, ..., 2*N-1]
+        // - crc2: in64[ 2*N, 2*N+1, ..., 3*N-1]
+        for (unsigned i = 0; i < N; ++i, in += 8) {
+            crc0 = _mm_crc32_u64(crc0, seastar::read_le<uint64_t>((const char*)in));
+            crc1 = _mm_crc32_u64(crc1, seastar::read_le<uint64_t>((const char*)in + N*8));
+            crc2 = _mm_crc32_u64(crc2, seastar::read_le<uint64_t>((const char*)in + N*2*8));
+        }
+        in += N*2*8;
+
+        // combine three blocks' crc and last two u64
+        // - CRC32(crc0 * CRC32(x^(N*64*2)))
+        crc0 = _mm_crc32_u64(0, clmul_u32(crc0, K0));
+        // - CRC32(crc1 * CRC32(x^(N*64)))
+        crc1 = _mm_crc32_u64(0, clmul_u32(crc1, K1));
+        // - CRC32(crc2 * x^32 + u64[-2])
+        crc2 = _mm_crc32_u64(crc2, seastar::read_le<uint64_t>((const char*)in));
+        in += 8;
+        // - Last u64
+        return _mm_crc32_u64(crc0^crc1^crc2, seastar::read_le<uint64_t>((const char*)in));
+    }
+
     void process(const uint8_t* in, size_t size) {
         if ((reinterpret_cast<uintptr_t>(in) & 1) && size >= 1) {
             process_le(*in);
@@ -117,35 +148,18 @@ class crc32 {
             size -= 4;
         }
 
-        // do in three parallel loops
+        // Large inputs are processed in 1024-byte blocks, and the rest in 256-byte blocks,
+        // so that medium-sized inputs, like commitlog entries, benefit from parallel loops too.
         while (size >= 1024) {
-            uint32_t crc0 = _r, crc1 = 0, crc2 = 0;
-
-            // calculate three blocks in parallel
-            // - crc0: in64[ 0,  1, ...,  41]
-            // - crc1: in64[42, 43, ...,  83]
-            // - crc2: in64[84, 85, ..., 125]
-            for (int i = 0; i < 42; ++i, in += 8) {
-                crc0 = _mm_crc32_u64(crc0, seastar::read_le<uint64_t>((const char*)in));
-                crc1 = _mm_crc32_u64(crc1, seastar::read_le<uint64_t>((const char*)in + 42*8));
-                crc2 = _mm_crc32_u64(crc2, seastar::read_le<uint64_t>((const char*)in + 42*2*8));
-            }
-            in += 42*2*8;
-
-            // combine three blocks' crc and last two u64
-            // - CRC32(crc0 * CRC32(x^(42*64*2)))
-            crc0 = _mm_crc32_u64(0, clmul_u32(crc0, 0xe417f38a));
-            // - CRC32(crc1 * CRC32(x^(42*64)))
-            crc1 = _mm_crc32_u64(0, clmul_u32(crc1, 0x8f158014));
-            // - CRC32(crc2 * x^32 + u64[-2])
-            crc2 = _mm_crc32_u64(crc2, seastar::read_le<uint64_t>((const char*)in));
-            in += 8;
-            // - Last u64
-            _r = _mm_crc32_u64(crc0^crc1^crc2, seastar::read_le<uint64_t>((const char*)in));
-            in += 8;
-
+            _r = process_block<42, 0xe417f38a, 0x8f158014>(_r, in);
+            in += 1024;
             size -= 1024;
         }
+        while (size >= 256) {
+            _r = process_block<10, 0x1b3d8f29, 0x083a6eec>(_r, in);
+            in += 256;
+            size -= 256;
+        }
 
         while (size >= 8) {
             process_le(seastar::read_le<uint64_t>(reinterpret_cast<const char*>(in)));
@@ -492,6 +492,21 @@ struct estimated_histogram {
         _sample_sum += n;
     }
 
+    /**
+     * Adds weight to the count of the bucket closest to n, rounding UP,
+     * as if n was added weight times.
+     */
+    void add_weighted(int64_t n, int64_t weight) {
+        auto pos = bucket_offsets.size();
+        auto low = std::lower_bound(bucket_offsets.begin(), bucket_offsets.end(), n);
+        if (low != bucket_offsets.end()) {
+            pos = std::distance(bucket_offsets.begin(), low);
+        }
+        buckets.at(pos) += weight;
+        _count += weight;
+        _sample_sum += n * weight;
+    }
+
     /**
      * Increments the count of the bucket closest to n, rounding UP.
      * when using sampling, the number of items in the bucket will
@@ -41,6 +41,12 @@ filter_ptr i_filter::get_filter(int64_t num_elements, double max_false_pos_proba
 
     int buckets_per_element = bloom_calculations::max_buckets_per_element(num_elements);
     auto spec = bloom_calculations::compute_bloom_spec(buckets_per_element, max_false_pos_probability);
+    if (fformat == filter_format::split_block_format) {
+        // Confining the bits of a key to a single block makes the false positive
+        // rate somewhat worse than that of a standard bloom filter of the same
+        // size, which an extra bit per element more than makes up for.
+        return filter::create_filter(filter::split_block_bloom_filter::hash_count, num_elements, spec.buckets_per_element + 1, fformat);
+    }
     return filter::create_filter(spec.K, num_elements, spec.buckets_per_element, fformat);
 }
 
@@ -51,6 +51,10 @@ using filter_ptr = std::unique_ptr<i_filter>;
 enum class filter_format {
     k_l_format,
     m_format,
+    // Split block bloom filter: all bits of a key are set in a single
+    // cache-line sized block, one bit in each of its words, so a lookup
+    // touches a single cache line. Not readable by Cassandra.
+    split_block_format,
 };
 
 class hashed_key {
@@ -896,6 +896,24 @@ class tree {
             }
         }
 
+        /*
+         * Returns pointer on the owning tree. Walks up to the root,
+         * so it takes logarithmic time.
+         */
+        tree* owning_tree() noexcept {
+            node_base* n = super::revalidate();
+
+            if (n->is_inline()) {
+                return tree::from_inline(n);
+            }
+
+            node* nd = node::from_base(n);
+            while (!nd->is_root()) {
+                nd = nd->_parent.n;
+            }
+            return nd->_parent.t;
+        }
+
         template <typename Disp>
         requires Disposer<Disp, Key>
         iterator erase_and_dispose(Disp&& disp) noexcept {
@@ -74,4 +74,14 @@ class large_bitset {
     const utils::chunked_vector<int_type>& get_storage() const {
         return _storage;
     }
+
+    // Returns a pointer to the idx-th word of the storage. Words following
+    // it are contiguous up to the end of the storage chunk it belongs to,
+    // which is never crossed by an aligned group of a power-of-two words.
+    int_type* words(size_t idx) {
+        return &_storage[idx];
+    }
+    const int_type* words(size_t idx) const {
+        return &_storage[idx];
+    }
 };
@@ -49,6 +49,7 @@
 
 #include <random>
 #include <chrono>
+#include <sys/mman.h>
 
 using namespace std::chrono_literals;
 
@@ -377,6 +378,8 @@ class background_reclaimer {
     scheduling_group _sg;
     noncopyable_function<void (size_t target)> _reclaim;
     timer<lowres_clock> _adjust_shares_timer;
+    // Wakes the main loop on behalf of kick(), which may run in the allocator.
+    timer<> _kick_timer;
     // If engaged, main loop is not running, set_value() to wake it.
     promise<>* _main_loop_wait = nullptr;
     future<> _done;
@@ -416,6 +419,13 @@ class background_reclaimer {
         }
         llogger.debug("background_reclaimer::main_loop: exit");
     }
+    void on_kick() {
+        if (_sg != default_scheduling_group()) {
+            adjust_shares();
+        } else if (have_work()) {
+            main_loop_wake();
+        }
+    }
     void adjust_shares() {
         if (have_work()) {
             auto shares = 1 + (1000 * (free_memory_threshold - memory::stats().free_memory())) / free_memory_threshold;
@@ -431,13 +441,23 @@ class background_reclaimer {
             : _sg(sg)
             , _reclaim(std::move(reclaim))
             , _adjust_shares_timer(default_scheduling_group(), [this] { adjust_shares(); })
+            , _kick_timer(default_scheduling_group(), [this] { on_kick(); })
             , _done(with_scheduling_group(_sg, [this] { return main_loop(); })) {
         if (sg != default_scheduling_group()) {
             _adjust_shares_timer.arm_periodic(50ms);
         }
     }
+    // Called when LSA takes memory from the standard allocator, so that
+    // the reclaimer frees memory ahead of the next allocations instead of
+    // waiting for the next adjust_shares() tick. Doesn't allocate.
+    void kick() noexcept {
+        if (_main_loop_wait && !_stopping && !_kick_timer.armed()) {
+            _kick_timer.arm(timer<>::clock::now());
+        }
+    }
     future<> stop() {
         _stopping = true;
+        _kick_timer.cancel();
         main_loop_wake();
         return std::move(_done);
     }
@@ -450,6 +470,7 @@ class tracker::impl {
     bool _reclaiming_enabled = true;
     size_t _reclamation_step = 1;
     bool _abort_on_bad_alloc = false;
+    uint64_t _sync_reclaims = 0;
 private:
     // Prevents tracker's reclaimer from running while live. Reclaimer may be
     // invoked synchronously with allocator. This guard ensures that this
@@ -478,6 +499,14 @@ class tracker::impl {
             return make_ready_future<>();
         }
     }
+    void kick_background_reclaim() noexcept {
+        if (_background_reclaimer) {
+            _background_reclaimer->kick();
+        }
+    }
+    void on_sync_reclaim() noexcept {
+        ++_sync_reclaims;
+    }
     void register_region(region::impl*);
     void unregister_region(region::impl*) noexcept;
     size_t reclaim(size_t bytes, is_preemptible p);
@@ -588,6 +617,10 @@ struct alignas(segment_size) segment {
     static void operator delete(void* ptr) = delete;
 };
 
+// Size of a transparent huge page on x86_64 and aarch64 with 4K base pages.
+static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+static_assert(huge_page_size % segment_size == 0, "Segments must not cross huge page boundaries");
+
 static constexpr size_t max_managed_object_size = segment_size * 0.1;
 static constexpr auto max_used_space_ratio_for_compaction = 0.85;
 static constexpr size_t max_used_space_for_compaction = segment_size * max_used_space_ratio_for_compaction;
@@ -693,6 +726,26 @@ class segment_store {
     bool can_allocate_more_segments() {
         return memory::stats().free_memory() >= non_lsa_reserve + segment::size;
     }
+    // Returns the index of the huge page containing the segment within the shard's
+    // memory, or nullopt if the huge page is not entirely within the shard's memory.
+    std::optional<size_t> huge_page_idx(segment* seg) const {
+        auto start = align_down(reinterpret_cast<uintptr_t>(seg), huge_page_size);
+        if (start < _layout.start || start + huge_page_size > _layout.end) {
+            return std::nullopt;
+        }
+        return (start - align_down(_layout.start, huge_page_size)) / huge_page_size;
+    }
+    size_t max_huge_pages() const {
+        return (_layout.end - align_down(_layout.start, huge_page_size)) / huge_page_size + 1;
+    }
+    // Asks the kernel to back the huge page containing the segment
+    // with a transparent huge page.
+    void advise_huge_page(segment* seg) {
+        auto start = align_down(reinterpret_cast<uintptr_t>(seg), huge_page_size);
+        if (::madvise(reinterpret_cast<void*>(start), huge_page_size, MADV_HUGEPAGE)) {
+            llogger.debug("madvise(MADV_HUGEPAGE) failed for {:#x}: {}", start, strerror(errno));
+        }
+    }
 };
 #else
 class segment_store {
@@ -750,6 +803,14 @@ class segment_store {
         auto i = find_empty();
         return i != _segments.end();
     }
+    // Segments are allocated with the system allocator, whose memory we don't control.
+    std::optional<size_t> huge_page_idx(segment* seg) const {
+        return std::nullopt;
+    }
+    size_t max_huge_pages() const {
+        return 0;
+    }
+    void advise_huge_page(segment* seg) { }
 };
 #endif
 
@@ -770,6 +831,8 @@ class segment_pool {
     size_t _emergency_reserve_max = 30;
     bool _allocation_failure_flag = false;
     bool _allocation_enabled = true;
+    bool _use_transparent_hugepages = false;
+    utils::dynamic_bitset _advised_huge_pages;
 
     struct allocation_lock {
         segment_pool& _pool;
@@ -818,8 +881,13 @@ class segment_pool {
         return _allocation_enabled && _store.can_allocate_more_segments();
     }
     bool compact_segment(segment* seg);
+    void maybe_advise_huge_page(segment* seg);
 public:
     segment_pool();
+    // Makes memory of segments backed by transparent huge pages, if the kernel allows it.
+    // LSA memory is accessed randomly by lookups in large regions, like the cache,
+    // so they benefit from fewer TLB misses.
+    void use_transparent_hugepages();
     void prime(size_t available_memory, size_t min_free_memory);
     segment* new_segment(region::impl* r);
     segment_descriptor& descriptor(segment*);
@@ -863,6 +931,7 @@ class segment_pool {
     struct stats {
         size_t segments_compacted;
         size_t lsa_buffer_segments;
+        uint64_t segment_allocation_stalls;
         uint64_t memory_allocated;
         uint64_t memory_compacted;
     };
@@ -955,15 +1024,19 @@ segment* segment_pool::allocate_segment(size_t reserve)
         if (can_allocate_more_segments()) {
             memory::disable_abort_on_alloc_failure_temporarily dfg;
             auto p = aligned_alloc(segment::size, segment::size);
-            if (!p) {
-                continue;
+            if (p) {
+                auto seg = new (p) segment;
+                poison(seg, sizeof(segment));
+                auto idx = _store.new_idx_for_segment(seg);
+                _lsa_owned_segments_bitmap.set(idx);
+                maybe_advise_huge_page(seg);
+                shard_tracker().get_impl().kick_background_reclaim();
+                return seg;
             }
-            auto seg = new (p) segment;
-            poison(seg, sizeof(segment));
-            auto idx = _store.new_idx_for_segment(seg);
-            _lsa_owned_segments_bitmap.set(idx);
-            return seg;
         }
+        // The background reclaimer didn't keep up, so the allocating
+        // fiber has to compact and evict.
+        ++_stats.segment_allocation_stalls;
     } while (shard_tracker().get_impl().compact_and_evict(reserve, shard_tracker().reclamation_step() * segment::size, is_preemptible::no));
     return nullptr;
 }
@@ -1049,9 +1122,33 @@ segment_pool::segment_pool()
     : _segments(max_segments())
     , _lsa_owned_segments_bitmap(max_segments())
     , _lsa_free_segments_bitmap(max_segments())
+    , _advised_huge_pages(_store.max_huge_pages())
 {
 }
 
+void segment_pool::maybe_advise_huge_page(segment* seg) {
+    if (!_use_transparent_hugepages) {
+        return;
+    }
+    // Segments of a huge page are usually allocated one after another,
+    // so advise every huge page only once.
+    auto idx = _store.huge_page_idx(seg);
+    if (!idx || _advised_huge_pages.test(*idx)) {
+        return;
+    }
+    _advised_huge_pages.set(*idx);
+    _store.advise_huge_page(seg);
+}
+
+void segment_pool::use_transparent_hugepages() {
+    _use_transparent_hugepages = true;
+    // Segments allocated so far, including those allocated by prime().
+    for (size_t idx = _lsa_owned_segments_bitmap.find_first_set(); idx != utils::dynamic_bitset::npos;
+            idx = _lsa_owned_segments_bitmap.find_next_set(idx)) {
+        maybe_advise_huge_page(segment_from_idx(idx));
+    }
+}
+
 void segment_pool::prime(size_t available_memory, size_t min_free_memory) {
     auto old_emergency_reserve = std::exchange(_emergency_reserve_max, std::numeric_limits<size_t>::max());
     try {
@@ -1902,10 +1999,14 @@ void tracker::configure(const config& cfg) {
         _impl->enable_abort_on_bad_alloc();
     }
     _impl->setup_background_reclaim(cfg.background_reclaim_sched_group);
+    if (cfg.use_transparent_hugepages) {
+        shard_segment_pool.use_transparent_hugepages();
+    }
     s_sanitizer_report_backtrace = cfg.sanitizer_report_backtrace;
 }
 
 memory::reclaiming_result tracker::reclaim(seastar::memory::reclaimer::request r) {
+    _impl->on_sync_reclaim();
     return reclaim(std::max(r.bytes_to_reclaim, _impl->reclamation_step() * segment::size))
            ? memory::reclaiming_result::reclaimed_something
            : memory::reclaiming_result::reclaimed_nothing;
@@ -2367,6 +2468,12 @@ tracker::impl::impl() {
 
         sm::make_derive("memory_allocated", [this] { return shard_segment_pool.statistics().memory_allocated; },
                         sm::description("Counts number of bytes which were requested from LSA allocator.")),
+
+        sm::make_derive("segment_allocation_stalls", [this] { return shard_segment_pool.statistics().segment_allocation_stalls; },
+                        sm::description("Counts segment allocations which had to compact or evict synchronously, because the background reclaimer didn't free memory in time.")),
+
+        sm::make_derive("sync_reclaims", [this] { return _sync_reclaims; },
+                        sm::description("Counts reclamations which the standard allocator requested synchronously, because the background reclaimer didn't free memory in time.")),
     });
 }
 
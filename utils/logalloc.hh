@@ -436,6 +436,7 @@ class tracker {
         bool sanitizer_report_backtrace = false; // Better reports but slower
         size_t lsa_reclamation_step;
         scheduling_group background_reclaim_sched_group;
+        bool use_transparent_hugepages = false;
     };
 
     void configure(const config& cfg);
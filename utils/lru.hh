@@ -52,6 +52,17 @@ class evictable {
     }
 };
 
+// Marks a position in the LRU, so that it can be walked in steps with
+// preemption in between, see lru::walk(). It is not an entry of the cache,
+// so evicting it does nothing, and it unlinks itself when destroyed.
+class lru_cursor final : public evictable {
+public:
+    lru_cursor() = default;
+    lru_cursor(lru_cursor&&) = delete;
+    ~lru_cursor() = default;
+    void on_evicted() noexcept override {}
+};
+
 class lru {
 private:
     friend class evictable;
@@ -92,6 +103,28 @@ class lru {
         return reclaiming_result::reclaimed_something;
     }
 
+    // Calls func on the elements from the most recently used one towards the
+    // least recently used one, starting after the cursor if it is linked,
+    // until func returns stop_iteration::yes. The cursor is left before the
+    // last visited element, so a later call continues from there. Elements
+    // touched in between move to the front of the walk and are not visited again.
+    // Returns true when there are no more elements to visit.
+    template <typename Func>
+    bool walk(lru_cursor& cursor, Func&& func) {
+        auto pos = cursor.is_linked() ? _list.iterator_to(cursor) : _list.end();
+        while (pos != _list.begin()) {
+            auto prev = std::prev(pos);
+            if (func(*prev)) {
+                cursor.unlink_from_lru();
+                _list.insert(prev, cursor);
+                return false;
+            }
+            pos = prev;
+        }
+        cursor.unlink_from_lru();
+        return true;
+    }
+
     // Evicts all elements.
     // May stall the reactor, use only in tests.
     void evict_all() {
@@ -19,33 +19,181 @@
  * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <seastar/core/aligned_buffer.hh>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <seastar/core/alien.hh>
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/util/noncopyable_function.hh>
 
 // We need to use experimental features of the zstd library (to allocate compression/decompression context),
 // which are available only when the library is linked statically.
 #define ZSTD_STATIC_LINKING_ONLY
 #include "zstd.h"
+#define ZDICT_STATIC_LINKING_ONLY
+#include "zdict.h"
 
 #include "compress.hh"
 #include "utils/class_registrator.hh"
 
 static const sstring COMPRESSION_LEVEL = "compression_level";
+static const sstring DICTIONARY_SIZE_KB = "dictionary_size_in_kb";
 static const sstring COMPRESSOR_NAME = compressor::namespace_prefix + "ZstdCompressor";
 
+// Limits the amount of data the dictionary is trained on, and so the time
+// training takes, which happens once per sstable.
+static constexpr size_t MAX_DICTIONARY_SIZE_KB = 64;
+// zstd recommends training on about 100 times the size of the dictionary.
+// A bit less is used, so that the samples of the largest one take 4MB.
+static constexpr size_t DICTIONARY_SAMPLE_RATIO = 64;
+
+struct zstd_cctx_deleter {
+    void operator()(ZSTD_CCtx* cctx) const noexcept {
+        ZSTD_freeCCtx(cctx);
+    }
+};
+
+struct zstd_dctx_deleter {
+    void operator()(ZSTD_DCtx* dctx) const noexcept {
+        ZSTD_freeDCtx(dctx);
+    }
+};
+
+struct zstd_cdict_deleter {
+    void operator()(ZSTD_CDict* cdict) const noexcept {
+        ZSTD_freeCDict(cdict);
+    }
+};
+
+struct zstd_ddict_deleter {
+    void operator()(ZSTD_DDict* ddict) const noexcept {
+        ZSTD_freeDDict(ddict);
+    }
+};
+
+// Compression and decompression don't defer, so all compressors of a shard
+// share its contexts. With dictionaries, there is a compressor for every
+// sstable, and contexts of their own would take memory for as long as the
+// sstables are open. The contexts grow to fit the parameters they're used with.
+static thread_local std::unique_ptr<ZSTD_CCtx, zstd_cctx_deleter> local_cctx;
+static thread_local std::unique_ptr<ZSTD_DCtx, zstd_dctx_deleter> local_dctx;
+
+static ZSTD_CCtx* get_local_cctx() {
+    if (!local_cctx) {
+        local_cctx.reset(ZSTD_createCCtx());
+        if (!local_cctx) {
+            throw std::runtime_error("Unable to initialize ZSTD compression context");
+        }
+    }
+    return local_cctx.get();
+}
+
+static ZSTD_DCtx* get_local_dctx() {
+    if (!local_dctx) {
+        local_dctx.reset(ZSTD_createDCtx());
+        if (!local_dctx) {
+            throw std::runtime_error("Unable to initialize ZSTD decompression context");
+        }
+    }
+    return local_dctx.get();
+}
+
+// Trains dictionaries on a thread shared by all shards, at a lower priority
+// than the reactors, since training takes tens of milliseconds per sstable,
+// far longer than a reactor may go without preempting, and can't be preempted.
+// Each shard has at most one training queued, so the queue is bounded by the
+// shard count.
+class dictionary_trainer {
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::deque<noncopyable_function<void ()>> _jobs;
+    bool _stopped = false;
+    std::optional<std::thread> _thread;
+    static thread_local semaphore _local_slot;
+private:
+    void run() noexcept;
+public:
+    ~dictionary_trainer();
+    // Runs func on the trainer thread. Whatever func references must be
+    // kept alive until the returned future resolves.
+    future<size_t> submit(noncopyable_function<size_t ()> func);
+};
+
+thread_local semaphore dictionary_trainer::_local_slot{1};
+
+static dictionary_trainer the_dictionary_trainer;
+
+dictionary_trainer::~dictionary_trainer() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopped = true;
+    }
+    _cv.notify_one();
+    if (_thread) {
+        _thread->join();
+    }
+}
+
+void dictionary_trainer::run() noexcept {
+    ::setpriority(PRIO_PROCESS, ::syscall(SYS_gettid), 10);
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _cv.wait(lock, [this] { return _stopped || !_jobs.empty(); });
+        if (_stopped) {
+            return;
+        }
+        auto job = std::move(_jobs.front());
+        _jobs.pop_front();
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
+
+future<size_t> dictionary_trainer::submit(noncopyable_function<size_t ()> func) {
+    auto units = co_await get_units(_local_slot, 1);
+    promise<size_t> pr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_thread) {
+            _thread.emplace([this] { run(); });
+        }
+        _jobs.push_back([&func, &pr, shard = this_shard_id()] {
+            auto ret = func();
+            // The reactor is woken up by the message, so nothing polls for it.
+            seastar::alien::run_on(shard, [&pr, ret] () noexcept {
+                pr.set_value(ret);
+            });
+        });
+    }
+    _cv.notify_one();
+    // The promise can't be resolved before the reactor gets control back.
+    co_return co_await pr.get_future();
+}
+
 class zstd_processor : public compressor {
     int _compression_level = 3;
+    // Maximum size of the trained dictionary. Zero if dictionaries are not used.
+    size_t _dictionary_size = 0;
+    ZSTD_compressionParameters _cparams;
 
-    // Manages memory for the compression context.
-    std::unique_ptr<char[], free_deleter> _cctx_raw;
-    // Compression context. Observer of _cctx_raw.
-    ZSTD_CCtx* _cctx;
-
-    // Manages memory for the decompression context.
-    std::unique_ptr<char[], free_deleter> _dctx_raw;
-    // Decompression context. Observer of _dctx_raw.
-    ZSTD_DCtx* _dctx;
+    // Set only in compressors returned by with_dictionary().
+    // The digested dictionaries reference _dictionary.
+    bytes _dictionary;
+    std::unique_ptr<ZSTD_DDict, zstd_ddict_deleter> _ddict;
+    // Most compressors with a dictionary are only used for reading,
+    // so the compression dictionary is digested on first use.
+    mutable std::unique_ptr<ZSTD_CDict, zstd_cdict_deleter> _cdict;
 public:
     zstd_processor(const opt_getter&);
+    zstd_processor(const zstd_processor& base, bytes_view dictionary);
 
     size_t uncompress(const char* input, size_t input_len, char* output,
                     size_t output_len) const override;
@@ -55,6 +203,10 @@ class zstd_processor : public compressor {
 
     std::set<sstring> option_names() const override;
     std::map<sstring, sstring> options() const override;
+
+    size_t dictionary_sample_size() const override;
+    future<bytes> train_dictionary(const std::vector<temporary_buffer<char>>& samples) const override;
+    shared_ptr<compressor> with_dictionary(bytes_view dictionary) const override;
 };
 
 zstd_processor::zstd_processor(const opt_getter& opts)
@@ -76,6 +228,22 @@ zstd_processor::zstd_processor(const opt_getter& opts)
         }
     }
 
+    auto dictionary_size_kb = opts(DICTIONARY_SIZE_KB);
+    if (dictionary_size_kb) {
+        int size_kb;
+        try {
+            size_kb = std::stoi(*dictionary_size_kb);
+        } catch (const std::exception& e) {
+            throw exceptions::syntax_exception(
+                format("Invalid integer value {} for {}", *dictionary_size_kb, DICTIONARY_SIZE_KB));
+        }
+        if (size_kb < 0 || size_t(size_kb) > MAX_DICTIONARY_SIZE_KB) {
+            throw exceptions::configuration_exception(
+                format("{} must be between 0 and {}, got {}", DICTIONARY_SIZE_KB, MAX_DICTIONARY_SIZE_KB, size_kb));
+        }
+        _dictionary_size = size_t(size_kb) * 1024;
+    }
+
     auto chunk_len_kb = opts(compression_parameters::CHUNK_LENGTH_KB);
     if (!chunk_len_kb) {
         chunk_len_kb = opts(compression_parameters::CHUNK_LENGTH_KB_ERR);
@@ -86,25 +254,28 @@ zstd_processor::zstd_processor(const opt_getter& opts)
        : compression_parameters::DEFAULT_CHUNK_LENGTH;
 
     // We assume that the uncompressed input length is always <= chunk_len.
-    auto cparams = ZSTD_getCParams(_compression_level, chunk_len, 0);
-    auto cctx_size = ZSTD_estimateCCtxSize_usingCParams(cparams);
-    // According to the ZSTD documentation, pointer to the context buffer must be 8-bytes aligned.
-    _cctx_raw = allocate_aligned_buffer<char>(cctx_size, 8);
-    _cctx = ZSTD_initStaticCCtx(_cctx_raw.get(), cctx_size);
-    if (!_cctx) {
-        throw std::runtime_error("Unable to initialize ZSTD compression context");
-    }
+    // The dictionary, if any, adds to the data the compressor has to index.
+    _cparams = ZSTD_getCParams(_compression_level, chunk_len, _dictionary_size);
+}
 
-    auto dctx_size = ZSTD_estimateDCtxSize();
-    _dctx_raw = allocate_aligned_buffer<char>(dctx_size, 8);
-    _dctx = ZSTD_initStaticDCtx(_dctx_raw.get(), dctx_size);
-    if (!_cctx) {
-        throw std::runtime_error("Unable to initialize ZSTD decompression context");
+zstd_processor::zstd_processor(const zstd_processor& base, bytes_view dictionary)
+    : compressor(COMPRESSOR_NAME)
+    , _compression_level(base._compression_level)
+    , _dictionary_size(base._dictionary_size)
+    , _cparams(base._cparams)
+    , _dictionary(dictionary.begin(), dictionary.end())
+{
+    _ddict.reset(ZSTD_createDDict_byReference(_dictionary.data(), _dictionary.size()));
+    if (!_ddict) {
+        throw std::runtime_error("Unable to load ZSTD decompression dictionary");
     }
 }
 
 size_t zstd_processor::uncompress(const char* input, size_t input_len, char* output, size_t output_len) const {
-    auto ret = ZSTD_decompressDCtx(_dctx, output, output_len, input, input_len);
+    auto dctx = get_local_dctx();
+    auto ret = _ddict
+            ? ZSTD_decompress_usingDDict(dctx, output, output_len, input, input_len, _ddict.get())
+            : ZSTD_decompressDCtx(dctx, output, output_len, input, input_len);
     if (ZSTD_isError(ret)) {
         throw std::runtime_error( format("ZSTD decompression failure: {}", ZSTD_getErrorName(ret)));
     }
@@ -113,7 +284,16 @@ size_t zstd_processor::uncompress(const char* input, size_t input_len, char* out
 
 
 size_t zstd_processor::compress(const char* input, size_t input_len, char* output, size_t output_len) const {
-    auto ret = ZSTD_compressCCtx(_cctx, output, output_len, input, input_len, _compression_level);
+    if (_ddict && !_cdict) {
+        _cdict.reset(ZSTD_createCDict_advanced(_dictionary.data(), _dictionary.size(), ZSTD_dlm_byRef, ZSTD_dct_auto, _cparams, ZSTD_defaultCMem));
+        if (!_cdict) {
+            throw std::runtime_error("Unable to load ZSTD compression dictionary");
+        }
+    }
+    auto cctx = get_local_cctx();
+    auto ret = _cdict
+            ? ZSTD_compress_usingCDict(cctx, output, output_len, input, input_len, _cdict.get())
+            : ZSTD_compressCCtx(cctx, output, output_len, input, input_len, _compression_level);
     if (ZSTD_isError(ret)) {
         throw std::runtime_error( format("ZSTD compression failure: {}", ZSTD_getErrorName(ret)));
     }
@@ -125,11 +305,63 @@ size_t zstd_processor::compress_max_size(size_t input_len) const {
 }
 
 std::set<sstring> zstd_processor::option_names() const {
-    return {COMPRESSION_LEVEL};
+    return {COMPRESSION_LEVEL, DICTIONARY_SIZE_KB};
 }
 
 std::map<sstring, sstring> zstd_processor::options() const {
-    return {{COMPRESSION_LEVEL, std::to_string(_compression_level)}};
+    std::map<sstring, sstring> opts{{COMPRESSION_LEVEL, std::to_string(_compression_level)}};
+    if (_dictionary_size) {
+        opts.emplace(DICTIONARY_SIZE_KB, std::to_string(_dictionary_size / 1024));
+    }
+    return opts;
+}
+
+size_t zstd_processor::dictionary_sample_size() const {
+    return _dictionary_size * DICTIONARY_SAMPLE_RATIO;
+}
+
+future<bytes> zstd_processor::train_dictionary(const std::vector<temporary_buffer<char>>& samples) const {
+    size_t total_size = 0;
+    std::vector<size_t> sample_sizes;
+    sample_sizes.reserve(samples.size());
+    for (auto& s : samples) {
+        total_size += s.size();
+        sample_sizes.push_back(s.size());
+    }
+    auto buf = std::make_unique<char[]>(total_size);
+    bytes dictionary(bytes::initialized_later(), _dictionary_size);
+
+    ZDICT_fastCover_params_t params{};
+    params.d = 8;
+    params.k = 200;
+    params.f = 18;
+    params.accel = 1;
+    params.zParams.compressionLevel = _compression_level;
+
+    size_t ret;
+    try {
+        ret = co_await the_dictionary_trainer.submit([&] () noexcept {
+            // The trainer expects the samples to be concatenated.
+            auto dst = buf.get();
+            for (auto& s : samples) {
+                dst = std::copy_n(s.get(), s.size(), dst);
+            }
+            return ZDICT_trainFromBuffer_fastCover(dictionary.data(), dictionary.size(), buf.get(), sample_sizes.data(), sample_sizes.size(), params);
+        });
+    } catch (const std::system_error&) {
+        // Couldn't start the trainer thread. The sstable is compressed without a dictionary.
+        co_return bytes();
+    }
+    if (ZDICT_isError(ret)) {
+        // Most likely not enough data. The sstable is compressed without a dictionary.
+        co_return bytes();
+    }
+    dictionary.resize(ret);
+    co_return dictionary;
+}
+
+shared_ptr<compressor> zstd_processor::with_dictionary(bytes_view dictionary) const {
+    return ::make_shared<zstd_processor>(*this, dictionary);
 }
 
 static const class_registrator<compressor_ptr, zstd_processor, const compressor::opt_getter&>